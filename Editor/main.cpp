@@ -17,7 +17,7 @@ public:
     virtual ~SpoonEditorApp() {
         std::cout << "SpoonEngine Editor shutting down..." << std::endl;
     }
-    
+
 protected:
     void OnInitialize() override {
         std::cout << "Editor initialized" << std::endl;
@@ -87,12 +87,28 @@ protected:
         
         // Update materials with camera position
         UpdateMaterialsWithCameraPosition();
+        
+        // A click's entity id arrives a frame or two after its picking pass
+        if (m_PickResultReady) {
+            m_PickResultReady = false;
+            m_SelectedEntity = SpoonEngine::Entity();
+            for (auto entity : m_SceneEntities) {
+                if (static_cast<int>(entity.GetID()) == m_PickResult) {
+                    m_SelectedEntity = entity;
+                }
+            }
+        }
     }
     
     void OnRender() override {
         // Render scene to framebuffer safely
         if (m_ViewportFramebuffer && m_RenderSystem) {
+            SPOON_GPU_SCOPE("Editor Viewport");
             try {
+                // Deferred shading and dynamic resolution size their targets from it
+                SpoonEngine::FramebufferRegion region = m_ViewportFramebuffer->GetRegion();
+                m_RenderSystem->SetViewportSize(region.Width, region.Height);
+                
                 m_ViewportFramebuffer->Bind();
                 GetRenderer()->SetClearColor(0.1f, 0.1f, 0.1f, 1.0f);
                 GetRenderer()->Clear();
@@ -101,6 +117,11 @@ protected:
                 m_RenderSystem->Render(GetRenderer());
                 
                 m_ViewportFramebuffer->Unbind();
+                
+                if (m_PickRequested) {
+                    m_PickRequested = false;
+                    RenderPickingPass();
+                }
             } catch (...) {
                 // If framebuffer rendering fails, unbind and continue
                 m_ViewportFramebuffer->Unbind();
@@ -124,8 +145,11 @@ protected:
         }
         
         // Render ImGui
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        {
+            SPOON_GPU_SCOPE("Editor UI");
+            ImGui::Render();
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
     }
     
     void OnShutdown() override {
@@ -136,7 +160,7 @@ protected:
         
         std::cout << "Basic Editor shutdown" << std::endl;
     }
-    
+
 private:
     void InitializeImGui() {
         // Setup Dear ImGui context
@@ -184,6 +208,7 @@ private:
                 ImGui::MenuItem("Scene Hierarchy", nullptr, &m_ShowSceneHierarchy);
                 ImGui::MenuItem("Properties", nullptr, &m_ShowProperties);
                 ImGui::MenuItem("Viewport", nullptr, &m_ShowViewport);
+                ImGui::MenuItem("Profiler", nullptr, &m_ShowProfiler);
                 ImGui::EndMenu();
             }
             ImGui::EndMainMenuBar();
@@ -202,6 +227,10 @@ private:
             RenderViewport();
         }
         
+        if (m_ShowProfiler) {
+            RenderProfiler();
+        }
+        
         // Render dialogs every frame
         RenderSaveAsDialog();
         RenderOpenDialog();
@@ -317,6 +346,137 @@ private:
         ImGui::End();
     }
     
+    void RenderProfiler() {
+        if (!ImGui::Begin("Profiler", &m_ShowProfiler)) {
+            ImGui::End();
+            return;
+        }
+        
+        const auto& timings = GetRenderer()->GetFrameTimings();
+        auto stats = GetRenderer()->GetStats();
+        
+        ImGui::Text("Record: %.3f ms  Submit: %.3f ms", timings.RecordTime, timings.SubmitTime);
+        ImGui::Text("Draw calls: %u  Triangles: %llu", stats.DrawCalls, static_cast<unsigned long long>(stats.Triangles));
+        ImGui::Separator();
+        
+        if (m_RenderSystem) {
+            bool prePass = m_RenderSystem->IsDepthPrePass();
+            if (ImGui::Checkbox("Depth pre-pass", &prePass)) {
+                m_RenderSystem->SetDepthPrePass(prePass);
+            }
+        }
+        ImGui::Text("Shaded samples: %llu", static_cast<unsigned long long>(stats.ShadedSamples));
+        if (stats.PrePassSamples > 0 && stats.ShadedSamples > 0) {
+            // Depth fragments per shaded fragment: the overdraw the pre-pass kept out of the lit shaders
+            ImGui::Text("Pre-pass samples: %llu (overdraw saved %.2fx)", static_cast<unsigned long long>(stats.PrePassSamples),
+                        static_cast<double>(stats.PrePassSamples) / static_cast<double>(stats.ShadedSamples));
+        }
+        ImGui::Separator();
+        
+        if (m_RenderSystem) {
+            bool culling = m_RenderSystem->IsOcclusionCulling();
+            if (ImGui::Checkbox("Occlusion culling", &culling)) {
+                m_RenderSystem->SetOcclusionCulling(culling);
+            }
+            
+            const auto& culled = m_RenderSystem->GetCullingStats();
+            ImGui::Text("Tested: %u  Frustum: %u  Occluded: %u", culled.Tested, culled.FrustumCulled, culled.Occluded);
+            ImGui::Text("Occluders: %u (%u tris)  Raster: %.3f ms  Test: %.3f ms",
+                        culled.Occluders, culled.OccluderTriangles, culled.RasterTime, culled.TestTime);
+            
+            bool lodSelection = m_RenderSystem->IsLODSelection();
+            if (ImGui::Checkbox("Mesh LODs", &lodSelection)) {
+                m_RenderSystem->SetLODSelection(lodSelection);
+            }
+            
+            // Shown in pixels at 1080p rather than as a fraction of the viewport
+            float lodPixels = m_RenderSystem->GetLODErrorThreshold() * 1080.0f;
+            if (ImGui::SliderFloat("LOD error (px)", &lodPixels, 0.25f, 16.0f)) {
+                m_RenderSystem->SetLODErrorThreshold(lodPixels / 1080.0f);
+            }
+            ImGui::Separator();
+            
+            bool dynamicResolution = m_RenderSystem->IsDynamicResolution();
+            if (ImGui::Checkbox("Dynamic resolution", &dynamicResolution)) {
+                m_RenderSystem->SetDynamicResolution(dynamicResolution);
+            }
+            if (dynamicResolution) {
+                auto& controller = m_RenderSystem->GetResolutionController();
+                auto settings = controller.GetSettings();
+                bool changed = ImGui::SliderFloat("GPU budget (ms)", &settings.TargetGPUTime, 1.0f, 33.0f);
+                changed |= ImGui::SliderFloat("Min scale", &settings.MinScale, 0.25f, 1.0f);
+                if (changed) {
+                    controller.SetSettings(settings);
+                }
+                float sharpness = m_RenderSystem->GetUpscaleSharpness();
+                if (ImGui::SliderFloat("Sharpness", &sharpness, 0.0f, 1.0f)) {
+                    m_RenderSystem->SetUpscaleSharpness(sharpness);
+                }
+            }
+            ImGui::Text("Render scale: %.0f%% (%ux%u)  Scene GPU: %.2f ms", m_RenderSystem->GetRenderScale() * 100.0f,
+                        m_RenderSystem->GetRenderWidth(), m_RenderSystem->GetRenderHeight(),
+                        m_RenderSystem->GetResolutionController().GetGPUTime());
+            ImGui::Separator();
+        }
+        
+        auto geometry = SpoonEngine::GeometryPool::GetStats();
+        ImGui::Text("Geometry pools: %u  Blocks: %u  Meshes: %u  (%.1f MB)", geometry.Pools, geometry.Blocks,
+                    geometry.Allocations, static_cast<double>(geometry.Bytes) / (1024.0 * 1024.0));
+        ImGui::Text("Vertices: %llu / %llu  Indices: %llu / %llu  Free ranges: %u",
+                    static_cast<unsigned long long>(geometry.VerticesUsed), static_cast<unsigned long long>(geometry.VertexCapacity),
+                    static_cast<unsigned long long>(geometry.IndicesUsed), static_cast<unsigned long long>(geometry.IndexCapacity),
+                    geometry.FreeRanges);
+        if (ImGui::Button("Defragment geometry")) {
+            SpoonEngine::GeometryPool::DefragmentAll();
+        }
+        ImGui::Separator();
+        
+        bool cpuEnabled = SpoonEngine::Profiler::IsEnabled();
+        if (ImGui::Checkbox("CPU scopes", &cpuEnabled)) {
+            SpoonEngine::Profiler::SetEnabled(cpuEnabled);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Export CPU Trace")) {
+            SpoonEngine::Profiler::ExportTrace("cpu_trace.json");
+        }
+        ImGui::Separator();
+        
+        auto* profiler = SpoonEngine::GPUProfiler::Get();
+        if (!profiler) {
+            ImGui::Text("GPU profiler not available");
+            ImGui::End();
+            return;
+        }
+        
+        bool enabled = profiler->IsEnabled();
+        if (ImGui::Checkbox("GPU timers", &enabled)) {
+            profiler->SetEnabled(enabled);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Export GPU Trace")) {
+            profiler->ExportTrace("gpu_trace.json");
+        }
+        
+        auto result = profiler->GetLatestResult();
+        ImGui::Text("Frame %llu (resolved %u frames late)", static_cast<unsigned long long>(result.Frame),
+                    SpoonEngine::GPUProfiler::FrameLatency);
+        
+        ImGui::Columns(3, "ProfilerScopes");
+        ImGui::Text("Scope"); ImGui::NextColumn();
+        ImGui::Text("CPU (ms)"); ImGui::NextColumn();
+        ImGui::Text("GPU (ms)"); ImGui::NextColumn();
+        ImGui::Separator();
+        
+        for (const auto& scope : result.Scopes) {
+            ImGui::Text("%*s%s", static_cast<int>(scope.Depth * 2), "", scope.Name.c_str()); ImGui::NextColumn();
+            ImGui::Text("%.3f", scope.CPUTime); ImGui::NextColumn();
+            ImGui::Text("%.3f", scope.GPUTime); ImGui::NextColumn();
+        }
+        ImGui::Columns(1);
+        
+        ImGui::End();
+    }
+    
     void RenderViewport() {
         if (!ImGui::Begin("Viewport", &m_ShowViewport)) {
             ImGui::End();
@@ -381,9 +541,20 @@ private:
                 }
             }
             
+            // While the panel is being resized the framebuffer renders into part of its attachments
+            SpoonEngine::FramebufferRegion region = m_ViewportFramebuffer->GetRegion();
             uint32_t textureID = m_ViewportFramebuffer->GetColorAttachmentRendererID();
             if (textureID > 0) {
-                ImGui::Image(reinterpret_cast<void*>(textureID), ImVec2(panelWidth, panelHeight), ImVec2(0, 1), ImVec2(1, 0));
+                ImGui::Image(reinterpret_cast<void*>(textureID), ImVec2(panelWidth, panelHeight),
+                             ImVec2(0, region.GetUVScaleY()), ImVec2(region.GetUVScaleX(), 0));
+                
+                // Picking runs with the next frame's render; remember where, relative to the image
+                if (ImGui::IsItemHovered() && ImGui::IsMouseClicked(0)) {
+                    ImVec2 mouse = ImGui::GetMousePos();
+                    ImVec2 corner = ImGui::GetItemRectMin();
+                    m_PickPosition = ImVec2((mouse.x - corner.x) / panelWidth, 1.0f - (mouse.y - corner.y) / panelHeight);
+                    m_PickRequested = true;
+                }
             } else {
                 ImGui::Text("Viewport not ready");
             }
@@ -429,6 +600,8 @@ private:
             out vec3 v_Normal;
             out vec2 v_TexCoord;
             
+            invariant gl_Position;
+            
             void main() {
                 v_WorldPos = vec3(u_Model * vec4(a_Position, 1.0));
                 v_Normal = mat3(transpose(inverse(u_Model))) * a_Normal;
@@ -564,6 +737,91 @@ private:
         std::cout << "Created viewport framebuffer (1280x720)" << std::endl;
     }
     
+    // Draws every scene entity's id into a RED_INTEGER target and queues an asynchronous
+    // readback of the clicked pixel; OnUpdate applies the selection once it has landed
+    void RenderPickingPass() {
+        auto world = GetWorld();
+        if (!m_CameraEntity.IsValid() || !world->HasComponent<SpoonEngine::CameraComponent>(m_CameraEntity)) return;
+        auto& cameraComp = world->GetComponent<SpoonEngine::CameraComponent>(m_CameraEntity);
+        if (!cameraComp.Camera) return;
+        
+        SpoonEngine::FramebufferRegion viewport = m_ViewportFramebuffer->GetRegion();
+        if (viewport.Width == 0 || viewport.Height == 0) return;
+        
+        if (!m_PickingFramebuffer) {
+            SpoonEngine::FramebufferSpecification spec;
+            spec.Attachments = { SpoonEngine::FramebufferTextureFormat::RED_INTEGER, SpoonEngine::FramebufferTextureFormat::Depth };
+            spec.Width = viewport.Width;
+            spec.Height = viewport.Height;
+            m_PickingFramebuffer = SpoonEngine::Framebuffer::Create(spec);
+            
+            m_PickingShader = SpoonEngine::Shader::Create("EditorPicking", R"(
+                #version 330 core
+                layout (location = 0) in vec3 a_Position;
+                
+                uniform mat4 u_Model;
+                uniform mat4 u_View;
+                uniform mat4 u_Projection;
+                
+                void main() {
+                    gl_Position = u_Projection * u_View * u_Model * vec4(a_Position, 1.0);
+                }
+            )", R"(
+                #version 330 core
+                
+                uniform int u_EntityID;
+                
+                out int o_EntityID;
+                
+                void main() {
+                    o_EntityID = u_EntityID;
+                }
+            )");
+        } else {
+            m_PickingFramebuffer->Resize(viewport.Width, viewport.Height);
+        }
+        if (!m_PickingFramebuffer || !m_PickingShader) return;
+        
+        auto renderer = GetRenderer();
+        m_PickingFramebuffer->ClearAttachment(0, -1);
+        m_PickingFramebuffer->Bind();
+        
+        SpoonEngine::FramebufferRegion region = m_PickingFramebuffer->GetRegion();
+        m_PickingFramebuffer->ClearDepth(0, 0, region.Width, region.Height);
+        
+        m_PickingShader->Bind();
+        m_PickingShader->SetMat4("u_View", cameraComp.Camera->GetViewMatrix());
+        m_PickingShader->SetMat4("u_Projection", cameraComp.Camera->GetProjectionMatrix());
+        
+        for (auto entity : m_SceneEntities) {
+            if (!world->HasComponent<SpoonEngine::Transform>(entity) || !world->HasComponent<SpoonEngine::MeshRenderer>(entity)) continue;
+            
+            auto& meshRenderer = world->GetComponent<SpoonEngine::MeshRenderer>(entity);
+            if (!meshRenderer.Mesh) continue;
+            
+            glm::mat4 model = world->GetComponent<SpoonEngine::Transform>(entity).GetTransformMatrix();
+            m_PickingShader->SetMat4("u_Model", SpoonEngine::RenderSystem::GetMeshTransform(*meshRenderer.Mesh, model));
+            m_PickingShader->SetInt("u_EntityID", static_cast<int>(entity.GetID()));
+            
+            meshRenderer.Mesh->Bind();
+            SpoonEngine::RenderSystem::DrawMesh(renderer, *meshRenderer.Mesh, 0, meshRenderer.SubMesh);
+            meshRenderer.Mesh->Unbind();
+        }
+        m_PickingShader->Unbind();
+        
+        SpoonEngine::FramebufferRect rect;
+        rect.X = std::min(static_cast<uint32_t>(std::max(m_PickPosition.x, 0.0f) * region.Width), region.Width - 1);
+        rect.Y = std::min(static_cast<uint32_t>(std::max(m_PickPosition.y, 0.0f) * region.Height), region.Height - 1);
+        rect.Width = 1;
+        rect.Height = 1;
+        m_PickingFramebuffer->RequestReadback(rect, [this](const SpoonEngine::FramebufferReadback& readback) {
+            m_PickResult = readback.GetInt(0, 0);
+            m_PickResultReady = true;
+        });
+        
+        m_PickingFramebuffer->Unbind();
+    }
+    
     void UpdateMaterialsWithCameraPosition() {
         auto world = GetWorld();
         if (!m_CameraEntity.IsValid()) return;
@@ -658,6 +916,8 @@ private:
             out vec3 v_Normal;
             out vec2 v_TexCoord;
             
+            invariant gl_Position;
+            
             void main() {
                 v_WorldPos = vec3(u_Model * vec4(a_Position, 1.0));
                 v_Normal = mat3(transpose(inverse(u_Model))) * a_Normal;
@@ -848,7 +1108,7 @@ private:
             ImGui::EndPopup();
         }
     }
-    
+
 private:
     std::shared_ptr<SpoonEngine::RenderSystem> m_RenderSystem;
     std::vector<SpoonEngine::Entity> m_SceneEntities;
@@ -859,6 +1119,14 @@ private:
     std::shared_ptr<SpoonEngine::Framebuffer> m_ViewportFramebuffer;
     ImVec2 m_ViewportSize = ImVec2(0.0f, 0.0f);
     
+    // Click picking, read back without stalling on the GPU
+    std::shared_ptr<SpoonEngine::Framebuffer> m_PickingFramebuffer;
+    std::shared_ptr<SpoonEngine::Shader> m_PickingShader;
+    ImVec2 m_PickPosition = ImVec2(0.0f, 0.0f);   // within the viewport image, origin bottom-left
+    bool m_PickRequested = false;
+    bool m_PickResultReady = false;
+    int m_PickResult = -1;
+    
     // Scene management
     std::string m_CurrentScenePath = "";
     
@@ -872,6 +1140,7 @@ private:
     bool m_ShowSceneHierarchy = true;
     bool m_ShowProperties = true;
     bool m_ShowViewport = true;
+    bool m_ShowProfiler = false;
 };
 
 SPOON_MAIN(SpoonEditorApp)
\ No newline at end of file
@@ -4,11 +4,14 @@
 #include "SpoonEngine/Renderer/Buffer.h"
 #include "SpoonEngine/Math/Vector3.h"
 #include "SpoonEngine/Math/Vector2.h"
+#include "SpoonEngine/Math/BoundingBox.h"
 #include <vector>
 #include <memory>
 
 namespace SpoonEngine {
     
+    class GeometryAllocation;
+    
     struct Vertex {
         Vector3 Position;
         Vector3 Normal;
@@ -17,6 +20,49 @@ namespace SpoonEngine {
         Vector3 Bitangent;
     };
     
+    // Each attribute always binds to the shader location of its bit index (a_Position = 0,
+    // a_Normal = 1, a_TexCoord = 2, a_Tangent = 3, a_Bitangent = 4), whatever else is present
+    enum class VertexAttribute : uint32_t {
+        None = 0,
+        Position = 1 << 0,
+        Normal = 1 << 1,
+        TexCoord = 1 << 2,
+        Tangent = 1 << 3,
+        Bitangent = 1 << 4,
+        
+        Lit = Position | Normal | TexCoord,
+        All = Position | Normal | TexCoord | Tangent | Bitangent
+    };
+    
+    inline VertexAttribute operator|(VertexAttribute a, VertexAttribute b) {
+        return static_cast<VertexAttribute>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+    }
+    
+    inline bool HasAttribute(VertexAttribute set, VertexAttribute attribute) {
+        return (static_cast<uint32_t>(set) & static_cast<uint32_t>(attribute)) != 0;
+    }
+    
+    enum class VertexFormat {
+        // Float3 positions, normals, tangents and bitangents, Float2 UVs
+        Standard = 0,
+        // Short4N positions inside the mesh's quantization cube (see Mesh::GetQuantizationOffset)
+        // with the bitangent sign in w, Short2N octahedral normal and tangent, Half2 UVs. The
+        // bitangent is never stored: cross(normal, tangent) * sign.
+        Compressed
+    };
+    
+    enum class VertexStreams {
+        Interleaved = 0,    // one buffer; depth passes fetch whole vertices
+        SplitPosition       // positions in their own buffer, the rest interleaved in a second one
+    };
+    
+    struct VertexLayout {
+        VertexAttribute Attributes = VertexAttribute::All;
+        VertexFormat Format = VertexFormat::Standard;
+        VertexStreams Streams = VertexStreams::SplitPosition;
+    };
+    
+    // Range of a mesh's index buffer drawn as one unit; its indices are relative to BaseVertex
     struct SubMesh {
         uint32_t BaseVertex;
         uint32_t BaseIndex;
@@ -35,17 +81,90 @@ namespace SpoonEngine {
         void SetIndices(const std::vector<uint32_t>& indices);
         void SetSubMeshes(const std::vector<SubMesh>& subMeshes);
         
+        // All of the above plus GenerateLODs(lodCount) with its default reduction, uploaded once
+        // at the end instead of after every step; what importers should use
+        void SetGeometry(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                         const std::vector<SubMesh>& subMeshes, uint32_t lodCount = 1);
+        
         const std::vector<Vertex>& GetVertices() const { return m_Vertices; }
         const std::vector<uint32_t>& GetIndices() const { return m_Indices; }
         const std::vector<SubMesh>& GetSubMeshes() const { return m_SubMeshes; }
         
+        // A mesh without explicit sub-meshes is a single range over all of its indices. LODs
+        // keep one range per sub-mesh, so pass the LOD being drawn.
+        uint32_t GetSubMeshCount() const { return m_SubMeshes.empty() ? 1 : static_cast<uint32_t>(m_SubMeshes.size()); }
+        SubMesh GetSubMesh(uint32_t index, uint32_t lod = 0) const;
+        
+        // What gets uploaded; the CPU copy returned by GetVertices keeps every attribute at full
+        // precision. Drop attributes no shader of this mesh reads (a shadow-only caster needs
+        // just Position). RenderSystem folds the position dequantization of compressed meshes
+        // into u_Model, so only shaders reading a_Normal / a_Tangent need
+        // GetVertexDecodeSource() to accept them.
+        void SetVertexLayout(const VertexLayout& layout);
+        const VertexLayout& GetVertexLayout() const { return m_Layout; }
+        VertexFormat GetVertexFormat() const { return m_Layout.Format; }
+        
+        // Bit N set for every shader location this mesh provides, comparable to Shader::GetVertexInputMask
+        uint32_t GetVertexInputMask() const;
+        uint32_t GetVertexStride() const { return m_VertexStride; }
+        
+        // Mesh-space position = offset + quantized position * scale
+        const Vector3& GetQuantizationOffset() const { return m_QuantizationOffset; }
+        float GetQuantizationScale() const { return m_QuantizationScale; }
+        
+        // Declares `uniform bool u_CompressedVertices` plus DecodeNormal(vec4) and
+        // DecodeTangent(vec4), which return a_Normal.xyz / a_Tangent.xyz for standard meshes
+        // and decode octahedral data otherwise. Insert after #version.
+        static const char* GetVertexDecodeSource();
+        
+        // Builds up to lodCount - 1 simplified index buffers sharing this mesh's vertex buffer,
+        // each targeting `reduction` times the previous index count. A level is dropped once
+        // simplification stalls or its error (relative to the mesh extent) passes maxError.
+        // Sub-meshes must not share vertices; call SetSubMeshes first.
+        void GenerateLODs(uint32_t lodCount = DefaultLODCount, float reduction = 0.5f, float maxError = 0.05f);
+        
+        // LOD 0 is the full-detail mesh
+        uint32_t GetLODCount() const { return static_cast<uint32_t>(m_LODs.size()) + 1; }
+        float GetLODError(uint32_t lod) const { return lod == 0 ? 0.0f : m_LODs[lod - 1].Error; }
+        
+        // Local-space bounds of all vertices
+        const BoundingBox& GetBounds() const { return m_Bounds; }
+        
+        // Suballocate from the shared GeometryPool of this mesh's vertex format instead of owning
+        // buffers. Pooled meshes have no buffers or vertex arrays of their own; draw them
+        // through GetDrawVertexArray and GetDrawRange.
+        void SetGeometryPooling(bool enabled);
+        bool IsGeometryPooled() const { return m_Allocation != nullptr; }
+        
+        // Vertex array Bind(lod) / BindPositions(lod) bind
+        const std::shared_ptr<VertexArray>& GetDrawVertexArray(uint32_t lod = 0) const;
+        const std::shared_ptr<VertexArray>& GetDrawPositionVertexArray(uint32_t lod = 0) const;
+        
+        // GetSubMesh offset to where the range lives in the bound buffers
+        SubMesh GetDrawRange(uint32_t index, uint32_t lod = 0) const;
+        
         std::shared_ptr<VertexBuffer> GetVertexBuffer() const { return m_VertexBuffer; }
         std::shared_ptr<IndexBuffer> GetIndexBuffer() const { return m_IndexBuffer; }
+        std::shared_ptr<VertexArray> GetVertexArray() const { return m_VertexArray; }
+        
+        // Position-only stream sharing the mesh's index buffer, for depth-only passes; null for
+        // VertexStreams::Interleaved layouts, which depth passes draw through GetVertexArray
+        std::shared_ptr<VertexArray> GetPositionVertexArray() const { return m_PositionVertexArray; }
         
-        void Bind() const;
+        void Bind(uint32_t lod = 0) const;
         void Unbind() const;
         
-        uint32_t GetIndexCount() const { return static_cast<uint32_t>(m_Indices.size()); }
+        void BindPositions(uint32_t lod = 0) const;
+        void UnbindPositions() const;
+        
+        uint32_t GetIndexCount(uint32_t lod = 0) const {
+            return static_cast<uint32_t>(lod == 0 ? m_Indices.size() : m_LODs[lod - 1].Indices.size());
+        }
+        
+        // Chosen per index buffer at upload, so a coarse LOD may be 16-bit when LOD 0 is not
+        IndexType GetIndexType(uint32_t lod = 0) const;
+        
+        static constexpr uint32_t DefaultLODCount = 4;
         
         static std::shared_ptr<Mesh> Create(const std::string& path);
         static std::shared_ptr<Mesh> CreateCube();
@@ -53,15 +172,49 @@ namespace SpoonEngine {
         static std::shared_ptr<Mesh> CreatePlane(float width = 1.0f, float height = 1.0f);
         
     private:
+        struct LOD {
+            std::vector<uint32_t> Indices;
+            std::vector<SubMesh> SubMeshes;
+            float Error = 0.0f;
+            uint32_t PoolIndexOffset = 0;     // from the start of the mesh's pool allocation
+            
+            std::shared_ptr<IndexBuffer> Buffer;
+            std::shared_ptr<VertexArray> Array;
+            std::shared_ptr<VertexArray> PositionArray;
+        };
+        
+        // CPU side of GenerateLODs; leaves uploading to the caller
+        void BuildLODs(uint32_t lodCount, float reduction, float maxError);
+        void UpdateBounds();
         void UploadToGPU();
+        void UploadLOD(LOD& lod);
+        bool UploadToPool(const std::vector<BufferLayout>& streams);
+        void UpdateQuantization();
+        std::vector<BufferLayout> BuildStreamLayouts() const;
+        BufferLayout BuildStreamLayout(VertexAttribute attributes) const;
+        std::vector<uint8_t> BuildStreamData(const BufferLayout& layout) const;
         
         std::vector<Vertex> m_Vertices;
         std::vector<uint32_t> m_Indices;
         std::vector<SubMesh> m_SubMeshes;
+        BoundingBox m_Bounds;
+        
+        VertexLayout m_Layout;
+        uint32_t m_VertexStride = 0;
+        Vector3 m_QuantizationOffset = Vector3::Zero();
+        float m_QuantizationScale = 1.0f;
         
         std::shared_ptr<VertexBuffer> m_VertexBuffer;
         std::shared_ptr<IndexBuffer> m_IndexBuffer;
-        std::unique_ptr<class OpenGLVertexArray> m_VertexArray;
+        std::shared_ptr<VertexArray> m_VertexArray;
+        
+        std::shared_ptr<VertexBuffer> m_PositionBuffer;
+        std::shared_ptr<VertexArray> m_PositionVertexArray;
+        
+        std::vector<LOD> m_LODs;
+        
+        bool m_GeometryPooling = false;
+        std::unique_ptr<GeometryAllocation> m_Allocation;
         
         bool m_IsLoaded = false;
     };
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "SpoonEngine/Assets/Mesh.h"
+#include <vector>
+#include <cstdint>
+
+namespace SpoonEngine {
+    
+    // Quadric error metric edge-collapse simplifier. A collapse only ever moves a vertex onto
+    // one of its neighbours, so the result indexes the input vertex array unchanged and every
+    // LOD can share one vertex buffer. Vertices on open borders or attribute seams (several
+    // vertices at one position) are locked to keep silhouettes and UV layouts intact.
+    class MeshSimplifier {
+    public:
+        // Collapses edges cheapest-first until at most targetIndexCount indices remain or the
+        // next collapse would exceed targetError. Errors are relative to the largest extent
+        // of the mesh bounds; outError receives the error actually reached.
+        static std::vector<uint32_t> Simplify(const std::vector<Vertex>& vertices,
+                                              const std::vector<uint32_t>& indices,
+                                              size_t targetIndexCount,
+                                              float targetError,
+                                              float* outError = nullptr);
+    };
+    
+}
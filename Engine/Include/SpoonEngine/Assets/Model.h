@@ -4,49 +4,23 @@
 #include "SpoonEngine/Assets/Mesh.h"
 #include "SpoonEngine/Renderer/Material.h"
 #include "SpoonEngine/Math/Vector3.h"
+#include "SpoonEngine/Math/BoundingBox.h"
 #include <vector>
 #include <memory>
 #include <string>
 
 namespace SpoonEngine {
     
-    struct BoundingBox {
-        Vector3 Min = Vector3(FLT_MAX, FLT_MAX, FLT_MAX);
-        Vector3 Max = Vector3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
-        
-        Vector3 GetCenter() const {
-            return Vector3(
-                (Min.x + Max.x) * 0.5f,
-                (Min.y + Max.y) * 0.5f,
-                (Min.z + Max.z) * 0.5f
-            );
-        }
-        
-        Vector3 GetSize() const {
-            return Vector3(
-                Max.x - Min.x,
-                Max.y - Min.y,
-                Max.z - Min.z
-            );
-        }
-        
-        void Expand(const Vector3& point) {
-            if (point.x < Min.x) Min.x = point.x;
-            if (point.y < Min.y) Min.y = point.y;
-            if (point.z < Min.z) Min.z = point.z;
-            
-            if (point.x > Max.x) Max.x = point.x;
-            if (point.y > Max.y) Max.y = point.y;
-            if (point.z > Max.z) Max.z = point.z;
-        }
-    };
-    
     struct ModelMesh {
         std::shared_ptr<Mesh> MeshData;
         std::shared_ptr<Material> Material;
         std::string Name;
         BoundingBox Bounds;
         
+        // Range of MeshData drawn with Material; meshes of one model share MeshData.
+        // Copy it into MeshRenderer::SubMesh.
+        int32_t SubMeshIndex = -1;
+        
         ModelMesh() = default;
         ModelMesh(std::shared_ptr<Mesh> mesh, std::shared_ptr<class Material> material, const std::string& name = "")
             : MeshData(mesh), Material(material), Name(name) {}
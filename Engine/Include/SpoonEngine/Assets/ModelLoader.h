@@ -52,7 +52,24 @@ namespace SpoonEngine {
         static bool LoadModel(const std::string& path, Model* model);
         static bool LoadOBJ(const std::string& path, Model* model);
         
+        // LOD levels built for every loaded mesh, including the full-detail one; 1 disables simplification
+        static void SetLODCount(uint32_t count) { s_LODCount = count; }
+        static uint32_t GetLODCount() { return s_LODCount; }
+        
+        // GPU vertex layout of loaded meshes; the built-in model shaders decode both formats and
+        // read Position, Normal and TexCoord only, so VertexAttribute::Lit is enough for them
+        static void SetVertexLayout(const VertexLayout& layout) { s_VertexLayout = layout; }
+        static const VertexLayout& GetVertexLayout() { return s_VertexLayout; }
+        
+        // Loaded meshes suballocate from the shared GeometryPool of their vertex format
+        static void SetGeometryPooling(bool enabled) { s_GeometryPooling = enabled; }
+        static bool GetGeometryPooling() { return s_GeometryPooling; }
+    
     private:
+        static uint32_t s_LODCount;
+        static VertexLayout s_VertexLayout;
+        static bool s_GeometryPooling;
+        
         // OBJ parsing helpers
         static bool ParseOBJFile(const std::string& path, 
                                 std::vector<ModelMeshData>& meshes,
@@ -77,9 +94,17 @@ namespace SpoonEngine {
         static void GenerateTangents(ModelMeshData& meshData);
         static void CalculateBoundingBox(const ModelMeshData& meshData, BoundingBox& bounds);
         
+        // OBJ faces arrive as unshared corners in file order; weld identical corners, then
+        // reorder for the post-transform cache, overdraw and linear vertex fetch
+        static void OptimizeMesh(ModelMeshData& meshData);
+        static void WeldVertices(ModelMeshData& meshData);
+        
         // Engine integration
-        static std::shared_ptr<Mesh> CreateEngineMesh(const ModelMeshData& meshData);
+        static std::shared_ptr<Mesh> CreateEngineMesh(const std::vector<ModelMeshData>& meshes);
+        static void AppendEngineVertices(const ModelMeshData& meshData, std::vector<Vertex>& vertices);
         static std::shared_ptr<Material> CreateEngineMaterial(const ModelMaterial& material, const std::string& modelDir);
+        static std::shared_ptr<Shader> GetDefaultShader();
+        static std::shared_ptr<Shader> GetMaterialShader();
     };
     
 }
\ No newline at end of file
@@ -87,9 +87,20 @@ namespace SpoonEngine {
     struct MeshRenderer {
         std::shared_ptr<class Mesh> Mesh;
         std::shared_ptr<class Material> Material;
+        
+        // Sub-mesh of Mesh to draw with this material; -1 draws all of them
+        int32_t SubMesh = -1;
+        
         bool CastShadows = true;
         bool ReceiveShadows = true;
         
+        // Static renderers may be batched into multi-draw indirect submissions, and their shadow
+        // depth is cached by ShadowSystem until they move
+        bool Static = false;
+        
+        // Rasterized into the software occlusion buffer; keep these to large, low-poly meshes
+        bool Occluder = false;
+        
         // Legacy shader support for backward compatibility
         std::shared_ptr<class Shader> Shader;
     };
@@ -100,4 +111,26 @@ namespace SpoonEngine {
         int Priority = 0; // Higher priority cameras render last
     };
     
+    enum class LightType {
+        Point = 0,
+        Spot
+    };
+    
+    struct LightComponent {
+        LightType Type = LightType::Point;
+        Vector3 Color = Vector3::One();
+        float Intensity = 1.0f;
+        
+        // Distance at which the light's contribution reaches zero
+        float Range = 10.0f;
+        
+        // Spot cone half-angles in degrees; spot lights shine along the transform's local +Z,
+        // which Transform::LookAt turns towards its target
+        float InnerAngle = 25.0f;
+        float OuterAngle = 35.0f;
+        
+        // Gets a tile of ShadowSystem's local shadow atlas while on screen
+        bool CastShadows = false;
+    };
+    
 }
\ No newline at end of file
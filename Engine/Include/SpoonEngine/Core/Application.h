@@ -7,6 +7,7 @@ namespace SpoonEngine {
     
     class Window;
     class Renderer;
+    class RenderThread;
     class World;
     
     class Application {
@@ -21,6 +22,12 @@ namespace SpoonEngine {
         Renderer* GetRenderer() const { return m_Renderer.get(); }
         World* GetWorld() const { return m_World.get(); }
         
+        // Moves the GL context to a dedicated render thread that executes frame N while
+        // frame N+1 is recorded. Must be set before Run(); OnRender must then only touch
+        // the GPU through Renderer::Submit.
+        void SetThreadedRendering(bool enabled) { m_ThreadedRendering = enabled; }
+        bool IsThreadedRendering() const { return m_ThreadedRendering; }
+        
     protected:
         virtual void OnInitialize() {}
         virtual void OnUpdate(float deltaTime) {}
@@ -34,9 +41,11 @@ namespace SpoonEngine {
         
         std::unique_ptr<Window> m_Window;
         std::unique_ptr<Renderer> m_Renderer;
+        std::unique_ptr<RenderThread> m_RenderThread;
         std::unique_ptr<World> m_World;
         
         bool m_Running = false;
+        bool m_ThreadedRendering = false;
         float m_LastFrameTime = 0.0f;
         std::string m_Name;
     };
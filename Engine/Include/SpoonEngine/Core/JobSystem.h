@@ -0,0 +1,33 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+namespace SpoonEngine {
+    
+    // Fixed pool of worker threads fed from a shared queue. Waiting threads help run
+    // queued jobs instead of sleeping, so nested dispatches cannot deadlock. Without
+    // Init every job runs inline on the calling thread.
+    class JobSystem {
+    public:
+        using Job = std::function<void()>;
+        using RangeJob = std::function<void(uint32_t begin, uint32_t end)>;
+        
+        // workerCount == 0 picks one worker per hardware thread minus the caller
+        static void Init(uint32_t workerCount = 0);
+        static void Shutdown();
+        
+        static bool IsInitialized();
+        static uint32_t GetWorkerCount();
+        
+        // Queues a job; the counter is incremented now and decremented when it finishes
+        static void Execute(Job job, std::atomic<uint32_t>& counter);
+        
+        // Splits [0, count) into groups of groupSize and blocks until all groups have run
+        static void Dispatch(uint32_t count, uint32_t groupSize, const RangeJob& job);
+        
+        static void Wait(const std::atomic<uint32_t>& counter);
+    };
+    
+}
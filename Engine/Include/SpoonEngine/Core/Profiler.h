@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+namespace SpoonEngine {
+    
+    // Hierarchical CPU scope timings. Each thread appends completed scopes to its own ring
+    // buffer without locking; only registering a new thread and exporting take the mutex.
+    // Scopes are recorded through SPOON_PROFILE_SCOPE, which compiles to nothing unless the
+    // engine is built with SPOON_ENABLE_PROFILING.
+    class Profiler {
+    public:
+        struct Event {
+            const char* Name = nullptr;     // must outlive the profiler, normally a string literal
+            uint64_t Start = 0;             // nanoseconds since the profiler epoch
+            uint64_t End = 0;
+            uint32_t Depth = 0;
+        };
+        
+        static void SetEnabled(bool enabled) { s_Enabled.store(enabled, std::memory_order_relaxed); }
+        static bool IsEnabled() { return s_Enabled.load(std::memory_order_relaxed); }
+        
+        // Names the calling thread in exported traces
+        static void SetThreadName(const std::string& name);
+        
+        // Writes every thread's retained events as Chrome trace JSON (chrome://tracing, Perfetto)
+        static bool ExportTrace(const std::string& filepath);
+        static void Clear();
+        
+        static uint64_t Now();
+        
+        // Events kept per thread; older ones are overwritten
+        static constexpr uint32_t EventsPerThread = 1 << 16;
+    
+    private:
+        struct ThreadBuffer {
+            uint32_t ThreadIndex = 0;
+            std::string Name;
+            uint32_t Depth = 0;
+            
+            // Only the owning thread writes; Head is published with release so an exporting
+            // thread sees complete events
+            std::atomic<uint64_t> Head{0};
+            std::vector<Event> Events;      // allocated by the thread's first recorded scope
+        };
+        
+        static ThreadBuffer& GetThreadBuffer();
+        // Also allocates the thread's ring, which naming a thread alone does not
+        static ThreadBuffer& GetRecordingBuffer();
+        
+        static std::atomic<bool> s_Enabled;
+        static std::mutex s_RegistryMutex;
+        static std::vector<std::shared_ptr<ThreadBuffer>> s_Threads;
+        
+        friend class ProfileScope;
+    };
+    
+    class ProfileScope {
+    public:
+        ProfileScope(const char* name) {
+            if (Profiler::IsEnabled()) {
+                m_Buffer = &Profiler::GetRecordingBuffer();
+                m_Name = name;
+                m_Depth = m_Buffer->Depth++;
+                m_Start = Profiler::Now();
+            }
+        }
+        
+        ~ProfileScope() {
+            if (!m_Buffer) return;
+            
+            uint64_t end = Profiler::Now();
+            m_Buffer->Depth--;
+            
+            uint64_t head = m_Buffer->Head.load(std::memory_order_relaxed);
+            Profiler::Event& event = m_Buffer->Events[head % Profiler::EventsPerThread];
+            event.Name = m_Name;
+            event.Start = m_Start;
+            event.End = end;
+            event.Depth = m_Depth;
+            m_Buffer->Head.store(head + 1, std::memory_order_release);
+        }
+        
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+    
+    private:
+        Profiler::ThreadBuffer* m_Buffer = nullptr;
+        const char* m_Name = nullptr;
+        uint32_t m_Depth = 0;
+        uint64_t m_Start = 0;
+    };
+
+}
+
+#define SPOON_PROFILE_CONCAT_IMPL(a, b) a##b
+#define SPOON_PROFILE_CONCAT(a, b) SPOON_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef SPOON_ENABLE_PROFILING
+    #define SPOON_PROFILE_SCOPE(name) ::SpoonEngine::ProfileScope SPOON_PROFILE_CONCAT(profileScope, __LINE__)(name)
+    #define SPOON_PROFILE_FUNCTION() SPOON_PROFILE_SCOPE(__func__)
+#else
+    #define SPOON_PROFILE_SCOPE(name)
+    #define SPOON_PROFILE_FUNCTION()
+#endif
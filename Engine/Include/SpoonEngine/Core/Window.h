@@ -29,6 +29,18 @@ namespace SpoonEngine {
         
         void OnUpdate();
         
+        // OnUpdate split in two for threaded rendering: events stay on the main thread,
+        // presentation happens on the thread that owns the context
+        void PollEvents();
+        void SwapBuffers();
+        
+        void MakeContextCurrent();
+        void ReleaseContext();
+        
+        // A hidden context sharing objects with the window's, for GL work on a background thread
+        bool HasSharedContext() const { return m_SharedContext != nullptr; }
+        void MakeSharedContextCurrent();
+        
         uint32_t GetWidth() const { return m_Data.Width; }
         uint32_t GetHeight() const { return m_Data.Height; }
         
@@ -45,6 +57,7 @@ namespace SpoonEngine {
         void Shutdown();
         
         GLFWwindow* m_Window;
+        GLFWwindow* m_SharedContext = nullptr;
         
         struct WindowData {
             std::string Title;
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "SpoonEngine/Math/Vector3.h"
+#include <cfloat>
+
+namespace SpoonEngine {
+    
+    struct BoundingBox {
+        Vector3 Min = Vector3(FLT_MAX, FLT_MAX, FLT_MAX);
+        Vector3 Max = Vector3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        
+        Vector3 GetCenter() const {
+            return Vector3(
+                (Min.x + Max.x) * 0.5f,
+                (Min.y + Max.y) * 0.5f,
+                (Min.z + Max.z) * 0.5f
+            );
+        }
+        
+        Vector3 GetSize() const {
+            return Vector3(
+                Max.x - Min.x,
+                Max.y - Min.y,
+                Max.z - Min.z
+            );
+        }
+        
+        // False until at least one point has been added
+        bool IsValid() const {
+            return Min.x <= Max.x && Min.y <= Max.y && Min.z <= Max.z;
+        }
+        
+        void Expand(const Vector3& point) {
+            if (point.x < Min.x) Min.x = point.x;
+            if (point.y < Min.y) Min.y = point.y;
+            if (point.z < Min.z) Min.z = point.z;
+            
+            if (point.x > Max.x) Max.x = point.x;
+            if (point.y > Max.y) Max.y = point.y;
+            if (point.z > Max.z) Max.z = point.z;
+        }
+    };
+    
+}
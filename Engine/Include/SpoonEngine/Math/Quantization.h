@@ -0,0 +1,116 @@
+#pragma once
+
+#include "SpoonEngine/Math/Vector2.h"
+#include "SpoonEngine/Math/Vector3.h"
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+namespace SpoonEngine {
+    
+    // [-1, 1] to a signed normalized integer, matching GL's snorm conversion (c / 32767)
+    inline int16_t QuantizeSnorm16(float value) {
+        value = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+        return static_cast<int16_t>(std::lround(value * 32767.0f));
+    }
+    
+    inline float DequantizeSnorm16(int16_t value) {
+        float result = static_cast<float>(value) / 32767.0f;
+        return result < -1.0f ? -1.0f : result;
+    }
+    
+    // IEEE 754 binary16, round-to-nearest-even; out-of-range values saturate to infinity
+    inline uint16_t FloatToHalf(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        
+        uint32_t sign = (bits >> 16) & 0x8000u;
+        uint32_t exponent = (bits >> 23) & 0xffu;
+        uint32_t mantissa = bits & 0x7fffffu;
+        
+        if (exponent == 0xffu) {
+            return static_cast<uint16_t>(sign | 0x7c00u | (mantissa ? 0x200u : 0u));
+        }
+        
+        int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+        if (halfExponent >= 31) {
+            return static_cast<uint16_t>(sign | 0x7c00u);
+        }
+        
+        if (halfExponent <= 0) {
+            // Subnormal or zero
+            if (halfExponent < -10) return static_cast<uint16_t>(sign);
+            
+            mantissa |= 0x800000u;
+            uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+            uint32_t half = mantissa >> shift;
+            uint32_t remainder = mantissa & ((1u << shift) - 1u);
+            uint32_t midpoint = 1u << (shift - 1);
+            if (remainder > midpoint || (remainder == midpoint && (half & 1u))) half++;
+            return static_cast<uint16_t>(sign | half);
+        }
+        
+        uint32_t half = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+        uint32_t remainder = mantissa & 0x1fffu;
+        if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) half++;
+        return static_cast<uint16_t>(sign | half);
+    }
+    
+    inline float HalfToFloat(uint16_t value) {
+        uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+        uint32_t exponent = (value >> 10) & 0x1fu;
+        uint32_t mantissa = value & 0x3ffu;
+        
+        uint32_t bits;
+        if (exponent == 0) {
+            if (mantissa == 0) {
+                bits = sign;
+            } else {
+                // Renormalize the subnormal
+                exponent = 127 - 15 + 1;
+                while (!(mantissa & 0x400u)) {
+                    mantissa <<= 1;
+                    exponent--;
+                }
+                bits = sign | (exponent << 23) | ((mantissa & 0x3ffu) << 13);
+            }
+        } else if (exponent == 31) {
+            bits = sign | 0x7f800000u | (mantissa << 13);
+        } else {
+            bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+        }
+        
+        float result;
+        std::memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+    
+    // Octahedral unit vector encoding: project onto the octahedron |x|+|y|+|z| = 1 and fold the
+    // lower hemisphere over the diagonals, giving two values in [-1, 1]
+    inline Vector2 OctahedralEncode(const Vector3& v) {
+        float length = std::fabs(v.x) + std::fabs(v.y) + std::fabs(v.z);
+        if (length == 0.0f) return Vector2(0.0f, 0.0f);
+        
+        float x = v.x / length;
+        float y = v.y / length;
+        if (v.z < 0.0f) {
+            float foldedX = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            float foldedY = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = foldedX;
+            y = foldedY;
+        }
+        return Vector2(x, y);
+    }
+    
+    inline Vector3 OctahedralDecode(const Vector2& e) {
+        Vector3 v(e.x, e.y, 1.0f - std::fabs(e.x) - std::fabs(e.y));
+        if (v.z < 0.0f) {
+            float x = (1.0f - std::fabs(e.y)) * (e.x >= 0.0f ? 1.0f : -1.0f);
+            float y = (1.0f - std::fabs(e.x)) * (e.y >= 0.0f ? 1.0f : -1.0f);
+            v.x = x;
+            v.y = y;
+        }
+        return v.Normalize();
+    }
+    
+}
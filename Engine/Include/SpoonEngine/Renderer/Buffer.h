@@ -2,6 +2,8 @@
 
 #include <memory>
 #include <vector>
+#include <string>
+#include <cstdint>
 
 namespace SpoonEngine {
     
@@ -10,7 +12,12 @@ namespace SpoonEngine {
         Float, Float2, Float3, Float4,
         Mat3, Mat4,
         Int, Int2, Int3, Int4,
-        Bool
+        Bool,
+        // Compact vertex attributes; the shader still sees floats. The N types are signed
+        // normalized integers ([-1, 1] from c / 32767 or c / 127).
+        Half2, Half4,
+        Short2N, Short4N,
+        Byte4N
     };
     
     static uint32_t ShaderDataTypeSize(ShaderDataType type) {
@@ -27,21 +34,37 @@ namespace SpoonEngine {
             case ShaderDataType::Int3:     return 4 * 3;
             case ShaderDataType::Int4:     return 4 * 4;
             case ShaderDataType::Bool:     return 1;
+            case ShaderDataType::Half2:    return 2 * 2;
+            case ShaderDataType::Half4:    return 2 * 4;
+            case ShaderDataType::Short2N:  return 2 * 2;
+            case ShaderDataType::Short4N:  return 2 * 4;
+            case ShaderDataType::Byte4N:   return 4;
         }
         return 0;
     }
     
+    static bool ShaderDataTypeIsNormalized(ShaderDataType type) {
+        return type == ShaderDataType::Short2N || type == ShaderDataType::Short4N || type == ShaderDataType::Byte4N;
+    }
+    
     struct BufferElement {
         std::string Name;
         ShaderDataType Type;
         uint32_t Size;
         size_t Offset;
         bool Normalized;
+        int32_t Location = -1;      // -1 follows the previous element
         
         BufferElement() = default;
         
         BufferElement(ShaderDataType type, const std::string& name, bool normalized = false)
-            : Name(name), Type(type), Size(ShaderDataTypeSize(type)), Offset(0), Normalized(normalized) {
+            : Name(name), Type(type), Size(ShaderDataTypeSize(type)), Offset(0), Normalized(normalized || ShaderDataTypeIsNormalized(type)) {
+        }
+        
+        // Pinned to a shader attribute location, so layouts may skip locations
+        BufferElement(uint32_t location, ShaderDataType type, const std::string& name, bool normalized = false)
+            : BufferElement(type, name, normalized) {
+            Location = static_cast<int32_t>(location);
         }
         
         uint32_t GetComponentCount() const {
@@ -58,6 +81,11 @@ namespace SpoonEngine {
                 case ShaderDataType::Int3:    return 3;
                 case ShaderDataType::Int4:    return 4;
                 case ShaderDataType::Bool:    return 1;
+                case ShaderDataType::Half2:   return 2;
+                case ShaderDataType::Half4:   return 4;
+                case ShaderDataType::Short2N: return 2;
+                case ShaderDataType::Short4N: return 4;
+                case ShaderDataType::Byte4N:  return 4;
             }
             return 0;
         }
@@ -70,6 +98,10 @@ namespace SpoonEngine {
             : m_Elements(elements) {
             CalculateOffsetsAndStride();
         }
+        BufferLayout(const std::vector<BufferElement>& elements)
+            : m_Elements(elements) {
+            CalculateOffsetsAndStride();
+        }
         
         uint32_t GetStride() const { return m_Stride; }
         const std::vector<BufferElement>& GetElements() const { return m_Elements; }
@@ -101,8 +133,18 @@ namespace SpoonEngine {
         virtual void Bind() const = 0;
         virtual void Unbind() const = 0;
         
+        // Replaces the contents from the start. Buffers created with only a size are dynamic
+        // and get a fresh store each time, so rewriting them every frame never waits on draws
+        // still reading the old data; buffers created with data keep their static store.
         virtual void SetData(const void* data, uint32_t size) = 0;
         
+        // Writes into part of the buffer without orphaning the rest; ranges still read by
+        // queued draws must not be overwritten
+        virtual void SetSubData(const void* data, uint32_t size, uint32_t offset) = 0;
+        
+        // GPU-side copy; source must come from the same backend and may not be this buffer
+        virtual void CopyFrom(const VertexBuffer& source, uint32_t sourceOffset, uint32_t offset, uint32_t size) = 0;
+        
         virtual const BufferLayout& GetLayout() const = 0;
         virtual void SetLayout(const BufferLayout& layout) = 0;
         
@@ -110,6 +152,15 @@ namespace SpoonEngine {
         static std::shared_ptr<VertexBuffer> Create(float* vertices, uint32_t size);
     };
     
+    enum class IndexType {
+        UInt16 = 0,
+        UInt32
+    };
+    
+    static uint32_t IndexTypeSize(IndexType type) {
+        return type == IndexType::UInt16 ? 2 : 4;
+    }
+    
     class IndexBuffer {
     public:
         virtual ~IndexBuffer() = default;
@@ -118,8 +169,73 @@ namespace SpoonEngine {
         virtual void Unbind() const = 0;
         
         virtual uint32_t GetCount() const = 0;
+        virtual IndexType GetIndexType() const = 0;
+        
+        // Offsets and counts are in indices. uint32_t input is narrowed for 16-bit buffers.
+        virtual void SetSubData(const uint32_t* indices, uint32_t count, uint32_t offset) = 0;
+        virtual void CopyFrom(const IndexBuffer& source, uint32_t sourceOffset, uint32_t offset, uint32_t count) = 0;
+        
+        // Uninitialized storage for count indices, filled with SetSubData
+        static std::shared_ptr<IndexBuffer> Create(uint32_t count, IndexType type);
+        
+        // Narrows to 16-bit indices whenever every index fits, halving the upload and the
+        // bandwidth of each draw; pass GetIndexType() to the draw call
+        static std::shared_ptr<IndexBuffer> Create(const uint32_t* indices, uint32_t count);
+        static std::shared_ptr<IndexBuffer> Create(const uint16_t* indices, uint32_t count);
+    };
+    
+    // Matches the GL/Vulkan indexed indirect command layout, so an array of these can be
+    // uploaded to the GPU verbatim.
+    struct DrawElementsIndirectCommand {
+        uint32_t Count = 0;
+        uint32_t InstanceCount = 1;
+        uint32_t FirstIndex = 0;
+        int32_t BaseVertex = 0;
+        uint32_t BaseInstance = 0;
+    };
+    
+    class IndirectBuffer {
+    public:
+        virtual ~IndirectBuffer() = default;
+        
+        virtual void Bind() const = 0;
+        virtual void Unbind() const = 0;
+        
+        virtual void SetData(const DrawElementsIndirectCommand* commands, uint32_t count) = 0;
+        
+        // CPU-side copy of the last uploaded commands, used by backends without indirect support
+        virtual const std::vector<DrawElementsIndirectCommand>& GetCommands() const = 0;
+        virtual uint32_t GetCount() const = 0;
+        
+        static std::shared_ptr<IndirectBuffer> Create(uint32_t maxCommands);
+    };
+    
+    class UniformBuffer {
+    public:
+        virtual ~UniformBuffer() = default;
+        
+        virtual void Bind(uint32_t binding) const = 0;
+        virtual void SetData(const void* data, uint32_t size, uint32_t offset = 0) = 0;
+        
+        virtual uint32_t GetSize() const = 0;
+        
+        static std::shared_ptr<UniformBuffer> Create(uint32_t size);
+    };
+    
+    class VertexArray {
+    public:
+        virtual ~VertexArray() = default;
+        
+        virtual void Bind() const = 0;
+        virtual void Unbind() const = 0;
+        
+        virtual void AddVertexBuffer(const std::shared_ptr<VertexBuffer>& vertexBuffer) = 0;
+        virtual void SetIndexBuffer(const std::shared_ptr<IndexBuffer>& indexBuffer) = 0;
+        
+        virtual const std::vector<std::shared_ptr<VertexBuffer>>& GetVertexBuffers() const = 0;
+        virtual const std::shared_ptr<IndexBuffer>& GetIndexBuffer() const = 0;
         
-        static std::shared_ptr<IndexBuffer> Create(uint32_t* indices, uint32_t count);
+        static std::shared_ptr<VertexArray> Create();
     };
     
 }
\ No newline at end of file
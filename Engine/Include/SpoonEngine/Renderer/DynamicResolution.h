@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+namespace SpoonEngine {
+    
+    struct DynamicResolutionSettings {
+        float TargetGPUTime = 8.0f;     // ms the scaled passes may take on the GPU
+        float Headroom = 0.8f;          // the scale only grows while below TargetGPUTime * Headroom
+        float MinScale = 0.5f;
+        float MaxScale = 1.0f;
+        float ScaleStep = 0.05f;        // scales are multiples of this, so noise does not resize every frame
+    };
+    
+    // Picks the fraction of the output width and height to render at so a measured GPU time
+    // stays inside [TargetGPUTime * Headroom, TargetGPUTime]. The cost is modelled as
+    // proportional to the pixel count. GPU timings arrive GPUProfiler::FrameLatency frames
+    // late, so after a change the controller ignores the timings still rendered at the old scale.
+    class DynamicResolutionController {
+    public:
+        void SetSettings(const DynamicResolutionSettings& settings);
+        const DynamicResolutionSettings& GetSettings() const { return m_Settings; }
+        
+        // frame identifies the frame the timing belongs to; repeated timings of one frame are ignored
+        void Update(uint64_t frame, double gpuTime);
+        void Reset();
+        
+        float GetScale() const { return m_Scale; }
+        // Smoothed timing the last decision was based on, in ms
+        double GetGPUTime() const { return m_SmoothedTime; }
+    
+    private:
+        float Quantize(float scale) const;
+        
+        DynamicResolutionSettings m_Settings;
+        float m_Scale = 1.0f;
+        uint64_t m_LastFrame = 0;
+        uint32_t m_Cooldown = 0;
+        double m_SmoothedTime = 0.0;
+    };
+    
+}
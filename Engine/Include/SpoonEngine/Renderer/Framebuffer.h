@@ -1,9 +1,13 @@
 #pragma once
 
 #include "SpoonEngine/Assets/Texture.h"
+#include <functional>
 #include <memory>
 #include <vector>
+#include <set>
+#include <utility>
 #include <cstdint>
+#include <cstring>
 
 namespace SpoonEngine {
     
@@ -13,6 +17,9 @@ namespace SpoonEngine {
         // Color
         RGBA8,
         RED_INTEGER,
+        RGBA16F,
+        RG16,           // unsigned normalized; octahedral normals
+        R11G11B10F,
         
         // Depth/stencil
         DEPTH24STENCIL8,
@@ -46,25 +53,118 @@ namespace SpoonEngine {
         bool SwapChainTarget = false;
     };
     
+    // The part of a framebuffer's attachments that is rendered to. Attachments can be larger
+    // than the specification after a resize, in which case only the lower-left Width x Height
+    // is used; sample it with texture coordinates up to GetUVScaleX/Y().
+    struct FramebufferRegion {
+        uint32_t Width = 0, Height = 0;
+        uint32_t AttachmentWidth = 0, AttachmentHeight = 0;
+        
+        float GetUVScaleX() const { return AttachmentWidth ? static_cast<float>(Width) / AttachmentWidth : 1.0f; }
+        float GetUVScaleY() const { return AttachmentHeight ? static_cast<float>(Height) / AttachmentHeight : 1.0f; }
+    };
+    
+    struct FramebufferRect {
+        uint32_t X = 0, Y = 0;      // lower-left corner
+        uint32_t Width = 0, Height = 0;
+    };
+    
+    // Pixels copied out of one color attachment, rows bottom-up. RGBA8 and RG16 come as 8 and
+    // 16-bit channels, RED_INTEGER as int32, RGBA16F as half floats and R11G11B10F as floats.
+    struct FramebufferReadback {
+        FramebufferRect Rect;       // clipped to the framebuffer's region
+        uint32_t BytesPerPixel = 0;
+        std::vector<uint8_t> Data;
+        
+        // Value at (x, y) inside Rect of a RED_INTEGER attachment, e.g. an entity id for picking
+        int GetInt(uint32_t x, uint32_t y) const {
+            int value = -1;
+            size_t offset = (static_cast<size_t>(y) * Rect.Width + x) * BytesPerPixel;
+            if (x < Rect.Width && y < Rect.Height && offset + sizeof(value) <= Data.size()) {
+                std::memcpy(&value, Data.data() + offset, sizeof(value));
+            }
+            return value;
+        }
+    };
+    
+    using FramebufferReadbackCallback = std::function<void(const FramebufferReadback&)>;
+    
     class Framebuffer {
     public:
         virtual ~Framebuffer() = default;
         
+        // Unbind restores the framebuffer and viewport that were current at Bind, so passes can
+        // render offscreen from inside another framebuffer's pass
         virtual void Bind() = 0;
         virtual void Unbind() = 0;
         
+        // Resizes are not applied to the attachments right away: while the size keeps changing
+        // (an editor panel being dragged) the framebuffer renders to a sub-rect of the attachments
+        // it has, and only reallocates once the size has stopped changing for a moment
         virtual void Resize(uint32_t width, uint32_t height) = 0;
+        
+        // Reads one pixel of the bound framebuffer right away, which waits for the GPU to finish
+        // everything queued before it; prefer RequestReadback for anything done every frame
         virtual int ReadPixel(uint32_t attachmentIndex, int x, int y) = 0;
         
+        // Queues a copy of rect into a pixel-pack buffer without waiting for the GPU. The callback
+        // runs once the copy has landed, usually one or two frames later, from the renderer's
+        // BeginFrame on the thread that executes render commands. Returns false, without calling
+        // back, for multisampled or unknown attachments, an empty rect or a full readback ring.
+        virtual bool RequestReadback(const FramebufferRect& rect, FramebufferReadbackCallback callback, uint32_t attachmentIndex = 0) = 0;
+        
+        // Integer attachments (RED_INTEGER) only; call it outside Bind/Unbind of this framebuffer
         virtual void ClearAttachment(uint32_t attachmentIndex, int value) = 0;
         
+        // Copies all of this framebuffer's depth into destination with its lower-left corner at (x, y);
+        // both depth attachments must have the same format
+        virtual void BlitDepth(Framebuffer& destination, uint32_t x, uint32_t y) = 0;
+        
+        // Clears depth inside a rectangle only; the framebuffer must be bound with depth writes enabled
+        virtual void ClearDepth(uint32_t x, uint32_t y, uint32_t width, uint32_t height) = 0;
+        
         virtual uint32_t GetColorAttachmentRendererID(uint32_t index = 0) const = 0;
         virtual std::shared_ptr<Texture2D> GetColorAttachment(uint32_t index = 0) const = 0;
         virtual std::shared_ptr<Texture2D> GetDepthAttachment() const = 0;
         
         virtual const FramebufferSpecification& GetSpecification() const = 0;
+        virtual FramebufferRegion GetRegion() const = 0;
         
         static std::shared_ptr<Framebuffer> Create(const FramebufferSpecification& spec);
     };
     
-}
\ No newline at end of file
+    struct FramebufferTile {
+        uint32_t X = 0, Y = 0;
+        uint32_t Size = 0;      // 0 when not allocated
+    };
+    
+    // Hands out square power-of-two tiles of a square framebuffer, e.g. a shadow atlas. A request
+    // takes the first free tile of its size, splitting a larger one into four when there is
+    // none; freeing a tile merges it back once its three siblings are free too.
+    class FramebufferTileAllocator {
+    public:
+        explicit FramebufferTileAllocator(uint32_t size = 0, uint32_t minTileSize = 16);
+        
+        // size is rounded up to a power of two; false when no tile that large is free
+        bool Allocate(uint32_t size, FramebufferTile& tile);
+        void Free(FramebufferTile& tile);
+        
+        // Frees every tile
+        void Reset(uint32_t size);
+        
+        uint32_t GetSize() const { return m_Size; }
+        uint64_t GetUsedArea() const { return m_UsedArea; }
+        float GetUsage() const { return m_Size ? static_cast<float>(m_UsedArea) / (static_cast<float>(m_Size) * m_Size) : 0.0f; }
+    
+    private:
+        uint32_t GetLevel(uint32_t size) const;
+        
+        uint32_t m_Size = 0;
+        uint32_t m_MinTileSize = 16;
+        uint64_t m_UsedArea = 0;
+        
+        // Free tile origins (y, x) per level; level 0 is the whole framebuffer
+        std::vector<std::set<std::pair<uint32_t, uint32_t>>> m_FreeTiles;
+    };
+    
+}
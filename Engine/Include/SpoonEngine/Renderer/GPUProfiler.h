@@ -0,0 +1,125 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+namespace SpoonEngine {
+    
+    // Per-pass GPU timing from timestamp queries. Queries written in frame N are read back
+    // FrameLatency frames later and skipped if still unavailable, so the CPU never waits.
+    class GPUProfiler {
+    public:
+        struct ScopeResult {
+            std::string Name;
+            uint32_t Depth = 0;
+            
+            // Milliseconds; starts are relative to the profiler's creation
+            double CPUStart = 0.0;
+            double CPUTime = 0.0;
+            double GPUStart = 0.0;
+            double GPUTime = 0.0;
+        };
+        
+        struct FrameResult {
+            uint64_t Frame = 0;
+            std::vector<ScopeResult> Scopes;
+        };
+        
+        virtual ~GPUProfiler() = default;
+        
+        void BeginFrame();
+        void EndFrame();
+        
+        void BeginScope(const std::string& name);
+        void EndScope();
+        
+        void SetEnabled(bool enabled) { m_Enabled = enabled; }
+        bool IsEnabled() const { return m_Enabled; }
+        
+        // Most recent frame whose queries have resolved
+        FrameResult GetLatestResult() const;
+        
+        // Writes the retained history as Chrome trace JSON (chrome://tracing, Perfetto)
+        bool ExportTrace(const std::string& filepath) const;
+        
+        static constexpr uint32_t FrameLatency = 4;
+        static constexpr uint32_t MaxScopesPerFrame = 256;
+        static constexpr uint32_t HistorySize = 300;
+        
+        static void Init();
+        static void Shutdown();
+        static GPUProfiler* Get() { return s_Instance.get(); }
+        
+    protected:
+        GPUProfiler();
+        
+        // Backend hooks: record a timestamp into slot/index now, and later fetch count
+        // timestamps of a slot in nanoseconds, returning false if any is not available yet
+        virtual void WriteTimestamp(uint32_t slot, uint32_t index) = 0;
+        virtual bool ReadTimestamps(uint32_t slot, uint32_t count, uint64_t* nanoseconds) = 0;
+        
+    private:
+        struct PendingScope {
+            std::string Name;
+            uint32_t Depth;
+            uint32_t BeginQuery;
+            uint32_t EndQuery;
+            double CPUStart;
+            double CPUEnd;
+        };
+        
+        struct FrameSlot {
+            uint64_t Frame = 0;
+            bool Pending = false;
+            uint32_t QueryCount = 0;
+            double CPUStart = 0.0;
+            std::vector<PendingScope> Scopes;
+            std::vector<uint32_t> OpenScopes;
+        };
+        
+        void Resolve(FrameSlot& slot, uint32_t slotIndex);
+        double Now() const;
+        
+        bool m_Enabled = true;
+        bool m_InFrame = false;
+        uint64_t m_Frame = 0;
+        FrameSlot m_Slots[FrameLatency];
+        std::vector<uint64_t> m_Timestamps;
+        
+        std::chrono::steady_clock::time_point m_Epoch;
+        
+        mutable std::mutex m_ResultMutex;
+        std::deque<FrameResult> m_History;
+        
+        static std::unique_ptr<GPUProfiler> s_Instance;
+    };
+    
+    class GPUProfileScope {
+    public:
+        GPUProfileScope(const std::string& name) {
+            if (GPUProfiler* profiler = GPUProfiler::Get()) {
+                m_Profiler = profiler;
+                profiler->BeginScope(name);
+            }
+        }
+        
+        ~GPUProfileScope() {
+            if (m_Profiler) {
+                m_Profiler->EndScope();
+            }
+        }
+        
+    private:
+        GPUProfiler* m_Profiler = nullptr;
+    };
+    
+}
+
+#define SPOON_GPU_SCOPE_CONCAT_IMPL(a, b) a##b
+#define SPOON_GPU_SCOPE_CONCAT(a, b) SPOON_GPU_SCOPE_CONCAT_IMPL(a, b)
+#define SPOON_GPU_SCOPE(name) ::SpoonEngine::GPUProfileScope SPOON_GPU_SCOPE_CONCAT(gpuScope, __LINE__)(name)
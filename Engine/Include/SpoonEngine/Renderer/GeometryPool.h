@@ -0,0 +1,135 @@
+#pragma once
+
+#include "SpoonEngine/Renderer/Buffer.h"
+#include <map>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace SpoonEngine {
+    
+    // Vertex streams and index type shared by every allocation of one pool
+    struct GeometryPoolFormat {
+        // With several streams, stream 0 also gets a vertex array of its own for depth-only passes
+        std::vector<BufferLayout> Streams;
+        IndexType Indices = IndexType::UInt32;
+    };
+    
+    struct GeometryPoolStats {
+        uint32_t Pools = 0;
+        uint32_t Blocks = 0;
+        uint32_t Allocations = 0;
+        uint64_t VertexCapacity = 0;
+        uint64_t VerticesUsed = 0;
+        uint64_t IndexCapacity = 0;
+        uint64_t IndicesUsed = 0;
+        uint32_t FreeRanges = 0;    // vertex and index; a packed block has at most one tail of each
+        uint64_t Bytes = 0;
+    };
+    
+    // First-fit free list over [0, capacity), coalescing neighbours on free
+    class RangeAllocator {
+    public:
+        explicit RangeAllocator(uint32_t capacity = 0);
+        
+        // Returns InvalidOffset when no free range is large enough
+        uint32_t Allocate(uint32_t size);
+        void Free(uint32_t offset, uint32_t size);
+        
+        // Free space is not one range at the end
+        bool IsFragmented() const;
+        
+        uint32_t GetCapacity() const { return m_Capacity; }
+        uint32_t GetUsed() const { return m_Used; }
+        uint32_t GetFreeRangeCount() const { return static_cast<uint32_t>(m_FreeRanges.size()); }
+        
+        static constexpr uint32_t InvalidOffset = 0xffffffffu;
+    
+    private:
+        std::map<uint32_t, uint32_t> m_FreeRanges;  // offset -> size
+        uint32_t m_Capacity;
+        uint32_t m_Used = 0;
+    };
+    
+    class GeometryPool;
+    struct GeometryBlock;
+    
+    // Vertex and index ranges of one mesh inside a pool block, released on destruction.
+    // Defragment moves them, so read the offsets when drawing rather than caching them.
+    class GeometryAllocation {
+    public:
+        ~GeometryAllocation();
+        
+        uint32_t GetVertexOffset() const { return m_VertexOffset; }
+        uint32_t GetVertexCount() const { return m_VertexCount; }
+        uint32_t GetIndexOffset() const { return m_IndexOffset; }
+        uint32_t GetIndexCount() const { return m_IndexCount; }
+        
+        // data holds GetVertexCount() vertices in the stream's layout
+        void SetVertexData(uint32_t stream, const void* data);
+        // offset is relative to the allocation's first index
+        void SetIndexData(const uint32_t* indices, uint32_t count, uint32_t offset = 0);
+        
+        // Shared by every allocation of the block; draw with base vertex and first index
+        const std::shared_ptr<VertexArray>& GetVertexArray() const;
+        // Stream 0 only; null for single-stream pools
+        const std::shared_ptr<VertexArray>& GetStreamVertexArray() const;
+        
+        IndexType GetIndexType() const;
+    
+    private:
+        friend class GeometryPool;
+        GeometryAllocation() = default;
+        
+        std::shared_ptr<GeometryPool> m_Pool;
+        GeometryBlock* m_Block = nullptr;
+        uint32_t m_VertexOffset = 0;
+        uint32_t m_VertexCount = 0;
+        uint32_t m_IndexOffset = 0;
+        uint32_t m_IndexCount = 0;
+    };
+    
+    // Suballocates meshes of one vertex format from a few large blocks, each a set of stream
+    // buffers, an index buffer and a vertex array over them, so consecutive draws of pooled
+    // meshes only change their base vertex and first index
+    class GeometryPool : public std::enable_shared_from_this<GeometryPool> {
+    public:
+        explicit GeometryPool(const GeometryPoolFormat& format);
+        ~GeometryPool();
+        
+        // The shared pool of a format, created on first use and released with its last allocation
+        static std::shared_ptr<GeometryPool> Get(const GeometryPoolFormat& format);
+        
+        // Null when the backend cannot create buffers
+        std::unique_ptr<GeometryAllocation> Allocate(uint32_t vertexCount, uint32_t indexCount);
+        
+        // Repacks every fragmented block into fresh buffers with GPU-side copies and drops
+        // empty blocks. Offsets of live allocations change: run it between frames.
+        void Defragment();
+        static void DefragmentAll();
+        
+        const GeometryPoolFormat& GetFormat() const { return m_Format; }
+        
+        static GeometryPoolStats GetStats();
+        
+        // Capacity of new blocks; an allocation larger than this gets a block of its own
+        static void SetBlockSize(uint32_t vertices, uint32_t indices);
+        
+        static constexpr uint32_t DefaultBlockVertices = 1 << 18;
+        static constexpr uint32_t DefaultBlockIndices = 1 << 20;
+    
+    private:
+        friend class GeometryAllocation;
+        
+        std::unique_ptr<GeometryBlock> CreateBlock(uint32_t vertices, uint32_t indices) const;
+        std::unique_ptr<GeometryAllocation> AllocateFromBlock(GeometryBlock& block, uint32_t vertexCount, uint32_t indexCount);
+        void Free(GeometryAllocation* allocation);
+        
+        GeometryPoolFormat m_Format;
+        std::vector<std::unique_ptr<GeometryBlock>> m_Blocks;
+        
+        static uint32_t s_BlockVertices;
+        static uint32_t s_BlockIndices;
+    };
+    
+}
@@ -14,11 +14,18 @@ namespace SpoonEngine {
         ~Material() = default;
         
         void Bind();
+        // Binds a shader obtained from GetActiveShader earlier, so work recorded against it
+        // stays consistent if the material's shader finishes compiling in between
+        void Bind(const std::shared_ptr<class Shader>& shader);
         void Unbind();
         
-        void SetShader(std::shared_ptr<class Shader> shader) { m_Shader = shader; }
+        void SetShader(std::shared_ptr<class Shader> shader);
         std::shared_ptr<class Shader> GetShader() const { return m_Shader; }
         
+        // The shader Bind uses: the material's own once it has compiled, an unlit placeholder
+        // shared by all materials until then. Set per-draw uniforms on this one.
+        std::shared_ptr<class Shader> GetActiveShader() const;
+        
         // Texture management
         void SetTexture(const std::string& name, std::shared_ptr<class Texture> texture);
         std::shared_ptr<class Texture> GetTexture(const std::string& name) const;
@@ -45,9 +52,17 @@ namespace SpoonEngine {
         static std::shared_ptr<Material> Create(const std::string& name = "Material");
         static std::shared_ptr<Material> Create(std::shared_ptr<class Shader> shader, const std::string& name = "Material");
         
+        // The renderer creates the placeholder at initialization, on the thread owning the
+        // context, so recording a frame never has to
+        static void InitPlaceholderShader();
+        static void ReleasePlaceholderShader();
+        static std::shared_ptr<class Shader> GetPlaceholderShader();
+        
     private:
         std::string m_Name;
         std::shared_ptr<class Shader> m_Shader;
+        // Only held while m_Shader was still compiling when it was set
+        std::shared_ptr<class Shader> m_PlaceholderShader;
         
         // Textures
         std::unordered_map<std::string, std::shared_ptr<class Texture>> m_Textures;
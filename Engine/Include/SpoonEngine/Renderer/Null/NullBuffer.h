@@ -0,0 +1,111 @@
+#pragma once
+
+#include "SpoonEngine/Renderer/Buffer.h"
+#include "SpoonEngine/Renderer/StreamingBuffer.h"
+
+namespace SpoonEngine {
+    
+    class NullVertexBuffer : public VertexBuffer {
+    public:
+        NullVertexBuffer(uint32_t size);
+        NullVertexBuffer(float* vertices, uint32_t size);
+        
+        void Bind() const override;
+        void Unbind() const override {}
+        
+        void SetData(const void* data, uint32_t size) override;
+        void SetSubData(const void* data, uint32_t size, uint32_t offset) override;
+        void CopyFrom(const VertexBuffer& source, uint32_t sourceOffset, uint32_t offset, uint32_t size) override {}
+        
+        const BufferLayout& GetLayout() const override { return m_Layout; }
+        void SetLayout(const BufferLayout& layout) override { m_Layout = layout; }
+        
+    private:
+        BufferLayout m_Layout;
+    };
+    
+    class NullIndexBuffer : public IndexBuffer {
+    public:
+        NullIndexBuffer(const void* indices, uint32_t count, IndexType type);
+        
+        void Bind() const override;
+        void Unbind() const override {}
+        
+        uint32_t GetCount() const override { return m_Count; }
+        IndexType GetIndexType() const override { return m_Type; }
+        
+        void SetSubData(const uint32_t* indices, uint32_t count, uint32_t offset) override;
+        void CopyFrom(const IndexBuffer& source, uint32_t sourceOffset, uint32_t offset, uint32_t count) override {}
+        
+    private:
+        uint32_t m_Count;
+        IndexType m_Type;
+    };
+    
+    class NullIndirectBuffer : public IndirectBuffer {
+    public:
+        NullIndirectBuffer(uint32_t maxCommands);
+        
+        void Bind() const override;
+        void Unbind() const override {}
+        
+        void SetData(const DrawElementsIndirectCommand* commands, uint32_t count) override;
+        
+        const std::vector<DrawElementsIndirectCommand>& GetCommands() const override { return m_Commands; }
+        uint32_t GetCount() const override { return static_cast<uint32_t>(m_Commands.size()); }
+        
+    private:
+        uint32_t m_MaxCommands;
+        std::vector<DrawElementsIndirectCommand> m_Commands;
+    };
+    
+    class NullUniformBuffer : public UniformBuffer {
+    public:
+        NullUniformBuffer(uint32_t size);
+        
+        void Bind(uint32_t binding) const override;
+        void SetData(const void* data, uint32_t size, uint32_t offset = 0) override;
+        
+        uint32_t GetSize() const override { return m_Size; }
+        
+    private:
+        uint32_t m_Size;
+    };
+    
+    class NullVertexArray : public VertexArray {
+    public:
+        void Bind() const override;
+        void Unbind() const override {}
+        
+        void AddVertexBuffer(const std::shared_ptr<VertexBuffer>& vertexBuffer) override;
+        void SetIndexBuffer(const std::shared_ptr<IndexBuffer>& indexBuffer) override;
+        
+        const std::vector<std::shared_ptr<VertexBuffer>>& GetVertexBuffers() const override { return m_VertexBuffers; }
+        const std::shared_ptr<IndexBuffer>& GetIndexBuffer() const override { return m_IndexBuffer; }
+        
+    private:
+        std::vector<std::shared_ptr<VertexBuffer>> m_VertexBuffers;
+        std::shared_ptr<IndexBuffer> m_IndexBuffer;
+    };
+    
+    // CPU-only ring so callers exercise the same write path as on a GPU backend
+    class NullStreamingBuffer : public StreamingBuffer {
+    public:
+        NullStreamingBuffer(StreamingBufferUsage usage, uint32_t frameCapacity);
+        
+        StreamingAllocation Allocate(uint32_t size) override;
+        void Commit(const StreamingAllocation& allocation) override;
+        
+        void Bind() const override;
+        void BindRange(uint32_t binding, const StreamingAllocation& allocation) const override;
+        
+        uint32_t GetFrameCapacity() const override { return static_cast<uint32_t>(m_Storage.size()); }
+        bool IsPersistentlyMapped() const override { return true; }
+        
+    private:
+        std::vector<uint8_t> m_Storage;
+        uint32_t m_Head = 0;
+        uint64_t m_Frame = 0;
+    };
+    
+}
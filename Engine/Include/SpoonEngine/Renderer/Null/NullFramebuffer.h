@@ -0,0 +1,38 @@
+#pragma once
+
+#include "SpoonEngine/Renderer/Framebuffer.h"
+
+namespace SpoonEngine {
+    
+    class NullFramebuffer : public Framebuffer {
+    public:
+        NullFramebuffer(const FramebufferSpecification& spec);
+        
+        virtual void Bind() override;
+        virtual void Unbind() override;
+        
+        virtual void Resize(uint32_t width, uint32_t height) override;
+        virtual int ReadPixel(uint32_t attachmentIndex, int x, int y) override { return -1; }
+        virtual bool RequestReadback(const FramebufferRect& rect, FramebufferReadbackCallback callback, uint32_t attachmentIndex = 0) override { return false; }
+        
+        virtual void ClearAttachment(uint32_t attachmentIndex, int value) override {}
+        virtual void BlitDepth(Framebuffer& destination, uint32_t x, uint32_t y) override;
+        virtual void ClearDepth(uint32_t x, uint32_t y, uint32_t width, uint32_t height) override;
+        
+        virtual uint32_t GetColorAttachmentRendererID(uint32_t index = 0) const override { return 0; }
+        virtual std::shared_ptr<Texture2D> GetColorAttachment(uint32_t index = 0) const override { return nullptr; }
+        virtual std::shared_ptr<Texture2D> GetDepthAttachment() const override { return nullptr; }
+        
+        virtual const FramebufferSpecification& GetSpecification() const override {
+            return m_Specification;
+        }
+        
+        virtual FramebufferRegion GetRegion() const override {
+            return { m_Specification.Width, m_Specification.Height, m_Specification.Width, m_Specification.Height };
+        }
+    
+    private:
+        FramebufferSpecification m_Specification;
+    };
+    
+}
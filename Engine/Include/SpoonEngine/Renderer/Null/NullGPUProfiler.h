@@ -0,0 +1,14 @@
+#pragma once
+
+#include "SpoonEngine/Renderer/GPUProfiler.h"
+
+namespace SpoonEngine {
+    
+    // Keeps the scope/CPU timing side of the profiler working headless; GPU times read as zero
+    class NullGPUProfiler : public GPUProfiler {
+    protected:
+        void WriteTimestamp(uint32_t slot, uint32_t index) override;
+        bool ReadTimestamps(uint32_t slot, uint32_t count, uint64_t* nanoseconds) override;
+    };
+    
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "SpoonEngine/Renderer/Renderer.h"
+
+namespace SpoonEngine {
+    
+    // Headless backend: executes no GPU work, only counts what a real backend would have
+    // been asked to do. Stub resources from the Null/ headers report into the same counters.
+    class NullRenderer : public RendererBackend {
+    public:
+        void Initialize() override;
+        void Shutdown() override;
+        
+        void SetViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height) override;
+        void SetClearColor(float r, float g, float b, float a) override;
+        void Clear() override;
+        
+        void SetDepthTest(DepthFunc func, bool depthWrite) override;
+        void SetColorWrite(bool enabled) override;
+        
+        void BeginSampleCount(SamplePass pass) override;
+        void EndSampleCount(SamplePass pass) override;
+        
+        void BeginFrame() override;
+        void EndFrame() override;
+        
+        void DrawIndexed(uint32_t indexCount, IndexType indexType) override;
+        void DrawIndexedBaseVertex(uint32_t indexCount, uint32_t firstIndex, int32_t baseVertex, IndexType indexType) override;
+        void DrawIndexedIndirect(const IndirectBuffer& commands, uint32_t drawCount, IndexType indexType) override;
+        void Present() override;
+        
+        RendererStats GetStats() const override { return s_LastFrameStats; }
+        
+        // Counters of the frame currently being recorded
+        static RendererStats& GetFrameStats() { return s_FrameStats; }
+        static uint64_t GetFrameIndex() { return s_FrameIndex; }
+        
+    private:
+        static RendererStats s_FrameStats;
+        static RendererStats s_LastFrameStats;
+        static uint64_t s_FrameIndex;
+    };
+    
+}
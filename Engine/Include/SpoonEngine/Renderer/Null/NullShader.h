@@ -0,0 +1,39 @@
+#pragma once
+
+#include "SpoonEngine/Renderer/Shader.h"
+
+namespace SpoonEngine {
+    
+    class NullShader : public Shader {
+    public:
+        NullShader(const std::string& filepath);
+        NullShader(const std::string& name, const std::string& vertexSrc, const std::string& fragmentSrc);
+        
+        void Bind() const override;
+        void Unbind() const override {}
+        
+        void SetInt(const std::string& name, int value) override;
+        void SetIntArray(const std::string& name, int* values, uint32_t count) override;
+        void SetFloat(const std::string& name, float value) override;
+        void SetFloat2(const std::string& name, const glm::vec2& value) override;
+        void SetFloat3(const std::string& name, const glm::vec3& value) override;
+        void SetFloat4(const std::string& name, const glm::vec4& value) override;
+        void SetMat4(const std::string& name, const glm::mat4& value) override;
+        void SetFloat4Array(const std::string& name, const glm::vec4* values, uint32_t count) override;
+        void SetMat4Array(const std::string& name, const glm::mat4* values, uint32_t count) override;
+        
+        // Answered from the source text, so batching decisions match the GPU backends
+        uint32_t GetVertexInputMask() const override { return m_VertexInputMask; }
+        bool HasUniformBlock(const std::string& name) const override;
+        bool HasFragmentOutput(const std::string& name) const override;
+        void SetUniformBlockBinding(const std::string& name, uint32_t binding) override;
+        
+        const std::string& GetName() const override { return m_Name; }
+        
+    private:
+        std::string m_Name;
+        std::string m_Source;
+        uint32_t m_VertexInputMask = 0;
+    };
+    
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "SpoonEngine/Assets/Texture.h"
+
+namespace SpoonEngine {
+    
+    // Never decodes image files; size comes from the specification
+    class NullTexture2D : public Texture2D {
+    public:
+        NullTexture2D(AssetID id, const std::string& path);
+        NullTexture2D(AssetID id, const std::string& path, const TextureSpecification& specification);
+        
+        bool Load() override;
+        void Bind(uint32_t slot = 0) const override;
+        void Unbind() const override {}
+        
+        void SetData(void* data, uint32_t size) override;
+        
+        uint32_t GetWidth() const override { return m_Specification.Width; }
+        uint32_t GetHeight() const override { return m_Specification.Height; }
+        uint32_t GetRendererID() const override { return 0; }
+        
+        bool IsLoaded() const override { return m_IsLoaded; }
+        
+        bool operator==(const Texture& other) const override { return this == &other; }
+        
+    private:
+        bool m_IsLoaded = false;
+    };
+    
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "SpoonEngine/Math/BoundingBox.h"
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace SpoonEngine {
+    
+    class Mesh;
+    
+    enum class CullResult : uint8_t {
+        Visible = 0,
+        FrustumCulled,
+        Occluded
+    };
+    
+    struct CullingStats {
+        uint32_t Tested = 0;
+        uint32_t FrustumCulled = 0;
+        uint32_t Occluded = 0;
+        uint32_t Occluders = 0;
+        uint32_t OccluderTriangles = 0;
+        float RasterTime = 0.0f;    // ms spent rasterizing occluders and building the Hi-Z pyramid
+        float TestTime = 0.0f;      // ms spent testing bounds
+    };
+    
+    // Software occlusion culling. Selected occluder meshes are rasterized on the CPU into a
+    // small depth buffer (SSE, four pixels per step, screen split into bands across the job
+    // system), reduced to a max-depth Hi-Z pyramid, and bounding boxes are then tested
+    // against it. Every step errs towards "visible": triangles crossing the near plane are
+    // skipped as occluders, and boxes crossing it are never culled.
+    class OcclusionCuller {
+    public:
+        struct Item {
+            BoundingBox Bounds;     // local space
+            glm::mat4 Transform;
+        };
+        
+        OcclusionCuller(uint32_t width = DefaultWidth, uint32_t height = DefaultHeight);
+        
+        void BeginFrame(const glm::mat4& viewProjection);
+        // subMesh selects one sub-mesh to rasterize, -1 all of them (as MeshRenderer::SubMesh)
+        void AddOccluder(const Mesh& mesh, const glm::mat4& transform, int32_t subMesh = -1);
+        
+        // Rasterizes the occluders added since BeginFrame and builds the Hi-Z pyramid
+        void Rasterize();
+        
+        CullResult Test(const BoundingBox& bounds, const glm::mat4& transform) const;
+        void Test(const std::vector<Item>& items, std::vector<CullResult>& results);
+        
+        uint32_t GetWidth() const { return m_Width; }
+        uint32_t GetHeight() const { return m_Height; }
+        
+        // Level 0 is the rasterized depth, each further level the max of a 2x2 footprint
+        const std::vector<float>& GetDepthLevel(uint32_t level) const { return m_Levels[level].Depth; }
+        uint32_t GetLevelCount() const { return static_cast<uint32_t>(m_Levels.size()); }
+        
+        const CullingStats& GetStats() const { return m_Stats; }
+        
+        static constexpr uint32_t DefaultWidth = 256;
+        static constexpr uint32_t DefaultHeight = 128;
+        // Rows per rasterization job
+        static constexpr uint32_t BandHeight = 16;
+    
+    private:
+        struct ScreenTriangle {
+            float X[3];
+            float Y[3];
+            float Z[3];
+            int32_t MinY;
+            int32_t MaxY;
+        };
+        
+        struct Occluder {
+            const Mesh* MeshData;
+            glm::mat4 Transform;
+            int32_t SubMesh;
+        };
+        
+        struct Level {
+            uint32_t Width;
+            uint32_t Height;
+            std::vector<float> Depth;
+        };
+        
+        void TransformOccluder(const Occluder& occluder, std::vector<ScreenTriangle>& triangles) const;
+        void RasterizeBand(uint32_t minY, uint32_t maxY);
+        void RasterizeTriangle(const ScreenTriangle& triangle, int32_t minY, int32_t maxY);
+        void BuildHiZ();
+        
+        uint32_t m_Width;
+        uint32_t m_Height;
+        glm::mat4 m_ViewProjection = glm::mat4(1.0f);
+        
+        std::vector<Occluder> m_Occluders;
+        std::vector<std::vector<ScreenTriangle>> m_OccluderTriangles;
+        std::vector<ScreenTriangle> m_Triangles;
+        std::vector<Level> m_Levels;
+        bool m_HasOccluders = false;
+        
+        CullingStats m_Stats;
+    };
+    
+}
@@ -14,43 +14,90 @@ namespace SpoonEngine {
         void Unbind() const override;
         
         void SetData(const void* data, uint32_t size) override;
+        void SetSubData(const void* data, uint32_t size, uint32_t offset) override;
+        void CopyFrom(const VertexBuffer& source, uint32_t sourceOffset, uint32_t offset, uint32_t size) override;
         
         const BufferLayout& GetLayout() const override { return m_Layout; }
         void SetLayout(const BufferLayout& layout) override { m_Layout = layout; }
         
+        uint32_t GetRendererID() const { return m_RendererID; }
+        
     private:
         uint32_t m_RendererID;
+        uint32_t m_Size;
+        bool m_Dynamic = false;     // created without data: allocated GL_DYNAMIC_DRAW, orphaned by SetData
         BufferLayout m_Layout;
     };
     
     class OpenGLIndexBuffer : public IndexBuffer {
     public:
-        OpenGLIndexBuffer(uint32_t* indices, uint32_t count);
+        OpenGLIndexBuffer(const void* indices, uint32_t count, IndexType type);
         virtual ~OpenGLIndexBuffer();
         
         void Bind() const override;
         void Unbind() const override;
         
         uint32_t GetCount() const override { return m_Count; }
+        IndexType GetIndexType() const override { return m_Type; }
+        
+        void SetSubData(const uint32_t* indices, uint32_t count, uint32_t offset) override;
+        void CopyFrom(const IndexBuffer& source, uint32_t sourceOffset, uint32_t offset, uint32_t count) override;
+        
+        uint32_t GetRendererID() const { return m_RendererID; }
         
     private:
         uint32_t m_RendererID;
         uint32_t m_Count;
+        IndexType m_Type;
     };
     
-    class OpenGLVertexArray {
+    class OpenGLIndirectBuffer : public IndirectBuffer {
+    public:
+        OpenGLIndirectBuffer(uint32_t maxCommands);
+        virtual ~OpenGLIndirectBuffer();
+        
+        void Bind() const override;
+        void Unbind() const override;
+        
+        void SetData(const DrawElementsIndirectCommand* commands, uint32_t count) override;
+        
+        const std::vector<DrawElementsIndirectCommand>& GetCommands() const override { return m_Commands; }
+        uint32_t GetCount() const override { return static_cast<uint32_t>(m_Commands.size()); }
+        
+    private:
+        uint32_t m_RendererID = 0;
+        uint32_t m_MaxCommands;
+        std::vector<DrawElementsIndirectCommand> m_Commands;
+    };
+    
+    class OpenGLUniformBuffer : public UniformBuffer {
+    public:
+        OpenGLUniformBuffer(uint32_t size);
+        virtual ~OpenGLUniformBuffer();
+        
+        void Bind(uint32_t binding) const override;
+        void SetData(const void* data, uint32_t size, uint32_t offset = 0) override;
+        
+        uint32_t GetSize() const override { return m_Size; }
+        
+    private:
+        uint32_t m_RendererID;
+        uint32_t m_Size;
+    };
+    
+    class OpenGLVertexArray : public VertexArray {
     public:
         OpenGLVertexArray();
-        ~OpenGLVertexArray();
+        virtual ~OpenGLVertexArray();
         
-        void Bind() const;
-        void Unbind() const;
+        void Bind() const override;
+        void Unbind() const override;
         
-        void AddVertexBuffer(const std::shared_ptr<VertexBuffer>& vertexBuffer);
-        void SetIndexBuffer(const std::shared_ptr<IndexBuffer>& indexBuffer);
+        void AddVertexBuffer(const std::shared_ptr<VertexBuffer>& vertexBuffer) override;
+        void SetIndexBuffer(const std::shared_ptr<IndexBuffer>& indexBuffer) override;
         
-        const std::vector<std::shared_ptr<VertexBuffer>>& GetVertexBuffers() const { return m_VertexBuffers; }
-        const std::shared_ptr<IndexBuffer>& GetIndexBuffer() const { return m_IndexBuffer; }
+        const std::vector<std::shared_ptr<VertexBuffer>>& GetVertexBuffers() const override { return m_VertexBuffers; }
+        const std::shared_ptr<IndexBuffer>& GetIndexBuffer() const override { return m_IndexBuffer; }
         
     private:
         uint32_t m_RendererID;
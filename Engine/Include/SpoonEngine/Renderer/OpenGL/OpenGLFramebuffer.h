@@ -1,6 +1,7 @@
 #pragma once
 
 #include "SpoonEngine/Renderer/Framebuffer.h"
+#include <chrono>
 
 namespace SpoonEngine {
     
@@ -16,8 +17,13 @@ namespace SpoonEngine {
         
         virtual void Resize(uint32_t width, uint32_t height) override;
         virtual int ReadPixel(uint32_t attachmentIndex, int x, int y) override;
+        virtual bool RequestReadback(const FramebufferRect& rect, FramebufferReadbackCallback callback, uint32_t attachmentIndex = 0) override;
         
         virtual void ClearAttachment(uint32_t attachmentIndex, int value) override;
+        virtual void BlitDepth(Framebuffer& destination, uint32_t x, uint32_t y) override;
+        virtual void ClearDepth(uint32_t x, uint32_t y, uint32_t width, uint32_t height) override;
+        
+        uint32_t GetRendererID() const { return m_RendererID; }
         
         virtual uint32_t GetColorAttachmentRendererID(uint32_t index = 0) const override {
             if (index >= m_ColorAttachments.size()) return 0;
@@ -37,14 +43,42 @@ namespace SpoonEngine {
             return m_Specification;
         }
         
+        virtual FramebufferRegion GetRegion() const override {
+            return { m_Width, m_Height, m_AttachmentWidth, m_AttachmentHeight };
+        }
+        
+        // Textures released by resizes are kept for a while and handed to the next framebuffer
+        // that needs an attachment of the same format and size
+        static uint32_t GetPooledTextureCount();
+        static void ReleasePooledTextures();
+        
+        // Delivers the readbacks whose copies have completed; called by OpenGLRenderer at BeginFrame
+        static void ProcessReadbacks();
+        static void ReleaseReadbacks();
+    
     private:
+        void ReleaseAttachments();
+        
         uint32_t m_RendererID = 0;
         FramebufferSpecification m_Specification;
         
+        // Rendered region and the size of the attachments backing it
+        uint32_t m_Width = 0, m_Height = 0;
+        uint32_t m_AttachmentWidth = 0, m_AttachmentHeight = 0;
+        
+        // A resize waiting for the size to settle before the attachments follow it
+        bool m_ResizePending = false;
+        std::chrono::steady_clock::time_point m_LastResize;
+        
+        // Restored by Unbind
+        int32_t m_PreviousFramebuffer = 0;
+        int32_t m_PreviousViewport[4] = { 0, 0, 0, 0 };
+        
         std::vector<FramebufferTextureSpecification> m_ColorAttachmentSpecs;
         FramebufferTextureSpecification m_DepthAttachmentSpec = FramebufferTextureFormat::None;
         
         std::vector<uint32_t> m_ColorAttachments;
+        std::vector<uint32_t> m_ColorAttachmentFormats;     // GL internal formats, the pool key
         uint32_t m_DepthAttachment = 0;
         
         std::vector<std::shared_ptr<Texture2D>> m_ColorAttachmentTextures;
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "SpoonEngine/Renderer/GPUProfiler.h"
+
+namespace SpoonEngine {
+    
+    // GL_TIMESTAMP queries (core since 3.3), one growing pool per in-flight frame
+    class OpenGLGPUProfiler : public GPUProfiler {
+    public:
+        OpenGLGPUProfiler();
+        virtual ~OpenGLGPUProfiler();
+        
+    protected:
+        void WriteTimestamp(uint32_t slot, uint32_t index) override;
+        bool ReadTimestamps(uint32_t slot, uint32_t count, uint64_t* nanoseconds) override;
+        
+    private:
+        std::vector<uint32_t> m_Queries[FrameLatency];
+    };
+    
+}
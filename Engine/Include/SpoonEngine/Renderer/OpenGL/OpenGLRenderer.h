@@ -2,19 +2,81 @@
 
 #include "SpoonEngine/Renderer/Renderer.h"
 
+#include <vector>
+
 namespace SpoonEngine {
     
+    struct OpenGLCapabilities {
+        int MajorVersion = 3;
+        int MinorVersion = 3;
+        
+        bool DrawIndirect = false;        // GL 4.0 / ARB_draw_indirect
+        bool MultiDrawIndirect = false;   // GL 4.3 / ARB_multi_draw_indirect
+        bool BaseInstance = false;        // GL 4.2 / ARB_base_instance
+        bool BufferStorage = false;       // GL 4.4 / ARB_buffer_storage
+        bool ProgramBinary = false;       // GL 4.1 / ARB_get_program_binary, with at least one format
+        bool ParallelShaderCompile = false; // KHR_parallel_shader_compile / ARB_parallel_shader_compile
+        
+        uint32_t UniformBufferOffsetAlignment = 256;
+    };
+    
     class OpenGLRenderer : public RendererBackend {
     public:
+        ~OpenGLRenderer() override;
+        
         void Initialize() override;
         void Shutdown() override;
+        void StartShaderCompiler(const std::function<void()>& makeCurrent, const std::function<void()>& releaseContext) override;
         
         void SetViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height) override;
         void SetClearColor(float r, float g, float b, float a) override;
         void Clear() override;
         
-        void DrawIndexed(uint32_t indexCount) override;
+        void SetDepthTest(DepthFunc func, bool depthWrite) override;
+        void SetColorWrite(bool enabled) override;
+        
+        void BeginSampleCount(SamplePass pass) override;
+        void EndSampleCount(SamplePass pass) override;
+        
+        void BeginFrame() override;
+        void EndFrame() override;
+        
+        void DrawIndexed(uint32_t indexCount, IndexType indexType) override;
+        void DrawIndexedBaseVertex(uint32_t indexCount, uint32_t firstIndex, int32_t baseVertex, IndexType indexType) override;
+        void DrawIndexedIndirect(const IndirectBuffer& commands, uint32_t drawCount, IndexType indexType) override;
         void Present() override;
+        
+        RendererStats GetStats() const override { return m_LastFrameStats; }
+        
+        static const OpenGLCapabilities& GetCapabilities() { return s_Capabilities; }
+        static bool IsExtensionSupported(const char* name);
+        
+        // Frames between issuing a GL_SAMPLES_PASSED query and reading it back
+        static constexpr uint32_t SampleQueryLatency = 4;
+    
+    private:
+        static constexpr uint32_t SamplePassCount = static_cast<uint32_t>(SamplePass::Count);
+        
+        struct SampleQuerySlot {
+            std::vector<uint32_t> Queries[SamplePassCount];
+            uint32_t Used[SamplePassCount] = {};
+            bool Pending = false;
+        };
+        
+        static void QueryCapabilities();
+        void ResolveSampleQueries(SampleQuerySlot& slot);
+        
+        static OpenGLCapabilities s_Capabilities;
+        
+        // Identity table (0, 1, 2, ...) fetched per instance so that a_DrawID == BaseInstance
+        uint32_t m_DrawIDBuffer = 0;
+        
+        RendererStats m_FrameStats;
+        RendererStats m_LastFrameStats;
+        
+        SampleQuerySlot m_SampleQueries[SampleQueryLatency];
+        uint64_t m_ResolvedSamples[SamplePassCount] = {};
+        uint64_t m_FrameIndex = 0;
     };
     
-}
\ No newline at end of file
+}
@@ -1,10 +1,15 @@
 #pragma once
 
 #include "SpoonEngine/Renderer/Shader.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 namespace SpoonEngine {
     
+    struct ShaderCompileJob;
+    
     class OpenGLShader : public Shader {
     public:
         OpenGLShader(const std::string& filepath);
@@ -21,6 +26,16 @@ namespace SpoonEngine {
         void SetFloat3(const std::string& name, const glm::vec3& value) override;
         void SetFloat4(const std::string& name, const glm::vec4& value) override;
         void SetMat4(const std::string& name, const glm::mat4& value) override;
+        void SetFloat4Array(const std::string& name, const glm::vec4* values, uint32_t count) override;
+        void SetMat4Array(const std::string& name, const glm::mat4* values, uint32_t count) override;
+        
+        uint32_t GetVertexInputMask() const override;
+        bool IsReady() const override { return m_Ready; }
+        void WaitUntilReady() override { EnsureReady(); }
+        
+        bool HasUniformBlock(const std::string& name) const override;
+        bool HasFragmentOutput(const std::string& name) const override;
+        void SetUniformBlockBinding(const std::string& name, uint32_t binding) override;
         
         const std::string& GetName() const override { return m_Name; }
         
@@ -30,23 +45,56 @@ namespace SpoonEngine {
         void UploadUniformFloat2(const std::string& name, const glm::vec2& value);
         void UploadUniformFloat3(const std::string& name, const glm::vec3& value);
         void UploadUniformFloat4(const std::string& name, const glm::vec4& value);
+        void UploadUniformFloat4Array(const std::string& name, const glm::vec4* values, uint32_t count);
         void UploadUniformMat3(const std::string& name, const glm::mat3& matrix);
         void UploadUniformMat4(const std::string& name, const glm::mat4& matrix);
+        void UploadUniformMat4Array(const std::string& name, const glm::mat4* matrices, uint32_t count);
         
+        // Finishes a compile the driver or the compile thread is done with; never waits
+        bool PollCompile();
+        
+        // Compiles and links on the calling thread's context; 0 on failure
+        static uint32_t LinkProgram(const std::unordered_map<uint32_t, std::string>& sources, bool retrievable);
+    
     private:
         std::string ReadFile(const std::string& filepath);
         std::unordered_map<uint32_t, std::string> PreProcess(const std::string& source);
         void CompileOrGetVulkanBinaries(const std::unordered_map<uint32_t, std::string>& shaderSources);
         void CompileOrGetOpenGLBinaries();
         void CreateProgram();
+        void CompleteProgram();
+        void FinishCompile();
+        void EnsureReady() const;
         void Reflect(uint32_t stage, const std::vector<uint32_t>& shaderData);
         
-        uint32_t m_RendererID;
+        // Issues compilation and linking without querying a status, so with parallel
+        // compilation the driver returns before the work is done
+        static uint32_t StartProgram(const std::unordered_map<uint32_t, std::string>& sources, bool retrievable, std::vector<uint32_t>& shaderIDs);
+        // Reports errors and releases the stages; the program, or 0 if it failed to link
+        static uint32_t FinishProgram(uint32_t program, std::vector<uint32_t>& shaderIDs);
+        
+        uint32_t m_RendererID = 0;
         std::string m_FilePath;
         std::string m_Name;
         
+        // Compile state; read by IsReady from other threads. FinishCompile holds the mutex so
+        // only one caller completes the program.
+        std::atomic<bool> m_Ready{ false };
+        std::mutex m_CompileMutex;
+        uint64_t m_SourceHash = 0;
+        bool m_StoreBinary = false;
+        std::vector<uint32_t> m_PendingShaders;
+        std::shared_ptr<ShaderCompileJob> m_Job;
+        
         std::unordered_map<uint32_t, std::vector<uint32_t>> m_VulkanSPIRV;
         std::unordered_map<uint32_t, std::string> m_OpenGLSourceCode;
+        
+        // Reflection recorded once at link time and published with m_Ready. Frame recording
+        // queries these from the main thread, so they must never touch GL or change afterwards.
+        uint32_t m_VertexInputMask = 0;
+        std::unordered_map<std::string, uint32_t> m_UniformBlocks;
+        
+        mutable std::unordered_map<std::string, int32_t> m_FragmentOutputCache;
     };
     
 }
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+namespace SpoonEngine {
+    
+    struct ShaderCacheStats {
+        uint32_t Hits = 0;
+        uint32_t Misses = 0;
+        uint32_t Rejected = 0;      // entries the driver no longer accepted, recompiled and replaced
+        uint32_t Stored = 0;
+    };
+    
+    // On-disk cache of linked programs (GL 4.1 / ARB_get_program_binary), one file per hash of
+    // the stage sources. The header records that hash and a hash of the GL vendor, renderer and
+    // version strings; an entry written by another driver, or one glProgramBinary fails to
+    // link, is deleted and replaced by the recompiled program.
+    class OpenGLShaderCache {
+    public:
+        static void SetEnabled(bool enabled) { s_Enabled = enabled; }
+        static bool IsEnabled();
+        
+        static void SetDirectory(const std::string& directory) { s_Directory = directory; }
+        static const std::string& GetDirectory() { return s_Directory; }
+        
+        // Sources as (stage, source) pairs in a fixed order
+        static uint64_t HashSources(const std::vector<std::pair<uint32_t, const std::string*>>& sources);
+        
+        // A linked program for the sources, or 0 when there is no usable entry
+        static uint32_t Load(uint64_t sourceHash);
+        // Writes the program's binary; it must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+        static void Store(uint64_t sourceHash, uint32_t program);
+        
+        // Load and Store may run on different threads (a compile finished on the render thread)
+        static ShaderCacheStats GetStats();
+    
+    private:
+        static uint64_t GetDriverHash();
+        static std::string GetEntryPath(uint64_t sourceHash);
+        static void CountEvent(uint32_t ShaderCacheStats::* counter);
+        
+        static bool s_Enabled;
+        static std::string s_Directory;
+        static ShaderCacheStats s_Stats;
+        static uint64_t s_DriverHash;
+        static std::mutex s_Mutex;      // guards s_Stats and s_DriverHash
+    };
+    
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace SpoonEngine {
+    
+    class OpenGLShader;
+    
+    enum class ShaderCompileMode {
+        Immediate,      // compiled and linked before the shader is returned
+        Parallel,       // KHR/ARB_parallel_shader_compile; the driver links on its own threads
+        Thread          // a compile thread whose context shares objects with the renderer's
+    };
+    
+    // Sources handed to the compile thread; Program belongs to the thread until Done is set
+    struct ShaderCompileJob {
+        std::unordered_map<uint32_t, std::string> Sources;
+        bool Retrievable = false;
+        
+        uint32_t Program = 0;       // 0 when a stage failed to compile or the program to link
+        std::atomic<bool> Done{ false };
+    };
+    
+    // Keeps shader compilation off the frame. Shaders still compiling are registered here and
+    // finished by Poll at the start of a frame, which never waits on the driver; until then
+    // Shader::IsReady() is false and materials draw with a placeholder.
+    class OpenGLShaderCompiler {
+    public:
+        // Enables driver-side parallel compilation when available
+        static void Initialize();
+        // Without parallel compilation, moves it to a thread using a context that shares objects
+        // with the renderer's; the callbacks make it current on, and release it from, that thread
+        static void StartThread(const std::function<void()>& makeCurrent, const std::function<void()>& releaseContext);
+        static void Shutdown();
+        
+        static ShaderCompileMode GetMode();
+        
+        static void Submit(const std::shared_ptr<ShaderCompileJob>& job);
+        // Blocks until the thread has run the job. Returns false for a job it had not started
+        // yet, which is withdrawn instead, so the caller can compile it on its own context.
+        static bool Wait(const std::shared_ptr<ShaderCompileJob>& job);
+        
+        static void AddPending(OpenGLShader* shader);
+        static void RemovePending(OpenGLShader* shader);
+        static void Poll();
+    };
+    
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "SpoonEngine/Renderer/StreamingBuffer.h"
+#include <vector>
+
+typedef struct __GLsync* GLsync;
+
+namespace SpoonEngine {
+    
+    // Persistent path (GL 4.4 / ARB_buffer_storage): one coherent mapping split into
+    // FramesInFlight regions, each guarded by a fence placed when its frame ends.
+    // Fallback path: a single frame-sized store orphaned every frame and written
+    // through unsynchronized range maps.
+    class OpenGLStreamingBuffer : public StreamingBuffer {
+    public:
+        OpenGLStreamingBuffer(StreamingBufferUsage usage, uint32_t frameCapacity);
+        virtual ~OpenGLStreamingBuffer();
+        
+        StreamingAllocation Allocate(uint32_t size) override;
+        void Commit(const StreamingAllocation& allocation) override;
+        
+        void Bind() const override;
+        void BindRange(uint32_t binding, const StreamingAllocation& allocation) const override;
+        
+        uint32_t GetFrameCapacity() const override { return m_FrameCapacity; }
+        bool IsPersistentlyMapped() const override { return m_MappedData != nullptr; }
+        
+        // Called by OpenGLRenderer once all of a frame's commands have been issued
+        static void EndFrameAll();
+        
+    private:
+        void EndFrame();
+        void WaitForRegion(uint32_t region);
+        
+        uint32_t m_RendererID = 0;
+        uint32_t m_Target;
+        uint32_t m_Alignment;
+        uint32_t m_FrameCapacity;
+        
+        uint8_t* m_MappedData = nullptr;
+        GLsync m_Fences[FramesInFlight] = {};
+        uint32_t m_Region = 0;
+        uint32_t m_Head = 0;
+        bool m_RegionReady = false;
+        bool m_ReportedExhaustion = false;
+        
+        static std::vector<OpenGLStreamingBuffer*> s_Instances;
+    };
+    
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <cstdint>
+
+namespace SpoonEngine {
+    
+    // Backend-agnostic list of deferred render work. Commands capture everything they
+    // need by value so they can run on another thread after the recording frame moved on.
+    class RenderCommandQueue {
+    public:
+        using Command = std::function<void()>;
+        
+        RenderCommandQueue();
+        
+        void Submit(Command command);
+        void Execute();
+        
+        uint32_t GetCommandCount() const { return static_cast<uint32_t>(m_Commands.size()); }
+        
+    private:
+        std::vector<Command> m_Commands;
+    };
+    
+}
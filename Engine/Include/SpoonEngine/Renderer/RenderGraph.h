@@ -0,0 +1,170 @@
+#pragma once
+
+#include "SpoonEngine/Renderer/Framebuffer.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace SpoonEngine {
+    
+    class Renderer;
+    class RenderGraph;
+    
+    // Handle of a render target within one frame's graph
+    using RenderGraphResource = uint32_t;
+    
+    // A virtual render target: one framebuffer with these attachments, only backed by
+    // memory between the first and the last pass that uses it
+    struct RenderGraphTargetDesc {
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        std::vector<FramebufferTextureFormat> Attachments;
+        uint32_t Samples = 1;
+        
+        bool operator==(const RenderGraphTargetDesc& other) const {
+            return Width == other.Width && Height == other.Height && IsCompatible(other);
+        }
+        
+        // Whether one framebuffer can back both, after a resize
+        bool IsCompatible(const RenderGraphTargetDesc& other) const {
+            return Attachments == other.Attachments && Samples == other.Samples;
+        }
+    };
+    
+    struct RenderGraphStats {
+        uint32_t Passes = 0;
+        uint32_t CulledPasses = 0;
+        uint32_t Targets = 0;               // transient targets used by the executed passes
+        uint32_t Framebuffers = 0;          // pooled framebuffers backing them this frame
+        uint32_t PooledFramebuffers = 0;    // held by the pool, idle ones included
+        uint32_t Allocations = 0;           // framebuffers created this frame
+        uint32_t Resizes = 0;               // pooled framebuffers handed to a target of another size
+        uint32_t Clears = 0;
+        uint32_t Binds = 0;
+    };
+    
+    // Declares what one pass reads and writes while it is added to the graph
+    class RenderGraphBuilder {
+    public:
+        // A transient target this pass writes first; it is cleared when the pass binds it
+        RenderGraphResource Create(const std::string& name, const RenderGraphTargetDesc& desc);
+        
+        // Sampled by this pass
+        RenderGraphResource Read(RenderGraphResource target);
+        
+        // Rendered to by this pass. A pass renders to at most one target, which the graph
+        // binds around it; passes without one render to whatever was bound before Execute.
+        RenderGraphResource Write(RenderGraphResource target);
+        
+        // Keeps the pass even when nothing reads its output, e.g. because it draws to the screen
+        void SetSideEffect();
+    
+    private:
+        friend class RenderGraph;
+        RenderGraphBuilder(RenderGraph& graph, uint32_t pass) : m_Graph(graph), m_Pass(pass) {}
+        
+        RenderGraph& m_Graph;
+        uint32_t m_Pass;
+    };
+    
+    // What a pass sees while it executes
+    class RenderGraphContext {
+    public:
+        Renderer* GetRenderer() const { return m_Renderer; }
+        
+        // The framebuffer backing a target; null when the backend could not create one
+        Framebuffer* GetFramebuffer(RenderGraphResource target) const;
+        std::shared_ptr<Texture2D> GetColorAttachment(RenderGraphResource target, uint32_t index = 0) const;
+        std::shared_ptr<Texture2D> GetDepthAttachment(RenderGraphResource target) const;
+    
+    private:
+        friend class RenderGraph;
+        RenderGraphContext(const RenderGraph& graph, Renderer* renderer) : m_Graph(graph), m_Renderer(renderer) {}
+        
+        const RenderGraph& m_Graph;
+        Renderer* m_Renderer;
+    };
+    
+    // Frame graph of render passes. Passes are added each frame with a setup callback that
+    // declares their targets and an execute callback that records their draws. Execute culls
+    // the passes whose output nobody reads, runs the rest in the order they were added (which
+    // is already a dependency order, since a pass can only name targets declared before it),
+    // and backs transient targets with pooled framebuffers: targets with the same attachments
+    // whose lifetimes do not overlap share one, and the pool carries over to the next frame.
+    // A pooled framebuffer taken by a target of another size is resized rather than replaced,
+    // so a target that follows a changing viewport keeps its framebuffer. Like any resized
+    // framebuffer it may then cover less than the target's size until the size settles;
+    // passes render and sample within GetRegion() of the framebuffer.
+    // Consecutive passes writing the same target keep it bound, and each transient target is
+    // cleared once, by its first writer.
+    class RenderGraph {
+    public:
+        using SetupFunction = std::function<void(RenderGraphBuilder&)>;
+        using ExecuteFunction = std::function<void(RenderGraphContext&)>;
+        
+        // setup runs immediately, execute from Execute when the pass survives culling
+        void AddPass(const std::string& name, const SetupFunction& setup, const ExecuteFunction& execute);
+        
+        // A framebuffer owned outside the graph; passes writing it are never culled and it is never cleared
+        RenderGraphResource Import(const std::string& name, std::shared_ptr<Framebuffer> framebuffer);
+        
+        // Runs this frame's passes and forgets them. Creates framebuffers, so call it where
+        // the backend may be used (inside a render command).
+        void Execute(Renderer* renderer);
+        
+        // Drops the declared passes without running them
+        void Reset();
+        
+        // Frees every pooled framebuffer
+        void ReleaseResources();
+        
+        const RenderGraphStats& GetStats() const { return m_Stats; }
+        
+        static constexpr RenderGraphResource InvalidResource = 0xffffffffu;
+        // Pooled framebuffers no pass used for this many executions are freed
+        static constexpr uint32_t MaxIdleFrames = 4;
+    
+    private:
+        friend class RenderGraphBuilder;
+        friend class RenderGraphContext;
+        
+        struct Pass {
+            std::string Name;
+            ExecuteFunction Execute;
+            std::vector<RenderGraphResource> Reads;
+            RenderGraphResource Write = InvalidResource;
+            bool SideEffect = false;
+            bool Culled = false;
+        };
+        
+        struct Target {
+            std::string Name;
+            RenderGraphTargetDesc Desc;
+            std::shared_ptr<Framebuffer> Imported;
+            uint32_t Readers = 0;
+            int32_t FirstUse = -1;
+            int32_t LastUse = -1;
+            int32_t Pooled = -1;
+            bool Cleared = false;
+        };
+        
+        struct PooledFramebuffer {
+            RenderGraphTargetDesc Desc;
+            std::shared_ptr<Framebuffer> Instance;
+            int32_t BusyUntil = -1;     // last pass of the current user this frame
+            uint32_t IdleFrames = 0;
+        };
+        
+        void CullPasses();
+        void AllocateTargets();
+        Framebuffer* GetFramebuffer(RenderGraphResource target) const;
+        
+        std::vector<Pass> m_Passes;
+        std::vector<Target> m_Targets;
+        std::vector<PooledFramebuffer> m_Pool;
+        RenderGraphStats m_Stats;
+    };
+    
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "SpoonEngine/Renderer/RenderCommandQueue.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace SpoonEngine {
+    
+    // Owns the graphics context on a dedicated thread and executes one recorded frame
+    // while the main thread records the next (double-buffered command queues).
+    class RenderThread {
+    public:
+        RenderThread();
+        ~RenderThread();
+        
+        // onStart/onStop run on the render thread, e.g. to acquire and release the context
+        void Start(std::function<void()> onStart, std::function<void()> onStop);
+        void Stop();
+        
+        // Main thread: appends to the frame being recorded
+        void Submit(RenderCommandQueue::Command command);
+        
+        // Main thread: waits for the previous frame to finish, then hands over the recorded one
+        void Kick();
+        
+        bool IsRunning() const { return m_Running; }
+        bool IsRenderThread() const { return std::this_thread::get_id() == m_ThreadID; }
+        
+        // Time the main thread spent blocked in the last Kick
+        float GetLastWaitTime() const { return m_LastWaitTime; }
+        // Execution time and size of the most recently completed frame
+        float GetLastSubmitTime() const;
+        uint32_t GetLastCommandCount() const;
+        
+    private:
+        void ThreadMain(std::function<void()> onStart, std::function<void()> onStop);
+        void WaitForIdle(std::unique_lock<std::mutex>& lock);
+        
+        std::thread m_Thread;
+        std::thread::id m_ThreadID;
+        
+        mutable std::mutex m_Mutex;
+        std::condition_variable m_Condition;
+        
+        RenderCommandQueue m_Queues[2];
+        uint32_t m_RecordIndex = 0;
+        
+        bool m_Running = false;
+        bool m_FramePending = false;
+        
+        float m_LastWaitTime = 0.0f;
+        float m_LastSubmitTime = 0.0f;
+        uint32_t m_LastCommandCount = 0;
+    };
+    
+}
@@ -1,17 +1,61 @@
 #pragma once
 
+#include "SpoonEngine/Renderer/RenderCommandQueue.h"
+#include "SpoonEngine/Renderer/Buffer.h"
+
 #include <memory>
 #include <string>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 
 namespace SpoonEngine {
     
+    class RenderThread;
+    
+    struct RenderFrameTimings {
+        float RecordTime = 0.0f;    // ms the main thread spent building the frame
+        float SubmitTime = 0.0f;    // ms spent executing render commands against the backend
+        float WaitTime = 0.0f;      // ms the main thread blocked on the render thread
+        uint32_t CommandCount = 0;
+    };
+    
     enum class RendererAPI {
         None = 0,
         OpenGL = 1,
         Vulkan = 2,
         DirectX11 = 3,
         DirectX12 = 4,
-        Metal = 5
+        Metal = 5,
+        Null = 6      // Headless: stub resources, counts work instead of drawing
+    };
+    
+    enum class DepthFunc {
+        Less = 0,
+        LessEqual,
+        Equal,
+        Always
+    };
+    
+    // Passes whose depth-tested samples can be counted into RendererStats
+    enum class SamplePass {
+        DepthPrePass = 0,
+        Shading,
+        Count
+    };
+    
+    // Per-frame counters. The null backend fills every field; GPU backends report
+    // what they can track cheaply (draw calls, triangles and sample counts).
+    struct RendererStats {
+        uint32_t DrawCalls = 0;
+        uint32_t StateChanges = 0;      // binds plus uniform and fixed-function state updates
+        uint64_t UploadedBytes = 0;
+        uint64_t Triangles = 0;
+        
+        // Samples that passed the depth test inside BeginSampleCount/EndSampleCount. GPU
+        // backends resolve these a few frames late, so they describe an earlier frame.
+        uint64_t PrePassSamples = 0;
+        uint64_t ShadedSamples = 0;
     };
     
     class RendererBackend {
@@ -21,13 +65,46 @@ namespace SpoonEngine {
         virtual void Initialize() = 0;
         virtual void Shutdown() = 0;
         
+        // Offers a context sharing objects with the main one for compiling shaders in the
+        // background; the callbacks make it current on, and release it from, the calling thread
+        virtual void StartShaderCompiler(const std::function<void()>& makeCurrent, const std::function<void()>& releaseContext) {}
+        
         virtual void SetViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height) = 0;
         virtual void SetClearColor(float r, float g, float b, float a) = 0;
         virtual void Clear() = 0;
         
-        virtual void DrawIndexed(uint32_t indexCount) = 0;
+        virtual void SetDepthTest(DepthFunc func, bool depthWrite) = 0;
+        virtual void SetColorWrite(bool enabled) = 0;
+        
+        // Counts samples passing the depth test between the calls; passes must not nest
+        virtual void BeginSampleCount(SamplePass pass) = 0;
+        virtual void EndSampleCount(SamplePass pass) = 0;
+        
+        // Bracket all GPU work of one frame; per-frame streaming storage is recycled at EndFrame
+        virtual void BeginFrame() = 0;
+        virtual void EndFrame() = 0;
+        
+        // indexType must match the index buffer of the bound vertex array
+        virtual void DrawIndexed(uint32_t indexCount, IndexType indexType) = 0;
+        
+        // Draws indexCount indices starting at firstIndex, adding baseVertex to each before
+        // the vertex fetch; sub-meshes of a shared buffer draw this way without rebinding
+        virtual void DrawIndexedBaseVertex(uint32_t indexCount, uint32_t firstIndex, int32_t baseVertex, IndexType indexType) = 0;
+        
+        // Submits drawCount commands from the buffer against the currently bound vertex array.
+        // Shaders receive the command's BaseInstance through the a_DrawID attribute.
+        virtual void DrawIndexedIndirect(const IndirectBuffer& commands, uint32_t drawCount, IndexType indexType) = 0;
+        
         virtual void Present() = 0;
         
+        // Counters of the last frame closed with EndFrame
+        virtual RendererStats GetStats() const = 0;
+        
+        // Vertex attribute slot reserved for the per-draw index on the indirect path
+        static constexpr uint32_t DrawIDAttributeLocation = 15;
+        // Upper bound on BaseInstance values the indirect path can translate into a_DrawID
+        static constexpr uint32_t MaxIndirectDrawID = 4096;
+        
         static RendererAPI GetAPI() { return s_API; }
         static void SetAPI(RendererAPI api) { s_API = api; }
         
@@ -43,17 +120,51 @@ namespace SpoonEngine {
         void Initialize();
         void Shutdown();
         
+        void StartShaderCompiler(const std::function<void()>& makeCurrent, const std::function<void()>& releaseContext);
+        
         void SetViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height);
         void SetClearColor(float r, float g, float b, float a);
         void Clear();
         
-        void DrawIndexed(uint32_t indexCount);
+        void SetDepthTest(DepthFunc func, bool depthWrite);
+        void SetColorWrite(bool enabled);
+        
+        void BeginSampleCount(SamplePass pass);
+        void EndSampleCount(SamplePass pass);
+        
+        void BeginFrame();
+        void EndFrame();
+        
+        // Index buffers are narrowed to 16 bits when their data allows; pass the bound buffer's GetIndexType()
+        void DrawIndexed(uint32_t indexCount, IndexType indexType);
+        void DrawIndexedBaseVertex(uint32_t indexCount, uint32_t firstIndex, int32_t baseVertex, IndexType indexType);
+        void DrawIndexedIndirect(const IndirectBuffer& commands, uint32_t drawCount, IndexType indexType);
         void Present();
         
+        // Runs the command immediately, or queues it for the render thread when one is attached.
+        // Commands issued from the render thread itself always run immediately.
+        void Submit(RenderCommandQueue::Command command);
+        
+        void SetRenderThread(RenderThread* renderThread) { m_RenderThread = renderThread; }
+        bool IsThreaded() const { return m_RenderThread != nullptr; }
+        
+        // Timings of the last frame closed with EndFrame. With a render thread the submit
+        // time belongs to the previous frame, as it executes while the next one is recorded.
+        const RenderFrameTimings& GetFrameTimings() const { return m_FrameTimings; }
+        
+        RendererStats GetStats() const;
+        
         static RendererAPI GetAPI() { return RendererBackend::GetAPI(); }
         
     private:
         std::unique_ptr<RendererBackend> m_Backend;
+        RenderThread* m_RenderThread = nullptr;
+        
+        RenderFrameTimings m_FrameTimings;
+        std::chrono::high_resolution_clock::time_point m_FrameStart;
+        float m_ImmediateSubmitTime = 0.0f;
+        uint32_t m_ImmediateCommandCount = 0;
+        uint32_t m_SubmitDepth = 0;
     };
     
 }
\ No newline at end of file
@@ -21,8 +21,29 @@ namespace SpoonEngine {
         virtual void SetFloat4(const std::string& name, const glm::vec4& value) = 0;
         virtual void SetMat4(const std::string& name, const glm::mat4& value) = 0;
         
+        // Uploads count elements of a uniform array in one call; name is the array without an index
+        virtual void SetFloat4Array(const std::string& name, const glm::vec4* values, uint32_t count) = 0;
+        virtual void SetMat4Array(const std::string& name, const glm::mat4* values, uint32_t count) = 0;
+        
+        // Bit N is set when the vertex stage reads attribute location N. This and HasUniformBlock
+        // read reflection taken at link time, so frame recording may call them without the
+        // context; both report nothing until IsReady.
+        virtual uint32_t GetVertexInputMask() const = 0;
+        
+        virtual bool HasUniformBlock(const std::string& name) const = 0;
+        virtual void SetUniformBlockBinding(const std::string& name, uint32_t binding) = 0;
+        
+        // Whether the fragment stage declares an active output variable of this name
+        virtual bool HasFragmentOutput(const std::string& name) const = 0;
+        
         virtual const std::string& GetName() const = 0;
         
+        // False while the program is still compiling in the background. Binding the shader
+        // before then waits for it; Material::Bind draws a placeholder instead.
+        virtual bool IsReady() const { return true; }
+        // Finishes a background compile now, on the calling thread, which must own the context
+        virtual void WaitUntilReady() {}
+        
         static std::shared_ptr<Shader> Create(const std::string& filepath);
         static std::shared_ptr<Shader> Create(const std::string& name, const std::string& vertexSrc, const std::string& fragmentSrc);
     };
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <memory>
+#include <cstdint>
+
+namespace SpoonEngine {
+    
+    enum class StreamingBufferUsage {
+        Vertex = 0,
+        Index,
+        Uniform
+    };
+    
+    // A write-only window into the current frame's region of a streaming buffer
+    struct StreamingAllocation {
+        void* Data = nullptr;
+        uint32_t Offset = 0;
+        uint32_t Size = 0;
+        
+        operator bool() const { return Data != nullptr; }
+    };
+    
+    // Ring of per-frame regions for data rewritten every frame (instance data, debug lines,
+    // sprites, per-frame uniforms). Allocations are only valid until the renderer ends the frame.
+    class StreamingBuffer {
+    public:
+        virtual ~StreamingBuffer() = default;
+        
+        // Returns an empty allocation when the frame's region is exhausted.
+        // Only one allocation may be outstanding; Commit it before allocating again.
+        virtual StreamingAllocation Allocate(uint32_t size) = 0;
+        virtual void Commit(const StreamingAllocation& allocation) = 0;
+        
+        virtual void Bind() const = 0;
+        // Uniform streams only: binds the allocation's range to an indexed binding point
+        virtual void BindRange(uint32_t binding, const StreamingAllocation& allocation) const = 0;
+        
+        virtual uint32_t GetFrameCapacity() const = 0;
+        virtual bool IsPersistentlyMapped() const = 0;
+        
+        static constexpr uint32_t FramesInFlight = 3;
+        
+        static std::shared_ptr<StreamingBuffer> Create(StreamingBufferUsage usage, uint32_t frameCapacity);
+    };
+    
+}
@@ -3,6 +3,8 @@
 #include "Core/Application.h"
 #include "Core/Window.h"
 #include "Core/Input.h"
+#include "Core/Profiler.h"
+#include "Core/JobSystem.h"
 
 #include "ECS/Entity.h"
 #include "ECS/Component.h"
@@ -15,20 +17,34 @@
 #include "Renderer/Framebuffer.h"
 #include "Renderer/Shader.h"
 #include "Renderer/Buffer.h"
+#include "Renderer/StreamingBuffer.h"
+#include "Renderer/RenderCommandQueue.h"
+#include "Renderer/RenderThread.h"
+#include "Renderer/GPUProfiler.h"
+#include "Renderer/OcclusionCuller.h"
+#include "Renderer/GeometryPool.h"
+#include "Renderer/RenderGraph.h"
+#include "Renderer/DynamicResolution.h"
 
 #include "Math/Vector2.h"
 #include "Math/Vector3.h"
 #include "Math/Vector4.h"
 #include "Math/Matrix4.h"
+#include "Math/BoundingBox.h"
+#include "Math/Quantization.h"
 
 #include "Assets/AssetManager.h"
 #include "Assets/Texture.h"
 #include "Assets/Mesh.h"
+#include "Assets/MeshOptimizer.h"
+#include "Assets/MeshSimplifier.h"
 #include "Assets/Model.h"
 #include "Assets/SceneSerializer.h"
 
 #include "Components/Transform.h"
 #include "Systems/RenderSystem.h"
+#include "Systems/ShadowSystem.h"
+#include "Systems/LightSystem.h"
 
 namespace SpoonEngine {
     extern Application* g_Application;
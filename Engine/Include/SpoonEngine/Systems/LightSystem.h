@@ -0,0 +1,103 @@
+#pragma once
+
+#include "SpoonEngine/ECS/System.h"
+#include "SpoonEngine/Components/Transform.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace SpoonEngine {
+    
+    // A LightComponent as seen this frame, world space
+    struct LightData {
+        EntityID Entity;
+        LightType Type = LightType::Point;
+        glm::vec3 Position{0.0f};
+        glm::vec3 Direction{0.0f, 0.0f, 1.0f};     // spot lights only
+        glm::vec3 Color{1.0f};                      // premultiplied by intensity
+        float Range = 10.0f;
+        float CosInner = 1.0f;
+        float CosOuter = 1.0f;
+        float OuterAngle = 0.0f;                    // degrees
+        bool CastShadows = false;
+        
+        // Argument to SampleLocalShadow from ShadowSystem::GetShadowSource, or -1 when the light
+        // has no shadow this frame
+        int32_t ShadowIndex = -1;
+    };
+    
+    // One frame of clustered lights in the std140 layouts of GetClusterSource, ready to upload
+    struct ClusterData {
+        std::vector<glm::vec4> Lights;      // 4 per light: position/range, color/shadow index, direction/cos outer, spot scale
+        std::vector<uint32_t> Cells;        // per cluster: first index | count << 16
+        std::vector<uint32_t> Indices;      // four 8-bit light indices per word
+        glm::vec2 DepthParams{0.0f};        // slice = log(viewDepth) * x + y
+        
+        // Sets u_ClusterDepthParams and the block bindings on the bound shader
+        void SetUniforms(class Shader& shader) const;
+    };
+    
+    struct ClusterStats {
+        uint32_t Lights = 0;
+        uint32_t DroppedLights = 0;         // visible lights past MaxClusterLights
+        uint32_t Indices = 0;
+        uint32_t DroppedIndices = 0;        // cluster entries past MaxClusterIndices
+        uint32_t MaxClusterLightCount = 0;  // longest list of a single cluster
+        uint32_t OccupiedClusters = 0;
+    };
+    
+    // Gathers the Transform + LightComponent entities whose range reaches into the camera
+    // frustum. Register it with that signature and attach it with RenderSystem::SetLightSystem,
+    // which collects the lights before shadows and draws are recorded.
+    class LightSystem : public System {
+    public:
+        void SetWorld(class World* world) { m_World = world; }
+        class World* GetWorld() const { return m_World; }
+        
+        void CollectLights(const class Camera& camera);
+        
+        // Splits the camera frustum into ClusterTilesX x ClusterTilesY screen tiles by
+        // ClusterSlices exponentially spaced depth slices and lists the lights touching each
+        // cluster, one job per slice. Call after the shadow system has set ShadowIndex.
+        void AssignClusters(const class Camera& camera);
+        
+        // This frame's visible lights; ShadowSystem fills in their ShadowIndex
+        std::vector<LightData>& GetLights() { return m_Lights; }
+        const std::vector<LightData>& GetLights() const { return m_Lights; }
+        
+        const ClusterData& GetClusterData() const { return m_Clusters; }
+        const ClusterStats& GetClusterStats() const { return m_ClusterStats; }
+        
+        uint32_t GetCulledCount() const { return m_Culled; }
+        
+        // Declares the cluster blocks, u_View, u_Projection and u_ClusterDepthParams plus
+        //   uint GetCluster(vec3 worldPos)
+        //   uvec2 GetClusterLightRange(uint cluster)        first index, count
+        //   int GetClusterLightIndex(uint i)
+        //   vec3 GetClusterLightRadiance(int light, vec3 worldPos, vec3 normal, out vec3 lightDir)
+        //   vec3 ComputeClusteredLighting(vec3 worldPos, vec3 normal, vec3 viewDir, float shininess)
+        // Insert after ShadowSystem::GetShadowSource, whose SampleLocalShadow it calls.
+        static const char* GetClusterSource();
+        
+        static constexpr uint32_t ClusterTilesX = 16;
+        static constexpr uint32_t ClusterTilesY = 9;
+        static constexpr uint32_t ClusterSlices = 24;
+        static constexpr uint32_t ClusterCount = ClusterTilesX * ClusterTilesY * ClusterSlices;
+        // Each block stays within the 16 KB GL minimum
+        static constexpr uint32_t MaxClusterLights = 256;
+        static constexpr uint32_t MaxClusterIndices = 16384;
+        static constexpr uint32_t ClusterLightsBinding = 1;
+        static constexpr uint32_t ClusterCellsBinding = 2;
+        static constexpr uint32_t ClusterIndicesBinding = 3;
+    
+    private:
+        class World* m_World = nullptr;
+        std::vector<LightData> m_Lights;
+        uint32_t m_Culled = 0;
+        
+        ClusterData m_Clusters;
+        ClusterStats m_ClusterStats;
+        // Per-cluster light lists; each job only touches the clusters of its own slices
+        std::vector<std::vector<uint8_t>> m_ClusterLists;
+    };
+    
+}
@@ -2,7 +2,19 @@
 
 #include "SpoonEngine/ECS/System.h"
 #include "SpoonEngine/Components/Transform.h"
+#include "SpoonEngine/Renderer/Buffer.h"
+#include "SpoonEngine/Renderer/OcclusionCuller.h"
+#include "SpoonEngine/Renderer/RenderGraph.h"
+#include "SpoonEngine/Renderer/DynamicResolution.h"
+#include "SpoonEngine/Systems/ShadowSystem.h"
+#include "SpoonEngine/Systems/LightSystem.h"
+#include <glm/glm.hpp>
 #include <memory>
+#include <vector>
+#include <map>
+#include <set>
+#include <tuple>
+#include <unordered_map>
 
 namespace SpoonEngine {
     
@@ -19,9 +31,259 @@ namespace SpoonEngine {
         void SetWorld(class World* world) { m_World = world; }
         class World* GetWorld() const { return m_World; }
         
+        // Static renderers whose shader declares the DrawTransforms block are submitted
+        // per (material, mesh, LOD) bucket through Renderer::DrawIndexedIndirect
+        void SetIndirectDrawing(bool enabled) { m_IndirectDrawing = enabled; }
+        bool IsIndirectDrawing() const { return m_IndirectDrawing; }
+        
+        // Matches `layout(std140) uniform DrawTransforms { mat4 u_Models[256]; };` (16 KB, the GL minimum block size)
+        static constexpr uint32_t MaxDrawTransforms = 256;
+        static constexpr uint32_t DrawTransformsBinding = 0;
+        // Per-frame budget for streamed draw transforms (4096 matrices)
+        static constexpr uint32_t DrawTransformsStreamSize = 4096 * sizeof(glm::mat4);
+        
+        // Lays down depth with a position-only program, then shades with an EQUAL depth test so
+        // every covered pixel runs the lit shader once. Lit vertex shaders must declare
+        // `invariant gl_Position;` and compute it exactly like the built-in ones:
+        // worldPos = vec3(u_Model * vec4(a_Position, 1.0)), then u_Projection * u_View * vec4(worldPos, 1.0).
+        // RendererStats::PrePassSamples / ShadedSamples is the overdraw the pre-pass removed;
+        // close to 1 means the extra geometry pass is not paying off for this scene.
+        void SetDepthPrePass(bool enabled) { m_DepthPrePass = enabled; }
+        bool IsDepthPrePass() const { return m_DepthPrePass; }
+        
+        // Frustum-culls every renderer and tests it against a CPU depth buffer of the
+        // MeshRenderer::Occluder meshes before any draw is recorded
+        void SetOcclusionCulling(bool enabled) { m_OcclusionCulling = enabled; }
+        bool IsOcclusionCulling() const { return m_OcclusionCulling; }
+        
+        const CullingStats& GetCullingStats() const { return m_CullingStats; }
+        
+        // Draws each renderer with the coarsest Mesh LOD whose simplification error, projected
+        // to the screen, stays under the threshold (a fraction of the viewport height; the
+        // default is about a pixel at 1080p). Moving to a coarser level additionally needs the
+        // error to drop below threshold * (1 - hysteresis), so objects hovering around a
+        // switch distance do not pop back and forth every frame.
+        void SetLODSelection(bool enabled) { m_LODSelection = enabled; }
+        bool IsLODSelection() const { return m_LODSelection; }
+        void SetLODErrorThreshold(float threshold) { m_LODErrorThreshold = threshold; }
+        float GetLODErrorThreshold() const { return m_LODErrorThreshold; }
+        void SetLODHysteresis(float hysteresis) { m_LODHysteresis = hysteresis; }
+        float GetLODHysteresis() const { return m_LODHysteresis; }
+        
+        // Renders the shadow system's cascades before each camera pass and hands them to every
+        // lit shader that includes ShadowSystem::GetShadowSource. Texture slot
+        // ShadowSystem::AtlasTextureSlot is reserved for the atlas while attached.
+        void SetShadowSystem(std::shared_ptr<ShadowSystem> shadows) { m_ShadowSystem = shadows; }
+        std::shared_ptr<ShadowSystem> GetShadowSystem() const { return m_ShadowSystem; }
+        
+        // Collects the visible lights each frame before shadows are recorded, so the shadow
+        // system can give shadowed point and spot lights tiles of its local atlas. Texture slot
+        // ShadowSystem::LocalAtlasTextureSlot is reserved while both are attached. The lights
+        // are then assigned to clusters and uploaded for shaders that include
+        // LightSystem::GetClusterSource; uniform buffer bindings 1-3 are reserved for them.
+        void SetLightSystem(std::shared_ptr<LightSystem> lights) { m_LightSystem = lights; }
+        std::shared_ptr<LightSystem> GetLightSystem() const { return m_LightSystem; }
+        
+        // Draws the renderers whose shader writes the outputs of GetGBufferSource once into a
+        // G-buffer (albedo + specular RGBA8, octahedral normal RG16, emissive + shininess
+        // RGBA16F, depth), then lights each covered pixel in one fullscreen pass: ambient, the
+        // directional light with the shadow system's cascades, and the lights of the pixel's
+        // cluster when a light system is attached. Other shaders are drawn forward afterwards,
+        // depth-tested against the G-buffer. Needs the size of the target being rendered to.
+        void SetDeferredShading(bool enabled) { m_DeferredShading = enabled; }
+        bool IsDeferredShading() const { return m_DeferredShading; }
+        void SetViewportSize(uint32_t width, uint32_t height) { m_ViewportWidth = width; m_ViewportHeight = height; }
+        
+        // Passes, transient targets and aliasing of the last deferred frame's render graph
+        const RenderGraphStats& GetRenderGraphStats() const { return m_RenderGraph.GetStats(); }
+        
+        // Renders the scene into an internal target at a fraction of the viewport size and
+        // upscales it onto the bound target in one sharpening pass; only color reaches the
+        // target, not depth. The internal target stays at the viewport size, so a new fraction
+        // only changes the viewport. The controller sets the fraction from the GPU time of the
+        // "RenderSystem::Scene" GPU profiler scope, so it needs SetViewportSize and the profiler.
+        void SetDynamicResolution(bool enabled) { m_DynamicResolution = enabled; }
+        bool IsDynamicResolution() const { return m_DynamicResolution; }
+        DynamicResolutionController& GetResolutionController() { return m_ResolutionController; }
+        // 0 upscales bilinearly; 1 is the strongest sharpening
+        void SetUpscaleSharpness(float sharpness) { m_UpscaleSharpness = sharpness; }
+        float GetUpscaleSharpness() const { return m_UpscaleSharpness; }
+        // Scale and size the last frame was rendered at
+        float GetRenderScale() const { return m_RenderScale; }
+        uint32_t GetRenderWidth() const { return m_RenderWidth; }
+        uint32_t GetRenderHeight() const { return m_RenderHeight; }
+        
+        // Lighting of the deferred pass; keep the direction equal to the shadow system's
+        void SetAmbientLight(const glm::vec3& color) { m_AmbientLight = color; }
+        void SetDirectionalLight(const glm::vec3& direction, const glm::vec3& color) { m_LightDirection = direction; m_LightColor = color; }
+        
+        // Declares the G-buffer outputs plus
+        //   void WriteGBuffer(vec3 albedo, vec3 normal, float specular, float shininess, vec3 emissive)
+        // Insert after #version in the fragment shader of deferred materials.
+        static const char* GetGBufferSource();
+        
+        // Compressed meshes store positions in a cube around the origin; folds the way back into the model matrix
+        static glm::mat4 GetMeshTransform(const class Mesh& mesh, const glm::mat4& model);
+        
+        // Draws one sub-mesh of the mesh, or all of them for -1, from its bound draw vertex array
+        static void DrawMesh(class Renderer* renderer, const class Mesh& mesh, uint32_t lod, int32_t subMesh);
+    
     private:
+        struct Candidate {
+            EntityID Entity;
+            glm::mat4 Transform;
+            bool Visible = true;    // cleared by CullCandidates
+        };
+        
+        struct DrawItem {
+            std::shared_ptr<class Material> Material;
+            // Resolved when recording; for materials, the active shader at that time
+            std::shared_ptr<class Shader> Shader;
+            std::shared_ptr<class Mesh> Mesh;
+            uint32_t LOD = 0;
+            int32_t SubMesh = -1;
+            bool ReceiveShadows = true;
+            glm::mat4 Transform;
+        };
+        
+        // Deferred frames draw the G-buffer shaders and the forward ones in separate passes
+        enum class DrawFilter {
+            All,
+            GBuffer,
+            Forward
+        };
+        
+        struct IndirectBatch {
+            std::shared_ptr<class Material> Material;
+            std::shared_ptr<class Shader> Shader;
+            std::shared_ptr<class Mesh> Mesh;
+            uint32_t LOD = 0;
+            int32_t SubMesh = -1;
+            bool ReceiveShadows = true;
+            std::vector<glm::mat4> Transforms;
+        };
+        
+        // Everything the GPU side of a frame needs, owned by the recorded render command so
+        // the ECS can move on while a render thread is still executing it
+        struct RenderFrame {
+            glm::mat4 View;
+            glm::mat4 Projection;
+            glm::vec3 CameraPosition;
+            bool DepthPrePass = false;
+            
+            bool DeferredShading = false;
+            uint32_t ViewportWidth = 0;
+            uint32_t ViewportHeight = 0;
+            
+            // Below the viewport size when the scene is rendered at a reduced resolution
+            bool DynamicResolution = false;
+            uint32_t RenderWidth = 0;
+            uint32_t RenderHeight = 0;
+            float UpscaleSharpness = 0.0f;
+            
+            glm::vec3 AmbientLight;
+            glm::vec3 LightDirection;
+            glm::vec3 LightColor;
+            
+            std::shared_ptr<ShadowSystem> Shadows;
+            ShadowCascadeData ShadowData;
+            LocalShadowData LocalShadows;
+            
+            bool ClusteredLighting = false;
+            ClusterData Clusters;
+            
+            std::vector<DrawItem> Draws;
+            std::vector<IndirectBatch> IndirectBatches;
+        };
+        
+        void CullCandidates(const glm::mat4& viewProjection);
+        uint32_t SelectLOD(EntityID entity, const class Mesh& mesh, const glm::mat4& transform, const RenderFrame& frame);
+        
+        void CheckVertexLayout(const class Shader& shader, const class Mesh& mesh);
+        
+        std::shared_ptr<class Material> GetFrameMaterial(const std::shared_ptr<class Material>& material, bool snapshot);
+        
+        void ExecuteFrame(const RenderFrame& frame, class Renderer* renderer);
+        void ExecuteScene(const RenderFrame& frame, class Renderer* renderer);
+        bool ExecuteDepthPrePass(const RenderFrame& frame, class Renderer* renderer);
+        void DrawItems(const RenderFrame& frame, class Renderer* renderer, DrawFilter filter);
+        void FlushIndirectBatches(const RenderFrame& frame, class Renderer* renderer, bool depthOnly, DrawFilter filter = DrawFilter::All);
+        static bool PassesFilter(const class Shader& shader, DrawFilter filter);
+        
+        // G-buffer pass and lighting pass through the render graph
+        void ExecuteDeferredFrame(const RenderFrame& frame, class Renderer* renderer);
+        bool CreateDeferredResources();
+        bool CreateFullscreenTriangle();
+        void ShadeGBuffer(const RenderFrame& frame, class Renderer* renderer, class Framebuffer& gbuffer);
+        
+        void UploadClusters(const RenderFrame& frame);
+        
+        // Internal target of dynamic resolution and the pass scaling it up to the output
+        void UpdateRenderScale();
+        bool CreateResolutionResources(const RenderFrame& frame);
+        void UpscaleScene(const RenderFrame& frame, class Renderer* renderer);
+        
+        // Shadow and cluster uniforms go to each program once per frame; u_ReceiveShadows per draw
+        void ApplyLighting(const RenderFrame& frame, class Shader& shader, bool receiveShadows);
+        
         std::shared_ptr<class Camera> m_Camera;
         class World* m_World = nullptr;
+        
+        bool m_IndirectDrawing = true;
+        std::map<std::tuple<class Material*, class Shader*, class Mesh*, uint32_t, int32_t, bool>, size_t> m_IndirectBatchLookup;
+        std::map<class Material*, std::shared_ptr<class Material>> m_MaterialSnapshots;
+        std::shared_ptr<class IndirectBuffer> m_IndirectCommands;
+        std::vector<DrawElementsIndirectCommand> m_IndirectCommandScratch;
+        std::shared_ptr<class StreamingBuffer> m_DrawTransformStream;
+        std::shared_ptr<class UniformBuffer> m_DrawTransforms;
+        
+        std::vector<Candidate> m_Candidates;
+        
+        bool m_OcclusionCulling = false;
+        std::unique_ptr<OcclusionCuller> m_OcclusionCuller;
+        std::vector<OcclusionCuller::Item> m_CullItems;
+        std::vector<CullResult> m_CullResults;
+        CullingStats m_CullingStats;
+        
+        bool m_LODSelection = true;
+        float m_LODErrorThreshold = 1.0f / 1080.0f;
+        float m_LODHysteresis = 0.25f;
+        std::unordered_map<EntityID, uint32_t> m_EntityLODs;
+        
+        std::set<std::pair<const class Shader*, const class Mesh*>> m_LayoutWarnings;
+        
+        bool m_DepthPrePass = false;
+        std::shared_ptr<class Shader> m_DepthShader;
+        std::shared_ptr<class Shader> m_DepthIndirectShader;
+        
+        bool m_DeferredShading = false;
+        uint32_t m_ViewportWidth = 0;
+        uint32_t m_ViewportHeight = 0;
+        glm::vec3 m_AmbientLight{0.1f};
+        glm::vec3 m_LightDirection{0.0f, -1.0f, 0.0f};
+        glm::vec3 m_LightColor{0.0f};
+        RenderGraph m_RenderGraph;
+        std::shared_ptr<class Shader> m_DeferredLightingShader;
+        std::shared_ptr<class VertexArray> m_FullscreenTriangle;
+        
+        bool m_DynamicResolution = false;
+        DynamicResolutionController m_ResolutionController;
+        float m_UpscaleSharpness = 0.25f;
+        float m_RenderScale = 1.0f;
+        uint32_t m_RenderWidth = 0;
+        uint32_t m_RenderHeight = 0;
+        std::shared_ptr<class Framebuffer> m_SceneTarget;
+        std::shared_ptr<class Shader> m_UpscaleShader;
+        
+        std::shared_ptr<ShadowSystem> m_ShadowSystem;
+        std::shared_ptr<LightSystem> m_LightSystem;
+        std::shared_ptr<class UniformBuffer> m_ClusterLights;
+        std::shared_ptr<class UniformBuffer> m_ClusterCells;
+        std::shared_ptr<class UniformBuffer> m_ClusterIndices;
+        // Render thread: whether this frame's atlas is bound, and programs already given the
+        // frame's lighting uniforms
+        bool m_ShadowAtlasBound = false;
+        std::vector<const class Shader*> m_LitShaders;
     };
     
     class CameraSystem : public System {
@@ -35,7 +297,7 @@ namespace SpoonEngine {
         class World* GetWorld() const { return m_World; }
         
         std::shared_ptr<class Camera> GetActiveCamera() const { return m_ActiveCamera; }
-        
+    
     private:
         void UpdateActiveCamera();
         
@@ -0,0 +1,292 @@
+#pragma once
+
+#include "SpoonEngine/ECS/System.h"
+#include "SpoonEngine/Math/BoundingBox.h"
+#include "SpoonEngine/Renderer/Framebuffer.h"
+#include "SpoonEngine/Components/Transform.h"
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+namespace SpoonEngine {
+    
+    struct MeshRenderer;
+    struct LightData;
+    
+    // Everything lit shaders need to sample the cascades, captured when the shadow pass is
+    // recorded so a render thread never reads the live system
+    struct ShadowCascadeData {
+        uint32_t CascadeCount = 0;
+        
+        // Sized for ShadowSystem::MaxCascades
+        glm::mat4 Matrices[4];          // world space to atlas texture coordinates and depth
+        glm::vec4 Rects[4];             // atlas tile of each cascade, inset by half a texel
+        glm::vec4 Splits{0.0f};         // far view depth of each cascade
+        glm::vec4 TexelSizes{0.0f};     // world size of one shadow texel per cascade
+        glm::vec3 LightDirection{0.0f, -1.0f, 0.0f};
+        
+        // Sets the uniforms declared by ShadowSystem::GetShadowSource on the bound shader; the
+        // atlas itself is bound once per frame with ShadowSystem::BindAtlas
+        void SetUniforms(class Shader& shader) const;
+    };
+    
+    // Shadows of point and spot lights, captured with ShadowCascadeData
+    struct LocalShadowData {
+        uint32_t ShadowCount = 0;
+        uint32_t TileCount = 0;
+        
+        // Sized for ShadowSystem::MaxLocalShadows and MaxLocalShadowTiles
+        glm::vec4 Shadows[32];          // light position, first tile
+        glm::vec4 Params[32];           // face count, world texel size per unit of distance from the light
+        glm::mat4 Matrices[64];         // world space to atlas texture coordinates and depth once divided by w
+        glm::vec4 Rects[64];            // atlas region of each tile, inset by half a texel
+        
+        void SetUniforms(class Shader& shader) const;
+    };
+    
+    struct ShadowStats {
+        uint32_t CascadesRendered = 0;
+        uint32_t CascadesRefit = 0;
+        uint32_t StaticCascadesRendered = 0;
+        uint32_t CastersTested = 0;
+        uint32_t StaticDraws = 0;
+        uint32_t DynamicDraws = 0;
+        
+        uint32_t LocalShadows = 0;          // lights sampling the local atlas this frame
+        uint32_t LocalFacesRendered = 0;
+        uint32_t LocalFacesPending = 0;     // out of date, waiting for update budget
+        uint32_t LocalDraws = 0;
+        float LocalAtlasUsage = 0.0f;
+    };
+    
+    // Cascaded shadow maps for one directional light, fitted to splits of the camera frustum.
+    // Each cascade covers a padded, texel-snapped sphere around its split and keeps it while the
+    // split stays inside, so its light matrix only changes when the camera leaves it. That keeps
+    // the depth of MeshRenderer::Static casters valid across frames: it is rendered into a
+    // per-cascade cache when a static caster inside the cascade moves or the cascade is refit,
+    // and copied into the atlas before the dynamic casters are drawn on top.
+    //
+    // Shadowed point and spot lights get square tiles of a second atlas instead, one per face
+    // (six for point lights), sized by how much of the screen the light's range covers. A face
+    // keeps its depth until the light or a caster within its range changes; out-of-date lights
+    // are re-rendered within a per-frame face budget, largest and longest-waiting first, so a
+    // scene full of shadowed lights costs about as much per frame as the few that change.
+    //
+    // Register it with a Transform + MeshRenderer signature like RenderSystem and attach it
+    // with RenderSystem::SetShadowSystem, which renders it before the camera pass.
+    class ShadowSystem : public System {
+    public:
+        ShadowSystem();
+        ~ShadowSystem();
+        
+        void SetWorld(class World* world) { m_World = world; }
+        class World* GetWorld() const { return m_World; }
+        
+        // Direction the light travels in, world space
+        void SetLightDirection(const glm::vec3& direction);
+        const glm::vec3& GetLightDirection() const { return m_LightDirection; }
+        
+        void SetCascadeCount(uint32_t count);
+        uint32_t GetCascadeCount() const { return m_CascadeCount; }
+        
+        // Square tile size of each cascade in the atlas
+        void SetResolution(uint32_t resolution);
+        uint32_t GetResolution() const { return m_Resolution; }
+        
+        // View depth the last cascade ends at, clamped to the camera's far plane
+        void SetShadowDistance(float distance) { m_ShadowDistance = distance; }
+        float GetShadowDistance() const { return m_ShadowDistance; }
+        
+        // Blend between uniform (0) and logarithmic (1) split distances
+        void SetSplitLambda(float lambda) { m_SplitLambda = lambda; }
+        float GetSplitLambda() const { return m_SplitLambda; }
+        
+        // Cascade i re-renders its dynamic casters every interval[i] frames; refits and static
+        // changes still update it immediately. Defaults to 1, 2, 4, 8.
+        void SetUpdateInterval(uint32_t cascade, uint32_t frames);
+        uint32_t GetUpdateInterval(uint32_t cascade) const { return m_Cascades[cascade].Interval; }
+        
+        // Without caching, static casters are redrawn with the dynamic ones on every update
+        void SetStaticCaching(bool enabled);
+        bool IsStaticCaching() const { return m_StaticCaching; }
+        
+        // Side of the square local light atlas
+        void SetLocalAtlasSize(uint32_t size);
+        uint32_t GetLocalAtlasSize() const { return m_LocalAtlasSize; }
+        
+        // Powers of two; a light covering the whole screen gets the maximum
+        void SetLocalTileSizes(uint32_t minimum, uint32_t maximum);
+        uint32_t GetMinLocalTileSize() const { return m_MinLocalTileSize; }
+        uint32_t GetMaxLocalTileSize() const { return m_MaxLocalTileSize; }
+        
+        // Local light faces re-rendered per frame at most; one light is always allowed
+        void SetLocalUpdateBudget(uint32_t faces) { m_LocalUpdateBudget = faces; }
+        uint32_t GetLocalUpdateBudget() const { return m_LocalUpdateBudget; }
+        
+        // Records and submits this frame's cascade and local light updates for the camera, and
+        // sets the ShadowIndex of each light that has a shadow this frame
+        void RenderShadows(class Renderer* renderer, const class Camera& camera, std::vector<LightData>* lights = nullptr);
+        
+        // Render thread: binds the atlas depth to AtlasTextureSlot (and the local light atlas to
+        // LocalAtlasTextureSlot) once the submitted passes have executed; false until the
+        // backend has created the cascade atlas
+        bool BindAtlas() const;
+        
+        const ShadowCascadeData& GetCascadeData() const { return m_Data; }
+        const LocalShadowData& GetLocalShadowData() const { return m_LocalData; }
+        const ShadowStats& GetStats() const { return m_Stats; }
+        
+        // Declares the shadow uniforms plus
+        //   float SampleCascadedShadow(vec3 worldPos, vec3 normal, float viewDepth)
+        //   float SampleLocalShadow(int shadowIndex, vec3 worldPos, vec3 normal)
+        // returning 0 when lit and 1 when fully shadowed, with
+        // viewDepth = -(u_View * vec4(worldPos, 1.0)).z and shadowIndex from LightData.
+        // Insert after #version in fragment shaders.
+        static const char* GetShadowSource();
+        
+        static constexpr uint32_t MaxCascades = 4;
+        static constexpr uint32_t AtlasTextureSlot = 15;
+        static constexpr uint32_t DefaultResolution = 1024;
+        
+        static constexpr uint32_t MaxLocalShadows = 32;
+        static constexpr uint32_t MaxLocalShadowTiles = 64;
+        static constexpr uint32_t LocalAtlasTextureSlot = 14;
+        static constexpr uint32_t DefaultLocalAtlasSize = 4096;
+    
+    private:
+        struct Cascade {
+            glm::mat4 ViewProjection{1.0f};
+            glm::vec3 Center{0.0f};
+            float Radius = 0.0f;
+            
+            bool Valid = false;
+            bool StaticDirty = true;
+            uint32_t Interval = 1;
+        };
+        
+        struct Caster {
+            EntityID Entity;
+            const MeshRenderer* Component;
+            glm::mat4 Transform;
+            BoundingBox Bounds;             // world space
+        };
+        
+        struct TrackedCaster {
+            glm::mat4 Transform;
+            BoundingBox Bounds;
+            const class Mesh* Mesh = nullptr;
+            bool Static = false;
+            uint64_t Seen = 0;
+        };
+        
+        struct CasterDraw {
+            std::shared_ptr<class Mesh> Mesh;
+            uint32_t LOD = 0;
+            int32_t SubMesh = -1;
+            glm::mat4 Transform;
+        };
+        
+        struct CascadePass {
+            uint32_t Cascade = 0;
+            glm::mat4 ViewProjection;
+            uint32_t X = 0, Y = 0;
+            bool RenderStatic = false;
+            std::vector<CasterDraw> StaticCasters;
+            std::vector<CasterDraw> DynamicCasters;
+        };
+        
+        // Light state the tiles were last rendered with; sampling uses it until the next update
+        struct LocalShadow {
+            LightType Type = LightType::Point;
+            glm::vec3 Position{0.0f};
+            glm::vec3 Direction{0.0f};
+            float Range = 0.0f;
+            float OuterAngle = 0.0f;
+            
+            uint32_t FaceCount = 0;
+            FramebufferTile Tiles[6];
+            glm::mat4 ViewProjections[6];
+            float TexelScale = 0.0f;        // world texel size per unit of distance
+            
+            bool Rendered = false;          // every tile holds depth for the state above
+            bool Dirty = true;
+            uint32_t Waiting = 0;           // frames spent out of date
+            float Coverage = 0.0f;
+            uint64_t Seen = 0;
+        };
+        
+        struct LocalPass {
+            glm::mat4 ViewProjection;
+            FramebufferTile Tile;
+            std::vector<CasterDraw> Casters;
+        };
+        
+        struct ShadowFrame {
+            uint32_t Resolution = 0;
+            uint32_t CascadeCount = 0;
+            std::vector<CascadePass> Passes;
+            
+            uint32_t LocalAtlasSize = 0;
+            std::vector<LocalPass> LocalPasses;
+        };
+        
+        void InvalidateCascades();
+        bool FitCascade(uint32_t index, const glm::vec3* corners);
+        bool Overlaps(const Cascade& cascade, const BoundingBox& bounds) const;
+        void TrackCasters();
+        void InvalidateStatic(const BoundingBox& bounds);
+        uint32_t SelectLOD(const class Mesh& mesh, const glm::mat4& transform, float texelSize) const;
+        
+        void UpdateLocalShadows(const class Camera& camera, std::vector<LightData>& lights, ShadowFrame& frame);
+        bool AllocateLocalTiles(LocalShadow& shadow, uint32_t faceCount, uint32_t size);
+        void FreeLocalTiles(LocalShadow& shadow);
+        void RecordLocalShadow(LocalShadow& shadow, const LightData& light, ShadowFrame& frame);
+        
+        // Render thread
+        void CreateAtlas(uint32_t resolution, uint32_t cascadeCount);
+        void ExecuteShadows(const ShadowFrame& frame, class Renderer* renderer);
+        void ExecuteCascades(const ShadowFrame& frame, class Renderer* renderer);
+        void ExecuteLocalShadows(const ShadowFrame& frame, class Renderer* renderer);
+        void DrawCasters(const std::vector<CasterDraw>& casters, class Renderer* renderer);
+        
+        class World* m_World = nullptr;
+        
+        glm::vec3 m_LightDirection = glm::normalize(glm::vec3(-0.4f, -1.0f, -0.3f));
+        uint32_t m_CascadeCount = MaxCascades;
+        uint32_t m_Resolution = DefaultResolution;
+        float m_ShadowDistance = 100.0f;
+        float m_SplitLambda = 0.75f;
+        bool m_StaticCaching = true;
+        
+        // Fitted spheres are grown by this factor so small camera moves stay inside them
+        float m_Padding = 1.25f;
+        // Casters this far towards the light from a cascade's sphere still reach its depth range
+        float m_CasterPullback = 50.0f;
+        
+        Cascade m_Cascades[MaxCascades];
+        std::vector<Caster> m_Casters;
+        std::unordered_map<EntityID, TrackedCaster> m_TrackedCasters;
+        // World bounds casters left or entered this frame
+        std::vector<BoundingBox> m_ChangedBounds;
+        uint64_t m_FrameIndex = 0;
+        
+        uint32_t m_LocalAtlasSize = DefaultLocalAtlasSize;
+        uint32_t m_MinLocalTileSize = 64;
+        uint32_t m_MaxLocalTileSize = 1024;
+        uint32_t m_LocalUpdateBudget = 12;
+        FramebufferTileAllocator m_LocalTiles;
+        std::unordered_map<EntityID, LocalShadow> m_LocalShadows;
+        
+        // Owned by whichever thread executes render commands
+        std::shared_ptr<class Framebuffer> m_Atlas;
+        std::vector<std::shared_ptr<class Framebuffer>> m_StaticDepth;
+        std::shared_ptr<class Framebuffer> m_LocalAtlas;
+        std::shared_ptr<class Shader> m_DepthShader;
+        
+        ShadowCascadeData m_Data;
+        LocalShadowData m_LocalData;
+        ShadowStats m_Stats;
+    };
+    
+}
@@ -1,9 +1,35 @@
 #include "SpoonEngine/Assets/Mesh.h"
-#include "SpoonEngine/Renderer/OpenGL/OpenGLBuffer.h"
+#include "SpoonEngine/Assets/MeshSimplifier.h"
+#include "SpoonEngine/Assets/MeshOptimizer.h"
+#include "SpoonEngine/Renderer/GeometryPool.h"
+#include "SpoonEngine/Core/Profiler.h"
+#include "SpoonEngine/Math/Quantization.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 namespace SpoonEngine {
     
+    static const char* s_VertexDecodeSource = R"(
+        uniform bool u_CompressedVertices;
+        
+        vec3 DecodeOctahedral(vec2 e) {
+            vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+            if (v.z < 0.0) {
+                v.xy = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+            }
+            return normalize(v);
+        }
+        
+        vec3 DecodeNormal(vec4 normal) {
+            return u_CompressedVertices ? DecodeOctahedral(normal.xy) : normal.xyz;
+        }
+        
+        vec3 DecodeTangent(vec4 tangent) {
+            return u_CompressedVertices ? DecodeOctahedral(tangent.xy) : tangent.xyz;
+        }
+    )";
+    
     Mesh::Mesh(AssetID id, const std::string& path)
         : Asset(id, path) {
     }
@@ -17,56 +43,456 @@ namespace SpoonEngine {
     
     void Mesh::SetVertices(const std::vector<Vertex>& vertices) {
         m_Vertices = vertices;
+        UpdateBounds();
+        
+        m_LODs.clear();
         UploadToGPU();
     }
     
     void Mesh::SetIndices(const std::vector<uint32_t>& indices) {
         m_Indices = indices;
+        m_LODs.clear();
         UploadToGPU();
     }
     
+    void Mesh::SetVertexLayout(const VertexLayout& layout) {
+        m_Layout = layout;
+        if (!m_Vertices.empty()) {
+            UploadToGPU();
+        }
+    }
+    
+    uint32_t Mesh::GetVertexInputMask() const {
+        uint32_t mask = static_cast<uint32_t>(m_Layout.Attributes | VertexAttribute::Position);
+        if (m_Layout.Format == VertexFormat::Compressed) {
+            mask &= ~static_cast<uint32_t>(VertexAttribute::Bitangent);
+        }
+        return mask;
+    }
+    
+    const char* Mesh::GetVertexDecodeSource() {
+        return s_VertexDecodeSource;
+    }
+    
     void Mesh::SetSubMeshes(const std::vector<SubMesh>& subMeshes) {
         m_SubMeshes = subMeshes;
+        m_LODs.clear();
+    }
+    
+    void Mesh::SetGeometry(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                           const std::vector<SubMesh>& subMeshes, uint32_t lodCount) {
+        m_Vertices = vertices;
+        m_Indices = indices;
+        m_SubMeshes = subMeshes;
+        UpdateBounds();
+        
+        // LODs go up with everything else, in the same buffers or pool allocation
+        m_LODs.clear();
+        if (lodCount > 1) {
+            BuildLODs(lodCount, 0.5f, 0.05f);
+        }
+        UploadToGPU();
+    }
+    
+    SubMesh Mesh::GetSubMesh(uint32_t index, uint32_t lod) const {
+        if (lod > 0) {
+            return m_LODs[lod - 1].SubMeshes[index];
+        }
+        if (m_SubMeshes.empty()) {
+            return { 0, 0, static_cast<uint32_t>(m_Indices.size()), 0 };
+        }
+        return m_SubMeshes[index];
+    }
+    
+    void Mesh::GenerateLODs(uint32_t lodCount, float reduction, float maxError) {
+        BuildLODs(lodCount, reduction, maxError);
+        
+        // Pooled LOD index ranges live in the mesh's own allocation, which has to grow
+        if (m_Allocation) {
+            if (!m_LODs.empty()) {
+                UploadToGPU();
+            }
+        } else {
+            for (auto& lod : m_LODs) {
+                UploadLOD(lod);
+            }
+        }
+    }
+    
+    void Mesh::BuildLODs(uint32_t lodCount, float reduction, float maxError) {
+        SPOON_PROFILE_FUNCTION();
+        
+        m_LODs.clear();
+        if (m_Indices.empty() || m_Vertices.empty()) return;
+        
+        // The simplifier sees one mesh with absolute indices. Sub-meshes share no vertices and a
+        // collapse only moves a vertex onto a neighbour, so triangles never change sub-mesh.
+        uint32_t subMeshCount = GetSubMeshCount();
+        std::vector<uint32_t> indices(m_Indices.size());
+        std::vector<uint32_t> vertexSubMesh(m_Vertices.size(), 0);
+        for (uint32_t s = 0; s < subMeshCount; s++) {
+            SubMesh subMesh = GetSubMesh(s);
+            for (uint32_t i = subMesh.BaseIndex; i < subMesh.BaseIndex + subMesh.IndexCount; i++) {
+                indices[i] = m_Indices[i] + subMesh.BaseVertex;
+                vertexSubMesh[indices[i]] = s;
+            }
+        }
+        
+        // Every level simplifies the full mesh so its error is measured against the original surface
+        size_t previousCount = m_Indices.size();
+        std::vector<std::vector<uint32_t>> buckets(subMeshCount);
+        for (uint32_t level = 1; level < lodCount; level++) {
+            size_t target = static_cast<size_t>(previousCount * reduction) / 3 * 3;
+            if (target < 3) break;
+            
+            LOD lod;
+            std::vector<uint32_t> simplified = MeshSimplifier::Simplify(m_Vertices, indices, target, maxError, &lod.Error);
+            
+            // Not worth a level unless it saves at least a tenth of the previous one
+            if (simplified.empty() || simplified.size() * 10 > previousCount * 9) break;
+            previousCount = simplified.size();
+            
+            for (auto& bucket : buckets) {
+                bucket.clear();
+            }
+            for (size_t i = 0; i + 2 < simplified.size(); i += 3) {
+                auto& bucket = buckets[vertexSubMesh[simplified[i]]];
+                bucket.insert(bucket.end(), simplified.begin() + i, simplified.begin() + i + 3);
+            }
+            
+            // Back to sub-mesh relative indices, one range per sub-mesh even when it simplified away
+            lod.Indices.reserve(simplified.size());
+            for (uint32_t s = 0; s < subMeshCount; s++) {
+                SubMesh subMesh = GetSubMesh(s);
+                auto& bucket = buckets[s];
+                
+                uint32_t vertexCount = 0;
+                for (uint32_t& index : bucket) {
+                    index -= subMesh.BaseVertex;
+                    vertexCount = std::max(vertexCount, index + 1);
+                }
+                MeshOptimizer::OptimizeVertexCache(bucket, vertexCount);
+                
+                lod.SubMeshes.push_back({ subMesh.BaseVertex, static_cast<uint32_t>(lod.Indices.size()),
+                                          static_cast<uint32_t>(bucket.size()), subMesh.MaterialIndex });
+                lod.Indices.insert(lod.Indices.end(), bucket.begin(), bucket.end());
+            }
+            
+            m_LODs.push_back(std::move(lod));
+        }
     }
     
-    void Mesh::Bind() const {
-        if (m_VertexArray) {
-            m_VertexArray->Bind();
+    void Mesh::SetGeometryPooling(bool enabled) {
+        m_GeometryPooling = enabled;
+        if (!m_Vertices.empty()) {
+            UploadToGPU();
+        }
+    }
+    
+    const std::shared_ptr<VertexArray>& Mesh::GetDrawVertexArray(uint32_t lod) const {
+        if (m_Allocation) {
+            return m_Allocation->GetVertexArray();
+        }
+        if (lod > 0 && m_LODs[lod - 1].Array) {
+            return m_LODs[lod - 1].Array;
+        }
+        return m_VertexArray;
+    }
+    
+    const std::shared_ptr<VertexArray>& Mesh::GetDrawPositionVertexArray(uint32_t lod) const {
+        // The interleaved layout also starts with a_Position, so it works as a fallback
+        if (m_Allocation) {
+            if (m_Allocation->GetStreamVertexArray()) {
+                return m_Allocation->GetStreamVertexArray();
+            }
+        } else if (lod > 0 && m_LODs[lod - 1].PositionArray) {
+            return m_LODs[lod - 1].PositionArray;
+        } else if (lod == 0 && m_PositionVertexArray) {
+            return m_PositionVertexArray;
+        }
+        return GetDrawVertexArray(lod);
+    }
+    
+    SubMesh Mesh::GetDrawRange(uint32_t index, uint32_t lod) const {
+        SubMesh range = GetSubMesh(index, lod);
+        if (m_Allocation) {
+            range.BaseVertex += m_Allocation->GetVertexOffset();
+            range.BaseIndex += m_Allocation->GetIndexOffset() + (lod > 0 ? m_LODs[lod - 1].PoolIndexOffset : 0);
+        }
+        return range;
+    }
+    
+    void Mesh::Bind(uint32_t lod) const {
+        if (const auto& vertexArray = GetDrawVertexArray(lod)) {
+            vertexArray->Bind();
         }
     }
     
     void Mesh::Unbind() const {
-        if (m_VertexArray) {
-            m_VertexArray->Unbind();
+        if (const auto& vertexArray = GetDrawVertexArray(0)) {
+            vertexArray->Unbind();
+        }
+    }
+    
+    IndexType Mesh::GetIndexType(uint32_t lod) const {
+        if (m_Allocation) {
+            return m_Allocation->GetIndexType();
+        }
+        
+        const auto& buffer = lod == 0 ? m_IndexBuffer : m_LODs[lod - 1].Buffer;
+        return buffer ? buffer->GetIndexType() : IndexType::UInt32;
+    }
+    
+    void Mesh::BindPositions(uint32_t lod) const {
+        if (const auto& vertexArray = GetDrawPositionVertexArray(lod)) {
+            vertexArray->Bind();
+        }
+    }
+    
+    void Mesh::UnbindPositions() const {
+        if (const auto& vertexArray = GetDrawPositionVertexArray(0)) {
+            vertexArray->Unbind();
+        }
+    }
+    
+    void Mesh::UpdateBounds() {
+        m_Bounds = BoundingBox();
+        for (const auto& vertex : m_Vertices) {
+            m_Bounds.Expand(vertex.Position);
         }
     }
     
     void Mesh::UploadToGPU() {
-        m_VertexArray = std::make_unique<OpenGLVertexArray>();
+        m_VertexArray.reset();
+        m_VertexBuffer.reset();
+        m_IndexBuffer.reset();
+        m_PositionBuffer.reset();
+        m_PositionVertexArray.reset();
+        m_Allocation.reset();
+        m_VertexStride = 0;
+        
+        UpdateQuantization();
+        
+        std::vector<BufferLayout> streams = BuildStreamLayouts();
+        for (const auto& layout : streams) {
+            m_VertexStride += layout.GetStride();
+        }
+        
+        if (m_GeometryPooling && UploadToPool(streams)) {
+            m_IsLoaded = true;
+            return;
+        }
+        
+        m_VertexArray = VertexArray::Create();
+        if (!m_VertexArray) return;
         
         if (!m_Vertices.empty()) {
-            m_VertexBuffer = VertexBuffer::Create(reinterpret_cast<float*>(m_Vertices.data()), 
-                                                 static_cast<uint32_t>(m_Vertices.size() * sizeof(Vertex)));
+            bool split = m_Layout.Streams == VertexStreams::SplitPosition;
             
-            BufferLayout layout = {
-                { ShaderDataType::Float3, "a_Position" },
-                { ShaderDataType::Float3, "a_Normal" },
-                { ShaderDataType::Float2, "a_TexCoord" },
-                { ShaderDataType::Float3, "a_Tangent" },
-                { ShaderDataType::Float3, "a_Bitangent" }
-            };
-            m_VertexBuffer->SetLayout(layout);
-            m_VertexArray->AddVertexBuffer(m_VertexBuffer);
+            for (size_t s = 0; s < streams.size(); s++) {
+                std::vector<uint8_t> data = BuildStreamData(streams[s]);
+                
+                auto buffer = VertexBuffer::Create(reinterpret_cast<float*>(data.data()), static_cast<uint32_t>(data.size()));
+                buffer->SetLayout(streams[s]);
+                m_VertexArray->AddVertexBuffer(buffer);
+                
+                if (split && s == 0) {
+                    m_PositionBuffer = buffer;
+                    
+                    // Depth-only passes bind just this stream
+                    m_PositionVertexArray = VertexArray::Create();
+                    m_PositionVertexArray->AddVertexBuffer(m_PositionBuffer);
+                } else {
+                    m_VertexBuffer = buffer;
+                }
+            }
         }
         
         if (!m_Indices.empty()) {
             m_IndexBuffer = IndexBuffer::Create(m_Indices.data(), static_cast<uint32_t>(m_Indices.size()));
             m_VertexArray->SetIndexBuffer(m_IndexBuffer);
+            
+            if (m_PositionVertexArray) {
+                m_PositionVertexArray->SetIndexBuffer(m_IndexBuffer);
+            }
+        }
+        
+        for (auto& lod : m_LODs) {
+            UploadLOD(lod);
         }
         
         m_IsLoaded = true;
     }
     
+    bool Mesh::UploadToPool(const std::vector<BufferLayout>& streams) {
+        if (m_Vertices.empty() || m_Indices.empty() || streams.empty()) return false;
+        
+        // Indices are relative to each sub-mesh's BaseVertex, so most meshes fit a 16-bit pool
+        uint32_t maxIndex = *std::max_element(m_Indices.begin(), m_Indices.end());
+        
+        GeometryPoolFormat format;
+        format.Streams = streams;
+        format.Indices = maxIndex <= 0xffffu ? IndexType::UInt16 : IndexType::UInt32;
+        
+        // LOD index ranges follow LOD 0 inside the same allocation
+        uint32_t indexCount = static_cast<uint32_t>(m_Indices.size());
+        for (auto& lod : m_LODs) {
+            lod.PoolIndexOffset = indexCount;
+            indexCount += static_cast<uint32_t>(lod.Indices.size());
+        }
+        
+        m_Allocation = GeometryPool::Get(format)->Allocate(static_cast<uint32_t>(m_Vertices.size()), indexCount);
+        if (!m_Allocation) return false;
+        
+        for (size_t s = 0; s < streams.size(); s++) {
+            std::vector<uint8_t> data = BuildStreamData(streams[s]);
+            m_Allocation->SetVertexData(static_cast<uint32_t>(s), data.data());
+        }
+        
+        m_Allocation->SetIndexData(m_Indices.data(), static_cast<uint32_t>(m_Indices.size()));
+        for (auto& lod : m_LODs) {
+            m_Allocation->SetIndexData(lod.Indices.data(), static_cast<uint32_t>(lod.Indices.size()), lod.PoolIndexOffset);
+            
+            lod.Buffer.reset();
+            lod.Array.reset();
+            lod.PositionArray.reset();
+        }
+        return true;
+    }
+    
+    void Mesh::UpdateQuantization() {
+        m_QuantizationOffset = Vector3::Zero();
+        m_QuantizationScale = 1.0f;
+        if (m_Layout.Format != VertexFormat::Compressed) return;
+        
+        // One uniform scale keeps the dequantization a similarity transform, so shaders that
+        // derive the normal matrix from u_Model and renormalize stay correct
+        Vector3 size = m_Bounds.GetSize();
+        m_QuantizationOffset = m_Bounds.GetCenter();
+        m_QuantizationScale = std::max(size.x, std::max(size.y, size.z)) * 0.5f;
+        if (m_QuantizationScale <= 0.0f) m_QuantizationScale = 1.0f;
+    }
+    
+    std::vector<BufferLayout> Mesh::BuildStreamLayouts() const {
+        // Position is always uploaded; depth passes and the culling bounds rely on it
+        uint32_t attributes = static_cast<uint32_t>(m_Layout.Attributes | VertexAttribute::Position);
+        
+        std::vector<BufferLayout> streams;
+        if (m_Layout.Streams == VertexStreams::SplitPosition) {
+            streams.push_back(BuildStreamLayout(VertexAttribute::Position));
+            attributes &= ~static_cast<uint32_t>(VertexAttribute::Position);
+        }
+        
+        BufferLayout layout = BuildStreamLayout(static_cast<VertexAttribute>(attributes));
+        if (!layout.GetElements().empty()) {
+            streams.push_back(layout);
+        }
+        return streams;
+    }
+    
+    BufferLayout Mesh::BuildStreamLayout(VertexAttribute attributes) const {
+        static const char* names[] = { "a_Position", "a_Normal", "a_TexCoord", "a_Tangent", "a_Bitangent" };
+        static const ShaderDataType standardTypes[] = {
+            ShaderDataType::Float3, ShaderDataType::Float3, ShaderDataType::Float2, ShaderDataType::Float3, ShaderDataType::Float3
+        };
+        static const ShaderDataType compressedTypes[] = {
+            ShaderDataType::Short4N, ShaderDataType::Short2N, ShaderDataType::Half2, ShaderDataType::Short2N, ShaderDataType::None
+        };
+        
+        bool compressed = m_Layout.Format == VertexFormat::Compressed;
+        
+        std::vector<BufferElement> elements;
+        for (uint32_t location = 0; location < 5; location++) {
+            if (!HasAttribute(attributes, static_cast<VertexAttribute>(1u << location))) continue;
+            
+            ShaderDataType type = compressed ? compressedTypes[location] : standardTypes[location];
+            if (type == ShaderDataType::None) continue;
+            
+            elements.emplace_back(location, type, names[location]);
+        }
+        return BufferLayout(elements);
+    }
+    
+    std::vector<uint8_t> Mesh::BuildStreamData(const BufferLayout& layout) const {
+        uint32_t stride = layout.GetStride();
+        std::vector<uint8_t> data(static_cast<size_t>(stride) * m_Vertices.size());
+        
+        bool compressed = m_Layout.Format == VertexFormat::Compressed;
+        float invScale = 1.0f / m_QuantizationScale;
+        
+        for (size_t i = 0; i < m_Vertices.size(); i++) {
+            const Vertex& vertex = m_Vertices[i];
+            
+            for (const auto& element : layout) {
+                uint8_t* destination = &data[i * stride + element.Offset];
+                
+                if (!compressed) {
+                    const void* source = nullptr;
+                    switch (element.Location) {
+                        case 0: source = &vertex.Position; break;
+                        case 1: source = &vertex.Normal; break;
+                        case 2: source = &vertex.TexCoords; break;
+                        case 3: source = &vertex.Tangent; break;
+                        case 4: source = &vertex.Bitangent; break;
+                    }
+                    memcpy(destination, source, element.Size);
+                    continue;
+                }
+                
+                int16_t packed[4] = {};
+                switch (element.Location) {
+                    case 0: {
+                        Vector3 local = (vertex.Position - m_QuantizationOffset) * invScale;
+                        
+                        // Handedness of the tangent frame, so the shader can rebuild the bitangent
+                        float handedness = vertex.Normal.Cross(vertex.Tangent).Dot(vertex.Bitangent) < 0.0f ? -1.0f : 1.0f;
+                        
+                        packed[0] = QuantizeSnorm16(local.x);
+                        packed[1] = QuantizeSnorm16(local.y);
+                        packed[2] = QuantizeSnorm16(local.z);
+                        packed[3] = QuantizeSnorm16(handedness);
+                        break;
+                    }
+                    case 1:
+                    case 3: {
+                        Vector2 octahedral = OctahedralEncode(element.Location == 1 ? vertex.Normal : vertex.Tangent);
+                        packed[0] = QuantizeSnorm16(octahedral.x);
+                        packed[1] = QuantizeSnorm16(octahedral.y);
+                        break;
+                    }
+                    case 2: {
+                        packed[0] = static_cast<int16_t>(FloatToHalf(vertex.TexCoords.x));
+                        packed[1] = static_cast<int16_t>(FloatToHalf(vertex.TexCoords.y));
+                        break;
+                    }
+                }
+                memcpy(destination, packed, element.Size);
+            }
+        }
+        return data;
+    }
+    
+    void Mesh::UploadLOD(LOD& lod) {
+        lod.Array = VertexArray::Create();
+        if (!lod.Array || (!m_VertexBuffer && !m_PositionBuffer)) return;
+        
+        // Same vertex streams as LOD 0, only the index buffer differs
+        lod.Buffer = IndexBuffer::Create(lod.Indices.data(), static_cast<uint32_t>(lod.Indices.size()));
+        if (m_PositionBuffer) {
+            lod.Array->AddVertexBuffer(m_PositionBuffer);
+        }
+        if (m_VertexBuffer) {
+            lod.Array->AddVertexBuffer(m_VertexBuffer);
+        }
+        lod.Array->SetIndexBuffer(lod.Buffer);
+        
+        if (m_PositionVertexArray) {
+            lod.PositionArray = VertexArray::Create();
+            lod.PositionArray->AddVertexBuffer(m_PositionBuffer);
+            lod.PositionArray->SetIndexBuffer(lod.Buffer);
+        }
+    }
+    
     std::shared_ptr<Mesh> Mesh::Create(const std::string& path) {
         return AssetManager::GetInstance().LoadAsset<Mesh>(path);
     }
@@ -0,0 +1,297 @@
+#include "SpoonEngine/Assets/MeshOptimizer.h"
+#include "SpoonEngine/Core/Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SpoonEngine {
+    
+    // FIFO cache model using per-vertex insertion stamps; Reset invalidates everything at once
+    class CacheSimulator {
+    public:
+        CacheSimulator(uint32_t vertexCount, uint32_t cacheSize)
+            : m_Stamps(vertexCount, 0), m_CacheSize(cacheSize), m_Time(cacheSize + 1) {}
+        
+        // Returns 1 on a miss
+        uint32_t Access(uint32_t vertex) {
+            if (m_Time - m_Stamps[vertex] > m_CacheSize) {
+                m_Stamps[vertex] = m_Time++;
+                return 1;
+            }
+            return 0;
+        }
+        
+        uint32_t AccessTriangle(const uint32_t* triangle) {
+            return Access(triangle[0]) + Access(triangle[1]) + Access(triangle[2]);
+        }
+        
+        void Reset() { m_Time += m_CacheSize + 1; }
+    
+    private:
+        std::vector<uint32_t> m_Stamps;
+        uint32_t m_CacheSize;
+        uint32_t m_Time;
+    };
+    
+    VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize) {
+        VertexCacheStats stats;
+        if (indices.empty() || vertexCount == 0) return stats;
+        
+        CacheSimulator cache(vertexCount, cacheSize);
+        std::vector<uint8_t> referenced(vertexCount, 0);
+        
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            stats.VertexInvocations += cache.AccessTriangle(&indices[i]);
+            stats.Triangles++;
+        }
+        for (uint32_t index : indices) {
+            if (!referenced[index]) {
+                referenced[index] = 1;
+                stats.UniqueVertices++;
+            }
+        }
+        
+        stats.ACMR = static_cast<float>(stats.VertexInvocations) / static_cast<float>(stats.Triangles);
+        stats.ATVR = static_cast<float>(stats.VertexInvocations) / static_cast<float>(stats.UniqueVertices);
+        return stats;
+    }
+    
+    void MeshOptimizer::OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize) {
+        SPOON_PROFILE_FUNCTION();
+        
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0 || vertexCount == 0) return;
+        
+        // Triangles around each vertex
+        std::vector<uint32_t> offsets(vertexCount + 1, 0);
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+            offsets[indices[i] + 1]++;
+        }
+        for (uint32_t v = 0; v < vertexCount; v++) {
+            offsets[v + 1] += offsets[v];
+        }
+        
+        std::vector<uint32_t> adjacency(triangleCount * 3);
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+        
+        // Triangles each vertex still has to be emitted with
+        std::vector<uint32_t> live(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++) {
+            live[v] = offsets[v + 1] - offsets[v];
+        }
+        
+        std::vector<uint32_t> cacheTime(vertexCount, 0);
+        std::vector<uint8_t> emitted(triangleCount, 0);
+        std::vector<uint32_t> deadEnd;
+        std::vector<uint32_t> candidates;
+        std::vector<uint32_t> result;
+        result.reserve(triangleCount * 3);
+        
+        uint32_t time = cacheSize + 1;
+        uint32_t cursor = 0;
+        
+        // Most recently referenced vertex that is still live, else the next live one in input order
+        auto skipDeadEnd = [&]() -> int64_t {
+            while (!deadEnd.empty()) {
+                uint32_t vertex = deadEnd.back();
+                deadEnd.pop_back();
+                if (live[vertex] > 0) return vertex;
+            }
+            while (cursor < vertexCount) {
+                if (live[cursor] > 0) return cursor;
+                cursor++;
+            }
+            return -1;
+        };
+        
+        int64_t fanning = skipDeadEnd();
+        while (fanning >= 0) {
+            candidates.clear();
+            
+            for (uint32_t k = offsets[fanning]; k < offsets[fanning + 1]; k++) {
+                uint32_t triangle = adjacency[k];
+                if (emitted[triangle]) continue;
+                emitted[triangle] = 1;
+                
+                for (int c = 0; c < 3; c++) {
+                    uint32_t vertex = indices[triangle * 3 + c];
+                    result.push_back(vertex);
+                    deadEnd.push_back(vertex);
+                    candidates.push_back(vertex);
+                    live[vertex]--;
+                    
+                    if (time - cacheTime[vertex] > cacheSize) {
+                        cacheTime[vertex] = time++;
+                    }
+                }
+            }
+            
+            // Prefer the candidate that entered the cache earliest but will survive its own fan
+            int64_t next = -1;
+            int64_t bestPriority = -1;
+            for (uint32_t vertex : candidates) {
+                if (live[vertex] == 0) continue;
+                
+                int64_t priority = 0;
+                if (time - cacheTime[vertex] + 2 * live[vertex] <= cacheSize) {
+                    priority = time - cacheTime[vertex];
+                }
+                if (priority > bestPriority) {
+                    bestPriority = priority;
+                    next = vertex;
+                }
+            }
+            
+            fanning = next >= 0 ? next : skipDeadEnd();
+        }
+        
+        indices.swap(result);
+    }
+    
+    void MeshOptimizer::OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vector3>& positions, float threshold, uint32_t cacheSize) {
+        SPOON_PROFILE_FUNCTION();
+        
+        size_t triangleCount = indices.size() / 3;
+        uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+        if (triangleCount == 0 || vertexCount == 0) return;
+        
+        // Hard boundaries: the vertex cache pass restarted, all three vertices miss
+        std::vector<uint32_t> hardBoundaries;
+        {
+            CacheSimulator cache(vertexCount, cacheSize);
+            for (size_t t = 0; t < triangleCount; t++) {
+                if (cache.AccessTriangle(&indices[t * 3]) == 3) {
+                    hardBoundaries.push_back(static_cast<uint32_t>(t));
+                }
+            }
+            if (hardBoundaries.empty() || hardBoundaries[0] != 0) {
+                hardBoundaries.insert(hardBoundaries.begin(), 0);
+            }
+            hardBoundaries.push_back(static_cast<uint32_t>(triangleCount));
+        }
+        
+        // Soft boundaries: split wherever the running ACMR is already within threshold of the cluster's
+        std::vector<uint32_t> clusters;
+        {
+            CacheSimulator cache(vertexCount, cacheSize);
+            for (size_t h = 0; h + 1 < hardBoundaries.size(); h++) {
+                uint32_t begin = hardBoundaries[h];
+                uint32_t end = hardBoundaries[h + 1];
+                
+                cache.Reset();
+                uint32_t clusterMisses = 0;
+                for (uint32_t t = begin; t < end; t++) {
+                    clusterMisses += cache.AccessTriangle(&indices[t * 3]);
+                }
+                float limit = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+                
+                clusters.push_back(begin);
+                cache.Reset();
+                uint32_t misses = 0;
+                uint32_t start = begin;
+                for (uint32_t t = begin; t < end; t++) {
+                    misses += cache.AccessTriangle(&indices[t * 3]);
+                    
+                    if (t + 1 < end && static_cast<float>(misses) <= limit * static_cast<float>(t + 1 - start)) {
+                        clusters.push_back(t + 1);
+                        cache.Reset();
+                        misses = 0;
+                        start = t + 1;
+                    }
+                }
+            }
+            clusters.push_back(static_cast<uint32_t>(triangleCount));
+        }
+        
+        // Area-weighted centroid of the whole mesh
+        double meshX = 0, meshY = 0, meshZ = 0, meshArea = 0;
+        std::vector<float> triangleData(triangleCount * 7);
+        for (size_t t = 0; t < triangleCount; t++) {
+            const Vector3& p0 = positions[indices[t * 3 + 0]];
+            const Vector3& p1 = positions[indices[t * 3 + 1]];
+            const Vector3& p2 = positions[indices[t * 3 + 2]];
+            
+            Vector3 normal = (p1 - p0).Cross(p2 - p0);
+            float area = normal.Length() * 0.5f;
+            
+            float* data = &triangleData[t * 7];
+            data[0] = (p0.x + p1.x + p2.x) / 3.0f;
+            data[1] = (p0.y + p1.y + p2.y) / 3.0f;
+            data[2] = (p0.z + p1.z + p2.z) / 3.0f;
+            data[3] = normal.x;
+            data[4] = normal.y;
+            data[5] = normal.z;
+            data[6] = area;
+            
+            meshX += data[0] * area;
+            meshY += data[1] * area;
+            meshZ += data[2] * area;
+            meshArea += area;
+        }
+        if (meshArea > 0.0) {
+            meshX /= meshArea;
+            meshY /= meshArea;
+            meshZ /= meshArea;
+        }
+        
+        // Clusters facing away from the centre are likely in front of the rest from any viewpoint
+        size_t clusterCount = clusters.size() - 1;
+        std::vector<float> sortKeys(clusterCount);
+        for (size_t c = 0; c < clusterCount; c++) {
+            double cx = 0, cy = 0, cz = 0, nx = 0, ny = 0, nz = 0, area = 0;
+            for (uint32_t t = clusters[c]; t < clusters[c + 1]; t++) {
+                const float* data = &triangleData[t * 7];
+                cx += data[0] * data[6];
+                cy += data[1] * data[6];
+                cz += data[2] * data[6];
+                nx += data[3];
+                ny += data[4];
+                nz += data[5];
+                area += data[6];
+            }
+            
+            double length = std::sqrt(nx * nx + ny * ny + nz * nz);
+            if (area <= 0.0 || length <= 0.0) {
+                sortKeys[c] = 0.0f;
+                continue;
+            }
+            
+            double dx = cx / area - meshX;
+            double dy = cy / area - meshY;
+            double dz = cz / area - meshZ;
+            sortKeys[c] = static_cast<float>((dx * nx + dy * ny + dz * nz) / length);
+        }
+        
+        std::vector<uint32_t> order(clusterCount);
+        for (size_t c = 0; c < clusterCount; c++) {
+            order[c] = static_cast<uint32_t>(c);
+        }
+        std::stable_sort(order.begin(), order.end(), [&sortKeys](uint32_t a, uint32_t b) {
+            return sortKeys[a] > sortKeys[b];
+        });
+        
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+        for (uint32_t c : order) {
+            result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+        }
+        indices.swap(result);
+    }
+    
+    uint32_t MeshOptimizer::OptimizeVertexFetch(std::vector<uint32_t>& indices, uint32_t vertexCount, std::vector<uint32_t>& remap) {
+        remap.assign(vertexCount, UnusedVertex);
+        
+        uint32_t next = 0;
+        for (uint32_t& index : indices) {
+            if (remap[index] == UnusedVertex) {
+                remap[index] = next++;
+            }
+            index = remap[index];
+        }
+        return next;
+    }
+    
+}
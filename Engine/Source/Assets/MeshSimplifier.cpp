@@ -0,0 +1,282 @@
+#include "SpoonEngine/Assets/MeshSimplifier.h"
+#include "SpoonEngine/Core/Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace SpoonEngine {
+    
+    // Symmetric 4x4 error quadric stored as its upper triangle
+    struct Quadric {
+        double A00 = 0, A01 = 0, A02 = 0, A03 = 0;
+        double A11 = 0, A12 = 0, A13 = 0;
+        double A22 = 0, A23 = 0;
+        double A33 = 0;
+        double Weight = 0;
+        
+        void AddPlane(double nx, double ny, double nz, double d, double weight) {
+            A00 += weight * nx * nx; A01 += weight * nx * ny; A02 += weight * nx * nz; A03 += weight * nx * d;
+            A11 += weight * ny * ny; A12 += weight * ny * nz; A13 += weight * ny * d;
+            A22 += weight * nz * nz; A23 += weight * nz * d;
+            A33 += weight * d * d;
+            Weight += weight;
+        }
+        
+        void Add(const Quadric& other) {
+            A00 += other.A00; A01 += other.A01; A02 += other.A02; A03 += other.A03;
+            A11 += other.A11; A12 += other.A12; A13 += other.A13;
+            A22 += other.A22; A23 += other.A23;
+            A33 += other.A33;
+            Weight += other.Weight;
+        }
+        
+        // Area-weighted mean squared distance from p to the accumulated planes
+        double Evaluate(const Vector3& p) const {
+            double x = p.x, y = p.y, z = p.z;
+            double error = A00 * x * x + 2.0 * A01 * x * y + 2.0 * A02 * x * z + 2.0 * A03 * x
+                         + A11 * y * y + 2.0 * A12 * y * z + 2.0 * A13 * y
+                         + A22 * z * z + 2.0 * A23 * z
+                         + A33;
+            if (Weight > 0.0) error /= Weight;
+            return error > 0.0 ? error : 0.0;
+        }
+    };
+    
+    struct EdgeCollapse {
+        uint32_t From;
+        uint32_t To;
+        double Cost;
+    };
+    
+    static Vector3 TriangleNormal(const Vector3& a, const Vector3& b, const Vector3& c) {
+        Vector3 e0(b.x - a.x, b.y - a.y, b.z - a.z);
+        Vector3 e1(c.x - a.x, c.y - a.y, c.z - a.z);
+        return Vector3(e0.y * e1.z - e0.z * e1.y,
+                       e0.z * e1.x - e0.x * e1.z,
+                       e0.x * e1.y - e0.y * e1.x);
+    }
+    
+    // Groups vertices sharing a position; remap[i] is the first vertex of i's group
+    static void BuildPositionRemap(const std::vector<Vertex>& vertices, std::vector<uint32_t>& remap) {
+        std::vector<uint32_t> order(vertices.size());
+        for (uint32_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        
+        auto less = [&vertices](uint32_t a, uint32_t b) {
+            const Vector3& pa = vertices[a].Position;
+            const Vector3& pb = vertices[b].Position;
+            if (pa.x != pb.x) return pa.x < pb.x;
+            if (pa.y != pb.y) return pa.y < pb.y;
+            if (pa.z != pb.z) return pa.z < pb.z;
+            return a < b;
+        };
+        std::sort(order.begin(), order.end(), less);
+        
+        remap.resize(vertices.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            const Vector3& p = vertices[order[i]].Position;
+            if (i > 0) {
+                const Vector3& previous = vertices[order[i - 1]].Position;
+                if (p.x == previous.x && p.y == previous.y && p.z == previous.z) {
+                    remap[order[i]] = remap[order[i - 1]];
+                    continue;
+                }
+            }
+            remap[order[i]] = order[i];
+        }
+    }
+    
+    std::vector<uint32_t> MeshSimplifier::Simplify(const std::vector<Vertex>& vertices,
+                                                   const std::vector<uint32_t>& indices,
+                                                   size_t targetIndexCount,
+                                                   float targetError,
+                                                   float* outError) {
+        SPOON_PROFILE_FUNCTION();
+        
+        std::vector<uint32_t> result = indices;
+        if (outError) *outError = 0.0f;
+        if (vertices.empty() || indices.size() % 3 != 0 || result.size() <= targetIndexCount) {
+            return result;
+        }
+        
+        size_t vertexCount = vertices.size();
+        
+        BoundingBox bounds;
+        for (const auto& vertex : vertices) {
+            bounds.Expand(vertex.Position);
+        }
+        Vector3 size = bounds.GetSize();
+        double scale = std::max(size.x, std::max(size.y, size.z));
+        if (scale <= 0.0) scale = 1.0;
+        
+        std::vector<uint32_t> remap;
+        BuildPositionRemap(vertices, remap);
+        
+        // Seams: more than one vertex at a position
+        std::vector<uint32_t> wedgeCount(vertexCount, 0);
+        for (size_t i = 0; i < vertexCount; i++) {
+            wedgeCount[remap[i]]++;
+        }
+        
+        std::vector<uint8_t> locked(vertexCount, 0);
+        for (size_t i = 0; i < vertexCount; i++) {
+            if (wedgeCount[remap[i]] > 1) locked[remap[i]] = 1;
+        }
+        
+        // Borders: position edges used by a single triangle
+        std::unordered_map<uint64_t, uint32_t> edgeUse;
+        edgeUse.reserve(indices.size());
+        for (size_t t = 0; t < indices.size(); t += 3) {
+            for (int e = 0; e < 3; e++) {
+                uint64_t a = remap[indices[t + e]];
+                uint64_t b = remap[indices[t + (e + 1) % 3]];
+                edgeUse[a < b ? (a << 32) | b : (b << 32) | a]++;
+            }
+        }
+        for (const auto& edge : edgeUse) {
+            if (edge.second == 1) {
+                locked[static_cast<uint32_t>(edge.first >> 32)] = 1;
+                locked[static_cast<uint32_t>(edge.first & 0xffffffffu)] = 1;
+            }
+        }
+        
+        // Area-weighted plane quadrics, accumulated per position
+        std::vector<Quadric> quadrics(vertexCount);
+        for (size_t t = 0; t < indices.size(); t += 3) {
+            const Vector3& p0 = vertices[indices[t + 0]].Position;
+            const Vector3& p1 = vertices[indices[t + 1]].Position;
+            const Vector3& p2 = vertices[indices[t + 2]].Position;
+            
+            Vector3 normal = TriangleNormal(p0, p1, p2);
+            double length = std::sqrt(double(normal.x) * normal.x + double(normal.y) * normal.y + double(normal.z) * normal.z);
+            if (length == 0.0) continue;
+            
+            double nx = normal.x / length, ny = normal.y / length, nz = normal.z / length;
+            double d = -(nx * p0.x + ny * p0.y + nz * p0.z);
+            double area = length * 0.5;
+            
+            for (int k = 0; k < 3; k++) {
+                quadrics[remap[indices[t + k]]].AddPlane(nx, ny, nz, d, area);
+            }
+        }
+        
+        double errorLimit = double(targetError) * scale;
+        errorLimit *= errorLimit;
+        double maxError = 0.0;
+        
+        std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+        std::vector<uint32_t> vertexTriangles;
+        std::vector<EdgeCollapse> collapses;
+        std::vector<uint32_t> collapseTarget(vertexCount);
+        std::vector<uint8_t> touched(vertexCount);
+        
+        while (result.size() > targetIndexCount) {
+            size_t triangleCount = result.size() / 3;
+            
+            // Triangles around each vertex
+            std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+            for (uint32_t index : result) {
+                triangleOffsets[index + 1]++;
+            }
+            for (size_t i = 0; i < vertexCount; i++) {
+                triangleOffsets[i + 1] += triangleOffsets[i];
+            }
+            vertexTriangles.resize(result.size());
+            std::vector<uint32_t> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+            for (size_t i = 0; i < result.size(); i++) {
+                vertexTriangles[fill[result[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+            
+            collapses.clear();
+            for (size_t t = 0; t < result.size(); t += 3) {
+                for (int e = 0; e < 3; e++) {
+                    uint32_t a = result[t + e];
+                    uint32_t b = result[t + (e + 1) % 3];
+                    
+                    Quadric q = quadrics[remap[a]];
+                    q.Add(quadrics[remap[b]]);
+                    
+                    if (!locked[remap[a]]) collapses.push_back({ a, b, q.Evaluate(vertices[b].Position) });
+                    if (!locked[remap[b]]) collapses.push_back({ b, a, q.Evaluate(vertices[a].Position) });
+                }
+            }
+            if (collapses.empty()) break;
+            
+            std::sort(collapses.begin(), collapses.end(), [](const EdgeCollapse& l, const EdgeCollapse& r) {
+                return l.Cost < r.Cost;
+            });
+            
+            // Each collapse removes about two triangles; stop once this pass has enough
+            size_t trianglesToRemove = triangleCount - targetIndexCount / 3;
+            size_t removed = 0;
+            
+            for (size_t i = 0; i < vertexCount; i++) {
+                collapseTarget[i] = static_cast<uint32_t>(i);
+            }
+            std::fill(touched.begin(), touched.end(), 0);
+            
+            for (const auto& collapse : collapses) {
+                if (collapse.Cost > errorLimit || removed >= trianglesToRemove) break;
+                if (touched[collapse.From] || touched[collapse.To]) continue;
+                
+                // Reject collapses that would flip or degenerate a surviving triangle
+                const Vector3& target = vertices[collapse.To].Position;
+                bool valid = true;
+                for (uint32_t k = triangleOffsets[collapse.From]; k < triangleOffsets[collapse.From + 1] && valid; k++) {
+                    const uint32_t* tri = &result[vertexTriangles[k] * 3];
+                    if (remap[tri[0]] == remap[collapse.To] || remap[tri[1]] == remap[collapse.To] || remap[tri[2]] == remap[collapse.To]) continue;
+                    
+                    Vector3 p[3];
+                    Vector3 q[3];
+                    for (int c = 0; c < 3; c++) {
+                        p[c] = vertices[tri[c]].Position;
+                        q[c] = tri[c] == collapse.From ? target : p[c];
+                    }
+                    
+                    Vector3 before = TriangleNormal(p[0], p[1], p[2]);
+                    Vector3 after = TriangleNormal(q[0], q[1], q[2]);
+                    double dot = double(before.x) * after.x + double(before.y) * after.y + double(before.z) * after.z;
+                    double afterLength = double(after.x) * after.x + double(after.y) * after.y + double(after.z) * after.z;
+                    if (dot <= 0.0 || afterLength == 0.0) valid = false;
+                }
+                if (!valid) continue;
+                
+                collapseTarget[collapse.From] = collapse.To;
+                quadrics[remap[collapse.To]].Add(quadrics[remap[collapse.From]]);
+                maxError = std::max(maxError, collapse.Cost);
+                removed += 2;
+                
+                // Freeze the whole neighbourhood so later flip checks in this pass stay valid
+                touched[collapse.To] = 1;
+                for (uint32_t k = triangleOffsets[collapse.From]; k < triangleOffsets[collapse.From + 1]; k++) {
+                    const uint32_t* tri = &result[vertexTriangles[k] * 3];
+                    touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+                }
+            }
+            
+            if (removed == 0) break;
+            
+            size_t write = 0;
+            for (size_t t = 0; t < result.size(); t += 3) {
+                uint32_t a = collapseTarget[result[t + 0]];
+                uint32_t b = collapseTarget[result[t + 1]];
+                uint32_t c = collapseTarget[result[t + 2]];
+                
+                if (remap[a] == remap[b] || remap[b] == remap[c] || remap[c] == remap[a]) continue;
+                
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+            result.resize(write);
+        }
+        
+        if (outError) {
+            *outError = static_cast<float>(std::sqrt(maxError) / scale);
+        }
+        return result;
+    }
+    
+}
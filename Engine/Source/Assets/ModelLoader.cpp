@@ -1,10 +1,13 @@
 #include "SpoonEngine/Assets/ModelLoader.h"
+#include "SpoonEngine/Assets/MeshOptimizer.h"
 #include "SpoonEngine/Renderer/Shader.h"
 #include "SpoonEngine/Assets/Texture.h"
+#include "SpoonEngine/Core/Profiler.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <algorithm>
+#include <cstring>
 
 // Use platform-specific filesystem implementation
 #if __has_include(<filesystem>)
@@ -36,6 +39,10 @@
 
 namespace SpoonEngine {
     
+    uint32_t ModelLoader::s_LODCount = Mesh::DefaultLODCount;
+    VertexLayout ModelLoader::s_VertexLayout;
+    bool ModelLoader::s_GeometryPooling = true;
+    
     bool ModelLoader::LoadModel(const std::string& path, Model* model) {
         if (!model) {
             std::cout << "Invalid model pointer" << std::endl;
@@ -55,6 +62,8 @@ namespace SpoonEngine {
     }
     
     bool ModelLoader::LoadOBJ(const std::string& path, Model* model) {
+        SPOON_PROFILE_SCOPE("ModelLoader::LoadOBJ");
+        
         std::vector<ModelMeshData> meshes;
         std::unordered_map<std::string, ModelMaterial> materials;
         
@@ -64,22 +73,35 @@ namespace SpoonEngine {
         
         std::string modelDir = fs::path(path).parent_path().string();
         
-        // Convert parsed data to engine objects
+        meshes.erase(std::remove_if(meshes.begin(), meshes.end(), [](const ModelMeshData& meshData) {
+            return meshData.Vertices.empty() || meshData.Indices.empty();
+        }), meshes.end());
+        
         for (auto& meshData : meshes) {
             // Generate normals if missing
             if (!meshData.Vertices.empty() && meshData.Vertices[0].Normal == Vector3::Zero()) {
                 GenerateNormals(meshData);
             }
             
-            // Generate tangents for normal mapping
-            GenerateTangents(meshData);
+            OptimizeMesh(meshData);
             
-            // Create engine mesh
-            auto engineMesh = CreateEngineMesh(meshData);
-            if (!engineMesh) {
-                std::cout << "Failed to create engine mesh for: " << meshData.Name << std::endl;
-                continue;
+            // Generate tangents for normal mapping, unless the layout drops them anyway
+            if (HasAttribute(s_VertexLayout.Attributes, VertexAttribute::Tangent | VertexAttribute::Bitangent)) {
+                GenerateTangents(meshData);
             }
+        }
+        
+        // Every material group becomes a sub-mesh of one shared mesh, so the whole model draws
+        // from a single vertex array
+        auto engineMesh = CreateEngineMesh(meshes);
+        if (!engineMesh) {
+            std::cout << "Failed to create engine mesh for: " << path << std::endl;
+            return false;
+        }
+        
+        // Convert parsed data to engine objects
+        for (size_t meshIndex = 0; meshIndex < meshes.size(); meshIndex++) {
+            const auto& meshData = meshes[meshIndex];
             
             // Create material
             std::shared_ptr<Material> engineMaterial;
@@ -87,70 +109,7 @@ namespace SpoonEngine {
                 engineMaterial = CreateEngineMaterial(materials[meshData.MaterialName], modelDir);
             } else {
                 // Create default material
-                auto defaultShader = Shader::Create("DefaultModel", 
-                    // Default vertex shader
-                    R"(
-                        #version 330 core
-                        layout (location = 0) in vec3 a_Position;
-                        layout (location = 1) in vec3 a_Normal;
-                        layout (location = 2) in vec2 a_TexCoord;
-                        
-                        uniform mat4 u_Model;
-                        uniform mat4 u_View;
-                        uniform mat4 u_Projection;
-                        
-                        out vec3 v_WorldPos;
-                        out vec3 v_Normal;
-                        out vec2 v_TexCoord;
-                        
-                        void main() {
-                            v_WorldPos = vec3(u_Model * vec4(a_Position, 1.0));
-                            v_Normal = mat3(transpose(inverse(u_Model))) * a_Normal;
-                            v_TexCoord = a_TexCoord;
-                            
-                            gl_Position = u_Projection * u_View * vec4(v_WorldPos, 1.0);
-                        }
-                    )",
-                    // Default fragment shader
-                    R"(
-                        #version 330 core
-                        
-                        in vec3 v_WorldPos;
-                        in vec3 v_Normal;
-                        in vec2 v_TexCoord;
-                        
-                        uniform vec3 u_Color;
-                        uniform vec3 u_LightPosition;
-                        uniform vec3 u_LightColor;
-                        uniform vec3 u_CameraPosition;
-                        
-                        out vec4 FragColor;
-                        
-                        void main() {
-                            vec3 norm = normalize(v_Normal);
-                            vec3 lightDir = normalize(u_LightPosition - v_WorldPos);
-                            
-                            // Ambient
-                            float ambientStrength = 0.1;
-                            vec3 ambient = ambientStrength * u_LightColor;
-                            
-                            // Diffuse
-                            float diff = max(dot(norm, lightDir), 0.0);
-                            vec3 diffuse = diff * u_LightColor;
-                            
-                            // Specular
-                            vec3 viewDir = normalize(u_CameraPosition - v_WorldPos);
-                            vec3 reflectDir = reflect(-lightDir, norm);
-                            float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32.0);
-                            vec3 specular = spec * u_LightColor;
-                            
-                            vec3 result = (ambient + diffuse + specular) * u_Color;
-                            FragColor = vec4(result, 1.0);
-                        }
-                    )"
-                );
-                
-                engineMaterial = Material::Create(defaultShader, "DefaultModelMaterial");
+                engineMaterial = Material::Create(GetDefaultShader(), "DefaultModelMaterial");
                 engineMaterial->SetFloat3("u_Color", glm::vec3(0.8f, 0.8f, 0.8f));
                 engineMaterial->SetFloat3("u_LightPosition", glm::vec3(5.0f, 5.0f, 5.0f));
                 engineMaterial->SetFloat3("u_LightColor", glm::vec3(1.0f, 1.0f, 1.0f));
@@ -162,6 +121,7 @@ namespace SpoonEngine {
             
             // Create model mesh
             ModelMesh modelMesh(engineMesh, engineMaterial, meshData.Name);
+            modelMesh.SubMeshIndex = static_cast<int32_t>(meshIndex);
             modelMesh.Bounds = meshBounds;
             
             model->m_Meshes.push_back(modelMesh);
@@ -173,6 +133,7 @@ namespace SpoonEngine {
     bool ModelLoader::ParseOBJFile(const std::string& path, 
                                   std::vector<ModelMeshData>& meshes,
                                   std::unordered_map<std::string, ModelMaterial>& materials) {
+        SPOON_PROFILE_SCOPE("ModelLoader::ParseOBJFile");
         
         std::ifstream file(path);
         if (!file.is_open()) {
@@ -544,10 +505,103 @@ namespace SpoonEngine {
         }
     }
     
-    std::shared_ptr<Mesh> ModelLoader::CreateEngineMesh(const ModelMeshData& meshData) {
-        // Convert ModelVertex to engine vertex format
+    void ModelLoader::OptimizeMesh(ModelMeshData& meshData) {
+        SPOON_PROFILE_FUNCTION();
+        
+        if (meshData.Indices.empty()) return;
+        
+        VertexCacheStats before = MeshOptimizer::AnalyzeVertexCache(meshData.Indices, static_cast<uint32_t>(meshData.Vertices.size()));
+        
+        WeldVertices(meshData);
+        
+        uint32_t vertexCount = static_cast<uint32_t>(meshData.Vertices.size());
+        MeshOptimizer::OptimizeVertexCache(meshData.Indices, vertexCount);
+        
+        std::vector<Vector3> positions;
+        positions.reserve(vertexCount);
+        for (const auto& vertex : meshData.Vertices) {
+            positions.push_back(vertex.Position);
+        }
+        MeshOptimizer::OptimizeOverdraw(meshData.Indices, positions);
+        
+        std::vector<uint32_t> remap;
+        uint32_t usedCount = MeshOptimizer::OptimizeVertexFetch(meshData.Indices, vertexCount, remap);
+        
+        std::vector<ModelVertex> vertices(usedCount);
+        for (uint32_t i = 0; i < vertexCount; i++) {
+            if (remap[i] != MeshOptimizer::UnusedVertex) {
+                vertices[remap[i]] = meshData.Vertices[i];
+            }
+        }
+        meshData.Vertices.swap(vertices);
+        
+        VertexCacheStats after = MeshOptimizer::AnalyzeVertexCache(meshData.Indices, usedCount);
+        std::cout << "  Optimized '" << meshData.Name << "': ACMR " << before.ACMR << " -> " << after.ACMR
+                  << ", ATVR " << before.ATVR << " -> " << after.ATVR << std::endl;
+    }
+    
+    void ModelLoader::WeldVertices(ModelMeshData& meshData) {
+        // Bitwise equality: corners that differ in any attribute stay separate
+        auto less = [&meshData](uint32_t a, uint32_t b) {
+            int order = std::memcmp(&meshData.Vertices[a], &meshData.Vertices[b], sizeof(ModelVertex));
+            return order != 0 ? order < 0 : a < b;
+        };
+        
+        std::vector<uint32_t> sorted(meshData.Vertices.size());
+        for (uint32_t i = 0; i < sorted.size(); i++) {
+            sorted[i] = i;
+        }
+        std::sort(sorted.begin(), sorted.end(), less);
+        
+        std::vector<uint32_t> remap(meshData.Vertices.size());
+        std::vector<ModelVertex> unique;
+        unique.reserve(meshData.Vertices.size());
+        for (size_t i = 0; i < sorted.size(); i++) {
+            if (i == 0 || std::memcmp(&meshData.Vertices[sorted[i - 1]], &meshData.Vertices[sorted[i]], sizeof(ModelVertex)) != 0) {
+                unique.push_back(meshData.Vertices[sorted[i]]);
+            }
+            remap[sorted[i]] = static_cast<uint32_t>(unique.size() - 1);
+        }
+        
+        for (auto& index : meshData.Indices) {
+            index = remap[index];
+        }
+        meshData.Vertices.swap(unique);
+    }
+    
+    std::shared_ptr<Mesh> ModelLoader::CreateEngineMesh(const std::vector<ModelMeshData>& meshes) {
+        if (meshes.empty()) return nullptr;
+        
+        // Convert ModelVertex to engine vertex format, appending each group's vertices and its
+        // group-relative indices; the sub-mesh BaseVertex restores the offset at draw time
         std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<SubMesh> subMeshes;
+        
+        for (const auto& meshData : meshes) {
+            SubMesh subMesh;
+            subMesh.BaseVertex = static_cast<uint32_t>(vertices.size());
+            subMesh.BaseIndex = static_cast<uint32_t>(indices.size());
+            subMesh.IndexCount = static_cast<uint32_t>(meshData.Indices.size());
+            subMesh.MaterialIndex = static_cast<uint32_t>(subMeshes.size());
+            subMeshes.push_back(subMesh);
+            
+            AppendEngineVertices(meshData, vertices);
+            indices.insert(indices.end(), meshData.Indices.begin(), meshData.Indices.end());
+        }
         
+        // Create mesh with procedural asset ID and empty path
+        static AssetID meshID = 2000; // Start mesh IDs at 2000
+        auto mesh = std::make_shared<Mesh>(meshID++, "");
+        
+        mesh->SetVertexLayout(s_VertexLayout);
+        mesh->SetGeometryPooling(s_GeometryPooling);
+        mesh->SetGeometry(vertices, indices, subMeshes, s_LODCount);
+        
+        return mesh;
+    }
+    
+    void ModelLoader::AppendEngineVertices(const ModelMeshData& meshData, std::vector<Vertex>& vertices) {
         for (const auto& vertex : meshData.Vertices) {
             Vertex engineVertex;
             engineVertex.Position = vertex.Position;
@@ -557,25 +611,124 @@ namespace SpoonEngine {
             engineVertex.Bitangent = vertex.Bitangent;
             vertices.push_back(engineVertex);
         }
+    }
+    
+    std::shared_ptr<Material> ModelLoader::CreateEngineMaterial(const ModelMaterial& material, const std::string& modelDir) {
+        auto engineMaterial = Material::Create(GetMaterialShader(), material.Name);
         
-        // Create mesh with procedural asset ID and empty path
-        static AssetID meshID = 2000; // Start mesh IDs at 2000
-        auto mesh = std::make_shared<Mesh>(meshID++, "");
+        // Set material properties
+        engineMaterial->SetFloat3("u_Ambient", glm::vec3(material.Ambient.x, material.Ambient.y, material.Ambient.z));
+        engineMaterial->SetFloat3("u_Diffuse", glm::vec3(material.Diffuse.x, material.Diffuse.y, material.Diffuse.z));
+        engineMaterial->SetFloat3("u_Specular", glm::vec3(material.Specular.x, material.Specular.y, material.Specular.z));
+        engineMaterial->SetFloat("u_Shininess", material.Shininess);
         
-        mesh->SetVertices(vertices);
-        mesh->SetIndices(meshData.Indices);
+        // Load diffuse texture if specified
+        if (!material.DiffuseTexture.empty()) {
+            std::string texturePath = (fs::path(modelDir) / material.DiffuseTexture).string();
+            auto texture = Texture2D::Create(texturePath);
+            if (texture->Load()) {
+                engineMaterial->SetTexture("u_DiffuseTexture", texture);
+            } else {
+                std::cout << "Failed to load diffuse texture: " << texturePath << std::endl;
+            }
+        }
         
-        return mesh;
+        // Set default lighting
+        engineMaterial->SetFloat3("u_LightPosition", glm::vec3(5.0f, 5.0f, 5.0f));
+        engineMaterial->SetFloat3("u_LightColor", glm::vec3(1.0f, 1.0f, 1.0f));
+        
+        return engineMaterial;
     }
     
-    std::shared_ptr<Material> ModelLoader::CreateEngineMaterial(const ModelMaterial& material, const std::string& modelDir) {
-        // Create basic material shader
-        auto shader = Shader::Create("ModelMaterial_" + material.Name,
-            // Vertex shader
+    // The built-in shaders are shared by every loaded material; the material parameters are
+    // per-material uniforms, so a shader is only compiled again once no material uses it
+    std::shared_ptr<Shader> ModelLoader::GetDefaultShader() {
+        static std::weak_ptr<Shader> s_Shared;
+        auto shader = s_Shared.lock();
+        if (shader) return shader;
+        
+        shader = Shader::Create("DefaultModel",
+            // Default vertex shader
+            std::string(R"(
+                #version 330 core
+            )") + Mesh::GetVertexDecodeSource() + R"(
+                layout (location = 0) in vec3 a_Position;
+                layout (location = 1) in vec4 a_Normal;
+                layout (location = 2) in vec2 a_TexCoord;
+                
+                uniform mat4 u_Model;
+                uniform mat4 u_View;
+                uniform mat4 u_Projection;
+                
+                out vec3 v_WorldPos;
+                out vec3 v_Normal;
+                out vec2 v_TexCoord;
+                
+                invariant gl_Position;
+                
+                void main() {
+                    v_WorldPos = vec3(u_Model * vec4(a_Position, 1.0));
+                    v_Normal = mat3(transpose(inverse(u_Model))) * DecodeNormal(a_Normal);
+                    v_TexCoord = a_TexCoord;
+                    
+                    gl_Position = u_Projection * u_View * vec4(v_WorldPos, 1.0);
+                }
+            )",
+            // Default fragment shader
             R"(
                 #version 330 core
+                
+                in vec3 v_WorldPos;
+                in vec3 v_Normal;
+                in vec2 v_TexCoord;
+                
+                uniform vec3 u_Color;
+                uniform vec3 u_LightPosition;
+                uniform vec3 u_LightColor;
+                uniform vec3 u_CameraPosition;
+                
+                out vec4 FragColor;
+                
+                void main() {
+                    vec3 norm = normalize(v_Normal);
+                    vec3 lightDir = normalize(u_LightPosition - v_WorldPos);
+                    
+                    // Ambient
+                    float ambientStrength = 0.1;
+                    vec3 ambient = ambientStrength * u_LightColor;
+                    
+                    // Diffuse
+                    float diff = max(dot(norm, lightDir), 0.0);
+                    vec3 diffuse = diff * u_LightColor;
+                    
+                    // Specular
+                    vec3 viewDir = normalize(u_CameraPosition - v_WorldPos);
+                    vec3 reflectDir = reflect(-lightDir, norm);
+                    float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32.0);
+                    vec3 specular = spec * u_LightColor;
+                    
+                    vec3 result = (ambient + diffuse + specular) * u_Color;
+                    FragColor = vec4(result, 1.0);
+                }
+            )"
+        );
+        
+        s_Shared = shader;
+        return shader;
+    }
+    
+    std::shared_ptr<Shader> ModelLoader::GetMaterialShader() {
+        static std::weak_ptr<Shader> s_Shared;
+        auto shader = s_Shared.lock();
+        if (shader) return shader;
+        
+        shader = Shader::Create("ModelMaterial",
+            // Vertex shader
+            std::string(R"(
+                #version 330 core
+            )") + Mesh::GetVertexDecodeSource() + R"(
                 layout (location = 0) in vec3 a_Position;
-                layout (location = 1) in vec3 a_Normal;
+                layout (location = 1) in vec4 a_Normal;
                 layout (location = 2) in vec2 a_TexCoord;
                 
                 uniform mat4 u_Model;
@@ -586,9 +739,11 @@ namespace SpoonEngine {
                 out vec3 v_Normal;
                 out vec2 v_TexCoord;
                 
+                invariant gl_Position;
+                
                 void main() {
                     v_WorldPos = vec3(u_Model * vec4(a_Position, 1.0));
-                    v_Normal = mat3(transpose(inverse(u_Model))) * a_Normal;
+                    v_Normal = mat3(transpose(inverse(u_Model))) * DecodeNormal(a_Normal);
                     v_TexCoord = a_TexCoord;
                     
                     gl_Position = u_Projection * u_View * vec4(v_WorldPos, 1.0);
@@ -639,30 +794,9 @@ namespace SpoonEngine {
             )"
         );
         
-        auto engineMaterial = Material::Create(shader, material.Name);
-        
-        // Set material properties
-        engineMaterial->SetFloat3("u_Ambient", glm::vec3(material.Ambient.x, material.Ambient.y, material.Ambient.z));
-        engineMaterial->SetFloat3("u_Diffuse", glm::vec3(material.Diffuse.x, material.Diffuse.y, material.Diffuse.z));
-        engineMaterial->SetFloat3("u_Specular", glm::vec3(material.Specular.x, material.Specular.y, material.Specular.z));
-        engineMaterial->SetFloat("u_Shininess", material.Shininess);
-        
-        // Load diffuse texture if specified
-        if (!material.DiffuseTexture.empty()) {
-            std::string texturePath = (fs::path(modelDir) / material.DiffuseTexture).string();
-            auto texture = Texture2D::Create(texturePath);
-            if (texture->Load()) {
-                engineMaterial->SetTexture("u_DiffuseTexture", texture);
-            } else {
-                std::cout << "Failed to load diffuse texture: " << texturePath << std::endl;
-            }
-        }
         
-        // Set default lighting
-        engineMaterial->SetFloat3("u_LightPosition", glm::vec3(5.0f, 5.0f, 5.0f));
-        engineMaterial->SetFloat3("u_LightColor", glm::vec3(1.0f, 1.0f, 1.0f));
-        
-        return engineMaterial;
+        s_Shared = shader;
+        return shader;
     }
     
-}
\ No newline at end of file
+}
@@ -1,6 +1,7 @@
 #include "SpoonEngine/Assets/Texture.h"
 #include "SpoonEngine/Renderer/Renderer.h"
 #include "SpoonEngine/Renderer/OpenGL/OpenGLTexture.h"
+#include "SpoonEngine/Renderer/Null/NullTexture.h"
 
 namespace SpoonEngine {
     
@@ -19,11 +20,15 @@ namespace SpoonEngine {
         switch (Renderer::GetAPI()) {
             case RendererAPI::None:    return nullptr;
             case RendererAPI::OpenGL:  return std::make_shared<OpenGLTexture2D>(0, "", specification);
+            case RendererAPI::Null:    return std::make_shared<NullTexture2D>(0, "", specification);
         }
         return nullptr;
     }
     
     std::shared_ptr<Texture> Texture::Create(const std::string& path) {
+        if (Renderer::GetAPI() == RendererAPI::Null) {
+            return AssetManager::GetInstance().LoadAsset<NullTexture2D>(path);
+        }
         return AssetManager::GetInstance().LoadAsset<OpenGLTexture2D>(path);
     }
     
@@ -39,11 +44,15 @@ namespace SpoonEngine {
         switch (Renderer::GetAPI()) {
             case RendererAPI::None:    return nullptr;
             case RendererAPI::OpenGL:  return std::make_shared<OpenGLTexture2D>(0, "", specification);
+            case RendererAPI::Null:    return std::make_shared<NullTexture2D>(0, "", specification);
         }
         return nullptr;
     }
     
     std::shared_ptr<Texture2D> Texture2D::Create(const std::string& path) {
+        if (Renderer::GetAPI() == RendererAPI::Null) {
+            return AssetManager::GetInstance().LoadAsset<NullTexture2D>(path);
+        }
         return AssetManager::GetInstance().LoadAsset<OpenGLTexture2D>(path);
     }
     
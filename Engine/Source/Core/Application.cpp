@@ -1,6 +1,9 @@
 #include "SpoonEngine/Core/Application.h"
 #include "SpoonEngine/Core/Window.h"
+#include "SpoonEngine/Core/Profiler.h"
+#include "SpoonEngine/Core/JobSystem.h"
 #include "SpoonEngine/Renderer/Renderer.h"
+#include "SpoonEngine/Renderer/RenderThread.h"
 #include "SpoonEngine/ECS/World.h"
 
 #include <GLFW/glfw3.h>
@@ -16,10 +19,14 @@ namespace SpoonEngine {
     }
     
     void Application::Run() {
+        Profiler::SetThreadName("Main Thread");
+        
         Initialize();
         
         m_Running = true;
         while (m_Running) {
+            SPOON_PROFILE_SCOPE("Application::Run Frame");
+            
             float time = static_cast<float>(glfwGetTime());
             float deltaTime = time - m_LastFrameTime;
             m_LastFrameTime = time;
@@ -30,15 +37,38 @@ namespace SpoonEngine {
             Render();
             OnRender();
             
-            m_Window->OnUpdate();
+            SPOON_PROFILE_SCOPE("Application::Present");
+            if (m_RenderThread) {
+                Window* window = m_Window.get();
+                m_Renderer->Submit([window]() { window->SwapBuffers(); });
+                m_Renderer->EndFrame();
+                
+                m_Window->PollEvents();
+            } else {
+                if (m_Renderer) {
+                    m_Renderer->EndFrame();
+                }
+                
+                m_Window->OnUpdate();
+            }
             
             if (m_Window->ShouldClose()) {
                 m_Running = false;
             }
         }
         
+        if (m_RenderThread) {
+            // Drain the last frame and take the context back for resource teardown
+            m_RenderThread->Stop();
+            m_Renderer->SetRenderThread(nullptr);
+            m_RenderThread.reset();
+            m_Window->MakeContextCurrent();
+        }
+        
         OnShutdown();
         Shutdown();
+        
+        JobSystem::Shutdown();
     }
     
     void Application::Shutdown() {
@@ -46,6 +76,8 @@ namespace SpoonEngine {
     }
     
     void Application::Initialize() {
+        SPOON_PROFILE_FUNCTION();
+        
         if (!glfwInit()) {
             std::cerr << "Failed to initialize GLFW!" << std::endl;
             return;
@@ -58,9 +90,30 @@ namespace SpoonEngine {
         m_Renderer->Initialize();
         m_Renderer->SetViewport(0, 0, m_Window->GetWidth(), m_Window->GetHeight());
         
+        if (m_Window->HasSharedContext()) {
+            Window* window = m_Window.get();
+            m_Renderer->StartShaderCompiler(
+                [window]() { window->MakeSharedContextCurrent(); },
+                [window]() { window->ReleaseContext(); });
+        }
+        
         m_World = std::make_unique<World>();
         
+        JobSystem::Init();
+        
         OnInitialize();
+        
+        if (m_ThreadedRendering) {
+            // Assets created in OnInitialize were uploaded with the context still on this thread
+            Window* window = m_Window.get();
+            window->ReleaseContext();
+            
+            m_RenderThread = std::make_unique<RenderThread>();
+            m_RenderThread->Start(
+                [window]() { window->MakeContextCurrent(); },
+                [window]() { window->ReleaseContext(); });
+            m_Renderer->SetRenderThread(m_RenderThread.get());
+        }
     }
     
     void Application::Update() {
@@ -71,6 +124,7 @@ namespace SpoonEngine {
     
     void Application::Render() {
         if (m_Renderer) {
+            m_Renderer->BeginFrame();
             m_Renderer->Clear();
             
             if (m_World) {
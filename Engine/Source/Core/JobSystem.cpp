@@ -0,0 +1,149 @@
+#include "SpoonEngine/Core/JobSystem.h"
+#include "SpoonEngine/Core/Profiler.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+namespace SpoonEngine {
+    
+    struct QueuedJob {
+        JobSystem::Job Function;
+        std::atomic<uint32_t>* Counter;
+    };
+    
+    static std::vector<std::thread> s_Workers;
+    static std::deque<QueuedJob> s_Queue;
+    static std::mutex s_QueueMutex;
+    static std::condition_variable s_QueueCondition;
+    // Written under s_QueueMutex so waiting workers see it change; Dispatch reads it without the lock
+    static std::atomic<bool> s_Running{false};
+    
+    static bool TryRunJob() {
+        QueuedJob job;
+        {
+            std::lock_guard<std::mutex> lock(s_QueueMutex);
+            if (s_Queue.empty()) return false;
+            
+            job = std::move(s_Queue.front());
+            s_Queue.pop_front();
+        }
+        
+        job.Function();
+        job.Counter->fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    }
+    
+    static void WorkerMain(uint32_t index) {
+        Profiler::SetThreadName("Worker " + std::to_string(index));
+        
+        while (true) {
+            QueuedJob job;
+            {
+                std::unique_lock<std::mutex> lock(s_QueueMutex);
+                s_QueueCondition.wait(lock, [] { return !s_Queue.empty() || !s_Running; });
+                
+                if (s_Queue.empty() && !s_Running) {
+                    break;
+                }
+                
+                job = std::move(s_Queue.front());
+                s_Queue.pop_front();
+            }
+            
+            job.Function();
+            job.Counter->fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+    
+    void JobSystem::Init(uint32_t workerCount) {
+        if (s_Running) return;
+        
+        if (workerCount == 0) {
+            uint32_t hardwareThreads = std::thread::hardware_concurrency();
+            workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+        }
+        
+        s_Running = true;
+        s_Workers.reserve(workerCount);
+        for (uint32_t i = 0; i < workerCount; i++) {
+            s_Workers.emplace_back(WorkerMain, i);
+        }
+        
+        std::cout << "Job system started with " << workerCount << " workers" << std::endl;
+    }
+    
+    void JobSystem::Shutdown() {
+        if (!s_Running) return;
+        
+        {
+            std::lock_guard<std::mutex> lock(s_QueueMutex);
+            s_Running = false;
+        }
+        s_QueueCondition.notify_all();
+        
+        for (auto& worker : s_Workers) {
+            worker.join();
+        }
+        s_Workers.clear();
+    }
+    
+    bool JobSystem::IsInitialized() {
+        return s_Running;
+    }
+    
+    uint32_t JobSystem::GetWorkerCount() {
+        return static_cast<uint32_t>(s_Workers.size());
+    }
+    
+    void JobSystem::Execute(Job job, std::atomic<uint32_t>& counter) {
+        if (!s_Running) {
+            job();
+            return;
+        }
+        
+        counter.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(s_QueueMutex);
+            s_Queue.push_back({ std::move(job), &counter });
+        }
+        s_QueueCondition.notify_one();
+    }
+    
+    void JobSystem::Dispatch(uint32_t count, uint32_t groupSize, const RangeJob& job) {
+        if (count == 0) return;
+        if (groupSize == 0) groupSize = 1;
+        
+        uint32_t groupCount = (count + groupSize - 1) / groupSize;
+        if (!s_Running || groupCount == 1) {
+            job(0, count);
+            return;
+        }
+        
+        std::atomic<uint32_t> counter{0};
+        
+        // The caller takes the first group itself
+        for (uint32_t group = 1; group < groupCount; group++) {
+            uint32_t begin = group * groupSize;
+            uint32_t end = begin + groupSize < count ? begin + groupSize : count;
+            Execute([&job, begin, end]() { job(begin, end); }, counter);
+        }
+        
+        job(0, groupSize < count ? groupSize : count);
+        Wait(counter);
+    }
+    
+    void JobSystem::Wait(const std::atomic<uint32_t>& counter) {
+        while (counter.load(std::memory_order_acquire) > 0) {
+            if (!TryRunJob()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    
+}
@@ -0,0 +1,112 @@
+#include "SpoonEngine/Core/Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+namespace SpoonEngine {
+    
+    std::atomic<bool> Profiler::s_Enabled{true};
+    std::mutex Profiler::s_RegistryMutex;
+    std::vector<std::shared_ptr<Profiler::ThreadBuffer>> Profiler::s_Threads;
+    
+    static const std::chrono::steady_clock::time_point s_Epoch = std::chrono::steady_clock::now();
+    
+    static std::string EscapeJSON(const std::string& value) {
+        std::string result;
+        result.reserve(value.size());
+        for (char c : value) {
+            if (c == '"' || c == '\\') result += '\\';
+            result += c;
+        }
+        return result;
+    }
+    
+    uint64_t Profiler::Now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - s_Epoch).count());
+    }
+    
+    Profiler::ThreadBuffer& Profiler::GetThreadBuffer() {
+        // The registry keeps a reference so events survive threads that have already exited
+        thread_local std::shared_ptr<ThreadBuffer> buffer;
+        if (!buffer) {
+            buffer = std::make_shared<ThreadBuffer>();
+            
+            std::lock_guard<std::mutex> lock(s_RegistryMutex);
+            buffer->ThreadIndex = static_cast<uint32_t>(s_Threads.size()) + 1;
+            buffer->Name = "Thread " + std::to_string(buffer->ThreadIndex);
+            s_Threads.push_back(buffer);
+        }
+        return *buffer;
+    }
+    
+    Profiler::ThreadBuffer& Profiler::GetRecordingBuffer() {
+        ThreadBuffer& buffer = GetThreadBuffer();
+        // Exporters only read events below Head, which stays 0 until the ring exists
+        if (buffer.Events.empty()) {
+            buffer.Events.resize(EventsPerThread);
+        }
+        return buffer;
+    }
+    
+    void Profiler::SetThreadName(const std::string& name) {
+        ThreadBuffer& buffer = GetThreadBuffer();
+        
+        std::lock_guard<std::mutex> lock(s_RegistryMutex);
+        buffer.Name = name;
+    }
+    
+    void Profiler::Clear() {
+        std::lock_guard<std::mutex> lock(s_RegistryMutex);
+        for (auto& thread : s_Threads) {
+            // Not synchronized with the writer; a scope closing concurrently may survive the clear
+            thread->Head.store(0, std::memory_order_relaxed);
+        }
+    }
+    
+    bool Profiler::ExportTrace(const std::string& filepath) {
+        std::ofstream out(filepath);
+        if (!out) {
+            std::cerr << "Failed to open trace file: " << filepath << std::endl;
+            return false;
+        }
+        
+        std::lock_guard<std::mutex> lock(s_RegistryMutex);
+        
+        size_t eventCount = 0;
+        bool first = true;
+        out << "{\"traceEvents\":[";
+        
+        for (const auto& thread : s_Threads) {
+            out << (first ? "\n" : ",\n");
+            first = false;
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->ThreadIndex
+                << ",\"args\":{\"name\":\"" << EscapeJSON(thread->Name) << "\"}}";
+            
+            // Events in the oldest part of the ring may be overwritten while we read them;
+            // that only corrupts samples about to be discarded anyway
+            uint64_t head = thread->Head.load(std::memory_order_acquire);
+            uint64_t count = std::min<uint64_t>(head, EventsPerThread);
+            
+            for (uint64_t i = head - count; i < head; i++) {
+                const Event& event = thread->Events[i % EventsPerThread];
+                if (!event.Name) continue;
+                
+                // Trace timestamps are in microseconds
+                out << ",\n{\"name\":\"" << EscapeJSON(event.Name) << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1"
+                    << ",\"tid\":" << thread->ThreadIndex
+                    << ",\"ts\":" << event.Start / 1000.0 << ",\"dur\":" << (event.End - event.Start) / 1000.0
+                    << ",\"args\":{\"depth\":" << event.Depth << "}}";
+                eventCount++;
+            }
+        }
+        
+        out << "\n]}\n";
+        
+        std::cout << "CPU trace written to " << filepath << " (" << eventCount << " events)" << std::endl;
+        return true;
+    }
+
+}
@@ -52,6 +52,10 @@ namespace SpoonEngine {
             return;
         }
         
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        m_SharedContext = glfwCreateWindow(1, 1, m_Data.Title.c_str(), nullptr, m_Window);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+        
         glfwMakeContextCurrent(m_Window);
         glfwSetWindowUserPointer(m_Window, &m_Data);
         SetVSync(props.VSync);
@@ -68,6 +72,10 @@ namespace SpoonEngine {
     }
     
     void Window::Shutdown() {
+        if (m_SharedContext) {
+            glfwDestroyWindow(m_SharedContext);
+            m_SharedContext = nullptr;
+        }
         if (m_Window) {
             glfwDestroyWindow(m_Window);
             m_Window = nullptr;
@@ -75,10 +83,30 @@ namespace SpoonEngine {
     }
     
     void Window::OnUpdate() {
+        PollEvents();
+        SwapBuffers();
+    }
+    
+    void Window::PollEvents() {
         glfwPollEvents();
+    }
+    
+    void Window::SwapBuffers() {
         glfwSwapBuffers(m_Window);
     }
     
+    void Window::MakeContextCurrent() {
+        glfwMakeContextCurrent(m_Window);
+    }
+    
+    void Window::ReleaseContext() {
+        glfwMakeContextCurrent(nullptr);
+    }
+    
+    void Window::MakeSharedContextCurrent() {
+        glfwMakeContextCurrent(m_SharedContext);
+    }
+    
     void Window::SetVSync(bool enabled) {
         if (enabled) {
             glfwSwapInterval(1);
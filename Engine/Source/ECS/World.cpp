@@ -1,4 +1,5 @@
 #include "SpoonEngine/ECS/World.h"
+#include "SpoonEngine/Core/Profiler.h"
 
 namespace SpoonEngine {
     
@@ -22,10 +23,12 @@ namespace SpoonEngine {
     }
     
     void World::Update() {
+        SPOON_PROFILE_SCOPE("World::Update");
         m_SystemManager->UpdateSystems(0.0f);
     }
     
     void World::Render(Renderer* renderer) {
+        SPOON_PROFILE_SCOPE("World::Render");
         m_SystemManager->RenderSystems(renderer);
     }
     
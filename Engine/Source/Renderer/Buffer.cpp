@@ -1,6 +1,9 @@
 #include "SpoonEngine/Renderer/Buffer.h"
 #include "SpoonEngine/Renderer/Renderer.h"
 #include "SpoonEngine/Renderer/OpenGL/OpenGLBuffer.h"
+#include "SpoonEngine/Renderer/Null/NullBuffer.h"
+
+#include <algorithm>
 
 namespace SpoonEngine {
     
@@ -8,6 +11,7 @@ namespace SpoonEngine {
         switch (Renderer::GetAPI()) {
             case RendererAPI::None:    return nullptr;
             case RendererAPI::OpenGL:  return std::make_shared<OpenGLVertexBuffer>(size);
+            case RendererAPI::Null:    return std::make_shared<NullVertexBuffer>(size);
         }
         return nullptr;
     }
@@ -16,14 +20,71 @@ namespace SpoonEngine {
         switch (Renderer::GetAPI()) {
             case RendererAPI::None:    return nullptr;
             case RendererAPI::OpenGL:  return std::make_shared<OpenGLVertexBuffer>(vertices, size);
+            case RendererAPI::Null:    return std::make_shared<NullVertexBuffer>(vertices, size);
+        }
+        return nullptr;
+    }
+    
+    std::shared_ptr<IndexBuffer> IndexBuffer::Create(uint32_t count, IndexType type) {
+        switch (Renderer::GetAPI()) {
+            case RendererAPI::None:    return nullptr;
+            case RendererAPI::OpenGL:  return std::make_shared<OpenGLIndexBuffer>(nullptr, count, type);
+            case RendererAPI::Null:    return std::make_shared<NullIndexBuffer>(nullptr, count, type);
+        }
+        return nullptr;
+    }
+    
+    std::shared_ptr<IndexBuffer> IndexBuffer::Create(const uint32_t* indices, uint32_t count) {
+        uint32_t maxIndex = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            maxIndex = std::max(maxIndex, indices[i]);
+        }
+        
+        if (maxIndex <= 0xffffu) {
+            std::vector<uint16_t> narrow(indices, indices + count);
+            return Create(narrow.data(), count);
+        }
+        
+        switch (Renderer::GetAPI()) {
+            case RendererAPI::None:    return nullptr;
+            case RendererAPI::OpenGL:  return std::make_shared<OpenGLIndexBuffer>(indices, count, IndexType::UInt32);
+            case RendererAPI::Null:    return std::make_shared<NullIndexBuffer>(indices, count, IndexType::UInt32);
+        }
+        return nullptr;
+    }
+    
+    std::shared_ptr<IndexBuffer> IndexBuffer::Create(const uint16_t* indices, uint32_t count) {
+        switch (Renderer::GetAPI()) {
+            case RendererAPI::None:    return nullptr;
+            case RendererAPI::OpenGL:  return std::make_shared<OpenGLIndexBuffer>(indices, count, IndexType::UInt16);
+            case RendererAPI::Null:    return std::make_shared<NullIndexBuffer>(indices, count, IndexType::UInt16);
+        }
+        return nullptr;
+    }
+    
+    std::shared_ptr<IndirectBuffer> IndirectBuffer::Create(uint32_t maxCommands) {
+        switch (Renderer::GetAPI()) {
+            case RendererAPI::None:    return nullptr;
+            case RendererAPI::OpenGL:  return std::make_shared<OpenGLIndirectBuffer>(maxCommands);
+            case RendererAPI::Null:    return std::make_shared<NullIndirectBuffer>(maxCommands);
+        }
+        return nullptr;
+    }
+    
+    std::shared_ptr<UniformBuffer> UniformBuffer::Create(uint32_t size) {
+        switch (Renderer::GetAPI()) {
+            case RendererAPI::None:    return nullptr;
+            case RendererAPI::OpenGL:  return std::make_shared<OpenGLUniformBuffer>(size);
+            case RendererAPI::Null:    return std::make_shared<NullUniformBuffer>(size);
         }
         return nullptr;
     }
     
-    std::shared_ptr<IndexBuffer> IndexBuffer::Create(uint32_t* indices, uint32_t count) {
+    std::shared_ptr<VertexArray> VertexArray::Create() {
         switch (Renderer::GetAPI()) {
             case RendererAPI::None:    return nullptr;
-            case RendererAPI::OpenGL:  return std::make_shared<OpenGLIndexBuffer>(indices, count);
+            case RendererAPI::OpenGL:  return std::make_shared<OpenGLVertexArray>();
+            case RendererAPI::Null:    return std::make_shared<NullVertexArray>();
         }
         return nullptr;
     }
@@ -0,0 +1,64 @@
+#include "SpoonEngine/Renderer/DynamicResolution.h"
+#include "SpoonEngine/Renderer/GPUProfiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SpoonEngine {
+    
+    // Weight of the newest timing in the running average
+    static const double s_TimeSmoothing = 0.3;
+    // Largest change of the scale per decision; dropping is faster than recovering
+    static const float s_MaxScaleDrop = 0.75f;
+    static const float s_MaxScaleRise = 1.1f;
+    
+    void DynamicResolutionController::SetSettings(const DynamicResolutionSettings& settings) {
+        m_Settings = settings;
+        m_Settings.MinScale = std::max(m_Settings.MinScale, 0.1f);
+        m_Settings.MaxScale = std::max(m_Settings.MaxScale, m_Settings.MinScale);
+        m_Scale = std::min(std::max(m_Scale, m_Settings.MinScale), m_Settings.MaxScale);
+    }
+    
+    void DynamicResolutionController::Reset() {
+        m_Scale = m_Settings.MaxScale;
+        m_LastFrame = 0;
+        m_Cooldown = 0;
+        m_SmoothedTime = 0.0;
+    }
+    
+    float DynamicResolutionController::Quantize(float scale) const {
+        if (m_Settings.ScaleStep > 0.0f) {
+            scale = std::round(scale / m_Settings.ScaleStep) * m_Settings.ScaleStep;
+        }
+        return std::min(std::max(scale, m_Settings.MinScale), m_Settings.MaxScale);
+    }
+    
+    void DynamicResolutionController::Update(uint64_t frame, double gpuTime) {
+        if (frame == m_LastFrame || gpuTime <= 0.0) return;
+        m_LastFrame = frame;
+        
+        // Frames still in flight when the scale last changed were rendered at the old one
+        if (m_Cooldown > 0) {
+            m_Cooldown--;
+            return;
+        }
+        
+        m_SmoothedTime = m_SmoothedTime > 0.0 ? m_SmoothedTime + (gpuTime - m_SmoothedTime) * s_TimeSmoothing : gpuTime;
+        
+        double target = m_Settings.TargetGPUTime;
+        double lower = target * m_Settings.Headroom;
+        if (m_SmoothedTime <= target && m_SmoothedTime >= lower) return;
+        
+        // Aim for the middle of the band; the time scales with the square of the scale
+        float desired = m_Scale * static_cast<float>(std::sqrt((target + lower) * 0.5 / m_SmoothedTime));
+        desired = std::min(std::max(desired, m_Scale * s_MaxScaleDrop), m_Scale * s_MaxScaleRise);
+        desired = Quantize(desired);
+        
+        if (desired != m_Scale) {
+            m_Scale = desired;
+            m_Cooldown = GPUProfiler::FrameLatency + 1;
+            m_SmoothedTime = 0.0;
+        }
+    }
+    
+}
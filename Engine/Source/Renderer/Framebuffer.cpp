@@ -1,6 +1,9 @@
 #include "SpoonEngine/Renderer/Framebuffer.h"
 #include "SpoonEngine/Renderer/Renderer.h"
 #include "SpoonEngine/Renderer/OpenGL/OpenGLFramebuffer.h"
+#include "SpoonEngine/Renderer/Null/NullFramebuffer.h"
+
+#include <algorithm>
 
 namespace SpoonEngine {
     
@@ -8,6 +11,7 @@ namespace SpoonEngine {
         switch (Renderer::GetAPI()) {
             case RendererAPI::None:    return nullptr;
             case RendererAPI::OpenGL:  return std::make_shared<OpenGLFramebuffer>(spec);
+            case RendererAPI::Null:    return std::make_shared<NullFramebuffer>(spec);
             case RendererAPI::Vulkan:  return nullptr;
             case RendererAPI::DirectX11: return nullptr;
             case RendererAPI::DirectX12: return nullptr;
@@ -17,4 +21,106 @@ namespace SpoonEngine {
         return nullptr;
     }
     
-}
\ No newline at end of file
+    FramebufferTileAllocator::FramebufferTileAllocator(uint32_t size, uint32_t minTileSize)
+        : m_MinTileSize(std::max(1u, minTileSize)) {
+        Reset(size);
+    }
+    
+    void FramebufferTileAllocator::Reset(uint32_t size) {
+        m_Size = size;
+        m_UsedArea = 0;
+        m_FreeTiles.clear();
+        if (size == 0) return;
+        
+        uint32_t levels = 1;
+        for (uint32_t tile = size; tile > m_MinTileSize && tile % 2 == 0; tile /= 2) {
+            levels++;
+        }
+        m_FreeTiles.resize(levels);
+        m_FreeTiles[0].insert({ 0, 0 });
+    }
+    
+    uint32_t FramebufferTileAllocator::GetLevel(uint32_t size) const {
+        uint32_t level = 0;
+        uint32_t tile = m_Size;
+        while (level + 1 < m_FreeTiles.size() && tile / 2 >= size) {
+            tile /= 2;
+            level++;
+        }
+        return level;
+    }
+    
+    bool FramebufferTileAllocator::Allocate(uint32_t size, FramebufferTile& tile) {
+        if (m_FreeTiles.empty() || size == 0 || size > m_Size) return false;
+        
+        uint32_t level = GetLevel(size);
+        
+        // Smallest free tile at or above the requested level
+        uint32_t source = level + 1;
+        while (source > 0 && m_FreeTiles[source - 1].empty()) {
+            source--;
+        }
+        if (source == 0) return false;
+        source--;
+        
+        auto origin = *m_FreeTiles[source].begin();
+        m_FreeTiles[source].erase(m_FreeTiles[source].begin());
+        
+        // Split down, keeping the top-left quarter and freeing the other three
+        uint32_t tileSize = m_Size >> source;
+        for (uint32_t split = source; split < level; split++) {
+            tileSize /= 2;
+            m_FreeTiles[split + 1].insert({ origin.first, origin.second + tileSize });
+            m_FreeTiles[split + 1].insert({ origin.first + tileSize, origin.second });
+            m_FreeTiles[split + 1].insert({ origin.first + tileSize, origin.second + tileSize });
+        }
+        
+        tile.X = origin.second;
+        tile.Y = origin.first;
+        tile.Size = tileSize;
+        m_UsedArea += static_cast<uint64_t>(tileSize) * tileSize;
+        return true;
+    }
+    
+    void FramebufferTileAllocator::Free(FramebufferTile& tile) {
+        if (tile.Size == 0 || m_FreeTiles.empty()) return;
+        
+        m_UsedArea -= static_cast<uint64_t>(tile.Size) * tile.Size;
+        
+        uint32_t level = GetLevel(tile.Size);
+        uint32_t size = tile.Size;
+        std::pair<uint32_t, uint32_t> origin = { tile.Y, tile.X };
+        tile.Size = 0;
+        
+        while (level > 0) {
+            uint32_t parentSize = size * 2;
+            std::pair<uint32_t, uint32_t> parent = { origin.first / parentSize * parentSize, origin.second / parentSize * parentSize };
+            std::pair<uint32_t, uint32_t> quarters[4] = {
+                parent,
+                { parent.first, parent.second + size },
+                { parent.first + size, parent.second },
+                { parent.first + size, parent.second + size }
+            };
+            
+            auto& free = m_FreeTiles[level];
+            bool merge = true;
+            for (const auto& quarter : quarters) {
+                if (quarter != origin && free.find(quarter) == free.end()) {
+                    merge = false;
+                    break;
+                }
+            }
+            if (!merge) break;
+            
+            for (const auto& quarter : quarters) {
+                free.erase(quarter);
+            }
+            origin = parent;
+            size = parentSize;
+            level--;
+        }
+        
+        m_FreeTiles[level].insert(origin);
+    }
+    
+}
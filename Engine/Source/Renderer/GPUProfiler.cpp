@@ -0,0 +1,200 @@
+#include "SpoonEngine/Renderer/GPUProfiler.h"
+#include "SpoonEngine/Renderer/Renderer.h"
+#include "SpoonEngine/Renderer/OpenGL/OpenGLGPUProfiler.h"
+#include "SpoonEngine/Renderer/Null/NullGPUProfiler.h"
+
+#include <fstream>
+#include <iostream>
+
+namespace SpoonEngine {
+    
+    std::unique_ptr<GPUProfiler> GPUProfiler::s_Instance;
+    
+    static const uint32_t s_DroppedScope = 0xFFFFFFFF;
+    
+    static std::string EscapeJSON(const std::string& value) {
+        std::string result;
+        result.reserve(value.size());
+        for (char c : value) {
+            if (c == '"' || c == '\\') result += '\\';
+            result += c;
+        }
+        return result;
+    }
+    
+    void GPUProfiler::Init() {
+        switch (Renderer::GetAPI()) {
+            case RendererAPI::None:    s_Instance.reset(); break;
+            case RendererAPI::OpenGL:  s_Instance = std::make_unique<OpenGLGPUProfiler>(); break;
+            case RendererAPI::Null:    s_Instance = std::make_unique<NullGPUProfiler>(); break;
+            default:                   s_Instance.reset(); break;
+        }
+    }
+    
+    void GPUProfiler::Shutdown() {
+        s_Instance.reset();
+    }
+    
+    GPUProfiler::GPUProfiler()
+        : m_Epoch(std::chrono::steady_clock::now()) {
+    }
+    
+    double GPUProfiler::Now() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_Epoch).count();
+    }
+    
+    void GPUProfiler::BeginFrame() {
+        if (!m_Enabled || m_InFrame) return;
+        
+        uint32_t slotIndex = static_cast<uint32_t>(m_Frame % FrameLatency);
+        FrameSlot& slot = m_Slots[slotIndex];
+        
+        // Queries from FrameLatency frames ago; unresolved ones are dropped rather than waited on
+        if (slot.Pending) {
+            Resolve(slot, slotIndex);
+        }
+        
+        slot.Frame = m_Frame;
+        slot.Pending = false;
+        slot.QueryCount = 0;
+        slot.CPUStart = Now();
+        slot.Scopes.clear();
+        slot.OpenScopes.clear();
+        
+        m_InFrame = true;
+        BeginScope("Frame");
+    }
+    
+    void GPUProfiler::EndFrame() {
+        if (!m_InFrame) return;
+        
+        FrameSlot& slot = m_Slots[m_Frame % FrameLatency];
+        while (!slot.OpenScopes.empty()) {
+            EndScope();
+        }
+        
+        slot.Pending = true;
+        m_InFrame = false;
+        m_Frame++;
+    }
+    
+    void GPUProfiler::BeginScope(const std::string& name) {
+        if (!m_InFrame) return;
+        
+        uint32_t slotIndex = static_cast<uint32_t>(m_Frame % FrameLatency);
+        FrameSlot& slot = m_Slots[slotIndex];
+        
+        if (slot.Scopes.size() >= MaxScopesPerFrame) {
+            slot.OpenScopes.push_back(s_DroppedScope);
+            return;
+        }
+        
+        PendingScope scope;
+        scope.Name = name;
+        scope.Depth = static_cast<uint32_t>(slot.OpenScopes.size());
+        scope.BeginQuery = slot.QueryCount++;
+        scope.EndQuery = scope.BeginQuery;
+        scope.CPUStart = Now();
+        scope.CPUEnd = scope.CPUStart;
+        
+        WriteTimestamp(slotIndex, scope.BeginQuery);
+        
+        slot.OpenScopes.push_back(static_cast<uint32_t>(slot.Scopes.size()));
+        slot.Scopes.push_back(std::move(scope));
+    }
+    
+    void GPUProfiler::EndScope() {
+        if (!m_InFrame) return;
+        
+        uint32_t slotIndex = static_cast<uint32_t>(m_Frame % FrameLatency);
+        FrameSlot& slot = m_Slots[slotIndex];
+        if (slot.OpenScopes.empty()) return;
+        
+        uint32_t index = slot.OpenScopes.back();
+        slot.OpenScopes.pop_back();
+        if (index == s_DroppedScope) return;
+        
+        PendingScope& scope = slot.Scopes[index];
+        scope.EndQuery = slot.QueryCount++;
+        scope.CPUEnd = Now();
+        
+        WriteTimestamp(slotIndex, scope.EndQuery);
+    }
+    
+    void GPUProfiler::Resolve(FrameSlot& slot, uint32_t slotIndex) {
+        slot.Pending = false;
+        if (slot.Scopes.empty()) return;
+        
+        m_Timestamps.resize(slot.QueryCount);
+        if (!ReadTimestamps(slotIndex, slot.QueryCount, m_Timestamps.data())) {
+            return;
+        }
+        
+        // GPU time is placed on the CPU timeline by anchoring the frame's first timestamp
+        // to the CPU time at which the frame began
+        uint64_t base = m_Timestamps[slot.Scopes[0].BeginQuery];
+        
+        FrameResult result;
+        result.Frame = slot.Frame;
+        result.Scopes.reserve(slot.Scopes.size());
+        
+        for (const auto& scope : slot.Scopes) {
+            uint64_t begin = m_Timestamps[scope.BeginQuery];
+            uint64_t end = m_Timestamps[scope.EndQuery];
+            
+            ScopeResult scopeResult;
+            scopeResult.Name = scope.Name;
+            scopeResult.Depth = scope.Depth;
+            scopeResult.CPUStart = scope.CPUStart;
+            scopeResult.CPUTime = scope.CPUEnd - scope.CPUStart;
+            scopeResult.GPUStart = slot.CPUStart + (begin >= base ? begin - base : 0) / 1.0e6;
+            scopeResult.GPUTime = (end >= begin ? end - begin : 0) / 1.0e6;
+            result.Scopes.push_back(std::move(scopeResult));
+        }
+        
+        std::lock_guard<std::mutex> lock(m_ResultMutex);
+        m_History.push_back(std::move(result));
+        while (m_History.size() > HistorySize) {
+            m_History.pop_front();
+        }
+    }
+    
+    GPUProfiler::FrameResult GPUProfiler::GetLatestResult() const {
+        std::lock_guard<std::mutex> lock(m_ResultMutex);
+        return m_History.empty() ? FrameResult() : m_History.back();
+    }
+    
+    bool GPUProfiler::ExportTrace(const std::string& filepath) const {
+        std::ofstream out(filepath);
+        if (!out) {
+            std::cerr << "Failed to open trace file: " << filepath << std::endl;
+            return false;
+        }
+        
+        std::lock_guard<std::mutex> lock(m_ResultMutex);
+        
+        out << "{\"traceEvents\":[\n";
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"Render (CPU)\"}},\n";
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+        
+        for (const auto& frame : m_History) {
+            for (const auto& scope : frame.Scopes) {
+                std::string name = EscapeJSON(scope.Name);
+                
+                // Trace timestamps are in microseconds
+                out << ",\n{\"name\":\"" << name << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+                    << ",\"ts\":" << scope.CPUStart * 1000.0 << ",\"dur\":" << scope.CPUTime * 1000.0
+                    << ",\"args\":{\"frame\":" << frame.Frame << "}}";
+                out << ",\n{\"name\":\"" << name << "\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":1,\"tid\":2"
+                    << ",\"ts\":" << scope.GPUStart * 1000.0 << ",\"dur\":" << scope.GPUTime * 1000.0
+                    << ",\"args\":{\"frame\":" << frame.Frame << "}}";
+            }
+        }
+        
+        out << "\n]}\n";
+        
+        std::cout << "GPU trace written to " << filepath << " (" << m_History.size() << " frames)" << std::endl;
+        return true;
+    }
+    
+}
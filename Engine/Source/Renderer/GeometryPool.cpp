@@ -0,0 +1,310 @@
+#include "SpoonEngine/Renderer/GeometryPool.h"
+#include "SpoonEngine/Core/Profiler.h"
+
+#include <algorithm>
+#include <string>
+
+namespace SpoonEngine {
+    
+    struct GeometryBlock {
+        RangeAllocator VertexRanges;
+        RangeAllocator IndexRanges;
+        
+        std::vector<std::shared_ptr<VertexBuffer>> Streams;
+        std::shared_ptr<IndexBuffer> Indices;
+        std::shared_ptr<VertexArray> Array;
+        std::shared_ptr<VertexArray> StreamArray;
+        
+        std::vector<GeometryAllocation*> Allocations;
+    };
+    
+    uint32_t GeometryPool::s_BlockVertices = GeometryPool::DefaultBlockVertices;
+    uint32_t GeometryPool::s_BlockIndices = GeometryPool::DefaultBlockIndices;
+    
+    // Pools stay alive through their allocations; the registry only finds them again
+    static std::map<std::string, std::weak_ptr<GeometryPool>>& GetPoolRegistry() {
+        static std::map<std::string, std::weak_ptr<GeometryPool>> registry;
+        return registry;
+    }
+    
+    static std::string GetFormatKey(const GeometryPoolFormat& format) {
+        std::string key = format.Indices == IndexType::UInt16 ? "u16" : "u32";
+        for (const auto& layout : format.Streams) {
+            key += "|";
+            for (const auto& element : layout) {
+                key += std::to_string(element.Location) + ":" + std::to_string(static_cast<int>(element.Type)) +
+                       (element.Normalized ? "n," : ",");
+            }
+        }
+        return key;
+    }
+    
+    // Range Allocator
+    RangeAllocator::RangeAllocator(uint32_t capacity)
+        : m_Capacity(capacity) {
+        if (capacity > 0) {
+            m_FreeRanges[0] = capacity;
+        }
+    }
+    
+    uint32_t RangeAllocator::Allocate(uint32_t size) {
+        if (size == 0) return InvalidOffset;
+        
+        for (auto it = m_FreeRanges.begin(); it != m_FreeRanges.end(); ++it) {
+            if (it->second < size) continue;
+            
+            uint32_t offset = it->first;
+            uint32_t remaining = it->second - size;
+            m_FreeRanges.erase(it);
+            if (remaining > 0) {
+                m_FreeRanges[offset + size] = remaining;
+            }
+            
+            m_Used += size;
+            return offset;
+        }
+        return InvalidOffset;
+    }
+    
+    void RangeAllocator::Free(uint32_t offset, uint32_t size) {
+        if (size == 0) return;
+        m_Used -= size;
+        
+        auto next = m_FreeRanges.lower_bound(offset);
+        
+        // Merge with the free range right after, then the one right before
+        if (next != m_FreeRanges.end() && offset + size == next->first) {
+            size += next->second;
+            next = m_FreeRanges.erase(next);
+        }
+        if (next != m_FreeRanges.begin()) {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == offset) {
+                previous->second += size;
+                return;
+            }
+        }
+        m_FreeRanges[offset] = size;
+    }
+    
+    bool RangeAllocator::IsFragmented() const {
+        if (m_FreeRanges.empty()) return false;
+        if (m_FreeRanges.size() > 1) return true;
+        
+        const auto& range = *m_FreeRanges.begin();
+        return range.first + range.second != m_Capacity;
+    }
+    
+    // Geometry Allocation
+    GeometryAllocation::~GeometryAllocation() {
+        if (m_Pool) {
+            m_Pool->Free(this);
+        }
+    }
+    
+    void GeometryAllocation::SetVertexData(uint32_t stream, const void* data) {
+        uint32_t stride = m_Pool->m_Format.Streams[stream].GetStride();
+        m_Block->Streams[stream]->SetSubData(data, m_VertexCount * stride, m_VertexOffset * stride);
+    }
+    
+    void GeometryAllocation::SetIndexData(const uint32_t* indices, uint32_t count, uint32_t offset) {
+        m_Block->Indices->SetSubData(indices, count, m_IndexOffset + offset);
+    }
+    
+    const std::shared_ptr<VertexArray>& GeometryAllocation::GetVertexArray() const {
+        return m_Block->Array;
+    }
+    
+    const std::shared_ptr<VertexArray>& GeometryAllocation::GetStreamVertexArray() const {
+        return m_Block->StreamArray;
+    }
+    
+    IndexType GeometryAllocation::GetIndexType() const {
+        return m_Pool->m_Format.Indices;
+    }
+    
+    // Geometry Pool
+    GeometryPool::GeometryPool(const GeometryPoolFormat& format)
+        : m_Format(format) {
+    }
+    
+    GeometryPool::~GeometryPool() {
+    }
+    
+    std::shared_ptr<GeometryPool> GeometryPool::Get(const GeometryPoolFormat& format) {
+        auto& registry = GetPoolRegistry();
+        auto& entry = registry[GetFormatKey(format)];
+        
+        auto pool = entry.lock();
+        if (!pool) {
+            pool = std::make_shared<GeometryPool>(format);
+            entry = pool;
+        }
+        return pool;
+    }
+    
+    std::unique_ptr<GeometryAllocation> GeometryPool::Allocate(uint32_t vertexCount, uint32_t indexCount) {
+        for (auto& block : m_Blocks) {
+            if (auto allocation = AllocateFromBlock(*block, vertexCount, indexCount)) {
+                return allocation;
+            }
+        }
+        
+        auto block = CreateBlock(std::max(s_BlockVertices, vertexCount), std::max(s_BlockIndices, indexCount));
+        if (!block) return nullptr;
+        
+        m_Blocks.push_back(std::move(block));
+        return AllocateFromBlock(*m_Blocks.back(), vertexCount, indexCount);
+    }
+    
+    std::unique_ptr<GeometryAllocation> GeometryPool::AllocateFromBlock(GeometryBlock& block, uint32_t vertexCount, uint32_t indexCount) {
+        uint32_t vertexOffset = 0;
+        if (vertexCount > 0) {
+            vertexOffset = block.VertexRanges.Allocate(vertexCount);
+            if (vertexOffset == RangeAllocator::InvalidOffset) return nullptr;
+        }
+        
+        uint32_t indexOffset = 0;
+        if (indexCount > 0) {
+            indexOffset = block.IndexRanges.Allocate(indexCount);
+            if (indexOffset == RangeAllocator::InvalidOffset) {
+                block.VertexRanges.Free(vertexOffset, vertexCount);
+                return nullptr;
+            }
+        }
+        
+        std::unique_ptr<GeometryAllocation> allocation(new GeometryAllocation());
+        allocation->m_Pool = shared_from_this();
+        allocation->m_Block = &block;
+        allocation->m_VertexOffset = vertexOffset;
+        allocation->m_VertexCount = vertexCount;
+        allocation->m_IndexOffset = indexOffset;
+        allocation->m_IndexCount = indexCount;
+        
+        block.Allocations.push_back(allocation.get());
+        return allocation;
+    }
+    
+    void GeometryPool::Free(GeometryAllocation* allocation) {
+        GeometryBlock& block = *allocation->m_Block;
+        block.VertexRanges.Free(allocation->m_VertexOffset, allocation->m_VertexCount);
+        block.IndexRanges.Free(allocation->m_IndexOffset, allocation->m_IndexCount);
+        
+        auto it = std::find(block.Allocations.begin(), block.Allocations.end(), allocation);
+        if (it != block.Allocations.end()) {
+            *it = block.Allocations.back();
+            block.Allocations.pop_back();
+        }
+    }
+    
+    std::unique_ptr<GeometryBlock> GeometryPool::CreateBlock(uint32_t vertices, uint32_t indices) const {
+        auto block = std::make_unique<GeometryBlock>();
+        block->VertexRanges = RangeAllocator(vertices);
+        block->IndexRanges = RangeAllocator(indices);
+        
+        block->Array = VertexArray::Create();
+        block->Indices = IndexBuffer::Create(indices, m_Format.Indices);
+        if (!block->Array || !block->Indices) return nullptr;
+        
+        for (const auto& layout : m_Format.Streams) {
+            auto stream = VertexBuffer::Create(vertices * layout.GetStride());
+            if (!stream) return nullptr;
+            
+            stream->SetLayout(layout);
+            block->Array->AddVertexBuffer(stream);
+            block->Streams.push_back(stream);
+        }
+        block->Array->SetIndexBuffer(block->Indices);
+        
+        if (block->Streams.size() > 1) {
+            block->StreamArray = VertexArray::Create();
+            block->StreamArray->AddVertexBuffer(block->Streams[0]);
+            block->StreamArray->SetIndexBuffer(block->Indices);
+        }
+        return block;
+    }
+    
+    void GeometryPool::Defragment() {
+        SPOON_PROFILE_FUNCTION();
+        
+        for (auto& block : m_Blocks) {
+            if (block->Allocations.empty()) continue;
+            if (!block->VertexRanges.IsFragmented() && !block->IndexRanges.IsFragmented()) continue;
+            
+            auto packed = CreateBlock(block->VertexRanges.GetCapacity(), block->IndexRanges.GetCapacity());
+            if (!packed) continue;
+            
+            // Keep the existing order so neighbouring meshes stay neighbours in memory
+            auto& allocations = block->Allocations;
+            std::sort(allocations.begin(), allocations.end(), [](const GeometryAllocation* a, const GeometryAllocation* b) {
+                return a->m_VertexOffset < b->m_VertexOffset;
+            });
+            
+            for (GeometryAllocation* allocation : allocations) {
+                if (allocation->m_VertexCount > 0) {
+                    uint32_t offset = packed->VertexRanges.Allocate(allocation->m_VertexCount);
+                    for (size_t s = 0; s < m_Format.Streams.size(); s++) {
+                        uint32_t stride = m_Format.Streams[s].GetStride();
+                        packed->Streams[s]->CopyFrom(*block->Streams[s], allocation->m_VertexOffset * stride,
+                                                     offset * stride, allocation->m_VertexCount * stride);
+                    }
+                    allocation->m_VertexOffset = offset;
+                }
+                if (allocation->m_IndexCount > 0) {
+                    uint32_t offset = packed->IndexRanges.Allocate(allocation->m_IndexCount);
+                    packed->Indices->CopyFrom(*block->Indices, allocation->m_IndexOffset, offset, allocation->m_IndexCount);
+                    allocation->m_IndexOffset = offset;
+                }
+            }
+            
+            // Move the contents so allocations keep pointing at the same block
+            packed->Allocations = std::move(allocations);
+            *block = std::move(*packed);
+        }
+        
+        m_Blocks.erase(std::remove_if(m_Blocks.begin(), m_Blocks.end(), [](const std::unique_ptr<GeometryBlock>& block) {
+            return block->Allocations.empty();
+        }), m_Blocks.end());
+    }
+    
+    void GeometryPool::DefragmentAll() {
+        for (auto& entry : GetPoolRegistry()) {
+            if (auto pool = entry.second.lock()) {
+                pool->Defragment();
+            }
+        }
+    }
+    
+    GeometryPoolStats GeometryPool::GetStats() {
+        GeometryPoolStats stats;
+        for (auto& entry : GetPoolRegistry()) {
+            auto pool = entry.second.lock();
+            if (!pool) continue;
+            
+            uint32_t vertexSize = 0;
+            for (const auto& layout : pool->m_Format.Streams) {
+                vertexSize += layout.GetStride();
+            }
+            
+            stats.Pools++;
+            for (const auto& block : pool->m_Blocks) {
+                stats.Blocks++;
+                stats.Allocations += static_cast<uint32_t>(block->Allocations.size());
+                stats.VertexCapacity += block->VertexRanges.GetCapacity();
+                stats.VerticesUsed += block->VertexRanges.GetUsed();
+                stats.IndexCapacity += block->IndexRanges.GetCapacity();
+                stats.IndicesUsed += block->IndexRanges.GetUsed();
+                stats.FreeRanges += block->VertexRanges.GetFreeRangeCount() + block->IndexRanges.GetFreeRangeCount();
+                stats.Bytes += static_cast<uint64_t>(block->VertexRanges.GetCapacity()) * vertexSize +
+                               static_cast<uint64_t>(block->IndexRanges.GetCapacity()) * IndexTypeSize(pool->m_Format.Indices);
+            }
+        }
+        return stats;
+    }
+    
+    void GeometryPool::SetBlockSize(uint32_t vertices, uint32_t indices) {
+        s_BlockVertices = std::max(1u, vertices);
+        s_BlockIndices = std::max(1u, indices);
+    }
+    
+}
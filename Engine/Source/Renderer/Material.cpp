@@ -1,19 +1,96 @@
 #include "SpoonEngine/Renderer/Material.h"
 #include "SpoonEngine/Renderer/Shader.h"
 #include "SpoonEngine/Assets/Texture.h"
+#include "SpoonEngine/Assets/Mesh.h"
 
 namespace SpoonEngine {
     
+    static const char* s_PlaceholderVertexSource = R"(
+        layout (location = 0) in vec3 a_Position;
+        layout (location = 1) in vec4 a_Normal;
+        
+        uniform mat4 u_Model;
+        uniform mat4 u_View;
+        uniform mat4 u_Projection;
+        
+        out vec3 v_Normal;
+        
+        // Same expression as the depth pre-pass, which the main pass tests against with EQUAL
+        invariant gl_Position;
+        
+        void main() {
+            v_Normal = mat3(u_Model) * DecodeNormal(a_Normal);
+            
+            vec3 worldPos = vec3(u_Model * vec4(a_Position, 1.0));
+            gl_Position = u_Projection * u_View * vec4(worldPos, 1.0);
+        }
+    )";
+    
+    static const char* s_PlaceholderFragmentSource = R"(
+        #version 330 core
+        
+        in vec3 v_Normal;
+        
+        out vec4 FragColor;
+        
+        void main() {
+            // Grey lit from above, so the shape reads without any lights bound
+            float shade = 0.55 + 0.35 * normalize(v_Normal).y;
+            FragColor = vec4(vec3(shade), 1.0);
+        }
+    )";
+    
+    static std::shared_ptr<Shader> s_PlaceholderShader;
+    
     Material::Material(const std::string& name)
         : m_Name(name) {
     }
     
     Material::Material(std::shared_ptr<Shader> shader, const std::string& name)
-        : m_Name(name), m_Shader(shader) {
+        : m_Name(name) {
+        SetShader(shader);
+    }
+    
+    void Material::SetShader(std::shared_ptr<Shader> shader) {
+        m_Shader = shader;
+        m_PlaceholderShader = m_Shader && !m_Shader->IsReady() ? GetPlaceholderShader() : nullptr;
+    }
+    
+    std::shared_ptr<Shader> Material::GetActiveShader() const {
+        if (m_PlaceholderShader && !m_Shader->IsReady()) {
+            return m_PlaceholderShader;
+        }
+        return m_Shader;
+    }
+    
+    void Material::InitPlaceholderShader() {
+        s_PlaceholderShader = Shader::Create("MaterialPlaceholder",
+            std::string("#version 330 core\n") + Mesh::GetVertexDecodeSource() + s_PlaceholderVertexSource,
+            s_PlaceholderFragmentSource);
+        
+        // It stands in for shaders still compiling, so it can never be one itself
+        if (s_PlaceholderShader) {
+            s_PlaceholderShader->WaitUntilReady();
+        }
+    }
+    
+    void Material::ReleasePlaceholderShader() {
+        s_PlaceholderShader.reset();
+    }
+    
+    std::shared_ptr<Shader> Material::GetPlaceholderShader() {
+        return s_PlaceholderShader;
     }
     
     void Material::Bind() {
-        if (m_Shader) {
+        Bind(GetActiveShader());
+    }
+    
+    void Material::Bind(const std::shared_ptr<Shader>& shader) {
+        if (shader && shader != m_Shader) {
+            // The placeholder reads none of the material's parameters
+            shader->Bind();
+        } else if (m_Shader) {
             m_Shader->Bind();
             
             // Bind textures
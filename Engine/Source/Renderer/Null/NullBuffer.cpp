@@ -0,0 +1,123 @@
+#include "SpoonEngine/Renderer/Null/NullBuffer.h"
+#include "SpoonEngine/Renderer/Null/NullRenderer.h"
+
+namespace SpoonEngine {
+    
+    // Vertex Buffer
+    NullVertexBuffer::NullVertexBuffer(uint32_t size) {
+    }
+    
+    NullVertexBuffer::NullVertexBuffer(float* vertices, uint32_t size) {
+        NullRenderer::GetFrameStats().UploadedBytes += size;
+    }
+    
+    void NullVertexBuffer::Bind() const {
+        NullRenderer::GetFrameStats().StateChanges++;
+    }
+    
+    void NullVertexBuffer::SetData(const void* data, uint32_t size) {
+        NullRenderer::GetFrameStats().UploadedBytes += size;
+    }
+    
+    void NullVertexBuffer::SetSubData(const void* data, uint32_t size, uint32_t offset) {
+        NullRenderer::GetFrameStats().UploadedBytes += size;
+    }
+    
+    // Index Buffer
+    NullIndexBuffer::NullIndexBuffer(const void* indices, uint32_t count, IndexType type)
+        : m_Count(count), m_Type(type) {
+        if (indices) {
+            NullRenderer::GetFrameStats().UploadedBytes += count * IndexTypeSize(type);
+        }
+    }
+    
+    void NullIndexBuffer::SetSubData(const uint32_t* indices, uint32_t count, uint32_t offset) {
+        NullRenderer::GetFrameStats().UploadedBytes += count * IndexTypeSize(m_Type);
+    }
+    
+    void NullIndexBuffer::Bind() const {
+        NullRenderer::GetFrameStats().StateChanges++;
+    }
+    
+    // Indirect Buffer
+    NullIndirectBuffer::NullIndirectBuffer(uint32_t maxCommands)
+        : m_MaxCommands(maxCommands) {
+        m_Commands.reserve(maxCommands);
+    }
+    
+    void NullIndirectBuffer::Bind() const {
+        NullRenderer::GetFrameStats().StateChanges++;
+    }
+    
+    void NullIndirectBuffer::SetData(const DrawElementsIndirectCommand* commands, uint32_t count) {
+        if (count > m_MaxCommands) {
+            count = m_MaxCommands;
+        }
+        
+        m_Commands.assign(commands, commands + count);
+        NullRenderer::GetFrameStats().UploadedBytes += count * sizeof(DrawElementsIndirectCommand);
+    }
+    
+    // Uniform Buffer
+    NullUniformBuffer::NullUniformBuffer(uint32_t size)
+        : m_Size(size) {
+    }
+    
+    void NullUniformBuffer::Bind(uint32_t binding) const {
+        NullRenderer::GetFrameStats().StateChanges++;
+    }
+    
+    void NullUniformBuffer::SetData(const void* data, uint32_t size, uint32_t offset) {
+        NullRenderer::GetFrameStats().UploadedBytes += size;
+    }
+    
+    // Vertex Array
+    void NullVertexArray::Bind() const {
+        NullRenderer::GetFrameStats().StateChanges++;
+    }
+    
+    void NullVertexArray::AddVertexBuffer(const std::shared_ptr<VertexBuffer>& vertexBuffer) {
+        m_VertexBuffers.push_back(vertexBuffer);
+    }
+    
+    void NullVertexArray::SetIndexBuffer(const std::shared_ptr<IndexBuffer>& indexBuffer) {
+        m_IndexBuffer = indexBuffer;
+    }
+    
+    // Streaming Buffer
+    NullStreamingBuffer::NullStreamingBuffer(StreamingBufferUsage usage, uint32_t frameCapacity)
+        : m_Storage(frameCapacity) {
+    }
+    
+    StreamingAllocation NullStreamingBuffer::Allocate(uint32_t size) {
+        StreamingAllocation allocation;
+        
+        if (m_Frame != NullRenderer::GetFrameIndex()) {
+            m_Frame = NullRenderer::GetFrameIndex();
+            m_Head = 0;
+        }
+        
+        if (m_Head + size > m_Storage.size()) {
+            return allocation;
+        }
+        
+        allocation.Data = m_Storage.data() + m_Head;
+        allocation.Offset = m_Head;
+        allocation.Size = size;
+        m_Head += size;
+        return allocation;
+    }
+    
+    void NullStreamingBuffer::Commit(const StreamingAllocation& allocation) {
+        NullRenderer::GetFrameStats().UploadedBytes += allocation.Size;
+    }
+    
+    void NullStreamingBuffer::Bind() const {
+        NullRenderer::GetFrameStats().StateChanges++;
+    }
+    
+    void NullStreamingBuffer::BindRange(uint32_t binding, const StreamingAllocation& allocation) const {
+        NullRenderer::GetFrameStats().StateChanges++;
+    }
+    
+}
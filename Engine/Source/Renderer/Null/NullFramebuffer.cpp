@@ -0,0 +1,34 @@
+#include "SpoonEngine/Renderer/Null/NullFramebuffer.h"
+#include "SpoonEngine/Renderer/Null/NullRenderer.h"
+
+namespace SpoonEngine {
+    
+    NullFramebuffer::NullFramebuffer(const FramebufferSpecification& spec)
+        : m_Specification(spec) {
+    }
+    
+    void NullFramebuffer::Bind() {
+        // Framebuffer bind plus the viewport change that goes with it
+        NullRenderer::GetFrameStats().StateChanges += 2;
+    }
+    
+    void NullFramebuffer::Unbind() {
+        NullRenderer::GetFrameStats().StateChanges++;
+    }
+    
+    void NullFramebuffer::BlitDepth(Framebuffer& destination, uint32_t x, uint32_t y) {
+        // Read and draw framebuffer binds
+        NullRenderer::GetFrameStats().StateChanges += 2;
+    }
+    
+    void NullFramebuffer::ClearDepth(uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+        // Scissor enable, rectangle and disable around the clear
+        NullRenderer::GetFrameStats().StateChanges += 3;
+    }
+    
+    void NullFramebuffer::Resize(uint32_t width, uint32_t height) {
+        m_Specification.Width = width;
+        m_Specification.Height = height;
+    }
+    
+}
@@ -0,0 +1,15 @@
+#include "SpoonEngine/Renderer/Null/NullGPUProfiler.h"
+
+namespace SpoonEngine {
+    
+    void NullGPUProfiler::WriteTimestamp(uint32_t slot, uint32_t index) {
+    }
+    
+    bool NullGPUProfiler::ReadTimestamps(uint32_t slot, uint32_t count, uint64_t* nanoseconds) {
+        for (uint32_t i = 0; i < count; i++) {
+            nanoseconds[i] = 0;
+        }
+        return true;
+    }
+    
+}
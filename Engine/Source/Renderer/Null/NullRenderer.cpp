@@ -0,0 +1,80 @@
+#include "SpoonEngine/Renderer/Null/NullRenderer.h"
+#include "SpoonEngine/Renderer/Buffer.h"
+
+#include <iostream>
+
+namespace SpoonEngine {
+    
+    RendererStats NullRenderer::s_FrameStats;
+    RendererStats NullRenderer::s_LastFrameStats;
+    uint64_t NullRenderer::s_FrameIndex = 0;
+    
+    void NullRenderer::Initialize() {
+        std::cout << "Null Renderer initialized" << std::endl;
+    }
+    
+    void NullRenderer::Shutdown() {
+        std::cout << "Null Renderer shutdown" << std::endl;
+    }
+    
+    void NullRenderer::SetViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+        s_FrameStats.StateChanges++;
+    }
+    
+    void NullRenderer::SetClearColor(float r, float g, float b, float a) {
+        s_FrameStats.StateChanges++;
+    }
+    
+    void NullRenderer::Clear() {
+    }
+    
+    void NullRenderer::SetDepthTest(DepthFunc func, bool depthWrite) {
+        s_FrameStats.StateChanges++;
+    }
+    
+    void NullRenderer::SetColorWrite(bool enabled) {
+        s_FrameStats.StateChanges++;
+    }
+    
+    void NullRenderer::BeginSampleCount(SamplePass pass) {
+        // Nothing is rasterized, so sample counts stay at zero
+    }
+    
+    void NullRenderer::EndSampleCount(SamplePass pass) {
+    }
+    
+    void NullRenderer::BeginFrame() {
+        s_FrameStats = RendererStats();
+    }
+    
+    void NullRenderer::EndFrame() {
+        s_LastFrameStats = s_FrameStats;
+        s_FrameIndex++;
+    }
+    
+    void NullRenderer::DrawIndexed(uint32_t indexCount, IndexType indexType) {
+        s_FrameStats.DrawCalls++;
+        s_FrameStats.Triangles += indexCount / 3;
+    }
+    
+    void NullRenderer::DrawIndexedBaseVertex(uint32_t indexCount, uint32_t firstIndex, int32_t baseVertex, IndexType indexType) {
+        s_FrameStats.DrawCalls++;
+        s_FrameStats.Triangles += indexCount / 3;
+    }
+    
+    void NullRenderer::DrawIndexedIndirect(const IndirectBuffer& commands, uint32_t drawCount, IndexType indexType) {
+        const auto& list = commands.GetCommands();
+        uint32_t count = drawCount < list.size() ? drawCount : static_cast<uint32_t>(list.size());
+        if (count == 0) return;
+        
+        // Counted as one submission, like glMultiDrawElementsIndirect
+        s_FrameStats.DrawCalls++;
+        for (uint32_t i = 0; i < count; i++) {
+            s_FrameStats.Triangles += static_cast<uint64_t>(list[i].Count / 3) * list[i].InstanceCount;
+        }
+    }
+    
+    void NullRenderer::Present() {
+    }
+    
+}
@@ -0,0 +1,98 @@
+#include "SpoonEngine/Renderer/Null/NullShader.h"
+#include "SpoonEngine/Renderer/Null/NullRenderer.h"
+
+#include <fstream>
+#include <regex>
+#include <sstream>
+
+namespace SpoonEngine {
+    
+    // Explicit `layout (location = N) in` declarations; fragment inputs rarely carry one
+    static uint32_t ParseVertexInputMask(const std::string& source) {
+        static const std::regex pattern(R"(layout\s*\(\s*location\s*=\s*(\d+)\s*\)\s*in\s)");
+        
+        uint32_t mask = 0;
+        for (auto it = std::sregex_iterator(source.begin(), source.end(), pattern); it != std::sregex_iterator(); ++it) {
+            int location = std::stoi((*it)[1].str());
+            if (location < 32) mask |= 1u << location;
+        }
+        return mask;
+    }
+    
+    NullShader::NullShader(const std::string& filepath) {
+        std::ifstream in(filepath, std::ios::in | std::ios::binary);
+        if (in) {
+            std::stringstream buffer;
+            buffer << in.rdbuf();
+            m_Source = buffer.str();
+            m_VertexInputMask = ParseVertexInputMask(m_Source);
+        }
+        
+        size_t lastSlash = filepath.find_last_of("/\\");
+        lastSlash = lastSlash == std::string::npos ? 0 : lastSlash + 1;
+        size_t lastDot = filepath.rfind('.');
+        size_t count = lastDot == std::string::npos ? filepath.size() - lastSlash : lastDot - lastSlash;
+        m_Name = filepath.substr(lastSlash, count);
+    }
+    
+    NullShader::NullShader(const std::string& name, const std::string& vertexSrc, const std::string& fragmentSrc)
+        : m_Name(name), m_Source(vertexSrc + fragmentSrc), m_VertexInputMask(ParseVertexInputMask(vertexSrc)) {
+    }
+    
+    void NullShader::Bind() const {
+        NullRenderer::GetFrameStats().StateChanges++;
+    }
+    
+    void NullShader::SetInt(const std::string& name, int value) {
+        NullRenderer::GetFrameStats().StateChanges++;
+    }
+    
+    void NullShader::SetIntArray(const std::string& name, int* values, uint32_t count) {
+        NullRenderer::GetFrameStats().StateChanges++;
+    }
+    
+    void NullShader::SetFloat(const std::string& name, float value) {
+        NullRenderer::GetFrameStats().StateChanges++;
+    }
+    
+    void NullShader::SetFloat2(const std::string& name, const glm::vec2& value) {
+        NullRenderer::GetFrameStats().StateChanges++;
+    }
+    
+    void NullShader::SetFloat3(const std::string& name, const glm::vec3& value) {
+        NullRenderer::GetFrameStats().StateChanges++;
+    }
+    
+    void NullShader::SetFloat4(const std::string& name, const glm::vec4& value) {
+        NullRenderer::GetFrameStats().StateChanges++;
+    }
+    
+    void NullShader::SetMat4(const std::string& name, const glm::mat4& value) {
+        NullRenderer::GetFrameStats().StateChanges++;
+    }
+    
+    void NullShader::SetFloat4Array(const std::string& name, const glm::vec4* values, uint32_t count) {
+        NullRenderer::GetFrameStats().StateChanges++;
+    }
+    
+    void NullShader::SetMat4Array(const std::string& name, const glm::mat4* values, uint32_t count) {
+        NullRenderer::GetFrameStats().StateChanges++;
+    }
+    
+    bool NullShader::HasUniformBlock(const std::string& name) const {
+        return m_Source.find("uniform " + name) != std::string::npos;
+    }
+    
+    void NullShader::SetUniformBlockBinding(const std::string& name, uint32_t binding) {
+    }
+    
+    bool NullShader::HasFragmentOutput(const std::string& name) const {
+        // A declaration line like "layout (location = 1) out vec2 name;"
+        size_t position = m_Source.find(" " + name + ";");
+        if (position == std::string::npos) return false;
+        
+        size_t line = m_Source.rfind('\n', position);
+        return m_Source.find("out ", line == std::string::npos ? 0 : line) < position;
+    }
+    
+}
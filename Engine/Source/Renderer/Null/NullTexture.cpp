@@ -0,0 +1,27 @@
+#include "SpoonEngine/Renderer/Null/NullTexture.h"
+#include "SpoonEngine/Renderer/Null/NullRenderer.h"
+
+namespace SpoonEngine {
+    
+    NullTexture2D::NullTexture2D(AssetID id, const std::string& path)
+        : Texture2D(id, path) {
+    }
+    
+    NullTexture2D::NullTexture2D(AssetID id, const std::string& path, const TextureSpecification& specification)
+        : Texture2D(id, path, specification), m_IsLoaded(true) {
+    }
+    
+    bool NullTexture2D::Load() {
+        m_IsLoaded = true;
+        return true;
+    }
+    
+    void NullTexture2D::Bind(uint32_t slot) const {
+        NullRenderer::GetFrameStats().StateChanges++;
+    }
+    
+    void NullTexture2D::SetData(void* data, uint32_t size) {
+        NullRenderer::GetFrameStats().UploadedBytes += size;
+    }
+    
+}
@@ -0,0 +1,366 @@
+#include "SpoonEngine/Renderer/OcclusionCuller.h"
+#include "SpoonEngine/Assets/Mesh.h"
+#include "SpoonEngine/Core/JobSystem.h"
+#include "SpoonEngine/Core/Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define SPOON_OCCLUSION_SSE 1
+#endif
+
+namespace SpoonEngine {
+    
+    // Clip-space w below which a vertex counts as touching the near plane
+    static const float s_NearEpsilon = 1e-5f;
+    
+    OcclusionCuller::OcclusionCuller(uint32_t width, uint32_t height)
+        : m_Width((std::max(width, 4u) + 3) & ~3u), m_Height(std::max(height, 1u)) {
+        
+        // Level 0 holds the rasterized depth; coarser levels halve down to 1x1
+        uint32_t levelWidth = m_Width;
+        uint32_t levelHeight = m_Height;
+        while (true) {
+            m_Levels.push_back({ levelWidth, levelHeight, std::vector<float>(levelWidth * levelHeight, 1.0f) });
+            if (levelWidth == 1 && levelHeight == 1) break;
+            
+            levelWidth = std::max(1u, (levelWidth + 1) / 2);
+            levelHeight = std::max(1u, (levelHeight + 1) / 2);
+        }
+    }
+    
+    void OcclusionCuller::BeginFrame(const glm::mat4& viewProjection) {
+        m_ViewProjection = viewProjection;
+        m_Occluders.clear();
+        m_HasOccluders = false;
+        m_Stats = CullingStats();
+    }
+    
+    void OcclusionCuller::AddOccluder(const Mesh& mesh, const glm::mat4& transform, int32_t subMesh) {
+        if (mesh.GetIndices().empty()) return;
+        if (subMesh >= static_cast<int32_t>(mesh.GetSubMeshCount())) return;
+        m_Occluders.push_back({ &mesh, transform, subMesh });
+    }
+    
+    void OcclusionCuller::Rasterize() {
+        SPOON_PROFILE_SCOPE("OcclusionCuller::Rasterize");
+        auto start = std::chrono::high_resolution_clock::now();
+        
+        uint32_t occluderCount = static_cast<uint32_t>(m_Occluders.size());
+        m_OccluderTriangles.resize(occluderCount);
+        
+        JobSystem::Dispatch(occluderCount, 1, [this](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                m_OccluderTriangles[i].clear();
+                TransformOccluder(m_Occluders[i], m_OccluderTriangles[i]);
+            }
+        });
+        
+        m_Triangles.clear();
+        for (uint32_t i = 0; i < occluderCount; i++) {
+            m_Triangles.insert(m_Triangles.end(), m_OccluderTriangles[i].begin(), m_OccluderTriangles[i].end());
+        }
+        
+        // Bands own disjoint rows, so they can be written without synchronization
+        uint32_t bandCount = (m_Height + BandHeight - 1) / BandHeight;
+        JobSystem::Dispatch(bandCount, 1, [this](uint32_t begin, uint32_t end) {
+            for (uint32_t band = begin; band < end; band++) {
+                RasterizeBand(band * BandHeight, std::min(m_Height, (band + 1) * BandHeight));
+            }
+        });
+        
+        BuildHiZ();
+        
+        m_HasOccluders = !m_Triangles.empty();
+        m_Stats.Occluders = occluderCount;
+        m_Stats.OccluderTriangles = static_cast<uint32_t>(m_Triangles.size());
+        
+        auto end = std::chrono::high_resolution_clock::now();
+        m_Stats.RasterTime = std::chrono::duration<float, std::milli>(end - start).count();
+    }
+    
+    void OcclusionCuller::TransformOccluder(const Occluder& occluder, std::vector<ScreenTriangle>& triangles) const {
+        const auto& vertices = occluder.MeshData->GetVertices();
+        const auto& indices = occluder.MeshData->GetIndices();
+        
+        glm::mat4 mvp = m_ViewProjection * occluder.Transform;
+        
+        std::vector<glm::vec4> clip(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            const Vector3& position = vertices[i].Position;
+            clip[i] = mvp * glm::vec4(position.x, position.y, position.z, 1.0f);
+        }
+        
+        float width = static_cast<float>(m_Width);
+        float height = static_cast<float>(m_Height);
+        
+        uint32_t firstSubMesh = occluder.SubMesh < 0 ? 0 : static_cast<uint32_t>(occluder.SubMesh);
+        uint32_t lastSubMesh = occluder.SubMesh < 0 ? occluder.MeshData->GetSubMeshCount() : firstSubMesh + 1;
+        for (uint32_t s = firstSubMesh; s < lastSubMesh; s++) {
+            SubMesh subMesh = occluder.MeshData->GetSubMesh(s);
+            
+            for (uint32_t i = subMesh.BaseIndex; i + 2 < subMesh.BaseIndex + subMesh.IndexCount; i += 3) {
+                uint32_t a = indices[i] + subMesh.BaseVertex;
+                uint32_t b = indices[i + 1] + subMesh.BaseVertex;
+                uint32_t c = indices[i + 2] + subMesh.BaseVertex;
+                if (a >= clip.size() || b >= clip.size() || c >= clip.size()) continue;
+                
+                const glm::vec4* corners[3] = { &clip[a], &clip[b], &clip[c] };
+                
+                // Skipping a triangle only makes the occluder smaller, so near-plane clipping is not needed
+                bool nearClipped = false;
+                for (const glm::vec4* corner : corners) {
+                    if (corner->w <= s_NearEpsilon || corner->z < -corner->w) {
+                        nearClipped = true;
+                    }
+                }
+                if (nearClipped) continue;
+                
+                ScreenTriangle triangle;
+                float minX = width, maxX = 0.0f;
+                float minY = height, maxY = 0.0f;
+                for (int v = 0; v < 3; v++) {
+                    float invW = 1.0f / corners[v]->w;
+                    triangle.X[v] = (corners[v]->x * invW * 0.5f + 0.5f) * width;
+                    triangle.Y[v] = (corners[v]->y * invW * 0.5f + 0.5f) * height;
+                    triangle.Z[v] = std::min(1.0f, corners[v]->z * invW * 0.5f + 0.5f);
+                    
+                    minX = std::min(minX, triangle.X[v]);
+                    maxX = std::max(maxX, triangle.X[v]);
+                    minY = std::min(minY, triangle.Y[v]);
+                    maxY = std::max(maxY, triangle.Y[v]);
+                }
+                
+                if (maxX < 0.0f || minX >= width || maxY < 0.0f || minY >= height) continue;
+                
+                triangle.MinY = std::max(0, static_cast<int32_t>(std::floor(minY)));
+                triangle.MaxY = std::min(static_cast<int32_t>(m_Height) - 1, static_cast<int32_t>(std::ceil(maxY)));
+                triangles.push_back(triangle);
+            }
+        }
+    }
+    
+    void OcclusionCuller::RasterizeBand(uint32_t minY, uint32_t maxY) {
+        float* depth = m_Levels[0].Depth.data();
+        std::fill(depth + minY * m_Width, depth + maxY * m_Width, 1.0f);
+        
+        for (const auto& triangle : m_Triangles) {
+            int32_t top = std::max(triangle.MinY, static_cast<int32_t>(minY));
+            int32_t bottom = std::min(triangle.MaxY, static_cast<int32_t>(maxY) - 1);
+            if (top <= bottom) {
+                RasterizeTriangle(triangle, top, bottom);
+            }
+        }
+    }
+    
+    void OcclusionCuller::RasterizeTriangle(const ScreenTriangle& t, int32_t minY, int32_t maxY) {
+        // Edge functions E(x, y) = A * x + B * y + C, each the weight of the opposite vertex
+        float a0 = t.Y[1] - t.Y[2], b0 = t.X[2] - t.X[1];
+        float a1 = t.Y[2] - t.Y[0], b1 = t.X[0] - t.X[2];
+        float a2 = t.Y[0] - t.Y[1], b2 = t.X[1] - t.X[0];
+        float c0 = -a0 * t.X[1] - b0 * t.Y[1];
+        float c1 = -a1 * t.X[2] - b1 * t.Y[2];
+        float c2 = -a2 * t.X[0] - b2 * t.Y[0];
+        
+        float area = a0 * t.X[0] + b0 * t.Y[0] + c0;
+        if (std::fabs(area) < 1e-6f) return;
+        
+        // Occluders are rasterized double-sided, so flip clockwise triangles
+        if (area < 0.0f) {
+            a0 = -a0; b0 = -b0; c0 = -c0;
+            a1 = -a1; b1 = -b1; c1 = -c1;
+            a2 = -a2; b2 = -b2; c2 = -c2;
+            area = -area;
+        }
+        
+        // Depth is affine in screen space: z = zA * x + zB * y + zC
+        float dz1 = (t.Z[1] - t.Z[0]) / area;
+        float dz2 = (t.Z[2] - t.Z[0]) / area;
+        float zA = a1 * dz1 + a2 * dz2;
+        float zB = b1 * dz1 + b2 * dz2;
+        float zC = t.Z[0] + c1 * dz1 + c2 * dz2;
+        
+        float minXf = std::min(t.X[0], std::min(t.X[1], t.X[2]));
+        float maxXf = std::max(t.X[0], std::max(t.X[1], t.X[2]));
+        int32_t minX = std::max(0, static_cast<int32_t>(std::floor(minXf))) & ~3;
+        int32_t maxX = std::min(static_cast<int32_t>(m_Width) - 1, static_cast<int32_t>(std::ceil(maxXf)));
+        
+        float* depth = m_Levels[0].Depth.data();
+
+#ifdef SPOON_OCCLUSION_SSE
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 pixelOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 a0v = _mm_set1_ps(a0), a1v = _mm_set1_ps(a1), a2v = _mm_set1_ps(a2), zAv = _mm_set1_ps(zA);
+        
+        for (int32_t y = minY; y <= maxY; y++) {
+            float py = static_cast<float>(y) + 0.5f;
+            __m128 row0 = _mm_set1_ps(b0 * py + c0);
+            __m128 row1 = _mm_set1_ps(b1 * py + c1);
+            __m128 row2 = _mm_set1_ps(b2 * py + c2);
+            __m128 rowZ = _mm_set1_ps(zB * py + zC);
+            float* row = depth + y * m_Width;
+            
+            // Width is a multiple of four, so a group starting at or before maxX stays in the row
+            for (int32_t x = minX; x <= maxX; x += 4) {
+                __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), pixelOffsets);
+                
+                __m128 e0 = _mm_add_ps(_mm_mul_ps(a0v, px), row0);
+                __m128 e1 = _mm_add_ps(_mm_mul_ps(a1v, px), row1);
+                __m128 e2 = _mm_add_ps(_mm_mul_ps(a2v, px), row2);
+                
+                __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+                if (_mm_movemask_ps(inside) == 0) continue;
+                
+                __m128 z = _mm_add_ps(_mm_mul_ps(zAv, px), rowZ);
+                __m128 previous = _mm_loadu_ps(row + x);
+                __m128 closer = _mm_and_ps(inside, _mm_cmplt_ps(z, previous));
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(closer, z), _mm_andnot_ps(closer, previous)));
+            }
+        }
+#else
+        for (int32_t y = minY; y <= maxY; y++) {
+            float py = static_cast<float>(y) + 0.5f;
+            float* row = depth + y * m_Width;
+            
+            for (int32_t x = minX; x <= maxX; x++) {
+                float px = static_cast<float>(x) + 0.5f;
+                if (a0 * px + b0 * py + c0 < 0.0f) continue;
+                if (a1 * px + b1 * py + c1 < 0.0f) continue;
+                if (a2 * px + b2 * py + c2 < 0.0f) continue;
+                
+                float z = zA * px + zB * py + zC;
+                if (z < row[x]) {
+                    row[x] = z;
+                }
+            }
+        }
+#endif
+    }
+    
+    void OcclusionCuller::BuildHiZ() {
+        for (size_t i = 1; i < m_Levels.size(); i++) {
+            const Level& source = m_Levels[i - 1];
+            Level& target = m_Levels[i];
+            
+            for (uint32_t y = 0; y < target.Height; y++) {
+                uint32_t y0 = y * 2;
+                uint32_t y1 = std::min(y0 + 1, source.Height - 1);
+                
+                for (uint32_t x = 0; x < target.Width; x++) {
+                    uint32_t x0 = x * 2;
+                    uint32_t x1 = std::min(x0 + 1, source.Width - 1);
+                    
+                    // Keep the farthest depth so a texel never claims more occlusion than its pixels
+                    float farthest = std::max(
+                        std::max(source.Depth[y0 * source.Width + x0], source.Depth[y0 * source.Width + x1]),
+                        std::max(source.Depth[y1 * source.Width + x0], source.Depth[y1 * source.Width + x1]));
+                    target.Depth[y * target.Width + x] = farthest;
+                }
+            }
+        }
+    }
+    
+    CullResult OcclusionCuller::Test(const BoundingBox& bounds, const glm::mat4& transform) const {
+        if (!bounds.IsValid()) return CullResult::Visible;
+        
+        glm::mat4 mvp = m_ViewProjection * transform;
+        
+        uint32_t outsideAll = 0x3F;
+        bool crossesNear = false;
+        float minX = 1.0f, maxX = -1.0f;
+        float minY = 1.0f, maxY = -1.0f;
+        float minZ = 1.0f;
+        
+        for (int i = 0; i < 8; i++) {
+            glm::vec4 corner(
+                (i & 1) ? bounds.Max.x : bounds.Min.x,
+                (i & 2) ? bounds.Max.y : bounds.Min.y,
+                (i & 4) ? bounds.Max.z : bounds.Min.z,
+                1.0f);
+            glm::vec4 clip = mvp * corner;
+            
+            uint32_t outside = 0;
+            if (clip.x < -clip.w) outside |= 1;
+            if (clip.x >  clip.w) outside |= 2;
+            if (clip.y < -clip.w) outside |= 4;
+            if (clip.y >  clip.w) outside |= 8;
+            if (clip.z < -clip.w) outside |= 16;
+            if (clip.z >  clip.w) outside |= 32;
+            outsideAll &= outside;
+            
+            if (clip.w <= s_NearEpsilon || clip.z < -clip.w) {
+                crossesNear = true;
+                continue;
+            }
+            
+            float invW = 1.0f / clip.w;
+            float x = clip.x * invW, y = clip.y * invW;
+            minX = std::min(minX, x); maxX = std::max(maxX, x);
+            minY = std::min(minY, y); maxY = std::max(maxY, y);
+            minZ = std::min(minZ, clip.z * invW);
+        }
+        
+        // All corners outside the same plane
+        if (outsideAll != 0) return CullResult::FrustumCulled;
+        if (crossesNear || !m_HasOccluders) return CullResult::Visible;
+        
+        float x0 = std::max(0.0f, (minX * 0.5f + 0.5f) * m_Width);
+        float x1 = std::min(static_cast<float>(m_Width - 1), (maxX * 0.5f + 0.5f) * m_Width);
+        float y0 = std::max(0.0f, (minY * 0.5f + 0.5f) * m_Height);
+        float y1 = std::min(static_cast<float>(m_Height - 1), (maxY * 0.5f + 0.5f) * m_Height);
+        if (x0 > x1 || y0 > y1) return CullResult::Visible;
+        
+        float nearest = minZ * 0.5f + 0.5f;
+        
+        // Coarsest level at which the rectangle still spans at most two texels per axis
+        float extent = std::max(x1 - x0, y1 - y0);
+        uint32_t level = 0;
+        while ((1u << (level + 1)) < extent && level + 1 < m_Levels.size()) {
+            level++;
+        }
+        
+        const Level& hiZ = m_Levels[level];
+        uint32_t tx0 = static_cast<uint32_t>(x0) >> level;
+        uint32_t tx1 = std::min(hiZ.Width - 1, static_cast<uint32_t>(x1) >> level);
+        uint32_t ty0 = static_cast<uint32_t>(y0) >> level;
+        uint32_t ty1 = std::min(hiZ.Height - 1, static_cast<uint32_t>(y1) >> level);
+        
+        for (uint32_t y = ty0; y <= ty1; y++) {
+            for (uint32_t x = tx0; x <= tx1; x++) {
+                if (nearest <= hiZ.Depth[y * hiZ.Width + x]) {
+                    return CullResult::Visible;
+                }
+            }
+        }
+        return CullResult::Occluded;
+    }
+    
+    void OcclusionCuller::Test(const std::vector<Item>& items, std::vector<CullResult>& results) {
+        SPOON_PROFILE_SCOPE("OcclusionCuller::Test");
+        auto start = std::chrono::high_resolution_clock::now();
+        
+        uint32_t count = static_cast<uint32_t>(items.size());
+        results.resize(count);
+        
+        JobSystem::Dispatch(count, 256, [this, &items, &results](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                results[i] = Test(items[i].Bounds, items[i].Transform);
+            }
+        });
+        
+        m_Stats.Tested = count;
+        m_Stats.FrustumCulled = 0;
+        m_Stats.Occluded = 0;
+        for (CullResult result : results) {
+            if (result == CullResult::FrustumCulled) m_Stats.FrustumCulled++;
+            if (result == CullResult::Occluded) m_Stats.Occluded++;
+        }
+        
+        auto end = std::chrono::high_resolution_clock::now();
+        m_Stats.TestTime = std::chrono::duration<float, std::milli>(end - start).count();
+    }
+    
+}
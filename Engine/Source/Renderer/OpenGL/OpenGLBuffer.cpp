@@ -1,4 +1,5 @@
 #include "SpoonEngine/Renderer/OpenGL/OpenGLBuffer.h"
+#include "SpoonEngine/Renderer/OpenGL/OpenGLRenderer.h"
 
 #ifdef SPOON_PLATFORM_MACOS
     #define GL_SILENCE_DEPRECATION
@@ -7,6 +8,9 @@
     #include <GL/glew.h>
 #endif
 
+#include <algorithm>
+#include <iostream>
+
 namespace SpoonEngine {
     
     static uint32_t ShaderDataTypeToOpenGLBaseType(ShaderDataType type) {
@@ -22,18 +26,25 @@ namespace SpoonEngine {
             case ShaderDataType::Int3:     return GL_INT;
             case ShaderDataType::Int4:     return GL_INT;
             case ShaderDataType::Bool:     return GL_BOOL;
+            case ShaderDataType::Half2:    return GL_HALF_FLOAT;
+            case ShaderDataType::Half4:    return GL_HALF_FLOAT;
+            case ShaderDataType::Short2N:  return GL_SHORT;
+            case ShaderDataType::Short4N:  return GL_SHORT;
+            case ShaderDataType::Byte4N:   return GL_BYTE;
         }
         return 0;
     }
     
     // Vertex Buffer
-    OpenGLVertexBuffer::OpenGLVertexBuffer(uint32_t size) {
+    OpenGLVertexBuffer::OpenGLVertexBuffer(uint32_t size)
+        : m_Size(size), m_Dynamic(true) {
         glGenBuffers(1, &m_RendererID);
         glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
         glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
     }
     
-    OpenGLVertexBuffer::OpenGLVertexBuffer(float* vertices, uint32_t size) {
+    OpenGLVertexBuffer::OpenGLVertexBuffer(float* vertices, uint32_t size)
+        : m_Size(size) {
         glGenBuffers(1, &m_RendererID);
         glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
         glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
@@ -53,15 +64,55 @@ namespace SpoonEngine {
     
     void OpenGLVertexBuffer::SetData(const void* data, uint32_t size) {
         glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        
+        if (m_Dynamic) {
+            // Orphan the old store instead of waiting for draws that may still read it
+            m_Size = std::max(m_Size, size);
+            glBufferData(GL_ARRAY_BUFFER, m_Size, nullptr, GL_DYNAMIC_DRAW);
+        } else if (size > m_Size) {
+            m_Size = size;
+            glBufferData(GL_ARRAY_BUFFER, m_Size, nullptr, GL_STATIC_DRAW);
+        }
         glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
     }
     
+    void OpenGLVertexBuffer::SetSubData(const void* data, uint32_t size, uint32_t offset) {
+        glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    }
+    
+    void OpenGLVertexBuffer::CopyFrom(const VertexBuffer& source, uint32_t sourceOffset, uint32_t offset, uint32_t size) {
+        glBindBuffer(GL_COPY_READ_BUFFER, static_cast<const OpenGLVertexBuffer&>(source).GetRendererID());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sourceOffset, offset, size);
+    }
+    
     // Index Buffer
-    OpenGLIndexBuffer::OpenGLIndexBuffer(uint32_t* indices, uint32_t count)
-        : m_Count(count) {
+    OpenGLIndexBuffer::OpenGLIndexBuffer(const void* indices, uint32_t count, IndexType type)
+        : m_Count(count), m_Type(type) {
         glGenBuffers(1, &m_RendererID);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(uint32_t), indices, GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * IndexTypeSize(type), indices, indices ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW);
+    }
+    
+    void OpenGLIndexBuffer::SetSubData(const uint32_t* indices, uint32_t count, uint32_t offset) {
+        uint32_t size = IndexTypeSize(m_Type);
+        
+        // The copy-write target leaves the element binding of whatever vertex array is bound alone
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+        if (m_Type == IndexType::UInt16) {
+            std::vector<uint16_t> narrow(indices, indices + count);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, offset * size, count * size, narrow.data());
+        } else {
+            glBufferSubData(GL_COPY_WRITE_BUFFER, offset * size, count * size, indices);
+        }
+    }
+    
+    void OpenGLIndexBuffer::CopyFrom(const IndexBuffer& source, uint32_t sourceOffset, uint32_t offset, uint32_t count) {
+        uint32_t size = IndexTypeSize(m_Type);
+        glBindBuffer(GL_COPY_READ_BUFFER, static_cast<const OpenGLIndexBuffer&>(source).GetRendererID());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sourceOffset * size, offset * size, count * size);
     }
     
     OpenGLIndexBuffer::~OpenGLIndexBuffer() {
@@ -76,6 +127,76 @@ namespace SpoonEngine {
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
     
+    // Indirect Buffer
+    OpenGLIndirectBuffer::OpenGLIndirectBuffer(uint32_t maxCommands)
+        : m_MaxCommands(maxCommands) {
+        m_Commands.reserve(maxCommands);
+        
+        // Pre-4.0 contexts have no GL_DRAW_INDIRECT_BUFFER; the renderer replays m_Commands instead
+        if (OpenGLRenderer::GetCapabilities().DrawIndirect) {
+            glGenBuffers(1, &m_RendererID);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID);
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, maxCommands * sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_DRAW);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
+    }
+    
+    OpenGLIndirectBuffer::~OpenGLIndirectBuffer() {
+        if (m_RendererID) {
+            glDeleteBuffers(1, &m_RendererID);
+        }
+    }
+    
+    void OpenGLIndirectBuffer::Bind() const {
+        if (m_RendererID) {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID);
+        }
+    }
+    
+    void OpenGLIndirectBuffer::Unbind() const {
+        if (m_RendererID) {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
+    }
+    
+    void OpenGLIndirectBuffer::SetData(const DrawElementsIndirectCommand* commands, uint32_t count) {
+        if (count > m_MaxCommands) {
+            std::cout << "Indirect buffer overflow: " << count << " commands, capacity " << m_MaxCommands << std::endl;
+            count = m_MaxCommands;
+        }
+        
+        m_Commands.assign(commands, commands + count);
+        
+        if (m_RendererID) {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID);
+            glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, count * sizeof(DrawElementsIndirectCommand), commands);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
+    }
+    
+    // Uniform Buffer
+    OpenGLUniformBuffer::OpenGLUniformBuffer(uint32_t size)
+        : m_Size(size) {
+        glGenBuffers(1, &m_RendererID);
+        glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+        glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    
+    OpenGLUniformBuffer::~OpenGLUniformBuffer() {
+        glDeleteBuffers(1, &m_RendererID);
+    }
+    
+    void OpenGLUniformBuffer::Bind(uint32_t binding) const {
+        glBindBufferBase(GL_UNIFORM_BUFFER, binding, m_RendererID);
+    }
+    
+    void OpenGLUniformBuffer::SetData(const void* data, uint32_t size, uint32_t offset) {
+        glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+        glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    
     // Vertex Array
     OpenGLVertexArray::OpenGLVertexArray() {
         glGenVertexArrays(1, &m_RendererID);
@@ -99,11 +220,20 @@ namespace SpoonEngine {
         
         const auto& layout = vertexBuffer->GetLayout();
         for (const auto& element : layout) {
+            if (element.Location >= 0) {
+                m_VertexBufferIndex = static_cast<uint32_t>(element.Location);
+            }
+            
             switch (element.Type) {
                 case ShaderDataType::Float:
                 case ShaderDataType::Float2:
                 case ShaderDataType::Float3:
-                case ShaderDataType::Float4: {
+                case ShaderDataType::Float4:
+                case ShaderDataType::Half2:
+                case ShaderDataType::Half4:
+                case ShaderDataType::Short2N:
+                case ShaderDataType::Short4N:
+                case ShaderDataType::Byte4N: {
                     glEnableVertexAttribArray(m_VertexBufferIndex);
                     glVertexAttribPointer(m_VertexBufferIndex,
                         element.GetComponentCount(),
@@ -8,32 +8,122 @@
     #include <GL/glew.h>
 #endif
 
+#include <algorithm>
 #include <iostream>
 
 namespace SpoonEngine {
     
     static const uint32_t s_MaxFramebufferSize = 8192;
     
+    // Settled resizes round the attachments up to this, so small size changes reuse them
+    static const uint32_t s_ResizeGranularity = 64;
+    // How long the size has to stay unchanged before the attachments follow a resize
+    static const float s_ResizeSettleTime = 0.25f;
+    
+    // Textures given up by resizes, reused by attachments of the same format, samples and size
+    struct PooledTexture {
+        uint32_t RendererID = 0;
+        GLenum InternalFormat = 0;
+        uint32_t Samples = 1;
+        uint32_t Width = 0, Height = 0;
+        std::chrono::steady_clock::time_point Released;
+    };
+    
+    static std::vector<PooledTexture> s_TexturePool;
+    static const size_t s_MaxPooledTextures = 32;
+    static const float s_PooledTextureLifetime = 5.0f;
+    
+    // Readbacks in flight, oldest at s_ReadbackHead. Each slot keeps its pixel-pack buffer
+    // between uses and only grows it.
+    struct PendingReadback {
+        uint32_t Buffer = 0;
+        uint32_t Capacity = 0;
+        GLsync Fence = nullptr;
+        FramebufferReadback Result;
+        FramebufferReadbackCallback Callback;
+    };
+    
+    static const uint32_t s_ReadbackRingSize = 8;
+    static PendingReadback s_Readbacks[s_ReadbackRingSize];
+    static uint32_t s_ReadbackHead = 0;
+    static uint32_t s_ReadbackCount = 0;
+    
     namespace Utils {
         
         static GLenum TextureTarget(bool multisampled) {
             return multisampled ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D;
         }
         
-        static void CreateTextures(bool multisampled, uint32_t* outID, uint32_t count) {
-            glGenTextures(count, outID);
-        }
-        
         static void BindTexture(bool multisampled, uint32_t id) {
             glBindTexture(TextureTarget(multisampled), id);
         }
         
-        static void AttachColorTexture(uint32_t id, int samples, GLenum internalFormat, GLenum format, uint32_t width, uint32_t height, int index) {
+        // A texture from the pool when one matches, otherwise a new one; allocate tells whether
+        // it still needs storage
+        static uint32_t AcquireTexture(GLenum internalFormat, uint32_t samples, uint32_t width, uint32_t height, bool& allocate) {
+            for (size_t i = 0; i < s_TexturePool.size(); i++) {
+                const PooledTexture& pooled = s_TexturePool[i];
+                if (pooled.InternalFormat == internalFormat && pooled.Samples == samples &&
+                    pooled.Width == width && pooled.Height == height) {
+                    uint32_t id = pooled.RendererID;
+                    s_TexturePool.erase(s_TexturePool.begin() + i);
+                    allocate = false;
+                    return id;
+                }
+            }
+            
+            uint32_t id = 0;
+            glGenTextures(1, &id);
+            allocate = true;
+            return id;
+        }
+        
+        static void ReleaseTexture(uint32_t id, GLenum internalFormat, uint32_t samples, uint32_t width, uint32_t height) {
+            if (!id) return;
+            if (!internalFormat) {
+                glDeleteTextures(1, &id);
+                return;
+            }
+            
+            if (s_TexturePool.size() >= s_MaxPooledTextures) {
+                glDeleteTextures(1, &s_TexturePool.front().RendererID);
+                s_TexturePool.erase(s_TexturePool.begin());
+            }
+            
+            PooledTexture pooled;
+            pooled.RendererID = id;
+            pooled.InternalFormat = internalFormat;
+            pooled.Samples = samples;
+            pooled.Width = width;
+            pooled.Height = height;
+            pooled.Released = std::chrono::steady_clock::now();
+            s_TexturePool.push_back(pooled);
+        }
+        
+        // Frees pooled textures nothing has reused for a while; the pool is ordered by release time
+        static void TrimTexturePool() {
+            auto now = std::chrono::steady_clock::now();
+            size_t expired = 0;
+            while (expired < s_TexturePool.size() &&
+                   std::chrono::duration<float>(now - s_TexturePool[expired].Released).count() > s_PooledTextureLifetime) {
+                glDeleteTextures(1, &s_TexturePool[expired].RendererID);
+                expired++;
+            }
+            s_TexturePool.erase(s_TexturePool.begin(), s_TexturePool.begin() + expired);
+        }
+        
+        static uint32_t RoundUpResize(uint32_t size) {
+            return std::min((size + s_ResizeGranularity - 1) / s_ResizeGranularity * s_ResizeGranularity, s_MaxFramebufferSize);
+        }
+        
+        static void AttachColorTexture(uint32_t id, int samples, GLenum internalFormat, GLenum format, GLenum type, uint32_t width, uint32_t height, int index, bool allocate) {
             bool multisampled = samples > 1;
-            if (multisampled) {
+            if (!allocate) {
+                // Reused from the pool with its storage and parameters
+            } else if (multisampled) {
                 glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, samples, internalFormat, width, height, GL_FALSE);
             } else {
-                glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+                glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
                 
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -45,9 +135,11 @@ namespace SpoonEngine {
             glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + index, TextureTarget(multisampled), id, 0);
         }
         
-        static void AttachDepthTexture(uint32_t id, int samples, GLenum format, GLenum attachmentType, uint32_t width, uint32_t height) {
+        static void AttachDepthTexture(uint32_t id, int samples, GLenum format, GLenum attachmentType, uint32_t width, uint32_t height, bool allocate) {
             bool multisampled = samples > 1;
-            if (multisampled) {
+            if (!allocate) {
+                // Reused from the pool with its storage and parameters
+            } else if (multisampled) {
                 glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, samples, format, width, height, GL_FALSE);
             } else {
                 // Use glTexImage2D instead of glTexStorage2D for better compatibility
@@ -62,6 +154,47 @@ namespace SpoonEngine {
             glFramebufferTexture2D(GL_FRAMEBUFFER, attachmentType, TextureTarget(multisampled), id, 0);
         }
         
+        // Internal format, pixel format and type of a color attachment; false for None and depth
+        static bool ColorTextureFormat(FramebufferTextureFormat textureFormat, GLenum& internalFormat, GLenum& format, GLenum& type) {
+            switch (textureFormat) {
+                case FramebufferTextureFormat::None:
+                    return false;
+                case FramebufferTextureFormat::RGBA8:
+                    internalFormat = GL_RGBA8; format = GL_RGBA; type = GL_UNSIGNED_BYTE;
+                    return true;
+                case FramebufferTextureFormat::RED_INTEGER:
+                    internalFormat = GL_R32I; format = GL_RED_INTEGER; type = GL_UNSIGNED_BYTE;
+                    return true;
+                case FramebufferTextureFormat::RGBA16F:
+                    internalFormat = GL_RGBA16F; format = GL_RGBA; type = GL_FLOAT;
+                    return true;
+                case FramebufferTextureFormat::RG16:
+                    internalFormat = GL_RG16; format = GL_RG; type = GL_UNSIGNED_SHORT;
+                    return true;
+                case FramebufferTextureFormat::R11G11B10F:
+                    internalFormat = GL_R11F_G11F_B10F; format = GL_RGB; type = GL_FLOAT;
+                    return true;
+                case FramebufferTextureFormat::DEPTH24STENCIL8:
+                    // Depth format in color attachment - should not happen
+                    return false;
+            }
+            
+            return false;
+        }
+        
+        // Pixel format and type a color attachment is read back with; returns the bytes per pixel, 0 when unsupported
+        static uint32_t ReadbackFormat(GLenum internalFormat, GLenum& format, GLenum& type) {
+            switch (internalFormat) {
+                case GL_RGBA8:          format = GL_RGBA;        type = GL_UNSIGNED_BYTE;  return 4;
+                case GL_R32I:           format = GL_RED_INTEGER; type = GL_INT;            return 4;
+                case GL_RGBA16F:        format = GL_RGBA;        type = GL_HALF_FLOAT;     return 8;
+                case GL_RG16:           format = GL_RG;          type = GL_UNSIGNED_SHORT; return 4;
+                case GL_R11F_G11F_B10F: format = GL_RGB;         type = GL_FLOAT;          return 12;
+            }
+            
+            return 0;
+        }
+        
         static bool IsDepthFormat(FramebufferTextureFormat format) {
             switch (format) {
                 case FramebufferTextureFormat::DEPTH24STENCIL8: return true;
@@ -74,6 +207,9 @@ namespace SpoonEngine {
                 case FramebufferTextureFormat::None:            return 0;
                 case FramebufferTextureFormat::RGBA8:           return GL_RGBA8;
                 case FramebufferTextureFormat::RED_INTEGER:     return GL_RED_INTEGER;
+                case FramebufferTextureFormat::RGBA16F:         return GL_RGBA16F;
+                case FramebufferTextureFormat::RG16:            return GL_RG16;
+                case FramebufferTextureFormat::R11G11B10F:      return GL_R11F_G11F_B10F;
                 case FramebufferTextureFormat::DEPTH24STENCIL8: return GL_DEPTH24_STENCIL8;
             }
             
@@ -92,6 +228,9 @@ namespace SpoonEngine {
                 m_DepthAttachmentSpec = spec;
         }
         
+        m_Width = m_AttachmentWidth = m_Specification.Width;
+        m_Height = m_AttachmentHeight = m_Specification.Height;
+        
         Invalidate();
     }
     
@@ -99,21 +238,48 @@ namespace SpoonEngine {
         glDeleteFramebuffers(1, &m_RendererID);
         glDeleteTextures(m_ColorAttachments.size(), m_ColorAttachments.data());
         glDeleteTextures(1, &m_DepthAttachment);
+        
+        // Wrappers still held elsewhere must not delete the ids again once GL reuses them
+        for (auto& texture : m_ColorAttachmentTextures) {
+            static_cast<OpenGLTexture2D&>(*texture).m_RendererID = 0;
+        }
+        if (m_DepthAttachmentTexture) {
+            static_cast<OpenGLTexture2D&>(*m_DepthAttachmentTexture).m_RendererID = 0;
+        }
     }
     
-    void OpenGLFramebuffer::Invalidate() {
-        if (m_RendererID) {
-            glDeleteFramebuffers(1, &m_RendererID);
-            glDeleteTextures(m_ColorAttachments.size(), m_ColorAttachments.data());
-            glDeleteTextures(1, &m_DepthAttachment);
-            
-            m_ColorAttachments.clear();
-            m_DepthAttachment = 0;
-            m_ColorAttachmentTextures.clear();
-            m_DepthAttachmentTexture = nullptr;
+    void OpenGLFramebuffer::ReleaseAttachments() {
+        for (size_t i = 0; i < m_ColorAttachments.size(); i++) {
+            Utils::ReleaseTexture(m_ColorAttachments[i], m_ColorAttachmentFormats[i], m_Specification.Samples, m_AttachmentWidth, m_AttachmentHeight);
         }
+        Utils::ReleaseTexture(m_DepthAttachment, GL_DEPTH24_STENCIL8, m_Specification.Samples, m_AttachmentWidth, m_AttachmentHeight);
         
-        glGenFramebuffers(1, &m_RendererID);
+        // The pool owns the textures now, not the wrappers handed out by GetColorAttachment
+        for (auto& texture : m_ColorAttachmentTextures) {
+            static_cast<OpenGLTexture2D&>(*texture).m_RendererID = 0;
+        }
+        if (m_DepthAttachmentTexture) {
+            static_cast<OpenGLTexture2D&>(*m_DepthAttachmentTexture).m_RendererID = 0;
+        }
+        
+        m_ColorAttachments.clear();
+        m_ColorAttachmentFormats.clear();
+        m_DepthAttachment = 0;
+        m_ColorAttachmentTextures.clear();
+        m_DepthAttachmentTexture = nullptr;
+    }
+    
+    void OpenGLFramebuffer::Invalidate() {
+        // Runs from Bind as well, possibly inside another framebuffer's pass
+        GLint previous = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+        
+        if (!m_RendererID) {
+            glGenFramebuffers(1, &m_RendererID);
+        }
+        if (!m_ColorAttachments.empty() || m_DepthAttachment) {
+            ReleaseAttachments();
+        }
         glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID);
         
         bool multisample = m_Specification.Samples > 1;
@@ -121,67 +287,53 @@ namespace SpoonEngine {
         // Attachments
         if (m_ColorAttachmentSpecs.size()) {
             m_ColorAttachments.resize(m_ColorAttachmentSpecs.size());
+            m_ColorAttachmentFormats.resize(m_ColorAttachmentSpecs.size());
             m_ColorAttachmentTextures.resize(m_ColorAttachmentSpecs.size());
-            Utils::CreateTextures(multisample, m_ColorAttachments.data(), m_ColorAttachments.size());
             
             for (size_t i = 0; i < m_ColorAttachments.size(); i++) {
+                GLenum internalFormat = 0, format = 0, type = 0;
+                Utils::ColorTextureFormat(m_ColorAttachmentSpecs[i].TextureFormat, internalFormat, format, type);
+                
+                bool allocate = true;
+                m_ColorAttachments[i] = Utils::AcquireTexture(internalFormat, m_Specification.Samples, m_AttachmentWidth, m_AttachmentHeight, allocate);
+                m_ColorAttachmentFormats[i] = internalFormat;
                 Utils::BindTexture(multisample, m_ColorAttachments[i]);
                 
-                switch (m_ColorAttachmentSpecs[i].TextureFormat) {
-                    case FramebufferTextureFormat::None:
-                        break;
-                    case FramebufferTextureFormat::RGBA8:
-                        Utils::AttachColorTexture(m_ColorAttachments[i], m_Specification.Samples, GL_RGBA8, GL_RGBA, m_Specification.Width, m_Specification.Height, i);
-                        break;
-                    case FramebufferTextureFormat::RED_INTEGER:
-                        Utils::AttachColorTexture(m_ColorAttachments[i], m_Specification.Samples, GL_R32I, GL_RED_INTEGER, m_Specification.Width, m_Specification.Height, i);
-                        break;
-                    case FramebufferTextureFormat::DEPTH24STENCIL8:
-                        // Depth format in color attachment - should not happen
-                        break;
+                if (internalFormat) {
+                    Utils::AttachColorTexture(m_ColorAttachments[i], m_Specification.Samples, internalFormat, format, type, m_AttachmentWidth, m_AttachmentHeight, i, allocate);
                 }
                 
                 // Create texture wrapper
                 TextureSpecification texSpec;
-                texSpec.Width = m_Specification.Width;
-                texSpec.Height = m_Specification.Height;
+                texSpec.Width = m_AttachmentWidth;
+                texSpec.Height = m_AttachmentHeight;
                 texSpec.Format = TextureFormat::RGBA8; // Default for framebuffer textures
                 
                 auto texture = std::make_shared<OpenGLTexture2D>(0, "", texSpec);
                 texture->m_RendererID = m_ColorAttachments[i];
-                texture->m_Width = m_Specification.Width;
-                texture->m_Height = m_Specification.Height;
+                texture->m_Width = m_AttachmentWidth;
+                texture->m_Height = m_AttachmentHeight;
                 texture->m_IsLoaded = true;
                 m_ColorAttachmentTextures[i] = texture;
             }
         }
         
         if (m_DepthAttachmentSpec.TextureFormat != FramebufferTextureFormat::None) {
-            Utils::CreateTextures(multisample, &m_DepthAttachment, 1);
+            bool allocate = true;
+            m_DepthAttachment = Utils::AcquireTexture(GL_DEPTH24_STENCIL8, m_Specification.Samples, m_AttachmentWidth, m_AttachmentHeight, allocate);
             Utils::BindTexture(multisample, m_DepthAttachment);
-            
-            switch (m_DepthAttachmentSpec.TextureFormat) {
-                case FramebufferTextureFormat::None:
-                    break;
-                case FramebufferTextureFormat::RGBA8:
-                case FramebufferTextureFormat::RED_INTEGER:
-                    // Color formats in depth attachment - should not happen
-                    break;
-                case FramebufferTextureFormat::DEPTH24STENCIL8:
-                    Utils::AttachDepthTexture(m_DepthAttachment, m_Specification.Samples, GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL_ATTACHMENT, m_Specification.Width, m_Specification.Height);
-                    break;
-            }
+            Utils::AttachDepthTexture(m_DepthAttachment, m_Specification.Samples, GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL_ATTACHMENT, m_AttachmentWidth, m_AttachmentHeight, allocate);
             
             // Create depth texture wrapper
             TextureSpecification depthSpec;
-            depthSpec.Width = m_Specification.Width;
-            depthSpec.Height = m_Specification.Height;
+            depthSpec.Width = m_AttachmentWidth;
+            depthSpec.Height = m_AttachmentHeight;
             depthSpec.Format = TextureFormat::RGBA8; // Placeholder
             
             auto depthTexture = std::make_shared<OpenGLTexture2D>(0, "", depthSpec);
             depthTexture->m_RendererID = m_DepthAttachment;
-            depthTexture->m_Width = m_Specification.Width;
-            depthTexture->m_Height = m_Specification.Height;
+            depthTexture->m_Width = m_AttachmentWidth;
+            depthTexture->m_Height = m_AttachmentHeight;
             depthTexture->m_IsLoaded = true;
             m_DepthAttachmentTexture = depthTexture;
         }
@@ -200,16 +352,69 @@ namespace SpoonEngine {
             std::cout << "Framebuffer not complete!" << std::endl;
         }
         
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, previous);
     }
     
     void OpenGLFramebuffer::Bind() {
+        // The size stopped changing: move the attachments to it, reusing pooled ones when possible
+        if (m_ResizePending &&
+            std::chrono::duration<float>(std::chrono::steady_clock::now() - m_LastResize).count() >= s_ResizeSettleTime) {
+            m_ResizePending = false;
+            
+            uint32_t width = Utils::RoundUpResize(m_Specification.Width);
+            uint32_t height = Utils::RoundUpResize(m_Specification.Height);
+            if (width != m_AttachmentWidth || height != m_AttachmentHeight) {
+                ReleaseAttachments();
+                m_AttachmentWidth = width;
+                m_AttachmentHeight = height;
+                Invalidate();
+            }
+            m_Width = m_Specification.Width;
+            m_Height = m_Specification.Height;
+        }
+        if (!s_TexturePool.empty()) {
+            Utils::TrimTexturePool();
+        }
+        
+        // Re-binding while bound (ClearAttachment inside a pass) keeps the outer target to return to
+        GLint current = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &current);
+        if (static_cast<uint32_t>(current) != m_RendererID) {
+            m_PreviousFramebuffer = current;
+            glGetIntegerv(GL_VIEWPORT, m_PreviousViewport);
+        }
+        
         glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID);
-        glViewport(0, 0, m_Specification.Width, m_Specification.Height);
+        glViewport(0, 0, m_Width, m_Height);
     }
     
     void OpenGLFramebuffer::Unbind() {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_PreviousFramebuffer);
+        if (m_PreviousViewport[2] > 0 && m_PreviousViewport[3] > 0) {
+            glViewport(m_PreviousViewport[0], m_PreviousViewport[1], m_PreviousViewport[2], m_PreviousViewport[3]);
+        }
+    }
+    
+    void OpenGLFramebuffer::BlitDepth(Framebuffer& destination, uint32_t x, uint32_t y) {
+        auto& target = static_cast<OpenGLFramebuffer&>(destination);
+        
+        GLint current = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &current);
+        
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_RendererID);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target.m_RendererID);
+        glBlitFramebuffer(0, 0, m_Width, m_Height,
+                          x, y, x + m_Width, y + m_Height,
+                          GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        
+        glBindFramebuffer(GL_FRAMEBUFFER, current);
+    }
+    
+    void OpenGLFramebuffer::ClearDepth(uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(x, y, width, height);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        glDisable(GL_SCISSOR_TEST);
     }
     
     void OpenGLFramebuffer::Resize(uint32_t width, uint32_t height) {
@@ -218,10 +423,28 @@ namespace SpoonEngine {
             return;
         }
         
+        if (width == m_Specification.Width && height == m_Specification.Height) return;
+        
         m_Specification.Width = width;
         m_Specification.Height = height;
         
-        Invalidate();
+        // No reallocation while the size keeps changing: render into as much of the current
+        // attachments as fits and let Bind reallocate once the size has settled
+        m_Width = std::min(width, m_AttachmentWidth);
+        m_Height = std::min(height, m_AttachmentHeight);
+        m_ResizePending = true;
+        m_LastResize = std::chrono::steady_clock::now();
+    }
+    
+    uint32_t OpenGLFramebuffer::GetPooledTextureCount() {
+        return static_cast<uint32_t>(s_TexturePool.size());
+    }
+    
+    void OpenGLFramebuffer::ReleasePooledTextures() {
+        for (auto& pooled : s_TexturePool) {
+            glDeleteTextures(1, &pooled.RendererID);
+        }
+        s_TexturePool.clear();
     }
     
     int OpenGLFramebuffer::ReadPixel(uint32_t attachmentIndex, int x, int y) {
@@ -234,6 +457,109 @@ namespace SpoonEngine {
         return pixelData;
     }
     
+    bool OpenGLFramebuffer::RequestReadback(const FramebufferRect& rect, FramebufferReadbackCallback callback, uint32_t attachmentIndex) {
+        if (!callback || attachmentIndex >= m_ColorAttachments.size() || m_Specification.Samples > 1)
+            return false;
+        
+        GLenum format = 0, type = 0;
+        uint32_t bytesPerPixel = Utils::ReadbackFormat(m_ColorAttachmentFormats[attachmentIndex], format, type);
+        
+        // Only the rendered region holds this frame's pixels
+        FramebufferRect clipped;
+        clipped.X = std::min(rect.X, m_Width);
+        clipped.Y = std::min(rect.Y, m_Height);
+        clipped.Width = std::min(rect.Width, m_Width - clipped.X);
+        clipped.Height = std::min(rect.Height, m_Height - clipped.Y);
+        if (!bytesPerPixel || clipped.Width == 0 || clipped.Height == 0)
+            return false;
+        
+        if (s_ReadbackCount == s_ReadbackRingSize) {
+            std::cout << "Readback ring full, dropping request" << std::endl;
+            return false;
+        }
+        
+        PendingReadback& slot = s_Readbacks[(s_ReadbackHead + s_ReadbackCount) % s_ReadbackRingSize];
+        uint32_t size = clipped.Width * clipped.Height * bytesPerPixel;
+        
+        GLint previous = 0;
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_RendererID);
+        glReadBuffer(GL_COLOR_ATTACHMENT0 + attachmentIndex);
+        
+        if (!slot.Buffer) {
+            glGenBuffers(1, &slot.Buffer);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.Buffer);
+        if (slot.Capacity < size) {
+            glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+            slot.Capacity = size;
+        }
+        
+        // With a pack buffer bound this only queues the copy
+        glReadPixels(clipped.X, clipped.Y, clipped.Width, clipped.Height, format, type, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, previous);
+        
+        slot.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slot.Result.Rect = clipped;
+        slot.Result.BytesPerPixel = bytesPerPixel;
+        slot.Callback = std::move(callback);
+        s_ReadbackCount++;
+        return true;
+    }
+    
+    void OpenGLFramebuffer::ProcessReadbacks() {
+        // In request order; a copy that has not landed holds back the ones after it
+        while (s_ReadbackCount > 0) {
+            PendingReadback& slot = s_Readbacks[s_ReadbackHead];
+            
+            GLenum status = glClientWaitSync(slot.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+            if (status == GL_TIMEOUT_EXPIRED)
+                break;
+            
+            glDeleteSync(slot.Fence);
+            slot.Fence = nullptr;
+            
+            FramebufferReadback result = std::move(slot.Result);
+            FramebufferReadbackCallback callback = std::move(slot.Callback);
+            slot.Result = FramebufferReadback();
+            slot.Callback = nullptr;
+            
+            if (status != GL_WAIT_FAILED) {
+                uint32_t size = result.Rect.Width * result.Rect.Height * result.BytesPerPixel;
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.Buffer);
+                if (const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT)) {
+                    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+                    result.Data.assign(bytes, bytes + size);
+                    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+                }
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            }
+            
+            // Free the slot first so the callback can queue the next readback
+            s_ReadbackHead = (s_ReadbackHead + 1) % s_ReadbackRingSize;
+            s_ReadbackCount--;
+            
+            if (!result.Data.empty()) {
+                callback(result);
+            }
+        }
+    }
+    
+    void OpenGLFramebuffer::ReleaseReadbacks() {
+        for (auto& slot : s_Readbacks) {
+            if (slot.Fence) {
+                glDeleteSync(slot.Fence);
+            }
+            if (slot.Buffer) {
+                glDeleteBuffers(1, &slot.Buffer);
+            }
+            slot = PendingReadback();
+        }
+        s_ReadbackHead = 0;
+        s_ReadbackCount = 0;
+    }
+    
     void OpenGLFramebuffer::ClearAttachment(uint32_t attachmentIndex, int value) {
         if (attachmentIndex >= m_ColorAttachments.size())
             return;
@@ -241,8 +567,8 @@ namespace SpoonEngine {
         // Alternative implementation without glClearTexImage for compatibility
         Bind();
         glDrawBuffer(GL_COLOR_ATTACHMENT0 + attachmentIndex);
-        glClearColor(static_cast<float>(value), static_cast<float>(value), static_cast<float>(value), 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        // glClear's float color is undefined for integer attachments such as picking ids
+        glClearBufferiv(GL_COLOR, 0, &value);
         Unbind();
     }
     
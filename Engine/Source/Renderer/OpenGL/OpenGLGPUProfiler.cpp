@@ -0,0 +1,51 @@
+#include "SpoonEngine/Renderer/OpenGL/OpenGLGPUProfiler.h"
+
+#ifdef SPOON_PLATFORM_MACOS
+    #define GL_SILENCE_DEPRECATION
+    #include <OpenGL/gl3.h>
+#else
+    #include <GL/glew.h>
+#endif
+
+namespace SpoonEngine {
+    
+    OpenGLGPUProfiler::OpenGLGPUProfiler() {
+    }
+    
+    OpenGLGPUProfiler::~OpenGLGPUProfiler() {
+        for (auto& queries : m_Queries) {
+            if (!queries.empty()) {
+                glDeleteQueries(static_cast<GLsizei>(queries.size()), queries.data());
+            }
+        }
+    }
+    
+    void OpenGLGPUProfiler::WriteTimestamp(uint32_t slot, uint32_t index) {
+        auto& queries = m_Queries[slot];
+        if (index >= queries.size()) {
+            size_t first = queries.size();
+            queries.resize(index + 1);
+            glGenQueries(static_cast<GLsizei>(queries.size() - first), queries.data() + first);
+        }
+        
+        glQueryCounter(queries[index], GL_TIMESTAMP);
+    }
+    
+    bool OpenGLGPUProfiler::ReadTimestamps(uint32_t slot, uint32_t count, uint64_t* nanoseconds) {
+        auto& queries = m_Queries[slot];
+        if (count == 0 || count > queries.size()) return false;
+        
+        // Queries complete in order, so the last one being available implies all are
+        GLint available = 0;
+        glGetQueryObjectiv(queries[count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) return false;
+        
+        for (uint32_t i = 0; i < count; i++) {
+            GLuint64 value = 0;
+            glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &value);
+            nanoseconds[i] = value;
+        }
+        return true;
+    }
+    
+}
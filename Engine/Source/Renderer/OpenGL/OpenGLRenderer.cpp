@@ -1,25 +1,128 @@
 #include "SpoonEngine/Renderer/OpenGL/OpenGLRenderer.h"
+#include "SpoonEngine/Renderer/OpenGL/OpenGLStreamingBuffer.h"
+#include "SpoonEngine/Renderer/OpenGL/OpenGLFramebuffer.h"
+#include "SpoonEngine/Renderer/OpenGL/OpenGLShaderCompiler.h"
+#include "SpoonEngine/Renderer/Buffer.h"
 
 #include <iostream>
+#include <cstring>
+#include <vector>
 
 #ifdef SPOON_PLATFORM_MACOS
     #define GL_SILENCE_DEPRECATION
     #include <OpenGL/gl3.h>
 #else
-    #include <GL/gl.h>
+    #include <GL/glew.h>
 #endif
 
 namespace SpoonEngine {
     
+    OpenGLCapabilities OpenGLRenderer::s_Capabilities;
+    
+    // Divisor large enough that every instance of a draw fetches the same a_DrawID entry
+    static const uint32_t s_DrawIDDivisor = 0x7FFFFFFF;
+    
+    OpenGLRenderer::~OpenGLRenderer() {
+        // The compile thread's context belongs to the window, which outlives the renderer
+        OpenGLShaderCompiler::Shutdown();
+    }
+    
     void OpenGLRenderer::Initialize() {
         std::cout << "OpenGL Renderer initialized" << std::endl;
         glEnable(GL_DEPTH_TEST);
+        
+        QueryCapabilities();
+        OpenGLShaderCompiler::Initialize();
+        
+        if (s_Capabilities.MultiDrawIndirect) {
+            std::vector<uint32_t> drawIDs(MaxIndirectDrawID);
+            for (uint32_t i = 0; i < MaxIndirectDrawID; i++) {
+                drawIDs[i] = i;
+            }
+            
+            glGenBuffers(1, &m_DrawIDBuffer);
+            glBindBuffer(GL_ARRAY_BUFFER, m_DrawIDBuffer);
+            glBufferData(GL_ARRAY_BUFFER, drawIDs.size() * sizeof(uint32_t), drawIDs.data(), GL_STATIC_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
     }
     
     void OpenGLRenderer::Shutdown() {
+        if (m_DrawIDBuffer) {
+            glDeleteBuffers(1, &m_DrawIDBuffer);
+            m_DrawIDBuffer = 0;
+        }
+        
+        for (auto& slot : m_SampleQueries) {
+            for (auto& queries : slot.Queries) {
+                if (!queries.empty()) {
+                    glDeleteQueries(static_cast<int>(queries.size()), queries.data());
+                    queries.clear();
+                }
+            }
+        }
+        
+        OpenGLShaderCompiler::Shutdown();
+        OpenGLFramebuffer::ReleaseReadbacks();
+        OpenGLFramebuffer::ReleasePooledTextures();
+        
         std::cout << "OpenGL Renderer shutdown" << std::endl;
     }
     
+    void OpenGLRenderer::StartShaderCompiler(const std::function<void()>& makeCurrent, const std::function<void()>& releaseContext) {
+        // Drivers compiling in parallel already keep the work off this thread
+        if (!s_Capabilities.ParallelShaderCompile) {
+            OpenGLShaderCompiler::StartThread(makeCurrent, releaseContext);
+        }
+    }
+    
+    void OpenGLRenderer::QueryCapabilities() {
+        glGetIntegerv(GL_MAJOR_VERSION, &s_Capabilities.MajorVersion);
+        glGetIntegerv(GL_MINOR_VERSION, &s_Capabilities.MinorVersion);
+        
+        int version = s_Capabilities.MajorVersion * 10 + s_Capabilities.MinorVersion;
+        
+        s_Capabilities.DrawIndirect = version >= 40 || IsExtensionSupported("GL_ARB_draw_indirect");
+        s_Capabilities.BaseInstance = version >= 42 || IsExtensionSupported("GL_ARB_base_instance");
+        s_Capabilities.MultiDrawIndirect = s_Capabilities.DrawIndirect && s_Capabilities.BaseInstance &&
+            (version >= 43 || IsExtensionSupported("GL_ARB_multi_draw_indirect"));
+        s_Capabilities.BufferStorage = version >= 44 || IsExtensionSupported("GL_ARB_buffer_storage");
+        
+        if (version >= 41 || IsExtensionSupported("GL_ARB_get_program_binary")) {
+            // Drivers may expose the entry points without any format they can save
+            int formats = 0;
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            s_Capabilities.ProgramBinary = formats > 0;
+        }
+        
+        s_Capabilities.ParallelShaderCompile = IsExtensionSupported("GL_KHR_parallel_shader_compile") ||
+            IsExtensionSupported("GL_ARB_parallel_shader_compile");
+        
+        int alignment = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        if (alignment > 0) {
+            s_Capabilities.UniformBufferOffsetAlignment = static_cast<uint32_t>(alignment);
+        }
+        
+        std::cout << "OpenGL " << s_Capabilities.MajorVersion << "." << s_Capabilities.MinorVersion
+                  << " (multi-draw indirect: " << (s_Capabilities.MultiDrawIndirect ? "yes" : "no")
+                  << ", persistent mapping: " << (s_Capabilities.BufferStorage ? "yes" : "no")
+                  << ", parallel shader compile: " << (s_Capabilities.ParallelShaderCompile ? "yes" : "no") << ")" << std::endl;
+    }
+    
+    bool OpenGLRenderer::IsExtensionSupported(const char* name) {
+        int count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        
+        for (int i = 0; i < count; i++) {
+            const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (extension && strcmp(extension, name) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
     void OpenGLRenderer::SetViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
         glViewport(x, y, width, height);
     }
@@ -32,11 +135,155 @@ namespace SpoonEngine {
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     }
     
-    void OpenGLRenderer::DrawIndexed(uint32_t indexCount) {
-        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, nullptr);
+    void OpenGLRenderer::SetDepthTest(DepthFunc func, bool depthWrite) {
+        switch (func) {
+            case DepthFunc::Less:      glDepthFunc(GL_LESS); break;
+            case DepthFunc::LessEqual: glDepthFunc(GL_LEQUAL); break;
+            case DepthFunc::Equal:     glDepthFunc(GL_EQUAL); break;
+            case DepthFunc::Always:    glDepthFunc(GL_ALWAYS); break;
+        }
+        glDepthMask(depthWrite ? GL_TRUE : GL_FALSE);
+    }
+    
+    void OpenGLRenderer::SetColorWrite(bool enabled) {
+        GLboolean mask = enabled ? GL_TRUE : GL_FALSE;
+        glColorMask(mask, mask, mask, mask);
+    }
+    
+    void OpenGLRenderer::BeginSampleCount(SamplePass pass) {
+        uint32_t index = static_cast<uint32_t>(pass);
+        SampleQuerySlot& slot = m_SampleQueries[m_FrameIndex % SampleQueryLatency];
+        
+        auto& queries = slot.Queries[index];
+        if (slot.Used[index] == queries.size()) {
+            uint32_t query = 0;
+            glGenQueries(1, &query);
+            queries.push_back(query);
+        }
+        
+        glBeginQuery(GL_SAMPLES_PASSED, queries[slot.Used[index]++]);
+    }
+    
+    void OpenGLRenderer::EndSampleCount(SamplePass pass) {
+        glEndQuery(GL_SAMPLES_PASSED);
+    }
+    
+    void OpenGLRenderer::ResolveSampleQueries(SampleQuerySlot& slot) {
+        slot.Pending = false;
+        
+        for (uint32_t pass = 0; pass < SamplePassCount; pass++) {
+            uint32_t used = slot.Used[pass];
+            slot.Used[pass] = 0;
+            if (used == 0) {
+                m_ResolvedSamples[pass] = 0;
+                continue;
+            }
+            
+            // Queries complete in order, so the last one tells whether the whole pass is ready.
+            // If it is not, keep the previous value rather than stalling on the GPU.
+            int available = 0;
+            glGetQueryObjectiv(slot.Queries[pass][used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) continue;
+            
+            uint64_t total = 0;
+            for (uint32_t i = 0; i < used; i++) {
+                uint64_t samples = 0;
+                glGetQueryObjectui64v(slot.Queries[pass][i], GL_QUERY_RESULT, &samples);
+                total += samples;
+            }
+            m_ResolvedSamples[pass] = total;
+        }
+    }
+    
+    void OpenGLRenderer::BeginFrame() {
+        m_FrameStats = RendererStats();
+        
+        SampleQuerySlot& slot = m_SampleQueries[m_FrameIndex % SampleQueryLatency];
+        if (slot.Pending) {
+            ResolveSampleQueries(slot);
+        }
+        
+        m_FrameStats.PrePassSamples = m_ResolvedSamples[static_cast<uint32_t>(SamplePass::DepthPrePass)];
+        m_FrameStats.ShadedSamples = m_ResolvedSamples[static_cast<uint32_t>(SamplePass::Shading)];
+        
+        OpenGLFramebuffer::ProcessReadbacks();
+        OpenGLShaderCompiler::Poll();
+    }
+    
+    void OpenGLRenderer::EndFrame() {
+        m_LastFrameStats = m_FrameStats;
+        
+        m_SampleQueries[m_FrameIndex % SampleQueryLatency].Pending = true;
+        m_FrameIndex++;
+        
+        // Fence and rotate streaming regions now that every command of the frame is queued
+        OpenGLStreamingBuffer::EndFrameAll();
+    }
+    
+    static GLenum IndexTypeToOpenGL(IndexType type) {
+        return type == IndexType::UInt16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    }
+    
+    void OpenGLRenderer::DrawIndexed(uint32_t indexCount, IndexType indexType) {
+        glDrawElements(GL_TRIANGLES, indexCount, IndexTypeToOpenGL(indexType), nullptr);
+        
+        m_FrameStats.DrawCalls++;
+        m_FrameStats.Triangles += indexCount / 3;
+    }
+    
+    void OpenGLRenderer::DrawIndexedBaseVertex(uint32_t indexCount, uint32_t firstIndex, int32_t baseVertex, IndexType indexType) {
+        glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, IndexTypeToOpenGL(indexType),
+            reinterpret_cast<const void*>(static_cast<uintptr_t>(firstIndex) * IndexTypeSize(indexType)), baseVertex);
+        
+        m_FrameStats.DrawCalls++;
+        m_FrameStats.Triangles += indexCount / 3;
+    }
+    
+    void OpenGLRenderer::DrawIndexedIndirect(const IndirectBuffer& commands, uint32_t drawCount, IndexType indexType) {
+        if (drawCount == 0) return;
+        
+        const auto& list = commands.GetCommands();
+        uint32_t count = drawCount < list.size() ? drawCount : static_cast<uint32_t>(list.size());
+        
+        for (uint32_t i = 0; i < count; i++) {
+            m_FrameStats.Triangles += static_cast<uint64_t>(list[i].Count / 3) * list[i].InstanceCount;
+        }
+        
+        if (s_Capabilities.MultiDrawIndirect) {
+            m_FrameStats.DrawCalls++;
+            
+            // Route BaseInstance into a_DrawID through an instanced identity attribute on the bound
+            // VAO, for this draw only: mesh VAOs are shared with the non-indirect paths
+            GLint previousBuffer = 0;
+            glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previousBuffer);
+            glBindBuffer(GL_ARRAY_BUFFER, m_DrawIDBuffer);
+            glEnableVertexAttribArray(DrawIDAttributeLocation);
+            glVertexAttribIPointer(DrawIDAttributeLocation, 1, GL_UNSIGNED_INT, 0, nullptr);
+            glVertexAttribDivisor(DrawIDAttributeLocation, s_DrawIDDivisor);
+            
+            commands.Bind();
+            glMultiDrawElementsIndirect(GL_TRIANGLES, IndexTypeToOpenGL(indexType), nullptr, count, 0);
+            commands.Unbind();
+            
+            glVertexAttribDivisor(DrawIDAttributeLocation, 0);
+            glDisableVertexAttribArray(DrawIDAttributeLocation);
+            glBindBuffer(GL_ARRAY_BUFFER, static_cast<GLuint>(previousBuffer));
+            return;
+        }
+        
+        // GL 3.3 fallback: replay the CPU copy, feeding a_DrawID as a constant attribute value
+        glDisableVertexAttribArray(DrawIDAttributeLocation);
+        m_FrameStats.DrawCalls += count;
+        for (uint32_t i = 0; i < count; i++) {
+            const auto& command = list[i];
+            glVertexAttribI1ui(DrawIDAttributeLocation, command.BaseInstance);
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.Count, IndexTypeToOpenGL(indexType),
+                reinterpret_cast<const void*>(static_cast<uintptr_t>(command.FirstIndex) * IndexTypeSize(indexType)),
+                command.InstanceCount, command.BaseVertex);
+        }
     }
     
     void OpenGLRenderer::Present() {
     }
     
-}
\ No newline at end of file
+}
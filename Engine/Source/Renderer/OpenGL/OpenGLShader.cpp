@@ -1,5 +1,9 @@
 #include "SpoonEngine/Renderer/OpenGL/OpenGLShader.h"
+#include "SpoonEngine/Renderer/OpenGL/OpenGLShaderCache.h"
+#include "SpoonEngine/Renderer/OpenGL/OpenGLShaderCompiler.h"
+#include "SpoonEngine/Core/Profiler.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 
@@ -34,7 +38,6 @@ namespace SpoonEngine {
         
         CompileOrGetVulkanBinaries(shaderSources);
         CompileOrGetOpenGLBinaries();
-        CreateProgram();
     }
     
     OpenGLShader::OpenGLShader(const std::string& name, const std::string& vertexSrc, const std::string& fragmentSrc)
@@ -46,10 +49,21 @@ namespace SpoonEngine {
         
         CompileOrGetVulkanBinaries(sources);
         CompileOrGetOpenGLBinaries();
-        CreateProgram();
     }
     
     OpenGLShader::~OpenGLShader() {
+        // Waits out a Poll that may be finishing this shader right now
+        OpenGLShaderCompiler::RemovePending(this);
+        
+        if (!m_Ready) {
+            // The compile thread may still be writing the program; a withdrawn job never created one
+            if (m_Job && OpenGLShaderCompiler::Wait(m_Job)) {
+                m_RendererID = m_Job->Program;
+            }
+            for (auto id : m_PendingShaders) {
+                glDeleteShader(id);
+            }
+        }
         glDeleteProgram(m_RendererID);
     }
     
@@ -95,73 +109,218 @@ namespace SpoonEngine {
     }
     
     void OpenGLShader::CompileOrGetOpenGLBinaries() {
-        std::vector<uint32_t> shaderIDs;
+        SPOON_PROFILE_SCOPE("OpenGLShader::Compile");
         
+        // Stage order of an unordered_map is unspecified; the cache key must not depend on it
+        std::vector<std::pair<uint32_t, const std::string*>> sources;
         for (auto&& [stage, source] : m_OpenGLSourceCode) {
+            sources.emplace_back(stage, &source);
+        }
+        std::sort(sources.begin(), sources.end());
+        m_SourceHash = OpenGLShaderCache::HashSources(sources);
+        
+        m_RendererID = OpenGLShaderCache::Load(m_SourceHash);
+        if (m_RendererID) {
+            CompleteProgram();
+            return;
+        }
+        m_StoreBinary = OpenGLShaderCache::IsEnabled();
+        
+        switch (OpenGLShaderCompiler::GetMode()) {
+            case ShaderCompileMode::Parallel:
+                m_RendererID = StartProgram(m_OpenGLSourceCode, m_StoreBinary, m_PendingShaders);
+                OpenGLShaderCompiler::AddPending(this);
+                break;
+            case ShaderCompileMode::Thread:
+                m_Job = std::make_shared<ShaderCompileJob>();
+                m_Job->Sources = m_OpenGLSourceCode;
+                m_Job->Retrievable = m_StoreBinary;
+                OpenGLShaderCompiler::Submit(m_Job);
+                OpenGLShaderCompiler::AddPending(this);
+                break;
+            default:
+                m_RendererID = LinkProgram(m_OpenGLSourceCode, m_StoreBinary);
+                CompleteProgram();
+                break;
+        }
+    }
+    
+    bool OpenGLShader::PollCompile() {
+        if (m_Ready) return true;
+        
+        if (m_Job) {
+            if (m_Job->Done) {
+                m_RendererID = m_Job->Program;
+            } else if (OpenGLShaderCompiler::GetMode() == ShaderCompileMode::Thread) {
+                return false;
+            } else {
+                // The compile thread stopped before reaching this job
+                m_RendererID = OpenGLShaderCompiler::Wait(m_Job) ? m_Job->Program : LinkProgram(m_OpenGLSourceCode, m_StoreBinary);
+            }
+            m_Job.reset();
+        } else {
+            int isComplete = 0;
+            glGetProgramiv(m_RendererID, GL_COMPLETION_STATUS_KHR, &isComplete);
+            if (isComplete == GL_FALSE) return false;
+            m_RendererID = FinishProgram(m_RendererID, m_PendingShaders);
+        }
+        
+        CompleteProgram();
+        return true;
+    }
+    
+    void OpenGLShader::FinishCompile() {
+        if (m_Ready) return;
+        
+        SPOON_PROFILE_SCOPE("OpenGLShader::FinishCompile");
+        
+        // Poll only reaches pending shaders and RemovePending waits for one in progress, so after
+        // this Poll cannot complete the program; the mutex settles callers racing each other
+        OpenGLShaderCompiler::RemovePending(this);
+        std::lock_guard<std::mutex> lock(m_CompileMutex);
+        if (m_Ready) return;
+        
+        if (m_Job) {
+            // A job the thread has not reached yet is cheaper to compile here than to wait for
+            m_RendererID = OpenGLShaderCompiler::Wait(m_Job) ? m_Job->Program : LinkProgram(m_OpenGLSourceCode, m_StoreBinary);
+            m_Job.reset();
+        } else {
+            m_RendererID = FinishProgram(m_RendererID, m_PendingShaders);
+        }
+        
+        CompleteProgram();
+    }
+    
+    void OpenGLShader::EnsureReady() const {
+        // Finishing the compile does not change what the shader is, only when it is usable
+        if (!m_Ready) {
+            const_cast<OpenGLShader*>(this)->FinishCompile();
+        }
+    }
+    
+    void OpenGLShader::CompleteProgram() {
+        if (m_RendererID && m_StoreBinary) {
+            OpenGLShaderCache::Store(m_SourceHash, m_RendererID);
+        }
+        CreateProgram();
+        
+        // A failed program is ready too: it draws nothing, as it always has
+        m_Ready = true;
+    }
+    
+    uint32_t OpenGLShader::StartProgram(const std::unordered_map<uint32_t, std::string>& sources, bool retrievable, std::vector<uint32_t>& shaderIDs) {
+        for (auto&& [stage, source] : sources) {
             uint32_t shader = glCreateShader(stage);
             
             const char* sourceCStr = source.c_str();
             glShaderSource(shader, 1, &sourceCStr, 0);
             glCompileShader(shader);
             
-            int isCompiled = 0;
-            glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
-            if (isCompiled == GL_FALSE) {
-                int maxLength = 0;
-                glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &maxLength);
-                
-                std::vector<char> infoLog(maxLength);
-                glGetShaderInfoLog(shader, maxLength, &maxLength, &infoLog[0]);
-                
-                glDeleteShader(shader);
-                
-                std::cout << "Shader compilation error: " << infoLog.data() << std::endl;
-                break;
-            }
-            
             shaderIDs.push_back(shader);
         }
         
-        m_RendererID = glCreateProgram();
+        uint32_t program = glCreateProgram();
         
         for (auto id : shaderIDs) {
-            glAttachShader(m_RendererID, id);
+            glAttachShader(program, id);
         }
         
-        glLinkProgram(m_RendererID);
+        if (retrievable) {
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+        
+        glLinkProgram(program);
+        return program;
+    }
         
+    uint32_t OpenGLShader::FinishProgram(uint32_t program, std::vector<uint32_t>& shaderIDs) {
         int isLinked = 0;
-        glGetProgramiv(m_RendererID, GL_LINK_STATUS, &isLinked);
+        glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
         if (isLinked == GL_FALSE) {
-            int maxLength = 0;
-            glGetProgramiv(m_RendererID, GL_INFO_LOG_LENGTH, &maxLength);
+            // A stage that failed to compile explains more than the link log
+            bool reported = false;
+            for (auto id : shaderIDs) {
+                int isCompiled = 0;
+                glGetShaderiv(id, GL_COMPILE_STATUS, &isCompiled);
+                if (isCompiled == GL_FALSE) {
+                    int maxLength = 0;
+                    glGetShaderiv(id, GL_INFO_LOG_LENGTH, &maxLength);
+                    
+                    std::vector<char> infoLog(std::max(maxLength, 1), '\0');
+                    glGetShaderInfoLog(id, maxLength, &maxLength, &infoLog[0]);
+                    
+                    std::cout << "Shader compilation error: " << infoLog.data() << std::endl;
+                    reported = true;
+                }
+            }
             
-            std::vector<char> infoLog(maxLength);
-            glGetProgramInfoLog(m_RendererID, maxLength, &maxLength, &infoLog[0]);
+            if (!reported) {
+                int maxLength = 0;
+                glGetProgramiv(program, GL_INFO_LOG_LENGTH, &maxLength);
+                
+                std::vector<char> infoLog(std::max(maxLength, 1), '\0');
+                glGetProgramInfoLog(program, maxLength, &maxLength, &infoLog[0]);
+                
+                std::cout << "Shader linking error: " << infoLog.data() << std::endl;
+            }
             
-            glDeleteProgram(m_RendererID);
+            glDeleteProgram(program);
             
             for (auto id : shaderIDs) {
                 glDeleteShader(id);
             }
-            
-            std::cout << "Shader linking error: " << infoLog.data() << std::endl;
-            return;
+            shaderIDs.clear();
+            return 0;
         }
         
         for (auto id : shaderIDs) {
-            glDetachShader(m_RendererID, id);
+            glDetachShader(program, id);
             glDeleteShader(id);
         }
+        shaderIDs.clear();
+        return program;
+    }
+        
+    uint32_t OpenGLShader::LinkProgram(const std::unordered_map<uint32_t, std::string>& sources, bool retrievable) {
+        std::vector<uint32_t> shaderIDs;
+        uint32_t program = StartProgram(sources, retrievable, shaderIDs);
+        return FinishProgram(program, shaderIDs);
     }
     
     void OpenGLShader::CreateProgram() {
+        if (!m_RendererID) return;
+        
+        // Active inputs only; built-ins such as gl_VertexID report location -1
+        int attributeCount = 0;
+        glGetProgramiv(m_RendererID, GL_ACTIVE_ATTRIBUTES, &attributeCount);
+        for (int i = 0; i < attributeCount; i++) {
+            char name[128];
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveAttrib(m_RendererID, i, sizeof(name), &length, &size, &type, name);
+            
+            int location = glGetAttribLocation(m_RendererID, name);
+            if (location >= 0 && location < 32) {
+                m_VertexInputMask |= 1u << location;
+            }
+        }
+        
+        int blockCount = 0;
+        glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+        for (int i = 0; i < blockCount; i++) {
+            char name[128];
+            GLsizei length = 0;
+            glGetActiveUniformBlockName(m_RendererID, i, sizeof(name), &length, name);
+            m_UniformBlocks.emplace(std::string(name, length), static_cast<uint32_t>(i));
+        }
     }
     
     void OpenGLShader::Reflect(uint32_t stage, const std::vector<uint32_t>& shaderData) {
     }
     
     void OpenGLShader::Bind() const {
+        EnsureReady();
         glUseProgram(m_RendererID);
     }
     
@@ -197,6 +356,41 @@ namespace SpoonEngine {
         UploadUniformMat4(name, value);
     }
     
+    void OpenGLShader::SetFloat4Array(const std::string& name, const glm::vec4* values, uint32_t count) {
+        UploadUniformFloat4Array(name, values, count);
+    }
+    
+    void OpenGLShader::SetMat4Array(const std::string& name, const glm::mat4* values, uint32_t count) {
+        UploadUniformMat4Array(name, values, count);
+    }
+    
+    uint32_t OpenGLShader::GetVertexInputMask() const {
+        // Callable without a context: reads the link-time reflection, empty until the program is ready
+        return m_Ready ? m_VertexInputMask : 0;
+    }
+    
+    bool OpenGLShader::HasUniformBlock(const std::string& name) const {
+        return m_Ready && m_UniformBlocks.count(name) > 0;
+    }
+    
+    void OpenGLShader::SetUniformBlockBinding(const std::string& name, uint32_t binding) {
+        EnsureReady();
+        
+        auto it = m_UniformBlocks.find(name);
+        if (it == m_UniformBlocks.end()) return;
+        glUniformBlockBinding(m_RendererID, it->second, binding);
+    }
+    
+    bool OpenGLShader::HasFragmentOutput(const std::string& name) const {
+        EnsureReady();
+        
+        auto it = m_FragmentOutputCache.find(name);
+        if (it == m_FragmentOutputCache.end()) {
+            it = m_FragmentOutputCache.emplace(name, glGetFragDataLocation(m_RendererID, name.c_str())).first;
+        }
+        return it->second >= 0;
+    }
+    
     void OpenGLShader::UploadUniformInt(const std::string& name, int value) {
         int location = glGetUniformLocation(m_RendererID, name.c_str());
         glUniform1i(location, value);
@@ -227,6 +421,11 @@ namespace SpoonEngine {
         glUniform4f(location, value.x, value.y, value.z, value.w);
     }
     
+    void OpenGLShader::UploadUniformFloat4Array(const std::string& name, const glm::vec4* values, uint32_t count) {
+        int location = glGetUniformLocation(m_RendererID, name.c_str());
+        glUniform4fv(location, count, glm::value_ptr(values[0]));
+    }
+    
     void OpenGLShader::UploadUniformMat3(const std::string& name, const glm::mat3& matrix) {
         int location = glGetUniformLocation(m_RendererID, name.c_str());
         glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(matrix));
@@ -237,4 +436,9 @@ namespace SpoonEngine {
         glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(matrix));
     }
     
+    void OpenGLShader::UploadUniformMat4Array(const std::string& name, const glm::mat4* matrices, uint32_t count) {
+        int location = glGetUniformLocation(m_RendererID, name.c_str());
+        glUniformMatrix4fv(location, count, GL_FALSE, glm::value_ptr(matrices[0]));
+    }
+    
 }
\ No newline at end of file
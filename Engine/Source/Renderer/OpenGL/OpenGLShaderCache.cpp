@@ -0,0 +1,182 @@
+#include "SpoonEngine/Renderer/OpenGL/OpenGLShaderCache.h"
+#include "SpoonEngine/Renderer/OpenGL/OpenGLRenderer.h"
+
+#ifdef SPOON_PLATFORM_MACOS
+    #define GL_SILENCE_DEPRECATION
+    #include <OpenGL/gl3.h>
+#else
+    #include <GL/glew.h>
+#endif
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+
+namespace SpoonEngine {
+    
+    bool OpenGLShaderCache::s_Enabled = true;
+    std::string OpenGLShaderCache::s_Directory = "ShaderCache";
+    ShaderCacheStats OpenGLShaderCache::s_Stats;
+    uint64_t OpenGLShaderCache::s_DriverHash = 0;
+    std::mutex OpenGLShaderCache::s_Mutex;
+    
+    static const uint32_t s_CacheMagic = 0x43535053;     // "SPSC"
+    static const uint32_t s_CacheVersion = 1;
+    
+    struct ShaderCacheHeader {
+        uint32_t Magic = s_CacheMagic;
+        uint32_t Version = s_CacheVersion;
+        uint64_t SourceHash = 0;
+        uint64_t DriverHash = 0;
+        uint32_t BinaryFormat = 0;
+        uint32_t BinarySize = 0;
+    };
+    
+    // FNV-1a, continuing from hash
+    static uint64_t HashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+    
+    static uint64_t HashString(const char* text, uint64_t hash) {
+        // Separator, so ("ab", "c") and ("a", "bc") differ
+        hash = HashBytes(text ? text : "", text ? std::char_traits<char>::length(text) : 0, hash);
+        return HashBytes("\0", 1, hash);
+    }
+    
+    bool OpenGLShaderCache::IsEnabled() {
+        return s_Enabled && OpenGLRenderer::GetCapabilities().ProgramBinary;
+    }
+    
+    uint64_t OpenGLShaderCache::HashSources(const std::vector<std::pair<uint32_t, const std::string*>>& sources) {
+        uint64_t hash = HashBytes(&s_CacheVersion, sizeof(s_CacheVersion));
+        for (const auto& [stage, source] : sources) {
+            hash = HashBytes(&stage, sizeof(stage), hash);
+            hash = HashString(source->c_str(), hash);
+        }
+        return hash;
+    }
+    
+    ShaderCacheStats OpenGLShaderCache::GetStats() {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        return s_Stats;
+    }
+    
+    void OpenGLShaderCache::CountEvent(uint32_t ShaderCacheStats::* counter) {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        s_Stats.*counter += 1;
+    }
+    
+    uint64_t OpenGLShaderCache::GetDriverHash() {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        if (!s_DriverHash) {
+            uint64_t hash = HashBytes(nullptr, 0);
+            for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION }) {
+                hash = HashString(reinterpret_cast<const char*>(glGetString(name)), hash);
+            }
+            s_DriverHash = hash;
+        }
+        return s_DriverHash;
+    }
+    
+    std::string OpenGLShaderCache::GetEntryPath(uint64_t sourceHash) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(sourceHash));
+        return (std::filesystem::path(s_Directory) / name).string();
+    }
+    
+    uint32_t OpenGLShaderCache::Load(uint64_t sourceHash) {
+        if (!IsEnabled()) return 0;
+        
+        std::string path = GetEntryPath(sourceHash);
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            CountEvent(&ShaderCacheStats::Misses);
+            return 0;
+        }
+        
+        ShaderCacheHeader header;
+        std::vector<char> binary;
+        bool valid = in.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+                     header.Magic == s_CacheMagic && header.Version == s_CacheVersion &&
+                     header.SourceHash == sourceHash && header.DriverHash == GetDriverHash();
+        if (valid) {
+            binary.resize(header.BinarySize);
+            valid = header.BinarySize > 0 && in.read(binary.data(), binary.size());
+        }
+        in.close();
+        
+        uint32_t program = 0;
+        if (valid) {
+            program = glCreateProgram();
+            glProgramBinary(program, header.BinaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+            
+            int isLinked = 0;
+            glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
+            if (isLinked == GL_FALSE) {
+                glDeleteProgram(program);
+                program = 0;
+            }
+        }
+        
+        if (!program) {
+            // Stale or foreign entry; the recompiled program replaces it
+            std::error_code error;
+            std::filesystem::remove(path, error);
+            CountEvent(&ShaderCacheStats::Rejected);
+            return 0;
+        }
+        
+        CountEvent(&ShaderCacheStats::Hits);
+        return program;
+    }
+    
+    void OpenGLShaderCache::Store(uint64_t sourceHash, uint32_t program) {
+        if (!IsEnabled() || !program) return;
+        
+        int length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return;
+        
+        ShaderCacheHeader header;
+        header.SourceHash = sourceHash;
+        header.DriverHash = GetDriverHash();
+        
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        GLsizei written = 0;
+        glGetProgramBinary(program, length, &written, &format, binary.data());
+        if (written <= 0) return;
+        header.BinaryFormat = format;
+        header.BinarySize = static_cast<uint32_t>(written);
+        
+        std::error_code error;
+        std::filesystem::create_directories(s_Directory, error);
+        
+        // Written next to the entry and renamed, so a crash never leaves a truncated entry behind
+        std::string path = GetEntryPath(sourceHash);
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                std::cout << "Shader cache: cannot write " << temporary << std::endl;
+                return;
+            }
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(binary.data(), header.BinarySize);
+            if (!out) return;
+        }
+        
+        std::filesystem::rename(temporary, path, error);
+        if (error) {
+            std::filesystem::remove(temporary, error);
+            return;
+        }
+        CountEvent(&ShaderCacheStats::Stored);
+    }
+    
+}
@@ -0,0 +1,148 @@
+#include "SpoonEngine/Renderer/OpenGL/OpenGLShaderCompiler.h"
+#include "SpoonEngine/Renderer/OpenGL/OpenGLShader.h"
+#include "SpoonEngine/Renderer/OpenGL/OpenGLRenderer.h"
+#include "SpoonEngine/Core/Profiler.h"
+
+#ifdef SPOON_PLATFORM_MACOS
+    #define GL_SILENCE_DEPRECATION
+    #include <OpenGL/gl3.h>
+#else
+    #include <GL/glew.h>
+#endif
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SpoonEngine {
+    
+    static ShaderCompileMode s_Mode = ShaderCompileMode::Immediate;
+    
+    static std::thread s_Thread;
+    static std::mutex s_QueueMutex;
+    static std::condition_variable s_QueueCondition;
+    static std::condition_variable s_DoneCondition;
+    static std::deque<std::shared_ptr<ShaderCompileJob>> s_Queue;
+    static bool s_Stopping = false;
+    
+    static std::mutex s_PendingMutex;
+    static std::vector<OpenGLShader*> s_Pending;
+    
+    static void CompileThread(std::function<void()> makeCurrent, std::function<void()> releaseContext) {
+        Profiler::SetThreadName("Shader Compile Thread");
+        makeCurrent();
+        
+        while (true) {
+            std::shared_ptr<ShaderCompileJob> job;
+            {
+                std::unique_lock<std::mutex> lock(s_QueueMutex);
+                s_QueueCondition.wait(lock, [] { return s_Stopping || !s_Queue.empty(); });
+                if (s_Stopping) break;
+                
+                job = s_Queue.front();
+                s_Queue.pop_front();
+            }
+            
+            {
+                SPOON_PROFILE_SCOPE("OpenGLShader::Compile");
+                job->Program = OpenGLShader::LinkProgram(job->Sources, job->Retrievable);
+                // Other contexts may only use the program once its commands have completed
+                glFinish();
+            }
+            
+            {
+                std::lock_guard<std::mutex> lock(s_QueueMutex);
+                job->Done = true;
+            }
+            s_DoneCondition.notify_all();
+        }
+        
+        releaseContext();
+    }
+    
+    void OpenGLShaderCompiler::Initialize() {
+        if (!OpenGLRenderer::GetCapabilities().ParallelShaderCompile) return;
+        
+        // Let the driver pick the number of compiler threads
+        if (OpenGLRenderer::IsExtensionSupported("GL_KHR_parallel_shader_compile")) {
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        } else {
+            glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+        }
+        s_Mode = ShaderCompileMode::Parallel;
+    }
+    
+    void OpenGLShaderCompiler::StartThread(const std::function<void()>& makeCurrent, const std::function<void()>& releaseContext) {
+        if (s_Mode != ShaderCompileMode::Immediate || s_Thread.joinable()) return;
+        
+        s_Stopping = false;
+        s_Thread = std::thread(CompileThread, makeCurrent, releaseContext);
+        s_Mode = ShaderCompileMode::Thread;
+        std::cout << "Shader compilation moved to a background thread" << std::endl;
+    }
+    
+    void OpenGLShaderCompiler::Shutdown() {
+        if (s_Thread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(s_QueueMutex);
+                s_Stopping = true;
+            }
+            s_QueueCondition.notify_all();
+            s_Thread.join();
+        }
+        
+        // Queued jobs stay queued; Wait withdraws them and their shaders compile on demand
+        if (s_Mode == ShaderCompileMode::Thread) {
+            s_Mode = ShaderCompileMode::Immediate;
+        }
+    }
+    
+    ShaderCompileMode OpenGLShaderCompiler::GetMode() {
+        return s_Mode;
+    }
+    
+    void OpenGLShaderCompiler::Submit(const std::shared_ptr<ShaderCompileJob>& job) {
+        {
+            std::lock_guard<std::mutex> lock(s_QueueMutex);
+            s_Queue.push_back(job);
+        }
+        s_QueueCondition.notify_one();
+    }
+    
+    bool OpenGLShaderCompiler::Wait(const std::shared_ptr<ShaderCompileJob>& job) {
+        std::unique_lock<std::mutex> lock(s_QueueMutex);
+        
+        auto it = std::find(s_Queue.begin(), s_Queue.end(), job);
+        if (it != s_Queue.end()) {
+            s_Queue.erase(it);
+            return false;
+        }
+        
+        s_DoneCondition.wait(lock, [&job] { return job->Done.load(); });
+        return true;
+    }
+    
+    void OpenGLShaderCompiler::AddPending(OpenGLShader* shader) {
+        std::lock_guard<std::mutex> lock(s_PendingMutex);
+        s_Pending.push_back(shader);
+    }
+    
+    void OpenGLShaderCompiler::RemovePending(OpenGLShader* shader) {
+        std::lock_guard<std::mutex> lock(s_PendingMutex);
+        s_Pending.erase(std::remove(s_Pending.begin(), s_Pending.end(), shader), s_Pending.end());
+    }
+    
+    void OpenGLShaderCompiler::Poll() {
+        std::lock_guard<std::mutex> lock(s_PendingMutex);
+        if (s_Pending.empty()) return;
+        
+        SPOON_PROFILE_SCOPE("OpenGLShaderCompiler::Poll");
+        s_Pending.erase(std::remove_if(s_Pending.begin(), s_Pending.end(),
+            [](OpenGLShader* shader) { return shader->PollCompile(); }), s_Pending.end());
+    }
+    
+}
@@ -0,0 +1,176 @@
+#include "SpoonEngine/Renderer/OpenGL/OpenGLStreamingBuffer.h"
+#include "SpoonEngine/Renderer/OpenGL/OpenGLRenderer.h"
+
+#ifdef SPOON_PLATFORM_MACOS
+    #define GL_SILENCE_DEPRECATION
+    #include <OpenGL/gl3.h>
+#else
+    #include <GL/glew.h>
+#endif
+
+#include <algorithm>
+#include <iostream>
+
+namespace SpoonEngine {
+    
+    std::vector<OpenGLStreamingBuffer*> OpenGLStreamingBuffer::s_Instances;
+    
+    static uint32_t StreamingBufferUsageToOpenGLTarget(StreamingBufferUsage usage) {
+        switch (usage) {
+            case StreamingBufferUsage::Vertex:   return GL_ARRAY_BUFFER;
+            case StreamingBufferUsage::Index:    return GL_ELEMENT_ARRAY_BUFFER;
+            case StreamingBufferUsage::Uniform:  return GL_UNIFORM_BUFFER;
+        }
+        return GL_ARRAY_BUFFER;
+    }
+    
+    // Storage and mapping go through GL_COPY_WRITE_BUFFER so that index streams never
+    // disturb the element buffer of whichever vertex array is currently bound
+    OpenGLStreamingBuffer::OpenGLStreamingBuffer(StreamingBufferUsage usage, uint32_t frameCapacity)
+        : m_Target(StreamingBufferUsageToOpenGLTarget(usage)) {
+        const auto& caps = OpenGLRenderer::GetCapabilities();
+        
+        m_Alignment = usage == StreamingBufferUsage::Uniform ? caps.UniformBufferOffsetAlignment : 16;
+        m_FrameCapacity = (frameCapacity + m_Alignment - 1) / m_Alignment * m_Alignment;
+        
+        glGenBuffers(1, &m_RendererID);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+        
+        if (caps.BufferStorage) {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            GLsizeiptr totalSize = static_cast<GLsizeiptr>(m_FrameCapacity) * FramesInFlight;
+            
+            glBufferStorage(GL_COPY_WRITE_BUFFER, totalSize, nullptr, flags);
+            m_MappedData = static_cast<uint8_t*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, totalSize, flags));
+            
+            if (!m_MappedData) {
+                std::cout << "Failed to persistently map streaming buffer, falling back to orphaning" << std::endl;
+                glDeleteBuffers(1, &m_RendererID);
+                glGenBuffers(1, &m_RendererID);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+            }
+        }
+        
+        if (!m_MappedData) {
+            glBufferData(GL_COPY_WRITE_BUFFER, m_FrameCapacity, nullptr, GL_STREAM_DRAW);
+        }
+        
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        
+        s_Instances.push_back(this);
+    }
+    
+    OpenGLStreamingBuffer::~OpenGLStreamingBuffer() {
+        s_Instances.erase(std::remove(s_Instances.begin(), s_Instances.end(), this), s_Instances.end());
+        
+        for (auto& fence : m_Fences) {
+            if (fence) {
+                glDeleteSync(fence);
+                fence = nullptr;
+            }
+        }
+        
+        if (m_MappedData) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+        
+        glDeleteBuffers(1, &m_RendererID);
+    }
+    
+    StreamingAllocation OpenGLStreamingBuffer::Allocate(uint32_t size) {
+        StreamingAllocation allocation;
+        
+        uint32_t offset = (m_Head + m_Alignment - 1) / m_Alignment * m_Alignment;
+        if (offset + size > m_FrameCapacity) {
+            if (m_ReportedExhaustion) return allocation;
+            m_ReportedExhaustion = true;
+            
+            std::cout << "Streaming buffer exhausted: requested " << size << " bytes, "
+                      << (m_FrameCapacity - std::min(offset, m_FrameCapacity)) << " left this frame" << std::endl;
+            return allocation;
+        }
+        m_Head = offset + size;
+        
+        if (m_MappedData) {
+            if (!m_RegionReady) {
+                WaitForRegion(m_Region);
+                m_RegionReady = true;
+            }
+            
+            allocation.Offset = m_Region * m_FrameCapacity + offset;
+            allocation.Data = m_MappedData + allocation.Offset;
+        } else {
+            // The store was orphaned at the end of the previous frame, so nothing the GPU
+            // still reads can alias this range
+            glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+            allocation.Offset = offset;
+            allocation.Data = glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, size,
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        }
+        
+        allocation.Size = size;
+        return allocation;
+    }
+    
+    void OpenGLStreamingBuffer::Commit(const StreamingAllocation& allocation) {
+        if (!allocation || m_MappedData) return;
+        
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    }
+    
+    void OpenGLStreamingBuffer::Bind() const {
+        glBindBuffer(m_Target, m_RendererID);
+    }
+    
+    void OpenGLStreamingBuffer::BindRange(uint32_t binding, const StreamingAllocation& allocation) const {
+        glBindBufferRange(m_Target, binding, m_RendererID, allocation.Offset, allocation.Size);
+    }
+    
+    void OpenGLStreamingBuffer::EndFrameAll() {
+        for (auto* buffer : s_Instances) {
+            buffer->EndFrame();
+        }
+    }
+    
+    void OpenGLStreamingBuffer::EndFrame() {
+        if (m_Head == 0) return;
+        
+        if (m_MappedData) {
+            if (m_Fences[m_Region]) {
+                glDeleteSync(m_Fences[m_Region]);
+            }
+            m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            
+            m_Region = (m_Region + 1) % FramesInFlight;
+            m_RegionReady = false;
+        } else {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+            glBufferData(GL_COPY_WRITE_BUFFER, m_FrameCapacity, nullptr, GL_STREAM_DRAW);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+        
+        m_Head = 0;
+    }
+    
+    void OpenGLStreamingBuffer::WaitForRegion(uint32_t region) {
+        GLsync fence = m_Fences[region];
+        if (!fence) return;
+        
+        // Flush on the first wait so the fence is guaranteed to signal
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        while (true) {
+            GLenum result = glClientWaitSync(fence, flags, 1000000);
+            if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED) {
+                break;
+            }
+            flags = 0;
+        }
+        
+        glDeleteSync(fence);
+        m_Fences[region] = nullptr;
+    }
+    
+}
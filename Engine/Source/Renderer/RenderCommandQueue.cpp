@@ -0,0 +1,22 @@
+#include "SpoonEngine/Renderer/RenderCommandQueue.h"
+
+namespace SpoonEngine {
+    
+    RenderCommandQueue::RenderCommandQueue() {
+        m_Commands.reserve(256);
+    }
+    
+    void RenderCommandQueue::Submit(Command command) {
+        m_Commands.push_back(std::move(command));
+    }
+    
+    void RenderCommandQueue::Execute() {
+        for (auto& command : m_Commands) {
+            command();
+        }
+        
+        // Keeps capacity, so steady-state recording does not allocate the list itself
+        m_Commands.clear();
+    }
+    
+}
@@ -0,0 +1,294 @@
+#include "SpoonEngine/Renderer/RenderGraph.h"
+#include "SpoonEngine/Renderer/Renderer.h"
+#include "SpoonEngine/Renderer/GPUProfiler.h"
+#include "SpoonEngine/Core/Profiler.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace SpoonEngine {
+    
+    RenderGraphResource RenderGraphBuilder::Create(const std::string& name, const RenderGraphTargetDesc& desc) {
+        RenderGraph::Target target;
+        target.Name = name;
+        target.Desc = desc;
+        m_Graph.m_Targets.push_back(std::move(target));
+        
+        return Write(static_cast<RenderGraphResource>(m_Graph.m_Targets.size() - 1));
+    }
+    
+    RenderGraphResource RenderGraphBuilder::Read(RenderGraphResource target) {
+        if (target >= m_Graph.m_Targets.size()) return RenderGraph::InvalidResource;
+        
+        auto& reads = m_Graph.m_Passes[m_Pass].Reads;
+        if (std::find(reads.begin(), reads.end(), target) == reads.end()) {
+            reads.push_back(target);
+        }
+        return target;
+    }
+    
+    RenderGraphResource RenderGraphBuilder::Write(RenderGraphResource target) {
+        if (target >= m_Graph.m_Targets.size()) return RenderGraph::InvalidResource;
+        
+        auto& pass = m_Graph.m_Passes[m_Pass];
+        if (pass.Write != RenderGraph::InvalidResource && pass.Write != target) {
+            std::cerr << "RenderGraph: pass '" << pass.Name << "' already writes '"
+                      << m_Graph.m_Targets[pass.Write].Name << "', ignoring '" << m_Graph.m_Targets[target].Name << "'" << std::endl;
+            return RenderGraph::InvalidResource;
+        }
+        pass.Write = target;
+        return target;
+    }
+    
+    void RenderGraphBuilder::SetSideEffect() {
+        m_Graph.m_Passes[m_Pass].SideEffect = true;
+    }
+    
+    Framebuffer* RenderGraphContext::GetFramebuffer(RenderGraphResource target) const {
+        return m_Graph.GetFramebuffer(target);
+    }
+    
+    std::shared_ptr<Texture2D> RenderGraphContext::GetColorAttachment(RenderGraphResource target, uint32_t index) const {
+        Framebuffer* framebuffer = m_Graph.GetFramebuffer(target);
+        return framebuffer ? framebuffer->GetColorAttachment(index) : nullptr;
+    }
+    
+    std::shared_ptr<Texture2D> RenderGraphContext::GetDepthAttachment(RenderGraphResource target) const {
+        Framebuffer* framebuffer = m_Graph.GetFramebuffer(target);
+        return framebuffer ? framebuffer->GetDepthAttachment() : nullptr;
+    }
+    
+    void RenderGraph::AddPass(const std::string& name, const SetupFunction& setup, const ExecuteFunction& execute) {
+        Pass pass;
+        pass.Name = name;
+        pass.Execute = execute;
+        m_Passes.push_back(std::move(pass));
+        
+        RenderGraphBuilder builder(*this, static_cast<uint32_t>(m_Passes.size() - 1));
+        setup(builder);
+    }
+    
+    RenderGraphResource RenderGraph::Import(const std::string& name, std::shared_ptr<Framebuffer> framebuffer) {
+        Target target;
+        target.Name = name;
+        target.Imported = framebuffer;
+        if (framebuffer) {
+            target.Desc.Width = framebuffer->GetRegion().Width;
+            target.Desc.Height = framebuffer->GetRegion().Height;
+        }
+        m_Targets.push_back(std::move(target));
+        return static_cast<RenderGraphResource>(m_Targets.size() - 1);
+    }
+    
+    Framebuffer* RenderGraph::GetFramebuffer(RenderGraphResource target) const {
+        if (target >= m_Targets.size()) return nullptr;
+        
+        const Target& entry = m_Targets[target];
+        if (entry.Imported) return entry.Imported.get();
+        return entry.Pooled >= 0 ? m_Pool[entry.Pooled].Instance.get() : nullptr;
+    }
+    
+    void RenderGraph::CullPasses() {
+        // Reference counts: readers per target, written targets per pass (at most one)
+        for (auto& target : m_Targets) {
+            target.Readers = 0;
+        }
+        for (const auto& pass : m_Passes) {
+            for (auto read : pass.Reads) {
+                m_Targets[read].Readers++;
+            }
+        }
+        
+        std::vector<RenderGraphResource> unread;
+        auto cull = [&](Pass& pass) {
+            pass.Culled = true;
+            for (auto read : pass.Reads) {
+                Target& target = m_Targets[read];
+                if (--target.Readers == 0 && !target.Imported) {
+                    unread.push_back(read);
+                }
+            }
+        };
+        
+        for (auto& pass : m_Passes) {
+            if (pass.Write == InvalidResource && !pass.SideEffect) {
+                cull(pass);
+            }
+        }
+        for (RenderGraphResource i = 0; i < m_Targets.size(); i++) {
+            if (m_Targets[i].Readers == 0 && !m_Targets[i].Imported) {
+                unread.push_back(i);
+            }
+        }
+        
+        // Writers of a target nobody reads are dead, which may leave their inputs unread in turn
+        while (!unread.empty()) {
+            RenderGraphResource target = unread.back();
+            unread.pop_back();
+            
+            for (auto& pass : m_Passes) {
+                if (pass.Write == target && !pass.Culled && !pass.SideEffect) {
+                    cull(pass);
+                }
+            }
+        }
+    }
+    
+    void RenderGraph::AllocateTargets() {
+        for (int32_t i = 0; i < static_cast<int32_t>(m_Passes.size()); i++) {
+            const Pass& pass = m_Passes[i];
+            if (pass.Culled) continue;
+            
+            auto use = [&](RenderGraphResource resource) {
+                Target& target = m_Targets[resource];
+                if (target.FirstUse < 0) target.FirstUse = i;
+                target.LastUse = i;
+            };
+            for (auto read : pass.Reads) {
+                use(read);
+            }
+            if (pass.Write != InvalidResource) {
+                use(pass.Write);
+            }
+        }
+        
+        for (auto& pooled : m_Pool) {
+            pooled.BusyUntil = -1;
+        }
+        
+        // In order of first use, so a pooled framebuffer is free once its last user's final pass is behind
+        std::vector<RenderGraphResource> order;
+        for (RenderGraphResource i = 0; i < m_Targets.size(); i++) {
+            if (!m_Targets[i].Imported && m_Targets[i].FirstUse >= 0) {
+                order.push_back(i);
+            }
+        }
+        std::stable_sort(order.begin(), order.end(), [this](RenderGraphResource a, RenderGraphResource b) {
+            return m_Targets[a].FirstUse < m_Targets[b].FirstUse;
+        });
+        
+        for (auto resource : order) {
+            Target& target = m_Targets[resource];
+            m_Stats.Targets++;
+            
+            // A free framebuffer of the same size if there is one, then one whose attachments
+            // already cover the size, then any with the same attachments
+            int32_t best = 0;
+            for (size_t p = 0; p < m_Pool.size(); p++) {
+                const PooledFramebuffer& pooled = m_Pool[p];
+                if (pooled.BusyUntil >= target.FirstUse || !pooled.Desc.IsCompatible(target.Desc)) continue;
+                
+                FramebufferRegion region = pooled.Instance->GetRegion();
+                int32_t score = pooled.Desc == target.Desc ? 3 :
+                                region.AttachmentWidth >= target.Desc.Width && region.AttachmentHeight >= target.Desc.Height ? 2 : 1;
+                if (score > best) {
+                    best = score;
+                    target.Pooled = static_cast<int32_t>(p);
+                }
+            }
+            
+            if (target.Pooled >= 0 && !(m_Pool[target.Pooled].Desc == target.Desc)) {
+                // The framebuffer defers reallocating until the new size has settled
+                PooledFramebuffer& pooled = m_Pool[target.Pooled];
+                pooled.Instance->Resize(target.Desc.Width, target.Desc.Height);
+                pooled.Desc = target.Desc;
+                m_Stats.Resizes++;
+            }
+            
+            if (target.Pooled < 0) {
+                FramebufferSpecification spec;
+                spec.Width = target.Desc.Width;
+                spec.Height = target.Desc.Height;
+                spec.Samples = target.Desc.Samples;
+                for (auto format : target.Desc.Attachments) {
+                    spec.Attachments.Attachments.emplace_back(format);
+                }
+                
+                PooledFramebuffer pooled;
+                pooled.Desc = target.Desc;
+                pooled.Instance = Framebuffer::Create(spec);
+                if (!pooled.Instance) continue;
+                
+                m_Pool.push_back(std::move(pooled));
+                target.Pooled = static_cast<int32_t>(m_Pool.size() - 1);
+                m_Stats.Allocations++;
+            }
+            
+            PooledFramebuffer& pooled = m_Pool[target.Pooled];
+            if (pooled.BusyUntil < 0) {
+                m_Stats.Framebuffers++;
+            }
+            pooled.BusyUntil = target.LastUse;
+        }
+    }
+    
+    void RenderGraph::Execute(Renderer* renderer) {
+        SPOON_PROFILE_SCOPE("RenderGraph::Execute");
+        
+        m_Stats = RenderGraphStats();
+        m_Stats.Passes = static_cast<uint32_t>(m_Passes.size());
+        
+        CullPasses();
+        AllocateTargets();
+        
+        RenderGraphContext context(*this, renderer);
+        Framebuffer* bound = nullptr;
+        
+        for (auto& pass : m_Passes) {
+            if (pass.Culled) {
+                m_Stats.CulledPasses++;
+                continue;
+            }
+            
+            Framebuffer* framebuffer = GetFramebuffer(pass.Write);
+            if (framebuffer != bound) {
+                if (bound) {
+                    bound->Unbind();
+                }
+                if (framebuffer) {
+                    framebuffer->Bind();
+                    m_Stats.Binds++;
+                }
+                bound = framebuffer;
+            }
+            
+            if (pass.Write != InvalidResource) {
+                Target& target = m_Targets[pass.Write];
+                if (!target.Imported && !target.Cleared && framebuffer) {
+                    renderer->Clear();
+                    target.Cleared = true;
+                    m_Stats.Clears++;
+                }
+            }
+            
+            SPOON_GPU_SCOPE(pass.Name);
+            pass.Execute(context);
+        }
+        
+        if (bound) {
+            bound->Unbind();
+        }
+        
+        // Free what the pool has not needed for a while
+        for (size_t p = m_Pool.size(); p-- > 0;) {
+            PooledFramebuffer& pooled = m_Pool[p];
+            pooled.IdleFrames = pooled.BusyUntil >= 0 ? 0 : pooled.IdleFrames + 1;
+            if (pooled.IdleFrames > MaxIdleFrames) {
+                m_Pool.erase(m_Pool.begin() + p);
+            }
+        }
+        m_Stats.PooledFramebuffers = static_cast<uint32_t>(m_Pool.size());
+        
+        Reset();
+    }
+    
+    void RenderGraph::Reset() {
+        m_Passes.clear();
+        m_Targets.clear();
+    }
+    
+    void RenderGraph::ReleaseResources() {
+        m_Pool.clear();
+    }
+    
+}
@@ -0,0 +1,115 @@
+#include "SpoonEngine/Renderer/RenderThread.h"
+#include "SpoonEngine/Core/Profiler.h"
+
+#include <chrono>
+
+namespace SpoonEngine {
+    
+    RenderThread::RenderThread() {
+    }
+    
+    RenderThread::~RenderThread() {
+        Stop();
+    }
+    
+    void RenderThread::Start(std::function<void()> onStart, std::function<void()> onStop) {
+        if (m_Running) return;
+        
+        m_Running = true;
+        m_Thread = std::thread(&RenderThread::ThreadMain, this, std::move(onStart), std::move(onStop));
+        m_ThreadID = m_Thread.get_id();
+    }
+    
+    void RenderThread::Stop() {
+        if (!m_Running) return;
+        
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            WaitForIdle(lock);
+            m_Running = false;
+        }
+        m_Condition.notify_all();
+        
+        m_Thread.join();
+        m_ThreadID = std::thread::id();
+    }
+    
+    void RenderThread::Submit(RenderCommandQueue::Command command) {
+        m_Queues[m_RecordIndex].Submit(std::move(command));
+    }
+    
+    void RenderThread::Kick() {
+        SPOON_PROFILE_SCOPE("RenderThread::Kick");
+        auto start = std::chrono::high_resolution_clock::now();
+        
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            WaitForIdle(lock);
+            
+            // The render thread is idle, so the other queue has been fully drained
+            m_RecordIndex ^= 1;
+            m_FramePending = true;
+        }
+        m_Condition.notify_all();
+        
+        auto end = std::chrono::high_resolution_clock::now();
+        m_LastWaitTime = std::chrono::duration<float, std::milli>(end - start).count();
+    }
+    
+    float RenderThread::GetLastSubmitTime() const {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_LastSubmitTime;
+    }
+    
+    uint32_t RenderThread::GetLastCommandCount() const {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_LastCommandCount;
+    }
+    
+    void RenderThread::WaitForIdle(std::unique_lock<std::mutex>& lock) {
+        m_Condition.wait(lock, [this] { return !m_FramePending; });
+    }
+    
+    void RenderThread::ThreadMain(std::function<void()> onStart, std::function<void()> onStop) {
+        Profiler::SetThreadName("Render Thread");
+        
+        if (onStart) {
+            onStart();
+        }
+        
+        while (true) {
+            RenderCommandQueue* queue = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Condition.wait(lock, [this] { return m_FramePending || !m_Running; });
+                
+                if (!m_FramePending && !m_Running) {
+                    break;
+                }
+                queue = &m_Queues[m_RecordIndex ^ 1];
+            }
+            
+            uint32_t commandCount = queue->GetCommandCount();
+            
+            auto start = std::chrono::high_resolution_clock::now();
+            {
+                SPOON_PROFILE_SCOPE("RenderThread::Execute");
+                queue->Execute();
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_LastSubmitTime = std::chrono::duration<float, std::milli>(end - start).count();
+                m_LastCommandCount = commandCount;
+                m_FramePending = false;
+            }
+            m_Condition.notify_all();
+        }
+        
+        if (onStop) {
+            onStop();
+        }
+    }
+    
+}
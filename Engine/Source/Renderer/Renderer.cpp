@@ -1,5 +1,9 @@
 #include "SpoonEngine/Renderer/Renderer.h"
+#include "SpoonEngine/Renderer/RenderThread.h"
+#include "SpoonEngine/Renderer/GPUProfiler.h"
+#include "SpoonEngine/Renderer/Material.h"
 #include "SpoonEngine/Renderer/OpenGL/OpenGLRenderer.h"
+#include "SpoonEngine/Renderer/Null/NullRenderer.h"
 
 namespace SpoonEngine {
     
@@ -18,49 +22,181 @@ namespace SpoonEngine {
             case RendererAPI::OpenGL:
                 m_Backend = std::make_unique<OpenGLRenderer>();
                 break;
+            case RendererAPI::Null:
+                m_Backend = std::make_unique<NullRenderer>();
+                break;
             default:
                 break;
         }
         
         if (m_Backend) {
             m_Backend->Initialize();
+            GPUProfiler::Init();
+            Material::InitPlaceholderShader();
         }
     }
     
     void Renderer::Shutdown() {
         if (m_Backend) {
+            Material::ReleasePlaceholderShader();
+            GPUProfiler::Shutdown();
             m_Backend->Shutdown();
         }
     }
     
+    void Renderer::StartShaderCompiler(const std::function<void()>& makeCurrent, const std::function<void()>& releaseContext) {
+        if (m_Backend) {
+            m_Backend->StartShaderCompiler(makeCurrent, releaseContext);
+        }
+    }
+    
     void Renderer::SetViewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
         if (m_Backend) {
-            m_Backend->SetViewport(x, y, width, height);
+            RendererBackend* backend = m_Backend.get();
+            Submit([=]() { backend->SetViewport(x, y, width, height); });
         }
     }
     
     void Renderer::SetClearColor(float r, float g, float b, float a) {
         if (m_Backend) {
-            m_Backend->SetClearColor(r, g, b, a);
+            RendererBackend* backend = m_Backend.get();
+            Submit([=]() { backend->SetClearColor(r, g, b, a); });
         }
     }
     
     void Renderer::Clear() {
         if (m_Backend) {
-            m_Backend->Clear();
+            RendererBackend* backend = m_Backend.get();
+            Submit([=]() { backend->Clear(); });
+        }
+    }
+    
+    void Renderer::SetDepthTest(DepthFunc func, bool depthWrite) {
+        if (m_Backend) {
+            RendererBackend* backend = m_Backend.get();
+            Submit([=]() { backend->SetDepthTest(func, depthWrite); });
+        }
+    }
+    
+    void Renderer::SetColorWrite(bool enabled) {
+        if (m_Backend) {
+            RendererBackend* backend = m_Backend.get();
+            Submit([=]() { backend->SetColorWrite(enabled); });
+        }
+    }
+    
+    void Renderer::BeginSampleCount(SamplePass pass) {
+        if (m_Backend) {
+            RendererBackend* backend = m_Backend.get();
+            Submit([=]() { backend->BeginSampleCount(pass); });
+        }
+    }
+    
+    void Renderer::EndSampleCount(SamplePass pass) {
+        if (m_Backend) {
+            RendererBackend* backend = m_Backend.get();
+            Submit([=]() { backend->EndSampleCount(pass); });
+        }
+    }
+    
+    void Renderer::BeginFrame() {
+        m_FrameStart = std::chrono::high_resolution_clock::now();
+        m_ImmediateSubmitTime = 0.0f;
+        m_ImmediateCommandCount = 0;
+        
+        if (m_Backend) {
+            RendererBackend* backend = m_Backend.get();
+            Submit([=]() {
+                backend->BeginFrame();
+                if (GPUProfiler* profiler = GPUProfiler::Get()) {
+                    profiler->BeginFrame();
+                }
+            });
         }
     }
     
-    void Renderer::DrawIndexed(uint32_t indexCount) {
+    void Renderer::EndFrame() {
         if (m_Backend) {
-            m_Backend->DrawIndexed(indexCount);
+            RendererBackend* backend = m_Backend.get();
+            Submit([=]() {
+                if (GPUProfiler* profiler = GPUProfiler::Get()) {
+                    profiler->EndFrame();
+                }
+                backend->EndFrame();
+            });
+        }
+        
+        auto recordEnd = std::chrono::high_resolution_clock::now();
+        float frameTime = std::chrono::duration<float, std::milli>(recordEnd - m_FrameStart).count();
+        
+        if (m_RenderThread) {
+            m_RenderThread->Kick();
+            
+            m_FrameTimings.RecordTime = frameTime;
+            m_FrameTimings.SubmitTime = m_RenderThread->GetLastSubmitTime();
+            m_FrameTimings.WaitTime = m_RenderThread->GetLastWaitTime();
+            m_FrameTimings.CommandCount = m_RenderThread->GetLastCommandCount();
+        } else {
+            m_FrameTimings.RecordTime = frameTime - m_ImmediateSubmitTime;
+            m_FrameTimings.SubmitTime = m_ImmediateSubmitTime;
+            m_FrameTimings.WaitTime = 0.0f;
+            m_FrameTimings.CommandCount = m_ImmediateCommandCount;
+        }
+    }
+    
+    void Renderer::DrawIndexed(uint32_t indexCount, IndexType indexType) {
+        if (m_Backend) {
+            RendererBackend* backend = m_Backend.get();
+            Submit([=]() { backend->DrawIndexed(indexCount, indexType); });
+        }
+    }
+    
+    void Renderer::DrawIndexedBaseVertex(uint32_t indexCount, uint32_t firstIndex, int32_t baseVertex, IndexType indexType) {
+        if (m_Backend) {
+            RendererBackend* backend = m_Backend.get();
+            Submit([=]() { backend->DrawIndexedBaseVertex(indexCount, firstIndex, baseVertex, indexType); });
+        }
+    }
+    
+    void Renderer::DrawIndexedIndirect(const IndirectBuffer& commands, uint32_t drawCount, IndexType indexType) {
+        if (m_Backend) {
+            RendererBackend* backend = m_Backend.get();
+            const IndirectBuffer* buffer = &commands;
+            Submit([=]() { backend->DrawIndexedIndirect(*buffer, drawCount, indexType); });
         }
     }
     
     void Renderer::Present() {
         if (m_Backend) {
-            m_Backend->Present();
+            RendererBackend* backend = m_Backend.get();
+            Submit([=]() { backend->Present(); });
+        }
+    }
+    
+    RendererStats Renderer::GetStats() const {
+        return m_Backend ? m_Backend->GetStats() : RendererStats();
+    }
+    
+    void Renderer::Submit(RenderCommandQueue::Command command) {
+        if (m_RenderThread && !m_RenderThread->IsRenderThread()) {
+            m_RenderThread->Submit(std::move(command));
+            return;
+        }
+        
+        // Only the outermost command is timed, nested submissions are part of it
+        if (m_SubmitDepth > 0 || m_RenderThread) {
+            command();
+            return;
         }
+        
+        m_SubmitDepth++;
+        auto start = std::chrono::high_resolution_clock::now();
+        command();
+        auto end = std::chrono::high_resolution_clock::now();
+        m_SubmitDepth--;
+        
+        m_ImmediateSubmitTime += std::chrono::duration<float, std::milli>(end - start).count();
+        m_ImmediateCommandCount++;
     }
     
-}
\ No newline at end of file
+}
@@ -1,6 +1,7 @@
 #include "SpoonEngine/Renderer/Shader.h"
 #include "SpoonEngine/Renderer/Renderer.h"
 #include "SpoonEngine/Renderer/OpenGL/OpenGLShader.h"
+#include "SpoonEngine/Renderer/Null/NullShader.h"
 
 namespace SpoonEngine {
     
@@ -8,6 +9,7 @@ namespace SpoonEngine {
         switch (Renderer::GetAPI()) {
             case RendererAPI::None:    return nullptr;
             case RendererAPI::OpenGL:  return std::make_shared<OpenGLShader>(filepath);
+            case RendererAPI::Null:    return std::make_shared<NullShader>(filepath);
         }
         return nullptr;
     }
@@ -16,6 +18,7 @@ namespace SpoonEngine {
         switch (Renderer::GetAPI()) {
             case RendererAPI::None:    return nullptr;
             case RendererAPI::OpenGL:  return std::make_shared<OpenGLShader>(name, vertexSrc, fragmentSrc);
+            case RendererAPI::Null:    return std::make_shared<NullShader>(name, vertexSrc, fragmentSrc);
         }
         return nullptr;
     }
@@ -0,0 +1,17 @@
+#include "SpoonEngine/Renderer/StreamingBuffer.h"
+#include "SpoonEngine/Renderer/Renderer.h"
+#include "SpoonEngine/Renderer/OpenGL/OpenGLStreamingBuffer.h"
+#include "SpoonEngine/Renderer/Null/NullBuffer.h"
+
+namespace SpoonEngine {
+    
+    std::shared_ptr<StreamingBuffer> StreamingBuffer::Create(StreamingBufferUsage usage, uint32_t frameCapacity) {
+        switch (Renderer::GetAPI()) {
+            case RendererAPI::None:    return nullptr;
+            case RendererAPI::OpenGL:  return std::make_shared<OpenGLStreamingBuffer>(usage, frameCapacity);
+            case RendererAPI::Null:    return std::make_shared<NullStreamingBuffer>(usage, frameCapacity);
+        }
+        return nullptr;
+    }
+    
+}
@@ -0,0 +1,340 @@
+#include "SpoonEngine/Systems/LightSystem.h"
+#include "SpoonEngine/Renderer/Camera.h"
+#include "SpoonEngine/Renderer/Shader.h"
+#include "SpoonEngine/ECS/World.h"
+#include "SpoonEngine/Core/JobSystem.h"
+#include "SpoonEngine/Core/Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SpoonEngine {
+    
+    // Sizes match LightSystem's constants: 1024 = 4 * MaxClusterLights, 864 = ClusterCount / 4,
+    // 1024 = MaxClusterIndices / 16
+    static const char* s_ClusterSource = R"(
+        layout (std140) uniform ClusterLights {
+            vec4 u_ClusterLights[1024];
+        };
+        
+        layout (std140) uniform ClusterCells {
+            uvec4 u_ClusterCells[864];
+        };
+        
+        layout (std140) uniform ClusterIndices {
+            uvec4 u_ClusterIndices[1024];
+        };
+        
+        uniform mat4 u_View;
+        uniform mat4 u_Projection;
+        uniform vec2 u_ClusterDepthParams;
+        
+        uint GetCluster(vec3 worldPos) {
+            vec4 viewPos = u_View * vec4(worldPos, 1.0);
+            vec4 clipPos = u_Projection * viewPos;
+            vec2 tile = clamp((clipPos.xy / clipPos.w * 0.5 + 0.5) * vec2(16.0, 9.0), vec2(0.0), vec2(15.0, 8.0));
+            float slice = clamp(floor(log(max(-viewPos.z, 0.0001)) * u_ClusterDepthParams.x + u_ClusterDepthParams.y), 0.0, 23.0);
+            return uint(tile.x) + uint(tile.y) * 16u + uint(slice) * 144u;
+        }
+        
+        uvec2 GetClusterLightRange(uint cluster) {
+            uint cell = u_ClusterCells[cluster >> 2u][cluster & 3u];
+            return uvec2(cell & 0xffffu, cell >> 16u);
+        }
+        
+        int GetClusterLightIndex(uint i) {
+            uint word = u_ClusterIndices[i >> 4u][(i >> 2u) & 3u];
+            return int((word >> ((i & 3u) * 8u)) & 0xffu);
+        }
+        
+        // Light color after distance and cone falloff and the light's shadow; lightDir points
+        // from the surface to the light
+        vec3 GetClusterLightRadiance(int light, vec3 worldPos, vec3 normal, out vec3 lightDir) {
+            vec4 position = u_ClusterLights[light * 4];
+            vec4 color = u_ClusterLights[light * 4 + 1];
+            vec4 spot = u_ClusterLights[light * 4 + 2];
+            float spotScale = u_ClusterLights[light * 4 + 3].x;
+            
+            vec3 toLight = position.xyz - worldPos;
+            float distance = length(toLight);
+            lightDir = toLight / max(distance, 0.0001);
+            
+            // Inverse square, windowed to reach zero at the range
+            float ratio = distance / position.w;
+            float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+            float attenuation = window * window / (distance * distance + 1.0);
+            
+            // Point lights have cos outer = -2, which keeps the cone factor at 1
+            float cone = clamp((dot(-lightDir, spot.xyz) - spot.w) * spotScale, 0.0, 1.0);
+            attenuation *= cone * cone;
+            
+            if (color.w >= 0.0 && attenuation > 0.0) {
+                attenuation *= 1.0 - SampleLocalShadow(int(color.w), worldPos, normal);
+            }
+            return color.rgb * attenuation;
+        }
+        
+        // Blinn-Phong diffuse and specular of every light in the cluster of worldPos
+        vec3 ComputeClusteredLighting(vec3 worldPos, vec3 normal, vec3 viewDir, float shininess) {
+            uvec2 range = GetClusterLightRange(GetCluster(worldPos));
+            vec3 result = vec3(0.0);
+            
+            for (uint i = 0u; i < range.y; i++) {
+                vec3 lightDir;
+                vec3 radiance = GetClusterLightRadiance(GetClusterLightIndex(range.x + i), worldPos, normal, lightDir);
+                
+                float diffuse = dot(normal, lightDir);
+                if (diffuse <= 0.0) continue;
+                
+                float specular = pow(max(dot(normal, normalize(lightDir + viewDir)), 0.0), shininess);
+                result += radiance * (diffuse + specular * 0.5);
+            }
+            return result;
+        }
+    )";
+    
+    // View-space x (axis 0) or y (axis 1) at which a view depth lands on an NDC coordinate
+    static float ViewFromNDC(const glm::mat4& projection, int axis, float ndc, float depth) {
+        float w = -projection[2][3] * depth + projection[3][3];
+        return (ndc * w + projection[2][axis] * depth - projection[3][axis]) / projection[axis][axis];
+    }
+    
+    static float NDCFromView(const glm::mat4& projection, int axis, float view, float depth) {
+        float w = -projection[2][3] * depth + projection[3][3];
+        return (projection[axis][axis] * view - projection[2][axis] * depth + projection[3][axis]) / w;
+    }
+    
+    // Inclusive range of the tiles an NDC interval covers; false when it misses the screen
+    static bool TileRange(float ndcMin, float ndcMax, uint32_t tiles, uint32_t& first, uint32_t& last) {
+        if (ndcMax < -1.0f || ndcMin > 1.0f) return false;
+        
+        float scale = 0.5f * static_cast<float>(tiles);
+        first = static_cast<uint32_t>(std::max(0.0f, std::floor((ndcMin + 1.0f) * scale)));
+        last = static_cast<uint32_t>(std::max(0.0f, std::min(static_cast<float>(tiles - 1), std::floor((ndcMax + 1.0f) * scale))));
+        first = std::min(first, last);
+        return true;
+    }
+    
+    void ClusterData::SetUniforms(Shader& shader) const {
+        shader.SetUniformBlockBinding("ClusterLights", LightSystem::ClusterLightsBinding);
+        shader.SetUniformBlockBinding("ClusterCells", LightSystem::ClusterCellsBinding);
+        shader.SetUniformBlockBinding("ClusterIndices", LightSystem::ClusterIndicesBinding);
+        shader.SetFloat2("u_ClusterDepthParams", DepthParams);
+    }
+    
+    const char* LightSystem::GetClusterSource() {
+        return s_ClusterSource;
+    }
+    
+    // Whether a sphere touches the frustum of a view-projection matrix (Gribb/Hartmann planes)
+    static bool SphereInFrustum(const glm::mat4& viewProjection, const glm::vec3& center, float radius) {
+        glm::vec4 rows[4];
+        for (int i = 0; i < 4; i++) {
+            rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+        }
+        
+        for (int i = 0; i < 6; i++) {
+            glm::vec4 plane = i % 2 == 0 ? rows[3] + rows[i / 2] : rows[3] - rows[i / 2];
+            float length = glm::length(glm::vec3(plane));
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius * length) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    void LightSystem::CollectLights(const Camera& camera) {
+        SPOON_PROFILE_SCOPE("LightSystem::CollectLights");
+        
+        m_Lights.clear();
+        m_Culled = 0;
+        if (!m_World) return;
+        
+        const glm::mat4& viewProjection = camera.GetViewProjectionMatrix();
+        
+        for (auto entity : m_Entities) {
+            if (!m_World->HasComponent<Transform>(entity) || !m_World->HasComponent<LightComponent>(entity)) continue;
+            
+            const auto& light = m_World->GetComponent<LightComponent>(entity);
+            if (light.Range <= 0.0f || light.Intensity <= 0.0f) continue;
+            
+            glm::mat4 transform = m_World->GetComponent<Transform>(entity).GetTransformMatrix();
+            glm::vec3 position(transform[3]);
+            
+            if (!SphereInFrustum(viewProjection, position, light.Range)) {
+                m_Culled++;
+                continue;
+            }
+            
+            LightData data;
+            data.Entity = entity;
+            data.Type = light.Type;
+            data.Position = position;
+            data.Color = glm::vec3(light.Color.x, light.Color.y, light.Color.z) * light.Intensity;
+            data.Range = light.Range;
+            data.CastShadows = light.CastShadows;
+            
+            if (light.Type == LightType::Spot) {
+                float outer = std::max(0.5f, std::min(light.OuterAngle, 89.0f));
+                float inner = std::min(light.InnerAngle, outer);
+                
+                glm::vec3 forward(transform[2]);
+                data.Direction = glm::length(forward) > 0.0f ? glm::normalize(forward) : glm::vec3(0.0f, 0.0f, 1.0f);
+                data.CosInner = std::cos(glm::radians(inner));
+                data.CosOuter = std::cos(glm::radians(outer));
+                data.OuterAngle = outer;
+            }
+            
+            m_Lights.push_back(data);
+        }
+    }
+    
+    void LightSystem::AssignClusters(const Camera& camera) {
+        SPOON_PROFILE_SCOPE("LightSystem::AssignClusters");
+        
+        m_ClusterStats = ClusterStats();
+        m_Clusters.Lights.clear();
+        m_Clusters.Cells.assign(ClusterCount, 0);
+        m_Clusters.Indices.clear();
+        
+        const glm::mat4& view = camera.GetViewMatrix();
+        const glm::mat4& projection = camera.GetProjectionMatrix();
+        
+        // Exponential slices from the near to the far plane; orthographic cameras may put the
+        // near plane at or behind the eye, so the log spacing starts a little in front of it
+        float nearPlane = camera.GetNearPlane();
+        float sliceNear = std::max(nearPlane, 0.01f);
+        float farPlane = std::max(camera.GetFarPlane(), sliceNear * 1.01f);
+        float logRange = std::log(farPlane / sliceNear);
+        m_Clusters.DepthParams = glm::vec2(ClusterSlices / logRange, -static_cast<float>(ClusterSlices) * std::log(sliceNear) / logRange);
+        
+        // Bounding spheres in view space, in the order the lights are uploaded
+        uint32_t lightCount = static_cast<uint32_t>(std::min<size_t>(m_Lights.size(), MaxClusterLights));
+        m_ClusterStats.Lights = lightCount;
+        m_ClusterStats.DroppedLights = static_cast<uint32_t>(m_Lights.size()) - lightCount;
+        
+        std::vector<glm::vec4> spheres(lightCount);
+        m_Clusters.Lights.resize(lightCount * 4);
+        
+        for (uint32_t i = 0; i < lightCount; i++) {
+            const LightData& light = m_Lights[i];
+            glm::vec3 center = light.Position;
+            float radius = light.Range;
+            
+            glm::vec4* packed = &m_Clusters.Lights[i * 4];
+            packed[0] = glm::vec4(light.Position, light.Range);
+            packed[1] = glm::vec4(light.Color, static_cast<float>(light.ShadowIndex));
+            
+            if (light.Type == LightType::Spot) {
+                packed[2] = glm::vec4(light.Direction, light.CosOuter);
+                packed[3] = glm::vec4(1.0f / std::max(light.CosInner - light.CosOuter, 0.0001f), 0.0f, 0.0f, 0.0f);
+                
+                // Tightest sphere around the cone
+                float angle = glm::radians(light.OuterAngle);
+                if (angle > glm::radians(45.0f)) {
+                    center += light.Direction * (light.Range * std::cos(angle));
+                    radius = light.Range * std::sin(angle);
+                } else {
+                    radius = light.Range / (2.0f * std::cos(angle));
+                    center += light.Direction * radius;
+                }
+            } else {
+                packed[2] = glm::vec4(0.0f, 0.0f, 0.0f, -2.0f);
+                packed[3] = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+            }
+            
+            spheres[i] = glm::vec4(glm::vec3(view * glm::vec4(center, 1.0f)), radius);
+        }
+        
+        m_ClusterLists.resize(ClusterCount);
+        
+        JobSystem::Dispatch(ClusterSlices, 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t slice = begin; slice < end; slice++) {
+                float sliceStart = slice == 0 ? nearPlane : sliceNear * std::pow(farPlane / sliceNear, static_cast<float>(slice) / ClusterSlices);
+                float sliceEnd = sliceNear * std::pow(farPlane / sliceNear, static_cast<float>(slice + 1) / ClusterSlices);
+                
+                // View-space tile borders at both ends of the slice
+                float borderX[2][ClusterTilesX + 1];
+                float borderY[2][ClusterTilesY + 1];
+                for (int side = 0; side < 2; side++) {
+                    float depth = side == 0 ? sliceStart : sliceEnd;
+                    for (uint32_t x = 0; x <= ClusterTilesX; x++) {
+                        borderX[side][x] = ViewFromNDC(projection, 0, -1.0f + 2.0f * x / ClusterTilesX, depth);
+                    }
+                    for (uint32_t y = 0; y <= ClusterTilesY; y++) {
+                        borderY[side][y] = ViewFromNDC(projection, 1, -1.0f + 2.0f * y / ClusterTilesY, depth);
+                    }
+                }
+                
+                uint32_t sliceOffset = slice * ClusterTilesX * ClusterTilesY;
+                for (uint32_t cluster = 0; cluster < ClusterTilesX * ClusterTilesY; cluster++) {
+                    m_ClusterLists[sliceOffset + cluster].clear();
+                }
+                
+                for (uint32_t i = 0; i < lightCount; i++) {
+                    glm::vec3 center(spheres[i]);
+                    float radius = spheres[i].w;
+                    float depth = -center.z;
+                    if (depth + radius < sliceStart || depth - radius > sliceEnd) continue;
+                    
+                    // Screen rectangle of the sphere's bounding box within the slice
+                    float depths[2] = { std::max(sliceStart, depth - radius), std::min(sliceEnd, depth + radius) };
+                    float minX = 2.0f, maxX = -2.0f, minY = 2.0f, maxY = -2.0f;
+                    for (float d : depths) {
+                        for (float sign = -1.0f; sign <= 1.0f; sign += 2.0f) {
+                            float x = NDCFromView(projection, 0, center.x + sign * radius, d);
+                            float y = NDCFromView(projection, 1, center.y + sign * radius, d);
+                            minX = std::min(minX, x);
+                            maxX = std::max(maxX, x);
+                            minY = std::min(minY, y);
+                            maxY = std::max(maxY, y);
+                        }
+                    }
+                    
+                    uint32_t firstX, lastX, firstY, lastY;
+                    if (!TileRange(minX, maxX, ClusterTilesX, firstX, lastX) || !TileRange(minY, maxY, ClusterTilesY, firstY, lastY)) continue;
+                    
+                    float closestZ = std::max(-sliceEnd, std::min(center.z, -sliceStart));
+                    float distanceZ = (center.z - closestZ) * (center.z - closestZ);
+                    
+                    for (uint32_t y = firstY; y <= lastY; y++) {
+                        float boxMinY = std::min(borderY[0][y], borderY[1][y]);
+                        float boxMaxY = std::max(borderY[0][y + 1], borderY[1][y + 1]);
+                        float closestY = std::max(boxMinY, std::min(center.y, boxMaxY));
+                        float distanceYZ = distanceZ + (center.y - closestY) * (center.y - closestY);
+                        
+                        for (uint32_t x = firstX; x <= lastX; x++) {
+                            float boxMinX = std::min(borderX[0][x], borderX[1][x]);
+                            float boxMaxX = std::max(borderX[0][x + 1], borderX[1][x + 1]);
+                            float closestX = std::max(boxMinX, std::min(center.x, boxMaxX));
+                            
+                            if (distanceYZ + (center.x - closestX) * (center.x - closestX) <= radius * radius) {
+                                m_ClusterLists[sliceOffset + y * ClusterTilesX + x].push_back(static_cast<uint8_t>(i));
+                            }
+                        }
+                    }
+                }
+            }
+        });
+        
+        // Flatten into one index list, four indices per word
+        uint32_t indexCount = 0;
+        for (uint32_t cluster = 0; cluster < ClusterCount; cluster++) {
+            const auto& list = m_ClusterLists[cluster];
+            if (list.empty()) continue;
+            
+            uint32_t count = std::min(static_cast<uint32_t>(list.size()), MaxClusterIndices - indexCount);
+            m_ClusterStats.DroppedIndices += static_cast<uint32_t>(list.size()) - count;
+            m_ClusterStats.MaxClusterLightCount = std::max(m_ClusterStats.MaxClusterLightCount, static_cast<uint32_t>(list.size()));
+            m_ClusterStats.OccupiedClusters++;
+            
+            m_Clusters.Cells[cluster] = indexCount | (count << 16);
+            m_Clusters.Indices.resize((indexCount + count + 3) / 4, 0);
+            for (uint32_t i = 0; i < count; i++, indexCount++) {
+                m_Clusters.Indices[indexCount / 4] |= static_cast<uint32_t>(list[i]) << ((indexCount % 4) * 8);
+            }
+        }
+        m_ClusterStats.Indices = indexCount;
+    }
+    
+}
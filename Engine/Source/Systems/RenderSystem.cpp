@@ -5,10 +5,234 @@
 #include "SpoonEngine/Renderer/Material.h"
 #include "SpoonEngine/Assets/Mesh.h"
 #include "SpoonEngine/Renderer/Shader.h"
+#include "SpoonEngine/Renderer/Buffer.h"
+#include "SpoonEngine/Renderer/Framebuffer.h"
+#include "SpoonEngine/Renderer/StreamingBuffer.h"
+#include "SpoonEngine/Renderer/GPUProfiler.h"
 #include "SpoonEngine/ECS/World.h"
+#include "SpoonEngine/Core/Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
 
 namespace SpoonEngine {
     
+    // Depth-only programs. GLSL only promises identical depth across programs for invariant
+    // outputs computed by the same expression, so lit shaders tested with EQUAL against this
+    // depth must declare `invariant gl_Position` and compute it the same way.
+    static const char* s_DepthVertexSource = R"(
+        #version 330 core
+        layout (location = 0) in vec3 a_Position;
+        
+        uniform mat4 u_Model;
+        uniform mat4 u_View;
+        uniform mat4 u_Projection;
+        
+        invariant gl_Position;
+        
+        void main() {
+            vec3 worldPos = vec3(u_Model * vec4(a_Position, 1.0));
+            gl_Position = u_Projection * u_View * vec4(worldPos, 1.0);
+        }
+    )";
+    
+    // a_DrawID sits at RendererBackend::DrawIDAttributeLocation
+    static const char* s_DepthIndirectVertexSource = R"(
+        #version 330 core
+        layout (location = 0) in vec3 a_Position;
+        layout (location = 15) in uint a_DrawID;
+        
+        layout (std140) uniform DrawTransforms {
+            mat4 u_Models[256];
+        };
+        
+        uniform mat4 u_View;
+        uniform mat4 u_Projection;
+        
+        invariant gl_Position;
+        
+        void main() {
+            vec3 worldPos = vec3(u_Models[a_DrawID] * vec4(a_Position, 1.0));
+            gl_Position = u_Projection * u_View * vec4(worldPos, 1.0);
+        }
+    )";
+    
+    static const char* s_DepthFragmentSource = R"(
+        #version 330 core
+        
+        void main() {
+        }
+    )";
+    
+    static const char* s_GBufferSource = R"(
+        layout (location = 0) out vec4 o_GBufferAlbedo;
+        layout (location = 1) out vec2 o_GBufferNormal;
+        layout (location = 2) out vec4 o_GBufferEmissive;
+        
+        // Octahedral mapping of a unit vector into [0, 1]^2
+        vec2 EncodeOctahedral(vec3 n) {
+            n /= abs(n.x) + abs(n.y) + abs(n.z);
+            vec2 e = n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+            return e * 0.5 + 0.5;
+        }
+        
+        void WriteGBuffer(vec3 albedo, vec3 normal, float specular, float shininess, vec3 emissive) {
+            o_GBufferAlbedo = vec4(albedo, specular);
+            o_GBufferNormal = EncodeOctahedral(normalize(normal));
+            o_GBufferEmissive = vec4(emissive, shininess);
+        }
+    )";
+    
+    // One triangle covering the viewport
+    static const char* s_FullscreenVertexSource = R"(
+        #version 330 core
+        layout (location = 0) in vec2 a_Position;
+        
+        out vec2 v_TexCoord;
+        
+        void main() {
+            v_TexCoord = a_Position * 0.5 + 0.5;
+            gl_Position = vec4(a_Position, 0.0, 1.0);
+        }
+    )";
+    
+    // Follows ShadowSystem::GetShadowSource and LightSystem::GetClusterSource; writes the
+    // G-buffer depth so forward draws afterwards are tested against it
+    static const char* s_DeferredLightingSource = R"(
+        uniform sampler2D u_GBufferAlbedo;
+        uniform sampler2D u_GBufferNormal;
+        uniform sampler2D u_GBufferEmissive;
+        uniform sampler2D u_GBufferDepth;
+        
+        uniform mat4 u_InverseViewProjection;
+        uniform vec3 u_CameraPosition;
+        uniform vec3 u_AmbientLight;
+        uniform vec3 u_LightDirection;
+        uniform vec3 u_LightColor;
+        uniform vec2 u_RenderSize;      // rendered part of the G-buffer in pixels
+        
+        in vec2 v_TexCoord;
+        
+        out vec4 FragColor;
+        
+        vec3 DecodeOctahedral(vec2 e) {
+            e = e * 2.0 - 1.0;
+            vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+            if (n.z < 0.0) {
+                n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+            }
+            return normalize(n);
+        }
+        
+        void main() {
+            ivec2 pixel = ivec2(v_TexCoord * u_RenderSize);
+            float depth = texelFetch(u_GBufferDepth, pixel, 0).r;
+            if (depth >= 1.0) {
+                discard;
+            }
+            
+            vec4 albedo = texelFetch(u_GBufferAlbedo, pixel, 0);
+            vec3 normal = DecodeOctahedral(texelFetch(u_GBufferNormal, pixel, 0).rg);
+            vec4 emissive = texelFetch(u_GBufferEmissive, pixel, 0);
+            float shininess = max(emissive.a, 1.0);
+            
+            vec4 world = u_InverseViewProjection * vec4(v_TexCoord * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+            vec3 worldPos = world.xyz / world.w;
+            vec3 viewDir = normalize(u_CameraPosition - worldPos);
+            float viewDepth = -(u_View * vec4(worldPos, 1.0)).z;
+            
+            vec3 diffuse = u_AmbientLight;
+            vec3 specular = vec3(0.0);
+            
+            vec3 lightDir = normalize(-u_LightDirection);
+            float lambert = dot(normal, lightDir);
+            if (lambert > 0.0) {
+                vec3 radiance = u_LightColor * (1.0 - SampleCascadedShadow(worldPos, normal, viewDepth));
+                diffuse += radiance * lambert;
+                specular += radiance * pow(max(dot(normal, normalize(lightDir + viewDir)), 0.0), shininess);
+            }
+            
+            // Only the lights of this pixel's cluster
+            uvec2 range = GetClusterLightRange(GetCluster(worldPos));
+            for (uint i = 0u; i < range.y; i++) {
+                vec3 radiance = GetClusterLightRadiance(GetClusterLightIndex(range.x + i), worldPos, normal, lightDir);
+                lambert = dot(normal, lightDir);
+                if (lambert <= 0.0) continue;
+                
+                diffuse += radiance * lambert;
+                specular += radiance * pow(max(dot(normal, normalize(lightDir + viewDir)), 0.0), shininess);
+            }
+            
+            FragColor = vec4(albedo.rgb * diffuse + specular * albedo.a + emissive.rgb, 1.0);
+            gl_FragDepth = depth;
+        }
+    )";
+    
+    // Scales the dynamic resolution target up to the output. The sharpening is an unsharp mask
+    // clamped to the neighbourhood, so it cannot ring around edges.
+    static const char* s_UpscaleFragmentSource = R"(
+        #version 330 core
+        uniform sampler2D u_Scene;
+        uniform vec2 u_SceneScale;      // rendered part of u_Scene in texture coordinates
+        uniform float u_Sharpness;
+        
+        in vec2 v_TexCoord;
+        
+        out vec4 FragColor;
+        
+        vec3 SampleScene(vec2 uv, vec2 texel) {
+            // Half a texel inside the rendered part, so bilinear taps never reach stale pixels
+            return texture(u_Scene, clamp(uv, texel * 0.5, u_SceneScale - texel * 0.5)).rgb;
+        }
+        
+        void main() {
+            vec2 texel = 1.0 / vec2(textureSize(u_Scene, 0));
+            vec2 uv = v_TexCoord * u_SceneScale;
+            vec3 center = SampleScene(uv, texel);
+            if (u_Sharpness <= 0.0) {
+                FragColor = vec4(center, 1.0);
+                return;
+            }
+            
+            vec3 north = SampleScene(uv + vec2(0.0, texel.y), texel);
+            vec3 south = SampleScene(uv - vec2(0.0, texel.y), texel);
+            vec3 east = SampleScene(uv + vec2(texel.x, 0.0), texel);
+            vec3 west = SampleScene(uv - vec2(texel.x, 0.0), texel);
+            
+            vec3 minimum = min(center, min(min(north, south), min(east, west)));
+            vec3 maximum = max(center, max(max(north, south), max(east, west)));
+            vec3 sharpened = center + (4.0 * center - north - south - east - west) * u_Sharpness;
+            FragColor = vec4(clamp(sharpened, minimum, maximum), 1.0);
+        }
+    )";
+    
+    // GPU profiler scope of the passes dynamic resolution scales
+    static const char* s_SceneScopeName = "RenderSystem::Scene";
+    
+    // Texture slots of the lighting pass
+    enum GBufferSlot : uint32_t {
+        GBufferAlbedoSlot = 0,
+        GBufferNormalSlot,
+        GBufferEmissiveSlot,
+        GBufferDepthSlot
+    };
+    
+    const char* RenderSystem::GetGBufferSource() {
+        return s_GBufferSource;
+    }
+    
+    glm::mat4 RenderSystem::GetMeshTransform(const Mesh& mesh, const glm::mat4& model) {
+        if (mesh.GetVertexFormat() != VertexFormat::Compressed) return model;
+        
+        const Vector3& offset = mesh.GetQuantizationOffset();
+        float scale = mesh.GetQuantizationScale();
+        
+        glm::mat4 dequantize(scale);
+        dequantize[3] = glm::vec4(offset.x, offset.y, offset.z, 1.0f);
+        return model * dequantize;
+    }
+    
     RenderSystem::RenderSystem() {
         m_Camera = std::make_shared<Camera>(CameraType::Perspective);
         m_Camera->SetPosition(Vector3(2, 2, 3));
@@ -22,52 +246,690 @@ namespace SpoonEngine {
     }
     
     void RenderSystem::Render(Renderer* renderer) {
+        SPOON_PROFILE_SCOPE("RenderSystem::Render");
         if (!m_Camera || !m_World) return;
         
+        // Record: gather this frame's draws on the calling thread
+        auto frame = std::make_shared<RenderFrame>();
+        frame->View = m_Camera->GetViewMatrix();
+        frame->Projection = m_Camera->GetProjectionMatrix();
+        frame->CameraPosition = glm::vec3(m_Camera->GetPosition().x, m_Camera->GetPosition().y, m_Camera->GetPosition().z);
+        frame->DepthPrePass = m_DepthPrePass;
+        frame->DeferredShading = m_DeferredShading;
+        frame->ViewportWidth = m_ViewportWidth;
+        frame->ViewportHeight = m_ViewportHeight;
+        frame->RenderWidth = m_ViewportWidth;
+        frame->RenderHeight = m_ViewportHeight;
+        m_RenderScale = 1.0f;
+        
+        if (m_DynamicResolution && m_ViewportWidth > 0 && m_ViewportHeight > 0) {
+            UpdateRenderScale();
+            m_RenderScale = m_ResolutionController.GetScale();
+            frame->DynamicResolution = true;
+            frame->RenderWidth = std::max(1u, static_cast<uint32_t>(m_ViewportWidth * m_RenderScale + 0.5f));
+            frame->RenderHeight = std::max(1u, static_cast<uint32_t>(m_ViewportHeight * m_RenderScale + 0.5f));
+            frame->UpscaleSharpness = m_UpscaleSharpness;
+        }
+        m_RenderWidth = frame->RenderWidth;
+        m_RenderHeight = frame->RenderHeight;
+        frame->AmbientLight = m_AmbientLight;
+        frame->LightDirection = m_LightDirection;
+        frame->LightColor = m_LightColor;
+        
+        if (m_LightSystem) {
+            m_LightSystem->CollectLights(*m_Camera);
+        }
+        
+        if (m_ShadowSystem) {
+            m_ShadowSystem->RenderShadows(renderer, *m_Camera, m_LightSystem ? &m_LightSystem->GetLights() : nullptr);
+            frame->Shadows = m_ShadowSystem;
+            frame->ShadowData = m_ShadowSystem->GetCascadeData();
+            frame->LocalShadows = m_ShadowSystem->GetLocalShadowData();
+        }
+        
+        // After the shadow pass so each light carries its shadow index
+        if (m_LightSystem) {
+            m_LightSystem->AssignClusters(*m_Camera);
+            frame->ClusteredLighting = true;
+            frame->Clusters = m_LightSystem->GetClusterData();
+        } else if (m_DeferredShading) {
+            // The lighting pass declares the cluster blocks either way; give it empty ones
+            frame->ClusteredLighting = true;
+            frame->Clusters.Cells.assign(LightSystem::ClusterCount, 0);
+        }
+        
+        // Materials stay mutable from game code, so a render thread gets a copy per frame
+        bool snapshotMaterials = renderer->IsThreaded();
+        m_MaterialSnapshots.clear();
+        m_IndirectBatchLookup.clear();
+        
+        m_Candidates.clear();
         for (auto entity : m_Entities) {
             if (m_World->HasComponent<Transform>(entity) && m_World->HasComponent<MeshRenderer>(entity)) {
-                auto& transform = m_World->GetComponent<Transform>(entity);
-                auto& meshRenderer = m_World->GetComponent<MeshRenderer>(entity);
+                m_Candidates.push_back({ entity, m_World->GetComponent<Transform>(entity).GetTransformMatrix() });
+            }
+        }
+        
+        if (m_OcclusionCulling) {
+            CullCandidates(frame->Projection * frame->View);
+        } else {
+            m_CullingStats = CullingStats();
+        }
+        
+        for (const auto& candidate : m_Candidates) {
+            if (candidate.Visible) {
+                auto& meshRenderer = m_World->GetComponent<MeshRenderer>(candidate.Entity);
                 
                 // Use material if available, otherwise fall back to legacy shader
                 bool useMaterial = meshRenderer.Material && meshRenderer.Material->GetShader();
                 bool useShader = meshRenderer.Shader && !useMaterial;
                 
                 if ((useMaterial || useShader) && meshRenderer.Mesh) {
-                    // Set transformation matrices
-                    glm::mat4 model = transform.GetTransformMatrix();
-                    glm::mat4 view = m_Camera->GetViewMatrix();
-                    glm::mat4 projection = m_Camera->GetProjectionMatrix();
-                    
-                    if (useMaterial) {
-                        // Use material system
-                        meshRenderer.Material->SetMat4("u_Model", model);
-                        meshRenderer.Material->SetMat4("u_View", view);
-                        meshRenderer.Material->SetMat4("u_Projection", projection);
-                        meshRenderer.Material->SetFloat3("u_CameraPosition", 
-                            glm::vec3(m_Camera->GetPosition().x, m_Camera->GetPosition().y, m_Camera->GetPosition().z));
-                        
-                        meshRenderer.Material->Bind();
-                    } else {
-                        // Legacy shader system
-                        meshRenderer.Shader->Bind();
-                        meshRenderer.Shader->SetMat4("u_Model", model);
-                        meshRenderer.Shader->SetMat4("u_View", view);
-                        meshRenderer.Shader->SetMat4("u_Projection", projection);
-                        meshRenderer.Shader->SetFloat3("u_CameraPosition", 
-                            glm::vec3(m_Camera->GetPosition().x, m_Camera->GetPosition().y, m_Camera->GetPosition().z));
+                    // A material's shader may finish compiling while the frame executes; everything
+                    // below and the draw itself use the one resolved here
+                    std::shared_ptr<Shader> shader = useMaterial ? meshRenderer.Material->GetActiveShader() : meshRenderer.Shader;
+                    if (!shader->IsReady() && Material::GetPlaceholderShader()) {
+                        // Draw anything still compiling with the placeholder, whose layout is known now
+                        shader = Material::GetPlaceholderShader();
                     }
+                    CheckVertexLayout(*shader, *meshRenderer.Mesh);
                     
-                    meshRenderer.Mesh->Bind();
-                    renderer->DrawIndexed(meshRenderer.Mesh->GetIndexCount());
-                    meshRenderer.Mesh->Unbind();
+                    uint32_t lod = SelectLOD(candidate.Entity, *meshRenderer.Mesh, candidate.Transform, *frame);
+                    glm::mat4 model = GetMeshTransform(*meshRenderer.Mesh, candidate.Transform);
                     
+                    if (useMaterial && m_IndirectDrawing && meshRenderer.Static && shader->HasUniformBlock("DrawTransforms")) {
+                        auto key = std::make_tuple(meshRenderer.Material.get(), shader.get(), meshRenderer.Mesh.get(), lod, meshRenderer.SubMesh, meshRenderer.ReceiveShadows);
+                        auto it = m_IndirectBatchLookup.find(key);
+                        if (it == m_IndirectBatchLookup.end()) {
+                            it = m_IndirectBatchLookup.emplace(key, frame->IndirectBatches.size()).first;
+                            frame->IndirectBatches.push_back({ GetFrameMaterial(meshRenderer.Material, snapshotMaterials), shader, meshRenderer.Mesh, lod,
+                                                               meshRenderer.SubMesh, meshRenderer.ReceiveShadows, {} });
+                        }
+                        frame->IndirectBatches[it->second].Transforms.push_back(model);
+                        continue;
+                    }
+                    
+                    DrawItem draw;
+                    draw.Mesh = meshRenderer.Mesh;
+                    draw.LOD = lod;
+                    draw.SubMesh = meshRenderer.SubMesh;
+                    draw.ReceiveShadows = meshRenderer.ReceiveShadows;
+                    draw.Transform = model;
+                    draw.Shader = shader;
                     if (useMaterial) {
-                        meshRenderer.Material->Unbind();
-                    } else {
-                        meshRenderer.Shader->Unbind();
+                        draw.Material = GetFrameMaterial(meshRenderer.Material, snapshotMaterials);
+                    }
+                    frame->Draws.push_back(std::move(draw));
+                }
+            }
+        }
+        
+        // Submit: runs now, or on the render thread while the next frame is recorded
+        renderer->Submit([this, frame, renderer]() {
+            ExecuteFrame(*frame, renderer);
+        });
+    }
+    
+    void RenderSystem::CullCandidates(const glm::mat4& viewProjection) {
+        SPOON_PROFILE_SCOPE("RenderSystem::Cull");
+        
+        if (!m_OcclusionCuller) {
+            m_OcclusionCuller = std::make_unique<OcclusionCuller>();
+        }
+        m_OcclusionCuller->BeginFrame(viewProjection);
+        
+        m_CullItems.clear();
+        for (const auto& candidate : m_Candidates) {
+            auto& meshRenderer = m_World->GetComponent<MeshRenderer>(candidate.Entity);
+            
+            OcclusionCuller::Item item;
+            item.Transform = candidate.Transform;
+            if (meshRenderer.Mesh) {
+                item.Bounds = meshRenderer.Mesh->GetBounds();
+                
+                if (meshRenderer.Occluder) {
+                    m_OcclusionCuller->AddOccluder(*meshRenderer.Mesh, candidate.Transform, meshRenderer.SubMesh);
+                }
+            }
+            m_CullItems.push_back(item);
+        }
+        
+        m_OcclusionCuller->Rasterize();
+        m_OcclusionCuller->Test(m_CullItems, m_CullResults);
+        m_CullingStats = m_OcclusionCuller->GetStats();
+        
+        for (size_t i = 0; i < m_Candidates.size(); i++) {
+            m_Candidates[i].Visible = m_CullResults[i] == CullResult::Visible;
+        }
+    }
+    
+    uint32_t RenderSystem::SelectLOD(EntityID entity, const Mesh& mesh, const glm::mat4& transform, const RenderFrame& frame) {
+        uint32_t lodCount = mesh.GetLODCount();
+        if (!m_LODSelection || lodCount == 1) return 0;
+        
+        const BoundingBox& bounds = mesh.GetBounds();
+        Vector3 center = bounds.GetCenter();
+        Vector3 size = bounds.GetSize();
+        
+        // LOD errors are relative to the largest local extent; scale it into world units
+        float scale = std::max(glm::length(glm::vec3(transform[0])),
+                               std::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+        float extent = std::max(size.x, std::max(size.y, size.z)) * scale;
+        
+        // Projected size of one world unit at the object's depth, as a fraction of the viewport height
+        float unitSize = frame.Projection[1][1] * 0.5f;
+        if (frame.Projection[3][3] == 0.0f) {
+            glm::vec4 viewCenter = frame.View * transform * glm::vec4(center.x, center.y, center.z, 1.0f);
+            float distance = -viewCenter.z - extent * 0.5f;
+            if (distance <= 0.0f) {
+                m_EntityLODs[entity] = 0;
+                return 0;
+            }
+            unitSize /= distance;
+        }
+        
+        auto current = m_EntityLODs.find(entity);
+        uint32_t previous = current != m_EntityLODs.end() ? current->second : 0;
+        
+        uint32_t lod = 0;
+        for (uint32_t level = lodCount - 1; level > 0; level--) {
+            float threshold = level > previous ? m_LODErrorThreshold * (1.0f - m_LODHysteresis) : m_LODErrorThreshold;
+            if (mesh.GetLODError(level) * extent * unitSize <= threshold) {
+                lod = level;
+                break;
+            }
+        }
+        
+        m_EntityLODs[entity] = lod;
+        return lod;
+    }
+    
+    void RenderSystem::CheckVertexLayout(const Shader& shader, const Mesh& mesh) {
+        // The indirect path feeds a_DrawID itself; meshes never carry it
+        uint32_t missing = shader.GetVertexInputMask() & ~mesh.GetVertexInputMask() &
+                           ~(1u << RendererBackend::DrawIDAttributeLocation);
+        if (!missing) return;
+        
+        // Missing attributes read as (0, 0, 0, 1); warn once per pair instead of every frame
+        if (m_LayoutWarnings.insert({ &shader, &mesh }).second) {
+            std::cout << "Shader " << shader.GetName() << " reads vertex attributes missing from mesh "
+                      << mesh.GetPath() << " (locations mask 0x" << std::hex << missing << std::dec << ")" << std::endl;
+        }
+    }
+    
+    std::shared_ptr<Material> RenderSystem::GetFrameMaterial(const std::shared_ptr<Material>& material, bool snapshot) {
+        if (!snapshot) return material;
+        
+        auto& copy = m_MaterialSnapshots[material.get()];
+        if (!copy) {
+            copy = std::make_shared<Material>(*material);
+        }
+        return copy;
+    }
+    
+    void RenderSystem::DrawMesh(Renderer* renderer, const Mesh& mesh, uint32_t lod, int32_t subMesh) {
+        IndexType indexType = mesh.GetIndexType(lod);
+        
+        // All ranges share the bound vertex array; only the offsets change between draws
+        uint32_t first = subMesh < 0 ? 0 : static_cast<uint32_t>(subMesh);
+        uint32_t last = subMesh < 0 ? mesh.GetSubMeshCount() : first + 1;
+        for (uint32_t s = first; s < last; s++) {
+            SubMesh range = mesh.GetDrawRange(s, lod);
+            if (range.IndexCount == 0) continue;
+            
+            renderer->DrawIndexedBaseVertex(range.IndexCount, range.BaseIndex, static_cast<int32_t>(range.BaseVertex), indexType);
+        }
+    }
+    
+    void RenderSystem::UploadClusters(const RenderFrame& frame) {
+        if (!frame.ClusteredLighting) return;
+        
+        if (!m_ClusterLights) {
+            m_ClusterLights = UniformBuffer::Create(LightSystem::MaxClusterLights * 4 * sizeof(glm::vec4));
+            m_ClusterCells = UniformBuffer::Create(LightSystem::ClusterCount * sizeof(uint32_t));
+            m_ClusterIndices = UniformBuffer::Create(LightSystem::MaxClusterIndices);
+        }
+        if (!m_ClusterLights || !m_ClusterCells || !m_ClusterIndices) return;
+        
+        // Only the used part of each block is rewritten; empty cells keep the shader away from the rest
+        const ClusterData& clusters = frame.Clusters;
+        if (!clusters.Lights.empty()) {
+            m_ClusterLights->SetData(clusters.Lights.data(), static_cast<uint32_t>(clusters.Lights.size() * sizeof(glm::vec4)));
+        }
+        m_ClusterCells->SetData(clusters.Cells.data(), static_cast<uint32_t>(clusters.Cells.size() * sizeof(uint32_t)));
+        if (!clusters.Indices.empty()) {
+            m_ClusterIndices->SetData(clusters.Indices.data(), static_cast<uint32_t>(clusters.Indices.size() * sizeof(uint32_t)));
+        }
+        
+        m_ClusterLights->Bind(LightSystem::ClusterLightsBinding);
+        m_ClusterCells->Bind(LightSystem::ClusterCellsBinding);
+        m_ClusterIndices->Bind(LightSystem::ClusterIndicesBinding);
+    }
+    
+    void RenderSystem::ApplyLighting(const RenderFrame& frame, Shader& shader, bool receiveShadows) {
+        if (!frame.Shadows && !frame.ClusteredLighting) return;
+        
+        if (std::find(m_LitShaders.begin(), m_LitShaders.end(), &shader) == m_LitShaders.end()) {
+            if (frame.Shadows) {
+                frame.ShadowData.SetUniforms(shader);
+                frame.LocalShadows.SetUniforms(shader);
+            }
+            if (frame.ClusteredLighting) {
+                frame.Clusters.SetUniforms(shader);
+            }
+            m_LitShaders.push_back(&shader);
+        }
+        if (frame.Shadows) {
+            shader.SetInt("u_ReceiveShadows", receiveShadows && m_ShadowAtlasBound);
+        }
+    }
+    
+    void RenderSystem::ExecuteFrame(const RenderFrame& frame, Renderer* renderer) {
+        SPOON_PROFILE_SCOPE("RenderSystem::ExecuteFrame");
+        SPOON_GPU_SCOPE("RenderSystem::Render");
+        
+        m_ShadowAtlasBound = frame.Shadows && frame.Shadows->BindAtlas();
+        m_LitShaders.clear();
+        UploadClusters(frame);
+        
+        // Viewport changes only: the target keeps the full viewport size
+        bool scaled = frame.DynamicResolution && CreateResolutionResources(frame);
+        if (scaled) {
+            m_SceneTarget->Bind();
+            renderer->SetViewport(0, 0, frame.RenderWidth, frame.RenderHeight);
+            renderer->Clear();
+        }
+        
+        {
+            SPOON_GPU_SCOPE(s_SceneScopeName);
+            ExecuteScene(frame, renderer);
+        }
+        
+        if (scaled) {
+            m_SceneTarget->Unbind();
+            UpscaleScene(frame, renderer);
+        }
+    }
+    
+    void RenderSystem::ExecuteScene(const RenderFrame& frame, Renderer* renderer) {
+        if (frame.DeferredShading && frame.ViewportWidth > 0 && frame.ViewportHeight > 0 && CreateDeferredResources()) {
+            ExecuteDeferredFrame(frame, renderer);
+            return;
+        }
+        
+        bool prePass = frame.DepthPrePass && ExecuteDepthPrePass(frame, renderer);
+        if (prePass) {
+            // Depth is final; only the nearest surface of each pixel passes
+            renderer->SetDepthTest(DepthFunc::Equal, false);
+        }
+        
+        renderer->BeginSampleCount(SamplePass::Shading);
+        DrawItems(frame, renderer, DrawFilter::All);
+        FlushIndirectBatches(frame, renderer, false);
+        renderer->EndSampleCount(SamplePass::Shading);
+        
+        if (prePass) {
+            renderer->SetDepthTest(DepthFunc::Less, true);
+        }
+    }
+    
+    void RenderSystem::ExecuteDeferredFrame(const RenderFrame& frame, Renderer* renderer) {
+        RenderGraphTargetDesc gbufferDesc;
+        gbufferDesc.Width = frame.ViewportWidth;
+        gbufferDesc.Height = frame.ViewportHeight;
+        gbufferDesc.Attachments = { FramebufferTextureFormat::RGBA8, FramebufferTextureFormat::RG16,
+                                    FramebufferTextureFormat::RGBA16F, FramebufferTextureFormat::Depth };
+        
+        RenderGraphResource gbuffer = RenderGraph::InvalidResource;
+        bool prePass = false;
+        
+        // The pre-pass lays its depth into the G-buffer, so forward draws later pass the EQUAL test too
+        m_RenderGraph.AddPass("GBuffer", [&](RenderGraphBuilder& builder) {
+            gbuffer = builder.Create("GBuffer", gbufferDesc);
+        }, [&](RenderGraphContext& context) {
+            // Binding the G-buffer set the viewport to its region, which may cover less than was
+            // asked for while the pooled framebuffer settles into a new size
+            Framebuffer* target = context.GetFramebuffer(gbuffer);
+            if (frame.DynamicResolution && target) {
+                FramebufferRegion region = target->GetRegion();
+                renderer->SetViewport(0, 0, std::min(frame.RenderWidth, region.Width), std::min(frame.RenderHeight, region.Height));
+            }
+            
+            prePass = frame.DepthPrePass && ExecuteDepthPrePass(frame, renderer);
+            if (prePass) {
+                renderer->SetDepthTest(DepthFunc::Equal, false);
+            }
+            
+            renderer->BeginSampleCount(SamplePass::Shading);
+            DrawItems(frame, renderer, DrawFilter::GBuffer);
+            FlushIndirectBatches(frame, renderer, false, DrawFilter::GBuffer);
+        });
+        
+        // Draws into whatever target the frame renders to
+        m_RenderGraph.AddPass("DeferredLighting", [&](RenderGraphBuilder& builder) {
+            builder.Read(gbuffer);
+            builder.SetSideEffect();
+        }, [&](RenderGraphContext& context) {
+            if (Framebuffer* target = context.GetFramebuffer(gbuffer)) {
+                ShadeGBuffer(frame, renderer, *target);
+            }
+            if (prePass) {
+                renderer->SetDepthTest(DepthFunc::Equal, false);
+            }
+            
+            DrawItems(frame, renderer, DrawFilter::Forward);
+            FlushIndirectBatches(frame, renderer, false, DrawFilter::Forward);
+            renderer->EndSampleCount(SamplePass::Shading);
+            
+            if (prePass) {
+                renderer->SetDepthTest(DepthFunc::Less, true);
+            }
+        });
+        
+        m_RenderGraph.Execute(renderer);
+    }
+    
+    bool RenderSystem::PassesFilter(const Shader& shader, DrawFilter filter) {
+        if (filter == DrawFilter::All) return true;
+        return shader.HasFragmentOutput("o_GBufferNormal") == (filter == DrawFilter::GBuffer);
+    }
+    
+    void RenderSystem::DrawItems(const RenderFrame& frame, Renderer* renderer, DrawFilter filter) {
+        // Pooled meshes of one vertex format share a vertex array; only rebind when it changes
+        const VertexArray* bound = nullptr;
+        
+        for (const auto& draw : frame.Draws) {
+            const std::shared_ptr<Shader>& shader = draw.Shader;
+            if (!PassesFilter(*shader, filter)) continue;
+            
+            if (draw.Material) {
+                draw.Material->Bind(shader);
+            } else {
+                // Legacy shader system
+                draw.Shader->Bind();
+            }
+            
+            shader->SetMat4("u_Model", draw.Transform);
+            shader->SetMat4("u_View", frame.View);
+            shader->SetMat4("u_Projection", frame.Projection);
+            shader->SetFloat3("u_CameraPosition", frame.CameraPosition);
+            shader->SetInt("u_CompressedVertices", draw.Mesh->GetVertexFormat() == VertexFormat::Compressed);
+            ApplyLighting(frame, *shader, draw.ReceiveShadows);
+            
+            const auto& vertexArray = draw.Mesh->GetDrawVertexArray(draw.LOD);
+            if (vertexArray && vertexArray.get() != bound) {
+                vertexArray->Bind();
+                bound = vertexArray.get();
+            }
+            DrawMesh(renderer, *draw.Mesh, draw.LOD, draw.SubMesh);
+            
+            if (draw.Material) {
+                draw.Material->Unbind();
+            } else {
+                draw.Shader->Unbind();
+            }
+        }
+        
+        if (bound) {
+            bound->Unbind();
+        }
+    }
+    
+    bool RenderSystem::CreateDeferredResources() {
+        if (!m_DeferredLightingShader) {
+            std::string lightingSource = std::string("#version 330 core\n") + ShadowSystem::GetShadowSource() +
+                                         LightSystem::GetClusterSource() + s_DeferredLightingSource;
+            m_DeferredLightingShader = Shader::Create("DeferredLighting", s_FullscreenVertexSource, lightingSource);
+        }
+        return m_DeferredLightingShader && CreateFullscreenTriangle();
+    }
+    
+    bool RenderSystem::CreateFullscreenTriangle() {
+        if (!m_FullscreenTriangle) {
+            float vertices[] = { -1.0f, -1.0f, 3.0f, -1.0f, -1.0f, 3.0f };
+            uint32_t indices[] = { 0, 1, 2 };
+            auto vertexBuffer = VertexBuffer::Create(vertices, sizeof(vertices));
+            auto indexBuffer = IndexBuffer::Create(indices, 3);
+            m_FullscreenTriangle = VertexArray::Create();
+            if (vertexBuffer && indexBuffer && m_FullscreenTriangle) {
+                vertexBuffer->SetLayout({ { ShaderDataType::Float2, "a_Position" } });
+                m_FullscreenTriangle->AddVertexBuffer(vertexBuffer);
+                m_FullscreenTriangle->SetIndexBuffer(indexBuffer);
+            }
+        }
+        return m_FullscreenTriangle != nullptr;
+    }
+    
+    void RenderSystem::UpdateRenderScale() {
+        GPUProfiler* profiler = GPUProfiler::Get();
+        if (!profiler || !profiler->IsEnabled()) return;
+        
+        auto result = profiler->GetLatestResult();
+        for (const auto& scope : result.Scopes) {
+            if (scope.Name == s_SceneScopeName) {
+                m_ResolutionController.Update(result.Frame, scope.GPUTime);
+                break;
+            }
+        }
+    }
+    
+    bool RenderSystem::CreateResolutionResources(const RenderFrame& frame) {
+        if (!CreateFullscreenTriangle()) return false;
+        
+        if (!m_UpscaleShader) {
+            m_UpscaleShader = Shader::Create("Upscale", s_FullscreenVertexSource, s_UpscaleFragmentSource);
+        }
+        
+        if (!m_SceneTarget) {
+            FramebufferSpecification spec;
+            spec.Width = frame.ViewportWidth;
+            spec.Height = frame.ViewportHeight;
+            spec.Attachments = { FramebufferTextureFormat::RGBA8, FramebufferTextureFormat::Depth };
+            m_SceneTarget = Framebuffer::Create(spec);
+        } else if (m_SceneTarget->GetSpecification().Width != frame.ViewportWidth ||
+                   m_SceneTarget->GetSpecification().Height != frame.ViewportHeight) {
+            m_SceneTarget->Resize(frame.ViewportWidth, frame.ViewportHeight);
+        }
+        
+        return m_UpscaleShader && m_SceneTarget && m_SceneTarget->GetColorAttachment();
+    }
+    
+    void RenderSystem::UpscaleScene(const RenderFrame& frame, Renderer* renderer) {
+        // While the target settles into a new viewport size it may cover less than was asked for
+        FramebufferRegion region = m_SceneTarget->GetRegion();
+        float scaleX = static_cast<float>(std::min(frame.RenderWidth, region.Width)) / region.AttachmentWidth;
+        float scaleY = static_cast<float>(std::min(frame.RenderHeight, region.Height)) / region.AttachmentHeight;
+        
+        renderer->SetDepthTest(DepthFunc::Always, false);
+        
+        m_SceneTarget->GetColorAttachment()->Bind(0);
+        
+        Shader& shader = *m_UpscaleShader;
+        shader.Bind();
+        shader.SetInt("u_Scene", 0);
+        shader.SetFloat2("u_SceneScale", glm::vec2(scaleX, scaleY));
+        shader.SetFloat("u_Sharpness", frame.UpscaleSharpness);
+        
+        m_FullscreenTriangle->Bind();
+        renderer->DrawIndexed(3, m_FullscreenTriangle->GetIndexBuffer()->GetIndexType());
+        m_FullscreenTriangle->Unbind();
+        shader.Unbind();
+        
+        renderer->SetDepthTest(DepthFunc::Less, true);
+    }
+    
+    void RenderSystem::ShadeGBuffer(const RenderFrame& frame, Renderer* renderer, Framebuffer& gbuffer) {
+        auto albedo = gbuffer.GetColorAttachment(0);
+        auto normal = gbuffer.GetColorAttachment(1);
+        auto emissive = gbuffer.GetColorAttachment(2);
+        auto depth = gbuffer.GetDepthAttachment();
+        if (albedo && normal && emissive && depth) {
+            albedo->Bind(GBufferAlbedoSlot);
+            normal->Bind(GBufferNormalSlot);
+            emissive->Bind(GBufferEmissiveSlot);
+            depth->Bind(GBufferDepthSlot);
+        }
+        
+        // Every covered pixel is written, so its depth replaces whatever the target held
+        renderer->SetDepthTest(DepthFunc::Always, true);
+        
+        Shader& shader = *m_DeferredLightingShader;
+        shader.Bind();
+        shader.SetInt("u_GBufferAlbedo", GBufferAlbedoSlot);
+        shader.SetInt("u_GBufferNormal", GBufferNormalSlot);
+        shader.SetInt("u_GBufferEmissive", GBufferEmissiveSlot);
+        shader.SetInt("u_GBufferDepth", GBufferDepthSlot);
+        shader.SetMat4("u_View", frame.View);
+        shader.SetMat4("u_Projection", frame.Projection);
+        shader.SetMat4("u_InverseViewProjection", glm::inverse(frame.Projection * frame.View));
+        shader.SetFloat3("u_CameraPosition", frame.CameraPosition);
+        shader.SetFloat3("u_AmbientLight", frame.AmbientLight);
+        shader.SetFloat3("u_LightDirection", frame.LightDirection);
+        shader.SetFloat3("u_LightColor", frame.LightColor);
+        FramebufferRegion region = gbuffer.GetRegion();
+        shader.SetFloat2("u_RenderSize", glm::vec2(std::min(frame.RenderWidth, region.Width), std::min(frame.RenderHeight, region.Height)));
+        ApplyLighting(frame, shader, true);
+        
+        m_FullscreenTriangle->Bind();
+        renderer->DrawIndexed(3, m_FullscreenTriangle->GetIndexBuffer()->GetIndexType());
+        m_FullscreenTriangle->Unbind();
+        shader.Unbind();
+        
+        renderer->SetDepthTest(DepthFunc::Less, true);
+    }
+    
+    bool RenderSystem::ExecuteDepthPrePass(const RenderFrame& frame, Renderer* renderer) {
+        if (!m_DepthShader) {
+            m_DepthShader = Shader::Create("DepthPrePass", s_DepthVertexSource, s_DepthFragmentSource);
+            m_DepthIndirectShader = Shader::Create("DepthPrePassIndirect", s_DepthIndirectVertexSource, s_DepthFragmentSource);
+        }
+        if (!m_DepthShader || !m_DepthIndirectShader) return false;
+        
+        SPOON_GPU_SCOPE("RenderSystem::DepthPrePass");
+        
+        renderer->SetColorWrite(false);
+        renderer->BeginSampleCount(SamplePass::DepthPrePass);
+        
+        m_DepthShader->Bind();
+        m_DepthShader->SetMat4("u_View", frame.View);
+        m_DepthShader->SetMat4("u_Projection", frame.Projection);
+        
+        const VertexArray* bound = nullptr;
+        for (const auto& draw : frame.Draws) {
+            m_DepthShader->SetMat4("u_Model", draw.Transform);
+            
+            const auto& vertexArray = draw.Mesh->GetDrawPositionVertexArray(draw.LOD);
+            if (vertexArray && vertexArray.get() != bound) {
+                vertexArray->Bind();
+                bound = vertexArray.get();
+            }
+            DrawMesh(renderer, *draw.Mesh, draw.LOD, draw.SubMesh);
+        }
+        
+        if (bound) {
+            bound->Unbind();
+        }
+        
+        m_DepthShader->Unbind();
+        
+        FlushIndirectBatches(frame, renderer, true);
+        
+        renderer->EndSampleCount(SamplePass::DepthPrePass);
+        renderer->SetColorWrite(true);
+        return true;
+    }
+    
+    void RenderSystem::FlushIndirectBatches(const RenderFrame& frame, Renderer* renderer, bool depthOnly, DrawFilter filter) {
+        if (frame.IndirectBatches.empty()) return;
+        
+        SPOON_GPU_SCOPE("RenderSystem::IndirectBatches");
+        
+        if (!m_IndirectCommands) {
+            m_IndirectCommands = IndirectBuffer::Create(MaxDrawTransforms);
+            m_DrawTransformStream = StreamingBuffer::Create(StreamingBufferUsage::Uniform, DrawTransformsStreamSize);
+            m_DrawTransforms = UniformBuffer::Create(MaxDrawTransforms * sizeof(glm::mat4));
+            m_IndirectCommandScratch.resize(MaxDrawTransforms);
+        }
+        if (!m_IndirectCommands || !m_DrawTransforms) return;
+        
+        std::vector<DrawElementsIndirectCommand>& commands = m_IndirectCommandScratch;
+        
+        for (const auto& batch : frame.IndirectBatches) {
+            if (!depthOnly && !PassesFilter(*batch.Shader, filter)) continue;
+            
+            std::shared_ptr<Shader> shader;
+            if (depthOnly) {
+                shader = m_DepthIndirectShader;
+                shader->Bind();
+                batch.Mesh->BindPositions(batch.LOD);
+            } else {
+                shader = batch.Shader;
+                batch.Material->Bind(shader);
+                shader->SetFloat3("u_CameraPosition", frame.CameraPosition);
+                shader->SetInt("u_CompressedVertices", batch.Mesh->GetVertexFormat() == VertexFormat::Compressed);
+                ApplyLighting(frame, *shader, batch.ReceiveShadows);
+                batch.Mesh->Bind(batch.LOD);
+            }
+            
+            shader->SetMat4("u_View", frame.View);
+            shader->SetMat4("u_Projection", frame.Projection);
+            shader->SetUniformBlockBinding("DrawTransforms", DrawTransformsBinding);
+            
+            // One command per sub-mesh range and transform
+            std::vector<SubMesh> ranges;
+            uint32_t firstRange = batch.SubMesh < 0 ? 0 : static_cast<uint32_t>(batch.SubMesh);
+            uint32_t lastRange = batch.SubMesh < 0 ? batch.Mesh->GetSubMeshCount() : firstRange + 1;
+            for (uint32_t s = firstRange; s < lastRange; s++) {
+                SubMesh range = batch.Mesh->GetDrawRange(s, batch.LOD);
+                if (range.IndexCount > 0) {
+                    ranges.push_back(range);
+                }
+            }
+            
+            uint32_t rangeCount = std::max(1u, static_cast<uint32_t>(ranges.size()));
+            uint32_t transformsPerDraw = std::max(1u, MaxDrawTransforms / rangeCount);
+            uint32_t total = static_cast<uint32_t>(batch.Transforms.size());
+            
+            // Every draw in a bucket shares the mesh; a_DrawID (BaseInstance) selects the transform
+            for (uint32_t first = 0; first < total && !ranges.empty(); first += transformsPerDraw) {
+                uint32_t count = std::min(total - first, transformsPerDraw);
+                
+                uint32_t commandCount = 0;
+                for (uint32_t i = 0; i < count; i++) {
+                    for (const auto& range : ranges) {
+                        if (commandCount == MaxDrawTransforms) break;
+                        commands[commandCount++] = { range.IndexCount, 1, range.BaseIndex, static_cast<int32_t>(range.BaseVertex), i };
                     }
                 }
+                
+                uint32_t size = count * sizeof(glm::mat4);
+                
+                // Write straight into this frame's streaming region; only fall back to a
+                // driver-side copy once the frame budget is used up
+                StreamingAllocation allocation;
+                if (m_DrawTransformStream) {
+                    allocation = m_DrawTransformStream->Allocate(size);
+                }
+                
+                if (allocation) {
+                    memcpy(allocation.Data, &batch.Transforms[first], size);
+                    m_DrawTransformStream->Commit(allocation);
+                    m_DrawTransformStream->BindRange(DrawTransformsBinding, allocation);
+                } else {
+                    m_DrawTransforms->SetData(&batch.Transforms[first], size);
+                    m_DrawTransforms->Bind(DrawTransformsBinding);
+                }
+                m_IndirectCommands->SetData(commands.data(), commandCount);
+                
+                renderer->DrawIndexedIndirect(*m_IndirectCommands, commandCount, batch.Mesh->GetIndexType(batch.LOD));
+            }
+            
+            if (depthOnly) {
+                batch.Mesh->UnbindPositions();
+                shader->Unbind();
+            } else {
+                batch.Mesh->Unbind();
+                batch.Material->Unbind();
             }
         }
     }
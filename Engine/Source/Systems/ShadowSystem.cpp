@@ -0,0 +1,955 @@
+#include "SpoonEngine/Systems/ShadowSystem.h"
+#include "SpoonEngine/Systems/RenderSystem.h"
+#include "SpoonEngine/Systems/LightSystem.h"
+#include "SpoonEngine/Components/Transform.h"
+#include "SpoonEngine/Renderer/Camera.h"
+#include "SpoonEngine/Renderer/Renderer.h"
+#include "SpoonEngine/Renderer/Framebuffer.h"
+#include "SpoonEngine/Renderer/Shader.h"
+#include "SpoonEngine/Renderer/GPUProfiler.h"
+#include "SpoonEngine/Assets/Mesh.h"
+#include "SpoonEngine/ECS/World.h"
+#include "SpoonEngine/Core/Profiler.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace SpoonEngine {
+    
+    static const char* s_ShadowDepthVertexSource = R"(
+        #version 330 core
+        layout (location = 0) in vec3 a_Position;
+        
+        uniform mat4 u_Model;
+        uniform mat4 u_LightSpaceMatrix;
+        
+        void main() {
+            gl_Position = u_LightSpaceMatrix * u_Model * vec4(a_Position, 1.0);
+        }
+    )";
+    
+    static const char* s_ShadowDepthFragmentSource = R"(
+        #version 330 core
+        
+        void main() {
+        }
+    )";
+    
+    static const char* s_ShadowSource = R"(
+        uniform sampler2D u_ShadowAtlas;
+        uniform int u_CascadeCount;
+        uniform bool u_ReceiveShadows;
+        uniform mat4 u_CascadeMatrices[4];
+        uniform vec4 u_CascadeRects[4];
+        uniform vec4 u_CascadeSplits;
+        uniform vec4 u_CascadeTexelSizes;
+        uniform vec3 u_ShadowLightDirection;
+        
+        float SampleCascadedShadow(vec3 worldPos, vec3 normal, float viewDepth) {
+            if (!u_ReceiveShadows || u_CascadeCount == 0 || viewDepth > u_CascadeSplits[u_CascadeCount - 1]) {
+                return 0.0;
+            }
+            
+            int cascade = 0;
+            while (cascade < u_CascadeCount - 1 && viewDepth > u_CascadeSplits[cascade]) {
+                cascade++;
+            }
+            
+            // Offsetting along the normal by a texel or so removes acne at any cascade scale;
+            // grazing surfaces need the most
+            vec3 n = normalize(normal);
+            float grazing = 1.0 - abs(dot(n, u_ShadowLightDirection));
+            vec3 position = worldPos + n * u_CascadeTexelSizes[cascade] * (0.5 + 1.5 * grazing);
+            
+            vec4 coord = u_CascadeMatrices[cascade] * vec4(position, 1.0);
+            vec4 rect = u_CascadeRects[cascade];
+            vec2 texel = 1.0 / vec2(textureSize(u_ShadowAtlas, 0));
+            
+            // 3x3 PCF kept inside the cascade's tile
+            float shadow = 0.0;
+            for (int x = -1; x <= 1; x++) {
+                for (int y = -1; y <= 1; y++) {
+                    vec2 uv = clamp(coord.xy + vec2(x, y) * texel, rect.xy, rect.zw);
+                    shadow += coord.z - 0.0005 > texture(u_ShadowAtlas, uv).r ? 1.0 : 0.0;
+                }
+            }
+            return shadow / 9.0;
+        }
+        
+        uniform sampler2D u_LocalShadowAtlas;
+        uniform vec4 u_LocalShadows[32];
+        uniform vec4 u_LocalShadowParams[32];
+        uniform mat4 u_LocalShadowMatrices[64];
+        uniform vec4 u_LocalShadowRects[64];
+        
+        float SampleLocalShadow(int shadowIndex, vec3 worldPos, vec3 normal) {
+            if (!u_ReceiveShadows || shadowIndex < 0) {
+                return 0.0;
+            }
+            
+            vec4 light = u_LocalShadows[shadowIndex];
+            vec4 params = u_LocalShadowParams[shadowIndex];
+            vec3 fromLight = worldPos - light.xyz;
+            float distance = max(length(fromLight), 0.0001);
+            
+            // Point lights use the cube face the fragment falls in: +X, -X, +Y, -Y, +Z, -Z
+            int tile = int(light.w);
+            if (params.x > 1.0) {
+                vec3 a = abs(fromLight);
+                if (a.x >= a.y && a.x >= a.z) {
+                    tile += fromLight.x > 0.0 ? 0 : 1;
+                } else if (a.y >= a.z) {
+                    tile += fromLight.y > 0.0 ? 2 : 3;
+                } else {
+                    tile += fromLight.z > 0.0 ? 4 : 5;
+                }
+            }
+            
+            // Perspective texels grow with distance from the light, and so do the normal and
+            // light-ward offsets standing in for a depth bias
+            float texelSize = distance * params.y;
+            vec3 position = worldPos + normalize(normal) * texelSize * 1.5 - fromLight / distance * texelSize;
+            
+            vec4 coord = u_LocalShadowMatrices[tile] * vec4(position, 1.0);
+            coord.xyz /= coord.w;
+            vec4 rect = u_LocalShadowRects[tile];
+            vec2 texel = 1.0 / vec2(textureSize(u_LocalShadowAtlas, 0));
+            
+            float shadow = 0.0;
+            for (int x = -1; x <= 1; x++) {
+                for (int y = -1; y <= 1; y++) {
+                    vec2 uv = clamp(coord.xy + vec2(x, y) * texel, rect.xy, rect.zw);
+                    shadow += coord.z > texture(u_LocalShadowAtlas, uv).r ? 1.0 : 0.0;
+                }
+            }
+            return shadow / 9.0;
+        }
+    )";
+    
+    static const char* s_CascadeMatrixNames[] = {
+        "u_CascadeMatrices[0]", "u_CascadeMatrices[1]", "u_CascadeMatrices[2]", "u_CascadeMatrices[3]"
+    };
+    
+    static const char* s_CascadeRectNames[] = {
+        "u_CascadeRects[0]", "u_CascadeRects[1]", "u_CascadeRects[2]", "u_CascadeRects[3]"
+    };
+    
+    static BoundingBox TransformBounds(const BoundingBox& bounds, const glm::mat4& transform) {
+        BoundingBox result;
+        for (int c = 0; c < 8; c++) {
+            glm::vec4 corner(c & 1 ? bounds.Max.x : bounds.Min.x,
+                             c & 2 ? bounds.Max.y : bounds.Min.y,
+                             c & 4 ? bounds.Max.z : bounds.Min.z, 1.0f);
+            glm::vec4 world = transform * corner;
+            result.Expand(Vector3(world.x, world.y, world.z));
+        }
+        return result;
+    }
+    
+    static bool SphereTouchesBox(const glm::vec3& center, float radius, const BoundingBox& bounds) {
+        glm::vec3 closest = glm::clamp(center, glm::vec3(bounds.Min.x, bounds.Min.y, bounds.Min.z),
+                                       glm::vec3(bounds.Max.x, bounds.Max.y, bounds.Max.z));
+        glm::vec3 offset = closest - center;
+        return glm::dot(offset, offset) <= radius * radius;
+    }
+    
+    // Box against the frustum planes of a view-projection matrix; unlike testing projected
+    // corners this holds for perspective frusta with corners behind the eye
+    static bool BoxInFrustum(const glm::mat4& viewProjection, const BoundingBox& bounds) {
+        for (int i = 0; i < 6; i++) {
+            int row = i / 2;
+            float sign = i % 2 == 0 ? 1.0f : -1.0f;
+            glm::vec4 plane(viewProjection[0][3] + sign * viewProjection[0][row],
+                            viewProjection[1][3] + sign * viewProjection[1][row],
+                            viewProjection[2][3] + sign * viewProjection[2][row],
+                            viewProjection[3][3] + sign * viewProjection[3][row]);
+            
+            // Corner furthest along the plane normal
+            glm::vec3 corner(plane.x >= 0.0f ? bounds.Max.x : bounds.Min.x,
+                             plane.y >= 0.0f ? bounds.Max.y : bounds.Min.y,
+                             plane.z >= 0.0f ? bounds.Max.z : bounds.Min.z);
+            if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    // Clip space to [0, 1] and then into the tile, applied before the divide by w
+    static glm::mat4 TileToAtlas(const FramebufferTile& tile, float atlasSize) {
+        float scale = tile.Size / atlasSize;
+        glm::mat4 toAtlas(1.0f);
+        toAtlas[0][0] = 0.5f * scale;
+        toAtlas[1][1] = 0.5f * scale;
+        toAtlas[2][2] = 0.5f;
+        toAtlas[3] = glm::vec4(tile.X / atlasSize + 0.5f * scale, tile.Y / atlasSize + 0.5f * scale, 0.5f, 1.0f);
+        return toAtlas;
+    }
+    
+    void ShadowCascadeData::SetUniforms(Shader& shader) const {
+        shader.SetInt("u_ShadowAtlas", ShadowSystem::AtlasTextureSlot);
+        shader.SetInt("u_CascadeCount", static_cast<int>(CascadeCount));
+        for (uint32_t i = 0; i < CascadeCount; i++) {
+            shader.SetMat4(s_CascadeMatrixNames[i], Matrices[i]);
+            shader.SetFloat4(s_CascadeRectNames[i], Rects[i]);
+        }
+        shader.SetFloat4("u_CascadeSplits", Splits);
+        shader.SetFloat4("u_CascadeTexelSizes", TexelSizes);
+        shader.SetFloat3("u_ShadowLightDirection", LightDirection);
+    }
+    
+    void LocalShadowData::SetUniforms(Shader& shader) const {
+        shader.SetInt("u_LocalShadowAtlas", ShadowSystem::LocalAtlasTextureSlot);
+        if (ShadowCount == 0) return;
+        
+        shader.SetFloat4Array("u_LocalShadows", Shadows, ShadowCount);
+        shader.SetFloat4Array("u_LocalShadowParams", Params, ShadowCount);
+        shader.SetMat4Array("u_LocalShadowMatrices", Matrices, TileCount);
+        shader.SetFloat4Array("u_LocalShadowRects", Rects, TileCount);
+    }
+    
+    ShadowSystem::ShadowSystem() {
+        for (uint32_t i = 0; i < MaxCascades; i++) {
+            m_Cascades[i].Interval = 1u << i;
+        }
+    }
+    
+    ShadowSystem::~ShadowSystem() = default;
+    
+    const char* ShadowSystem::GetShadowSource() {
+        return s_ShadowSource;
+    }
+    
+    void ShadowSystem::SetLightDirection(const glm::vec3& direction) {
+        glm::vec3 normalized = glm::normalize(direction);
+        if (normalized == m_LightDirection) return;
+        
+        m_LightDirection = normalized;
+        InvalidateCascades();
+    }
+    
+    void ShadowSystem::SetCascadeCount(uint32_t count) {
+        count = std::max(1u, std::min(count, MaxCascades));
+        if (count == m_CascadeCount) return;
+        
+        m_CascadeCount = count;
+        InvalidateCascades();
+    }
+    
+    void ShadowSystem::SetResolution(uint32_t resolution) {
+        if (resolution == 0 || resolution == m_Resolution) return;
+        
+        m_Resolution = resolution;
+        InvalidateCascades();
+    }
+    
+    void ShadowSystem::SetUpdateInterval(uint32_t cascade, uint32_t frames) {
+        if (cascade < MaxCascades) {
+            m_Cascades[cascade].Interval = std::max(1u, frames);
+        }
+    }
+    
+    void ShadowSystem::SetStaticCaching(bool enabled) {
+        m_StaticCaching = enabled;
+        InvalidateCascades();
+    }
+    
+    static uint32_t RoundUpToPowerOfTwo(uint32_t value) {
+        uint32_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+    
+    void ShadowSystem::SetLocalAtlasSize(uint32_t size) {
+        if (size == 0) return;
+        m_LocalAtlasSize = RoundUpToPowerOfTwo(size);
+    }
+    
+    void ShadowSystem::SetLocalTileSizes(uint32_t minimum, uint32_t maximum) {
+        // Face projections are widened by a texel on each side, which needs a few to spare
+        m_MinLocalTileSize = RoundUpToPowerOfTwo(std::max(16u, minimum));
+        m_MaxLocalTileSize = std::max(m_MinLocalTileSize, RoundUpToPowerOfTwo(maximum));
+        
+        // Reallocated at the new sizes on the next update
+        for (auto& entry : m_LocalShadows) {
+            FreeLocalTiles(entry.second);
+        }
+    }
+    
+    void ShadowSystem::InvalidateCascades() {
+        for (auto& cascade : m_Cascades) {
+            cascade.Valid = false;
+            cascade.StaticDirty = true;
+        }
+    }
+    
+    void ShadowSystem::RenderShadows(Renderer* renderer, const Camera& camera, std::vector<LightData>* lights) {
+        SPOON_PROFILE_SCOPE("ShadowSystem::RenderShadows");
+        
+        m_Stats = ShadowStats();
+        if (!m_World) return;
+        
+        m_FrameIndex++;
+        
+        m_Casters.clear();
+        for (auto entity : m_Entities) {
+            if (!m_World->HasComponent<Transform>(entity) || !m_World->HasComponent<MeshRenderer>(entity)) continue;
+            
+            const auto& meshRenderer = m_World->GetComponent<MeshRenderer>(entity);
+            if (!meshRenderer.CastShadows || !meshRenderer.Mesh) continue;
+            
+            glm::mat4 transform = m_World->GetComponent<Transform>(entity).GetTransformMatrix();
+            m_Casters.push_back({ entity, &meshRenderer, transform, TransformBounds(meshRenderer.Mesh->GetBounds(), transform) });
+        }
+        
+        TrackCasters();
+        
+        // Split distances between uniform and logarithmic
+        float nearPlane = camera.GetNearPlane();
+        float farPlane = camera.GetFarPlane();
+        float shadowFar = std::min(m_ShadowDistance, farPlane);
+        
+        float splits[MaxCascades];
+        for (uint32_t i = 0; i < m_CascadeCount; i++) {
+            float p = static_cast<float>(i + 1) / static_cast<float>(m_CascadeCount);
+            float uniform = nearPlane + (shadowFar - nearPlane) * p;
+            float logarithmic = nearPlane * std::pow(shadowFar / nearPlane, p);
+            splits[i] = uniform + (logarithmic - uniform) * m_SplitLambda;
+        }
+        
+        // Frustum corner rays; positions along them are linear in view depth
+        glm::mat4 inverse = glm::inverse(camera.GetViewProjectionMatrix());
+        glm::vec3 nearCorners[4];
+        glm::vec3 farCorners[4];
+        for (int c = 0; c < 4; c++) {
+            float x = c & 1 ? 1.0f : -1.0f;
+            float y = c & 2 ? 1.0f : -1.0f;
+            glm::vec4 nearCorner = inverse * glm::vec4(x, y, -1.0f, 1.0f);
+            glm::vec4 farCorner = inverse * glm::vec4(x, y, 1.0f, 1.0f);
+            nearCorners[c] = glm::vec3(nearCorner) / nearCorner.w;
+            farCorners[c] = glm::vec3(farCorner) / farCorner.w;
+        }
+        
+        auto frame = std::make_shared<ShadowFrame>();
+        frame->Resolution = m_Resolution;
+        frame->CascadeCount = m_CascadeCount;
+        
+        uint32_t columns = m_CascadeCount > 1 ? 2 : 1;
+        uint32_t rows = (m_CascadeCount + 1) / 2;
+        float atlasWidth = static_cast<float>(m_Resolution * columns);
+        float atlasHeight = static_cast<float>(m_Resolution * rows);
+        
+        float previous = nearPlane;
+        for (uint32_t i = 0; i < m_CascadeCount; i++) {
+            float t0 = (previous - nearPlane) / (farPlane - nearPlane);
+            float t1 = (splits[i] - nearPlane) / (farPlane - nearPlane);
+            previous = splits[i];
+            
+            glm::vec3 corners[8];
+            for (int c = 0; c < 4; c++) {
+                corners[c] = nearCorners[c] + (farCorners[c] - nearCorners[c]) * t0;
+                corners[c + 4] = nearCorners[c] + (farCorners[c] - nearCorners[c]) * t1;
+            }
+            
+            bool refit = FitCascade(i, corners);
+            Cascade& cascade = m_Cascades[i];
+            float texelSize = 2.0f * cascade.Radius / static_cast<float>(m_Resolution);
+            
+            m_Data.Splits[i] = splits[i];
+            m_Data.TexelSizes[i] = texelSize;
+            
+            // Staggered so far cascades sharing an interval do not all update on the same frame
+            if (!refit && !cascade.StaticDirty && (m_FrameIndex + i) % cascade.Interval != 0) continue;
+            
+            bool renderStatic = cascade.StaticDirty || !m_StaticCaching;
+            
+            CascadePass pass;
+            pass.Cascade = i;
+            pass.ViewProjection = cascade.ViewProjection;
+            pass.X = (i % columns) * m_Resolution;
+            pass.Y = (i / columns) * m_Resolution;
+            pass.RenderStatic = renderStatic;
+            
+            for (const auto& caster : m_Casters) {
+                bool cached = caster.Component->Static;
+                if (cached && !renderStatic) continue;
+                
+                m_Stats.CastersTested++;
+                if (!Overlaps(cascade, caster.Bounds)) continue;
+                
+                const auto& mesh = caster.Component->Mesh;
+                CasterDraw draw;
+                draw.Mesh = mesh;
+                draw.LOD = SelectLOD(*mesh, caster.Transform, texelSize);
+                draw.SubMesh = caster.Component->SubMesh;
+                draw.Transform = RenderSystem::GetMeshTransform(*mesh, caster.Transform);
+                
+                if (cached) {
+                    pass.StaticCasters.push_back(std::move(draw));
+                } else {
+                    pass.DynamicCasters.push_back(std::move(draw));
+                }
+            }
+            
+            // Texture coordinates: clip space to [0, 1], then into the cascade's tile
+            glm::vec2 scale(m_Resolution / atlasWidth, m_Resolution / atlasHeight);
+            glm::vec2 offset(pass.X / atlasWidth, pass.Y / atlasHeight);
+            glm::mat4 toAtlas(1.0f);
+            toAtlas[0][0] = 0.5f * scale.x;
+            toAtlas[1][1] = 0.5f * scale.y;
+            toAtlas[2][2] = 0.5f;
+            toAtlas[3] = glm::vec4(offset.x + 0.5f * scale.x, offset.y + 0.5f * scale.y, 0.5f, 1.0f);
+            
+            glm::vec2 halfTexel(0.5f / atlasWidth, 0.5f / atlasHeight);
+            m_Data.Matrices[i] = toAtlas * cascade.ViewProjection;
+            m_Data.Rects[i] = glm::vec4(offset + halfTexel, offset + scale - halfTexel);
+            
+            m_Stats.CascadesRendered++;
+            m_Stats.CascadesRefit += refit ? 1 : 0;
+            m_Stats.StaticCascadesRendered += renderStatic ? 1 : 0;
+            m_Stats.StaticDraws += static_cast<uint32_t>(pass.StaticCasters.size());
+            m_Stats.DynamicDraws += static_cast<uint32_t>(pass.DynamicCasters.size());
+            
+            cascade.StaticDirty = false;
+            frame->Passes.push_back(std::move(pass));
+        }
+        
+        m_Data.CascadeCount = m_CascadeCount;
+        m_Data.LightDirection = m_LightDirection;
+        
+        if (lights) {
+            UpdateLocalShadows(camera, *lights, *frame);
+        } else {
+            m_LocalData.ShadowCount = 0;
+            m_LocalData.TileCount = 0;
+        }
+        
+        if (frame->Passes.empty() && frame->LocalPasses.empty()) return;
+        
+        renderer->Submit([this, frame, renderer]() {
+            ExecuteShadows(*frame, renderer);
+        });
+    }
+    
+    bool ShadowSystem::FitCascade(uint32_t index, const glm::vec3* corners) {
+        Cascade& cascade = m_Cascades[index];
+        
+        glm::vec3 center(0.0f);
+        for (int c = 0; c < 8; c++) {
+            center += corners[c];
+        }
+        center /= 8.0f;
+        
+        float radius = 0.0f;
+        for (int c = 0; c < 8; c++) {
+            radius = std::max(radius, glm::length(corners[c] - center));
+        }
+        
+        // Keep the cascade while the split's sphere stays inside it and it has not become
+        // needlessly coarse (the camera's projection changed)
+        if (cascade.Valid && glm::length(center - cascade.Center) + radius <= cascade.Radius &&
+            radius * m_Padding >= cascade.Radius * 0.75f) {
+            return false;
+        }
+        
+        // Rounded up so a split that wobbles by float error keeps the same texel size
+        float padded = std::ceil(radius * m_Padding * 16.0f) / 16.0f;
+        float texelSize = 2.0f * padded / static_cast<float>(m_Resolution);
+        
+        glm::vec3 up = std::abs(m_LightDirection.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::mat4 rotation = glm::lookAt(glm::vec3(0.0f), m_LightDirection, up);
+        
+        // Snap the centre to whole texels across the light so a refit moves existing shadow
+        // edges by whole texels instead of making them crawl
+        glm::vec3 lightCenter = glm::vec3(rotation * glm::vec4(center, 1.0f));
+        lightCenter.x = std::floor(lightCenter.x / texelSize) * texelSize;
+        lightCenter.y = std::floor(lightCenter.y / texelSize) * texelSize;
+        center = glm::vec3(glm::inverse(rotation) * glm::vec4(lightCenter, 1.0f));
+        
+        float distance = padded + m_CasterPullback;
+        glm::mat4 view = glm::lookAt(center - m_LightDirection * distance, center, up);
+        glm::mat4 projection = glm::ortho(-padded, padded, -padded, padded, 0.0f, distance + padded);
+        
+        cascade.ViewProjection = projection * view;
+        cascade.Center = center;
+        cascade.Radius = padded;
+        cascade.Valid = true;
+        cascade.StaticDirty = true;
+        return true;
+    }
+    
+    bool ShadowSystem::Overlaps(const Cascade& cascade, const BoundingBox& bounds) const {
+        glm::vec3 minimum(FLT_MAX);
+        glm::vec3 maximum(-FLT_MAX);
+        for (int c = 0; c < 8; c++) {
+            glm::vec4 corner(c & 1 ? bounds.Max.x : bounds.Min.x,
+                             c & 2 ? bounds.Max.y : bounds.Min.y,
+                             c & 4 ? bounds.Max.z : bounds.Min.z, 1.0f);
+            glm::vec3 clip = glm::vec3(cascade.ViewProjection * corner);
+            minimum = glm::min(minimum, clip);
+            maximum = glm::max(maximum, clip);
+        }
+        
+        return maximum.x >= -1.0f && minimum.x <= 1.0f &&
+               maximum.y >= -1.0f && minimum.y <= 1.0f &&
+               maximum.z >= -1.0f && minimum.z <= 1.0f;
+    }
+    
+    void ShadowSystem::TrackCasters() {
+        m_ChangedBounds.clear();
+        
+        for (const auto& caster : m_Casters) {
+            bool isStatic = caster.Component->Static;
+            const Mesh* mesh = caster.Component->Mesh.get();
+            
+            auto it = m_TrackedCasters.find(caster.Entity);
+            if (it == m_TrackedCasters.end()) {
+                m_TrackedCasters.emplace(caster.Entity, TrackedCaster{ caster.Transform, caster.Bounds, mesh, isStatic, m_FrameIndex });
+                m_ChangedBounds.push_back(caster.Bounds);
+                if (isStatic) InvalidateStatic(caster.Bounds);
+                continue;
+            }
+            
+            TrackedCaster& tracked = it->second;
+            if (tracked.Transform != caster.Transform || tracked.Mesh != mesh) {
+                // Both where it was and where it is now
+                m_ChangedBounds.push_back(tracked.Bounds);
+                m_ChangedBounds.push_back(caster.Bounds);
+                if (tracked.Static || isStatic) {
+                    InvalidateStatic(tracked.Bounds);
+                    InvalidateStatic(caster.Bounds);
+                }
+            } else if (tracked.Static != isStatic) {
+                // Moves between the cached depth and the per-update depth
+                InvalidateStatic(caster.Bounds);
+            }
+            
+            tracked.Transform = caster.Transform;
+            tracked.Bounds = caster.Bounds;
+            tracked.Mesh = mesh;
+            tracked.Static = isStatic;
+            tracked.Seen = m_FrameIndex;
+        }
+        
+        // Destroyed or no longer casting
+        for (auto it = m_TrackedCasters.begin(); it != m_TrackedCasters.end();) {
+            if (it->second.Seen != m_FrameIndex) {
+                m_ChangedBounds.push_back(it->second.Bounds);
+                if (it->second.Static) InvalidateStatic(it->second.Bounds);
+                it = m_TrackedCasters.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    
+    void ShadowSystem::InvalidateStatic(const BoundingBox& bounds) {
+        if (!m_StaticCaching) return;
+        
+        for (uint32_t i = 0; i < m_CascadeCount; i++) {
+            Cascade& cascade = m_Cascades[i];
+            if (cascade.Valid && !cascade.StaticDirty && Overlaps(cascade, bounds)) {
+                cascade.StaticDirty = true;
+            }
+        }
+    }
+    
+    uint32_t ShadowSystem::SelectLOD(const Mesh& mesh, const glm::mat4& transform, float texelSize) const {
+        uint32_t lodCount = mesh.GetLODCount();
+        if (lodCount == 1) return 0;
+        
+        // LOD errors are relative to the largest local extent, like RenderSystem::SelectLOD
+        Vector3 size = mesh.GetBounds().GetSize();
+        float scale = std::max(glm::length(glm::vec3(transform[0])),
+                               std::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+        float extent = std::max(size.x, std::max(size.y, size.z)) * scale;
+        
+        // Coarsest level whose error stays under one shadow texel
+        for (uint32_t level = lodCount - 1; level > 0; level--) {
+            if (mesh.GetLODError(level) * extent <= texelSize) {
+                return level;
+            }
+        }
+        return 0;
+    }
+    
+    void ShadowSystem::UpdateLocalShadows(const Camera& camera, std::vector<LightData>& lights, ShadowFrame& frame) {
+        SPOON_PROFILE_SCOPE("ShadowSystem::UpdateLocalShadows");
+        
+        if (m_LocalTiles.GetSize() != m_LocalAtlasSize) {
+            m_LocalShadows.clear();
+            m_LocalTiles.Reset(m_LocalAtlasSize);
+        }
+        
+        // Projected size of each shadowed light's range as a fraction of the viewport height
+        glm::vec3 cameraPosition(camera.GetPosition().x, camera.GetPosition().y, camera.GetPosition().z);
+        float focal = camera.GetProjectionMatrix()[1][1];
+        
+        std::vector<std::pair<float, size_t>> candidates;
+        for (size_t i = 0; i < lights.size(); i++) {
+            lights[i].ShadowIndex = -1;
+            if (!lights[i].CastShadows) continue;
+            
+            float distance = glm::length(lights[i].Position - cameraPosition);
+            float coverage = distance > lights[i].Range ? lights[i].Range * focal / distance : 1.0f;
+            candidates.push_back({ std::min(coverage, 1.0f), i });
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const std::pair<float, size_t>& a, const std::pair<float, size_t>& b) {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        });
+        
+        // The shader's uniform arrays bound how many lights have shadows at once
+        std::vector<std::pair<LocalShadow*, LightData*>> active;
+        uint32_t tileCount = 0;
+        for (const auto& candidate : candidates) {
+            LightData& light = lights[candidate.second];
+            uint32_t faceCount = light.Type == LightType::Point ? 6 : 1;
+            if (active.size() == MaxLocalShadows) break;
+            if (tileCount + faceCount > MaxLocalShadowTiles) continue;
+            
+            LocalShadow& shadow = m_LocalShadows[light.Entity];
+            if (shadow.FaceCount != 0 && shadow.FaceCount != faceCount) {
+                FreeLocalTiles(shadow);
+            }
+            shadow.Seen = m_FrameIndex;
+            shadow.Coverage = candidate.first;
+            
+            tileCount += faceCount;
+            active.push_back({ &shadow, &light });
+        }
+        
+        // Off screen, no longer casting or crowded out: their tiles go back first
+        for (auto it = m_LocalShadows.begin(); it != m_LocalShadows.end();) {
+            if (it->second.Seen != m_FrameIndex) {
+                FreeLocalTiles(it->second);
+                it = m_LocalShadows.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        
+        // Largest lights pick tile sizes first, while space lasts
+        for (const auto& entry : active) {
+            LocalShadow& shadow = *entry.first;
+            uint32_t faceCount = entry.second->Type == LightType::Point ? 6 : 1;
+            
+            uint32_t size = m_MaxLocalTileSize;
+            while (size > m_MinLocalTileSize && size / 2 >= shadow.Coverage * m_MaxLocalTileSize) {
+                size /= 2;
+            }
+            
+            // Shrinking waits until a quarter of the current size would do, so lights hovering
+            // around a size boundary are not reallocated and re-rendered every frame
+            uint32_t current = shadow.FaceCount ? shadow.Tiles[0].Size : 0;
+            if (current != 0 && size <= current && size * 4 > current) continue;
+            
+            // A light that cannot grow keeps what it has; one without tiles settles for less
+            if (AllocateLocalTiles(shadow, faceCount, size) || current != 0) continue;
+            for (size /= 2; size >= m_MinLocalTileSize; size /= 2) {
+                if (AllocateLocalTiles(shadow, faceCount, size)) break;
+            }
+        }
+        
+        // Out of date: tiles never rendered, the light changed, or a caster in its range did
+        std::vector<size_t> pending;
+        for (size_t i = 0; i < active.size(); i++) {
+            LocalShadow& shadow = *active[i].first;
+            const LightData& light = *active[i].second;
+            if (shadow.FaceCount == 0) continue;
+            
+            if (!shadow.Rendered) {
+                shadow.Dirty = true;
+            } else if (!shadow.Dirty) {
+                bool moved = shadow.Type != light.Type || shadow.Position != light.Position || shadow.Range != light.Range ||
+                             (light.Type == LightType::Spot && (shadow.Direction != light.Direction || shadow.OuterAngle != light.OuterAngle));
+                shadow.Dirty = moved;
+                for (size_t b = 0; b < m_ChangedBounds.size() && !shadow.Dirty; b++) {
+                    shadow.Dirty = SphereTouchesBox(shadow.Position, shadow.Range, m_ChangedBounds[b]);
+                }
+            }
+            
+            if (shadow.Dirty) {
+                pending.push_back(i);
+            }
+        }
+        
+        // Lights with no shadow at all first, then by screen size weighted by frames waited
+        std::sort(pending.begin(), pending.end(), [&active](size_t a, size_t b) {
+            const LocalShadow& first = *active[a].first;
+            const LocalShadow& second = *active[b].first;
+            if (first.Rendered != second.Rendered) return !first.Rendered;
+            return first.Coverage * (1 + first.Waiting) > second.Coverage * (1 + second.Waiting);
+        });
+        
+        uint32_t facesRendered = 0;
+        for (size_t index : pending) {
+            LocalShadow& shadow = *active[index].first;
+            if (facesRendered > 0 && facesRendered + shadow.FaceCount > m_LocalUpdateBudget) {
+                shadow.Waiting++;
+                m_Stats.LocalFacesPending += shadow.FaceCount;
+                continue;
+            }
+            
+            RecordLocalShadow(shadow, *active[index].second, frame);
+            facesRendered += shadow.FaceCount;
+        }
+        m_Stats.LocalFacesRendered = facesRendered;
+        
+        // Lights sample the depth their tiles hold, even while an update is pending
+        float atlasSize = static_cast<float>(m_LocalAtlasSize);
+        m_LocalData.ShadowCount = 0;
+        m_LocalData.TileCount = 0;
+        for (const auto& entry : active) {
+            const LocalShadow& shadow = *entry.first;
+            if (!shadow.Rendered) continue;
+            
+            uint32_t index = m_LocalData.ShadowCount++;
+            m_LocalData.Shadows[index] = glm::vec4(shadow.Position, static_cast<float>(m_LocalData.TileCount));
+            m_LocalData.Params[index] = glm::vec4(static_cast<float>(shadow.FaceCount), shadow.TexelScale, 0.0f, 0.0f);
+            
+            for (uint32_t face = 0; face < shadow.FaceCount; face++) {
+                const FramebufferTile& tile = shadow.Tiles[face];
+                uint32_t tileIndex = m_LocalData.TileCount++;
+                
+                glm::vec2 offset(tile.X / atlasSize, tile.Y / atlasSize);
+                glm::vec2 extent(tile.Size / atlasSize);
+                glm::vec2 halfTexel(0.5f / atlasSize);
+                m_LocalData.Matrices[tileIndex] = TileToAtlas(tile, atlasSize) * shadow.ViewProjections[face];
+                m_LocalData.Rects[tileIndex] = glm::vec4(offset + halfTexel, offset + extent - halfTexel);
+            }
+            
+            entry.second->ShadowIndex = static_cast<int32_t>(index);
+        }
+        
+        m_Stats.LocalShadows = m_LocalData.ShadowCount;
+        m_Stats.LocalAtlasUsage = m_LocalTiles.GetUsage();
+        frame.LocalAtlasSize = m_LocalAtlasSize;
+    }
+    
+    bool ShadowSystem::AllocateLocalTiles(LocalShadow& shadow, uint32_t faceCount, uint32_t size) {
+        // All faces or none, and the old tiles stay until the new ones are in hand
+        FramebufferTile tiles[6];
+        for (uint32_t face = 0; face < faceCount; face++) {
+            if (!m_LocalTiles.Allocate(size, tiles[face])) {
+                for (uint32_t allocated = 0; allocated < face; allocated++) {
+                    m_LocalTiles.Free(tiles[allocated]);
+                }
+                return false;
+            }
+        }
+        
+        FreeLocalTiles(shadow);
+        for (uint32_t face = 0; face < faceCount; face++) {
+            shadow.Tiles[face] = tiles[face];
+        }
+        shadow.FaceCount = faceCount;
+        return true;
+    }
+    
+    void ShadowSystem::FreeLocalTiles(LocalShadow& shadow) {
+        for (uint32_t face = 0; face < shadow.FaceCount; face++) {
+            m_LocalTiles.Free(shadow.Tiles[face]);
+        }
+        shadow.FaceCount = 0;
+        shadow.Rendered = false;
+        shadow.Dirty = true;
+    }
+    
+    void ShadowSystem::RecordLocalShadow(LocalShadow& shadow, const LightData& light, ShadowFrame& frame) {
+        // Cube faces in the order SampleLocalShadow picks them
+        static const glm::vec3 s_FaceDirections[6] = {
+            { 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f },
+            { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f }
+        };
+        static const glm::vec3 s_FaceUps[6] = {
+            { 0.0f, -1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f },
+            { 0.0f, 0.0f, -1.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }
+        };
+        
+        shadow.Type = light.Type;
+        shadow.Position = light.Position;
+        shadow.Direction = light.Direction;
+        shadow.Range = light.Range;
+        shadow.OuterAngle = light.OuterAngle;
+        
+        // Widened by a texel on each side so PCF at a face's edge still reads its own depth
+        float tileSize = static_cast<float>(shadow.Tiles[0].Size);
+        float border = tileSize / (tileSize - 2.0f);
+        float halfTan = (light.Type == LightType::Point ? 1.0f : std::tan(glm::radians(light.OuterAngle))) * border;
+        float nearPlane = std::max(0.02f, light.Range * 0.01f);
+        glm::mat4 projection = glm::perspective(2.0f * std::atan(halfTan), 1.0f, nearPlane, light.Range);
+        shadow.TexelScale = 2.0f * halfTan / tileSize;
+        
+        std::vector<const Caster*> inRange;
+        for (const auto& caster : m_Casters) {
+            m_Stats.CastersTested++;
+            if (SphereTouchesBox(light.Position, light.Range, caster.Bounds)) {
+                inRange.push_back(&caster);
+            }
+        }
+        
+        for (uint32_t face = 0; face < shadow.FaceCount; face++) {
+            glm::vec3 direction = light.Type == LightType::Point ? s_FaceDirections[face] : light.Direction;
+            glm::vec3 up = light.Type == LightType::Point ? s_FaceUps[face] :
+                           (std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f));
+            shadow.ViewProjections[face] = projection * glm::lookAt(light.Position, light.Position + direction, up);
+            
+            LocalPass pass;
+            pass.ViewProjection = shadow.ViewProjections[face];
+            pass.Tile = shadow.Tiles[face];
+            
+            for (const Caster* caster : inRange) {
+                if (!BoxInFrustum(pass.ViewProjection, caster->Bounds)) continue;
+                
+                Vector3 center = caster->Bounds.GetCenter();
+                float distance = glm::length(glm::vec3(center.x, center.y, center.z) - light.Position);
+                
+                const auto& mesh = caster->Component->Mesh;
+                CasterDraw draw;
+                draw.Mesh = mesh;
+                draw.LOD = SelectLOD(*mesh, caster->Transform, distance * shadow.TexelScale);
+                draw.SubMesh = caster->Component->SubMesh;
+                draw.Transform = RenderSystem::GetMeshTransform(*mesh, caster->Transform);
+                pass.Casters.push_back(std::move(draw));
+            }
+            
+            m_Stats.LocalDraws += static_cast<uint32_t>(pass.Casters.size());
+            frame.LocalPasses.push_back(std::move(pass));
+        }
+        
+        shadow.Rendered = true;
+        shadow.Dirty = false;
+        shadow.Waiting = 0;
+    }
+    
+    void ShadowSystem::CreateAtlas(uint32_t resolution, uint32_t cascadeCount) {
+        uint32_t columns = cascadeCount > 1 ? 2 : 1;
+        uint32_t rows = (cascadeCount + 1) / 2;
+        
+        FramebufferSpecification spec;
+        spec.Width = resolution * columns;
+        spec.Height = resolution * rows;
+        spec.Attachments = { FramebufferTextureFormat::Depth };
+        m_Atlas = Framebuffer::Create(spec);
+        
+        spec.Width = resolution;
+        spec.Height = resolution;
+        m_StaticDepth.resize(cascadeCount);
+        for (auto& cache : m_StaticDepth) {
+            cache = Framebuffer::Create(spec);
+        }
+    }
+    
+    bool ShadowSystem::BindAtlas() const {
+        auto depth = m_Atlas ? m_Atlas->GetDepthAttachment() : nullptr;
+        if (!depth) return false;
+        
+        depth->Bind(AtlasTextureSlot);
+        
+        auto localDepth = m_LocalAtlas ? m_LocalAtlas->GetDepthAttachment() : nullptr;
+        if (localDepth) {
+            localDepth->Bind(LocalAtlasTextureSlot);
+        }
+        return true;
+    }
+    
+    void ShadowSystem::ExecuteShadows(const ShadowFrame& frame, Renderer* renderer) {
+        if (!m_DepthShader) {
+            m_DepthShader = Shader::Create("ShadowDepth", s_ShadowDepthVertexSource, s_ShadowDepthFragmentSource);
+        }
+        if (!m_DepthShader) return;
+        
+        renderer->SetDepthTest(DepthFunc::Less, true);
+        m_DepthShader->Bind();
+        
+        if (!frame.Passes.empty()) {
+            ExecuteCascades(frame, renderer);
+        }
+        if (!frame.LocalPasses.empty()) {
+            ExecuteLocalShadows(frame, renderer);
+        }
+        
+        m_DepthShader->Unbind();
+    }
+    
+    void ShadowSystem::ExecuteCascades(const ShadowFrame& frame, Renderer* renderer) {
+        SPOON_GPU_SCOPE("ShadowSystem::Cascades");
+        
+        // Every pass of a resized atlas is a refit, so all of its tiles get rewritten
+        if (!m_Atlas || m_StaticDepth.size() != frame.CascadeCount ||
+            m_StaticDepth[0]->GetSpecification().Width != frame.Resolution) {
+            CreateAtlas(frame.Resolution, frame.CascadeCount);
+        }
+        if (!m_Atlas) return;
+        
+        // Static depth goes into each cascade's own cache, which then also resets the atlas tile
+        for (const auto& pass : frame.Passes) {
+            auto& cache = m_StaticDepth[pass.Cascade];
+            if (pass.RenderStatic) {
+                cache->Bind();
+                renderer->Clear();
+                m_DepthShader->SetMat4("u_LightSpaceMatrix", pass.ViewProjection);
+                DrawCasters(pass.StaticCasters, renderer);
+                cache->Unbind();
+            }
+            cache->BlitDepth(*m_Atlas, pass.X, pass.Y);
+        }
+        
+        m_Atlas->Bind();
+        for (const auto& pass : frame.Passes) {
+            if (pass.DynamicCasters.empty()) continue;
+            
+            renderer->SetViewport(pass.X, pass.Y, frame.Resolution, frame.Resolution);
+            m_DepthShader->SetMat4("u_LightSpaceMatrix", pass.ViewProjection);
+            DrawCasters(pass.DynamicCasters, renderer);
+        }
+        m_Atlas->Unbind();
+    }
+    
+    void ShadowSystem::ExecuteLocalShadows(const ShadowFrame& frame, Renderer* renderer) {
+        SPOON_GPU_SCOPE("ShadowSystem::LocalLights");
+        
+        // A new atlas holds nothing, but the recording side reset every light along with it
+        if (!m_LocalAtlas || m_LocalAtlas->GetSpecification().Width != frame.LocalAtlasSize) {
+            FramebufferSpecification spec;
+            spec.Width = frame.LocalAtlasSize;
+            spec.Height = frame.LocalAtlasSize;
+            spec.Attachments = { FramebufferTextureFormat::Depth };
+            m_LocalAtlas = Framebuffer::Create(spec);
+        }
+        if (!m_LocalAtlas) return;
+        
+        m_LocalAtlas->Bind();
+        for (const auto& pass : frame.LocalPasses) {
+            const FramebufferTile& tile = pass.Tile;
+            renderer->SetViewport(tile.X, tile.Y, tile.Size, tile.Size);
+            m_LocalAtlas->ClearDepth(tile.X, tile.Y, tile.Size, tile.Size);
+            
+            m_DepthShader->SetMat4("u_LightSpaceMatrix", pass.ViewProjection);
+            DrawCasters(pass.Casters, renderer);
+        }
+        m_LocalAtlas->Unbind();
+    }
+    
+    void ShadowSystem::DrawCasters(const std::vector<CasterDraw>& casters, Renderer* renderer) {
+        const VertexArray* bound = nullptr;
+        for (const auto& draw : casters) {
+            m_DepthShader->SetMat4("u_Model", draw.Transform);
+            
+            const auto& vertexArray = draw.Mesh->GetDrawPositionVertexArray(draw.LOD);
+            if (vertexArray && vertexArray.get() != bound) {
+                vertexArray->Bind();
+                bound = vertexArray.get();
+            }
+            RenderSystem::DrawMesh(renderer, *draw.Mesh, draw.LOD, draw.SubMesh);
+        }
+        
+        if (bound) {
+            bound->Unbind();
+        }
+    }
+    
+}
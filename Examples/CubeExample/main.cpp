@@ -58,6 +58,8 @@ protected:
             out vec3 v_Normal;
             out vec2 v_TexCoord;
             
+            invariant gl_Position;
+            
             void main() {
                 v_WorldPos = vec3(u_Model * vec4(a_Position, 1.0));
                 v_Normal = mat3(transpose(inverse(u_Model))) * a_Normal;
@@ -0,0 +1,103 @@
+#include <SpoonEngine/SpoonEngine.h>
+#include <iostream>
+#include <cstdlib>
+
+// Runs the CPU side of the render path against the null backend: no window, no GPU.
+// Usage: HeadlessBenchmark [entityCount] [frameCount] [depthPrePass 0|1] [occlusionCulling 0|1] [deferred 0|1]
+int main(int argc, char** argv) {
+    uint32_t entityCount = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 4000;
+    uint32_t frameCount = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 300;
+    bool depthPrePass = argc > 3 && std::atoi(argv[3]) != 0;
+    bool occlusionCulling = argc > 4 && std::atoi(argv[4]) != 0;
+    bool deferred = argc > 5 && std::atoi(argv[5]) != 0;
+    
+    // The ECS holds 5000 entities and never hands out ID 0
+    if (entityCount > 4999) {
+        entityCount = 4999;
+    }
+    
+    SpoonEngine::RendererBackend::SetAPI(SpoonEngine::RendererAPI::Null);
+    
+    SpoonEngine::JobSystem::Init();
+    
+    SpoonEngine::Renderer renderer;
+    renderer.Initialize();
+    
+    SpoonEngine::World world;
+    world.RegisterComponent<SpoonEngine::Transform>();
+    world.RegisterComponent<SpoonEngine::MeshRenderer>();
+    
+    auto renderSystem = world.RegisterSystem<SpoonEngine::RenderSystem>();
+    renderSystem->SetWorld(&world);
+    renderSystem->SetDepthPrePass(depthPrePass);
+    renderSystem->SetOcclusionCulling(occlusionCulling);
+    renderSystem->SetDeferredShading(deferred);
+    renderSystem->SetViewportSize(1280, 720);
+    
+    SpoonEngine::Signature renderSignature;
+    renderSignature.set(world.GetComponentManager()->GetComponentType<SpoonEngine::Transform>());
+    renderSignature.set(world.GetComponentManager()->GetComponentType<SpoonEngine::MeshRenderer>());
+    world.SetSystemSignature<SpoonEngine::RenderSystem>(renderSignature);
+    
+    // The null shader only inspects source text, so declaring the block is enough to
+    // route static renderers through the indirect path,
+    auto dynamicShader = SpoonEngine::Shader::Create("Dynamic", "uniform mat4 u_Model;", "");
+    // and the G-buffer normal output into the deferred pass
+    auto staticShader = SpoonEngine::Shader::Create("Static", "uniform DrawTransforms { mat4 u_Models[256]; };",
+                                                    "layout (location = 1) out vec2 o_GBufferNormal;");
+    
+    auto dynamicMaterial = SpoonEngine::Material::Create(dynamicShader, "DynamicMaterial");
+    auto staticMaterial = SpoonEngine::Material::Create(staticShader, "StaticMaterial");
+    
+    auto cube = SpoonEngine::Mesh::CreateCube();
+    auto sphere = SpoonEngine::Mesh::CreateSphere();
+    
+    for (uint32_t i = 0; i < entityCount; i++) {
+        auto entity = world.CreateEntity();
+        
+        float x = static_cast<float>(i % 64) * 2.0f;
+        float z = static_cast<float>(i / 64) * 2.0f;
+        world.AddComponent(entity, SpoonEngine::Transform(SpoonEngine::Vector3(x, 0.0f, z)));
+        
+        SpoonEngine::MeshRenderer meshRenderer;
+        meshRenderer.Mesh = (i % 2 == 0) ? cube : sphere;
+        meshRenderer.Static = (i % 4 != 0);
+        meshRenderer.Material = meshRenderer.Static ? staticMaterial : dynamicMaterial;
+        world.AddComponent(entity, meshRenderer);
+    }
+    
+    double recordTime = 0.0;
+    double submitTime = 0.0;
+    SpoonEngine::RendererStats stats;
+    
+    for (uint32_t frame = 0; frame < frameCount; frame++) {
+        world.Update();
+        
+        renderer.BeginFrame();
+        renderer.Clear();
+        world.Render(&renderer);
+        renderer.Present();
+        renderer.EndFrame();
+        
+        recordTime += renderer.GetFrameTimings().RecordTime;
+        submitTime += renderer.GetFrameTimings().SubmitTime;
+        stats = renderer.GetStats();
+    }
+    
+    std::cout << "Entities:        " << entityCount << std::endl;
+    std::cout << "Frames:          " << frameCount << std::endl;
+    std::cout << "Depth pre-pass:  " << (depthPrePass ? "on" : "off") << std::endl;
+    std::cout << "Deferred:        " << (deferred ? "on" : "off") << std::endl;
+    std::cout << "Culled:          " << renderSystem->GetCullingStats().FrustumCulled << " frustum, "
+              << renderSystem->GetCullingStats().Occluded << " occluded" << std::endl;
+    std::cout << "Record (avg ms): " << recordTime / frameCount << std::endl;
+    std::cout << "Submit (avg ms): " << submitTime / frameCount << std::endl;
+    std::cout << "Draw calls:      " << stats.DrawCalls << std::endl;
+    std::cout << "State changes:   " << stats.StateChanges << std::endl;
+    std::cout << "Uploaded bytes:  " << stats.UploadedBytes << std::endl;
+    std::cout << "Triangles:       " << stats.Triangles << std::endl;
+    
+    renderer.Shutdown();
+    SpoonEngine::JobSystem::Shutdown();
+    return 0;
+}
@@ -12,6 +12,9 @@
 class ModelLoadingExampleApp : public SpoonEngine::Application {
 public:
     ModelLoadingExampleApp() : Application("SpoonEngine - 3D Model Loading Demo") {
+        // Record frames here and execute them on a render thread; material edits in OnUpdate
+        // reach it through the render system's per-frame snapshots
+        SetThreadedRendering(true);
         std::cout << "Model Loading Example created" << std::endl;
     }
     
@@ -176,6 +179,7 @@ private:
                 
                 SpoonEngine::MeshRenderer renderer;
                 renderer.Mesh = modelMesh.MeshData;
+                renderer.SubMesh = modelMesh.SubMeshIndex;
                 renderer.Material = modelMesh.Material;
                 
                 // Update material lighting properties
@@ -212,6 +216,8 @@ private:
             out vec3 v_Normal;
             out vec2 v_TexCoord;
             
+            invariant gl_Position;
+            
             void main() {
                 v_WorldPos = vec3(u_Model * vec4(a_Position, 1.0));
                 v_Normal = mat3(transpose(inverse(u_Model))) * a_Normal;
@@ -312,11 +318,14 @@ private:
             out vec3 v_Normal;
             out vec2 v_TexCoord;
             
+            invariant gl_Position;
+            
             void main() {
                 v_Normal = mat3(transpose(inverse(u_Model))) * a_Normal;
                 v_TexCoord = a_TexCoord * 6.0; // Tile the texture
                 
-                gl_Position = u_Projection * u_View * u_Model * vec4(a_Position, 1.0);
+                vec3 worldPos = vec3(u_Model * vec4(a_Position, 1.0));
+                gl_Position = u_Projection * u_View * vec4(worldPos, 1.0);
             }
         )";
         
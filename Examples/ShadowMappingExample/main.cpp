@@ -1,12 +1,6 @@
 #include <SpoonEngine/SpoonEngine.h>
 #include <iostream>
-
-#ifdef SPOON_PLATFORM_MACOS
-    #define GL_SILENCE_DEPRECATION
-    #include <OpenGL/gl3.h>
-#else
-    #include <GL/glew.h>
-#endif
+#include <cmath>
 
 class ShadowMappingExampleApp : public SpoonEngine::Application {
 public:
@@ -17,7 +11,7 @@ public:
     virtual ~ShadowMappingExampleApp() {
         std::cout << "Shadow Mapping Example destroyed" << std::endl;
     }
-    
+
 protected:
     void OnInitialize() override {
         std::cout << "Shadow Mapping Example initialized" << std::endl;
@@ -30,6 +24,7 @@ protected:
         world->RegisterComponent<SpoonEngine::Transform>();
         world->RegisterComponent<SpoonEngine::MeshRenderer>();
         world->RegisterComponent<SpoonEngine::CameraComponent>();
+        world->RegisterComponent<SpoonEngine::LightComponent>();
         
         // Register render system
         m_RenderSystem = world->RegisterSystem<SpoonEngine::RenderSystem>();
@@ -40,59 +35,42 @@ protected:
         renderSignature.set(world->GetComponentManager()->GetComponentType<SpoonEngine::MeshRenderer>());
         world->SetSystemSignature<SpoonEngine::RenderSystem>(renderSignature);
         
-        // Create shadow mapping framebuffer
-        CreateShadowMapFramebuffer();
-        
-        // Create shadow mapping shader
+        // Register shadow system; the render system draws its cascades before the camera pass
+        m_ShadowSystem = world->RegisterSystem<SpoonEngine::ShadowSystem>();
+        m_ShadowSystem->SetWorld(world);
+        m_ShadowSystem->SetLightDirection(m_LightDirection);
+        m_ShadowSystem->SetShadowDistance(40.0f);
+        world->SetSystemSignature<SpoonEngine::ShadowSystem>(renderSignature);
+        m_RenderSystem->SetShadowSystem(m_ShadowSystem);
+        
+        // Register light system; its point and spot lights are shaded through the light clusters
+        m_LightSystem = world->RegisterSystem<SpoonEngine::LightSystem>();
+        m_LightSystem->SetWorld(world);
+        
+        SpoonEngine::Signature lightSignature;
+        lightSignature.set(world->GetComponentManager()->GetComponentType<SpoonEngine::Transform>());
+        lightSignature.set(world->GetComponentManager()->GetComponentType<SpoonEngine::LightComponent>());
+        world->SetSystemSignature<SpoonEngine::LightSystem>(lightSignature);
+        m_RenderSystem->SetLightSystem(m_LightSystem);
+        
+        // Create shadow receiving shader
         CreateShadowMappingShaders();
         
         // Create scene objects
         CreateScene();
         
+        // Create point and spot lights
+        CreateLights();
+        
         // Setup camera
         SetupCamera();
         
         std::cout << "Shadow mapping demo initialized with " << m_SceneEntities.size() << " objects" << std::endl;
     }
-    
+
 private:
-    void CreateShadowMapFramebuffer() {
-        SpoonEngine::FramebufferSpecification shadowMapSpec;
-        shadowMapSpec.Width = SHADOW_MAP_SIZE;
-        shadowMapSpec.Height = SHADOW_MAP_SIZE;
-        shadowMapSpec.Attachments = { SpoonEngine::FramebufferTextureFormat::DEPTH24STENCIL8 };
-        shadowMapSpec.SwapChainTarget = false;
-        
-        m_ShadowMapFramebuffer = SpoonEngine::Framebuffer::Create(shadowMapSpec);
-        
-        std::cout << "Created shadow map framebuffer (" << SHADOW_MAP_SIZE << "x" << SHADOW_MAP_SIZE << ")" << std::endl;
-    }
-    
     void CreateShadowMappingShaders() {
-        // Shadow map generation shader (depth-only pass)
-        std::string shadowVertexShader = R"(
-            #version 330 core
-            layout (location = 0) in vec3 a_Position;
-            
-            uniform mat4 u_LightSpaceMatrix;
-            uniform mat4 u_Model;
-            
-            void main() {
-                gl_Position = u_LightSpaceMatrix * u_Model * vec4(a_Position, 1.0);
-            }
-        )";
-        
-        std::string shadowFragmentShader = R"(
-            #version 330 core
-            
-            void main() {
-                // gl_FragDepth is written automatically
-            }
-        )";
-        
-        m_ShadowMapShader = SpoonEngine::Shader::Create("ShadowMap", shadowVertexShader, shadowFragmentShader);
-        
-        // Main rendering shader with shadow mapping
+        // Main rendering shader sampling the engine's shadow cascades and light clusters
         std::string mainVertexShader = R"(
             #version 330 core
             layout (location = 0) in vec3 a_Position;
@@ -102,72 +80,41 @@ private:
             uniform mat4 u_Model;
             uniform mat4 u_View;
             uniform mat4 u_Projection;
-            uniform mat4 u_LightSpaceMatrix;
             
             out vec3 v_WorldPos;
             out vec3 v_Normal;
             out vec2 v_TexCoord;
-            out vec4 v_FragPosLightSpace;
+            out float v_ViewDepth;
+            
+            invariant gl_Position;
             
             void main() {
                 v_WorldPos = vec3(u_Model * vec4(a_Position, 1.0));
                 v_Normal = mat3(transpose(inverse(u_Model))) * a_Normal;
                 v_TexCoord = a_TexCoord;
-                v_FragPosLightSpace = u_LightSpaceMatrix * vec4(v_WorldPos, 1.0);
+                v_ViewDepth = -(u_View * vec4(v_WorldPos, 1.0)).z;
                 
                 gl_Position = u_Projection * u_View * vec4(v_WorldPos, 1.0);
             }
         )";
         
-        std::string mainFragmentShader = R"(
+        std::string mainFragmentShader = std::string(R"(
             #version 330 core
-            
+        )") + SpoonEngine::ShadowSystem::GetShadowSource() + SpoonEngine::LightSystem::GetClusterSource() + R"(
             in vec3 v_WorldPos;
             in vec3 v_Normal;
             in vec2 v_TexCoord;
-            in vec4 v_FragPosLightSpace;
+            in float v_ViewDepth;
             
             uniform vec3 u_CameraPosition;
             uniform sampler2D u_MainTexture;
-            uniform sampler2D u_ShadowMap;
             uniform vec3 u_Color;
-            uniform vec3 u_LightPosition;
+            uniform vec3 u_LightDirection;
             uniform vec3 u_LightColor;
             uniform float u_LightIntensity;
             
             out vec4 FragColor;
             
-            float ShadowCalculation(vec4 fragPosLightSpace) {
-                // Perform perspective divide
-                vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
-                
-                // Transform to [0,1] range
-                projCoords = projCoords * 0.5 + 0.5;
-                
-                // Get closest depth value from light's perspective
-                float closestDepth = texture(u_ShadowMap, projCoords.xy).r;
-                
-                // Get depth of current fragment from light's perspective
-                float currentDepth = projCoords.z;
-                
-                // Check whether current frag pos is in shadow
-                float bias = 0.005;
-                float shadow = currentDepth - bias > closestDepth ? 1.0 : 0.0;
-                
-                // PCF (Percentage Closer Filtering) for softer shadows
-                shadow = 0.0;
-                vec2 texelSize = 1.0 / textureSize(u_ShadowMap, 0);
-                for(int x = -1; x <= 1; ++x) {
-                    for(int y = -1; y <= 1; ++y) {
-                        float pcfDepth = texture(u_ShadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
-                        shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
-                    }
-                }
-                shadow /= 9.0;
-                
-                return shadow;
-            }
-            
             void main() {
                 vec3 norm = normalize(v_Normal);
                 vec3 color = texture(u_MainTexture, v_TexCoord).rgb * u_Color;
@@ -177,7 +124,7 @@ private:
                 vec3 ambient = ambientStrength * u_LightColor;
                 
                 // Diffuse
-                vec3 lightDir = normalize(u_LightPosition - v_WorldPos);
+                vec3 lightDir = normalize(-u_LightDirection);
                 float diff = max(dot(norm, lightDir), 0.0);
                 vec3 diffuse = diff * u_LightColor * u_LightIntensity;
                 
@@ -188,10 +135,13 @@ private:
                 vec3 specular = spec * u_LightColor * u_LightIntensity * 0.5;
                 
                 // Calculate shadow
-                float shadow = ShadowCalculation(v_FragPosLightSpace);
+                float shadow = SampleCascadedShadow(v_WorldPos, norm, v_ViewDepth);
+                
+                // Point and spot lights of this fragment's cluster
+                vec3 local = ComputeClusteredLighting(v_WorldPos, norm, viewDir, 32.0);
                 
                 // Combine lighting with shadow
-                vec3 lighting = ambient + (1.0 - shadow) * (diffuse + specular);
+                vec3 lighting = ambient + (1.0 - shadow) * (diffuse + specular) + local;
                 vec3 result = lighting * color;
                 
                 FragColor = vec4(result, 1.0);
@@ -214,7 +164,7 @@ private:
         auto material = SpoonEngine::Material::Create(m_MainShader, "ShadowMaterial");
         material->SetTexture("u_MainTexture", m_CheckerboardTexture);
         material->SetFloat3("u_Color", glm::vec3(1.0f, 1.0f, 1.0f));
-        material->SetFloat3("u_LightPosition", glm::vec3(m_LightPosition.x, m_LightPosition.y, m_LightPosition.z));
+        material->SetFloat3("u_LightDirection", m_LightDirection);
         material->SetFloat3("u_LightColor", glm::vec3(1.0f, 1.0f, 0.9f));
         material->SetFloat("u_LightIntensity", 1.0f);
         
@@ -228,13 +178,14 @@ private:
         auto groundMaterial = SpoonEngine::Material::Create(m_MainShader, "GroundMaterial");
         groundMaterial->SetTexture("u_MainTexture", m_CheckerboardTexture);
         groundMaterial->SetFloat3("u_Color", glm::vec3(0.8f, 0.8f, 0.8f));
-        groundMaterial->SetFloat3("u_LightPosition", glm::vec3(m_LightPosition.x, m_LightPosition.y, m_LightPosition.z));
+        groundMaterial->SetFloat3("u_LightDirection", m_LightDirection);
         groundMaterial->SetFloat3("u_LightColor", glm::vec3(1.0f, 1.0f, 0.9f));
         groundMaterial->SetFloat("u_LightIntensity", 1.0f);
         
         SpoonEngine::MeshRenderer groundRenderer;
         groundRenderer.Mesh = mesh;
         groundRenderer.Material = groundMaterial;
+        groundRenderer.Static = true;
         world->AddComponent(groundEntity, groundRenderer);
         m_SceneEntities.push_back(groundEntity);
         
@@ -262,19 +213,65 @@ private:
                 0.4f + (i * 0.1f), 
                 0.8f - (i * 0.1f)
             ));
-            cubeMaterial->SetFloat3("u_LightPosition", glm::vec3(m_LightPosition.x, m_LightPosition.y, m_LightPosition.z));
+            cubeMaterial->SetFloat3("u_LightDirection", m_LightDirection);
             cubeMaterial->SetFloat3("u_LightColor", glm::vec3(1.0f, 1.0f, 0.9f));
             cubeMaterial->SetFloat("u_LightIntensity", 1.0f);
             
             SpoonEngine::MeshRenderer renderer;
             renderer.Mesh = mesh;
             renderer.Material = cubeMaterial;
+            // The last cube moves, so only its depth is redrawn each frame
+            renderer.Static = i + 1 < cubePositions.size();
             world->AddComponent(cubeEntity, renderer);
             
             m_SceneEntities.push_back(cubeEntity);
+            m_MovingCube = cubeEntity;
         }
     }
     
+    void CreateLights() {
+        auto world = GetWorld();
+        
+        // A ring of small colored point lights above the ground
+        const int ringCount = 48;
+        for (int i = 0; i < ringCount; i++) {
+            float angle = 6.2831853f * i / ringCount;
+            
+            auto lightEntity = world->CreateEntity();
+            SpoonEngine::Transform transform;
+            transform.Position = SpoonEngine::Vector3(cos(angle) * 4.5f, -0.6f, sin(angle) * 4.5f);
+            world->AddComponent(lightEntity, transform);
+            
+            SpoonEngine::LightComponent light;
+            light.Type = SpoonEngine::LightType::Point;
+            light.Color = SpoonEngine::Vector3(
+                0.5f + 0.5f * cos(angle),
+                0.5f + 0.5f * cos(angle + 2.094f),
+                0.5f + 0.5f * cos(angle + 4.189f)
+            );
+            light.Intensity = 2.0f;
+            light.Range = 1.5f;
+            world->AddComponent(lightEntity, light);
+        }
+        
+        // One shadowed spot light looking down at the cubes
+        auto spotEntity = world->CreateEntity();
+        SpoonEngine::Transform spotTransform;
+        spotTransform.Position = SpoonEngine::Vector3(0.0f, 6.0f, 0.0f);
+        spotTransform.Rotation = SpoonEngine::Vector3(90.0f, 0.0f, 0.0f);
+        world->AddComponent(spotEntity, spotTransform);
+        
+        SpoonEngine::LightComponent spot;
+        spot.Type = SpoonEngine::LightType::Spot;
+        spot.Color = SpoonEngine::Vector3(1.0f, 0.85f, 0.6f);
+        spot.Intensity = 30.0f;
+        spot.Range = 12.0f;
+        spot.InnerAngle = 20.0f;
+        spot.OuterAngle = 30.0f;
+        spot.CastShadows = true;
+        world->AddComponent(spotEntity, spot);
+    }
+    
     void SetupCamera() {
         auto world = GetWorld();
         
@@ -329,89 +326,7 @@ private:
         
         std::cout << "Created checkerboard texture for shadow mapping demo" << std::endl;
     }
-    
-    glm::mat4 CalculateLightSpaceMatrix() {
-        float near_plane = 1.0f, far_plane = 20.0f;
-        glm::mat4 lightProjection = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, near_plane, far_plane);
-        
-        glm::vec3 lightPos(m_LightPosition.x, m_LightPosition.y, m_LightPosition.z);
-        glm::mat4 lightView = glm::lookAt(lightPos, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        
-        return lightProjection * lightView;
-    }
-    
-    void RenderShadowMap() {
-        glm::mat4 lightSpaceMatrix = CalculateLightSpaceMatrix();
-        
-        // Render to shadow map
-        m_ShadowMapFramebuffer->Bind();
-        GetRenderer()->Clear();
-        
-        // Configure viewport
-        glViewport(0, 0, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE);
-        
-        auto world = GetWorld();
-        
-        // Render all objects to shadow map
-        for (auto entity : m_SceneEntities) {
-            if (world->HasComponent<SpoonEngine::Transform>(entity) && 
-                world->HasComponent<SpoonEngine::MeshRenderer>(entity)) {
-                
-                auto& transform = world->GetComponent<SpoonEngine::Transform>(entity);
-                auto& meshRenderer = world->GetComponent<SpoonEngine::MeshRenderer>(entity);
-                
-                if (meshRenderer.Mesh) {
-                    glm::mat4 model = transform.GetTransformMatrix();
-                    
-                    m_ShadowMapShader->Bind();
-                    m_ShadowMapShader->SetMat4("u_LightSpaceMatrix", lightSpaceMatrix);
-                    m_ShadowMapShader->SetMat4("u_Model", model);
-                    
-                    meshRenderer.Mesh->Bind();
-                    GetRenderer()->DrawIndexed(meshRenderer.Mesh->GetIndexCount());
-                    meshRenderer.Mesh->Unbind();
-                    
-                    m_ShadowMapShader->Unbind();
-                }
-            }
-        }
-        
-        m_ShadowMapFramebuffer->Unbind();
-        
-        // Store light space matrix for main rendering pass
-        m_LightSpaceMatrix = lightSpaceMatrix;
-    }
-    
-    void RenderMainPass() {
-        // Bind default framebuffer and configure viewport
-        glViewport(0, 0, 1280, 720); // Should get actual window size
-        
-        auto world = GetWorld();
-        auto& cameraComp = world->GetComponent<SpoonEngine::CameraComponent>(m_CameraEntity);
-        
-        // Update all materials with shadow map and light space matrix
-        for (auto entity : m_SceneEntities) {
-            if (world->HasComponent<SpoonEngine::MeshRenderer>(entity)) {
-                auto& meshRenderer = world->GetComponent<SpoonEngine::MeshRenderer>(entity);
-                if (meshRenderer.Material) {
-                    // Bind shadow map texture
-                    auto shadowMapTexture = m_ShadowMapFramebuffer->GetDepthAttachment();
-                    if (shadowMapTexture) {
-                        meshRenderer.Material->SetTexture("u_ShadowMap", shadowMapTexture);
-                    }
-                    meshRenderer.Material->SetMat4("u_LightSpaceMatrix", m_LightSpaceMatrix);
-                    meshRenderer.Material->SetFloat3("u_CameraPosition", 
-                        glm::vec3(cameraComp.Camera->GetPosition().x, 
-                                 cameraComp.Camera->GetPosition().y, 
-                                 cameraComp.Camera->GetPosition().z));
-                }
-            }
-        }
-        
-        // Render using the render system
-        m_RenderSystem->Render(GetRenderer());
-    }
-    
+
 public:
     void OnUpdate(float deltaTime) override {
         if (SpoonEngine::Input::IsKeyPressed(SpoonEngine::KeyCode::Escape)) {
@@ -420,24 +335,15 @@ public:
         
         auto world = GetWorld();
         
-        // Animate light position
-        m_LightAngle += deltaTime * 30.0f;
-        m_LightPosition = SpoonEngine::Vector3(
-            cos(glm::radians(m_LightAngle)) * 8.0f,
-            6.0f,
-            sin(glm::radians(m_LightAngle)) * 8.0f
+        // Move the dynamic cube in a circle; the static casters keep their cached shadow depth
+        m_Time += deltaTime;
+        auto& cubeTransform = world->GetComponent<SpoonEngine::Transform>(m_MovingCube);
+        cubeTransform.Position = SpoonEngine::Vector3(
+            cos(m_Time) * 3.0f,
+            0.5f,
+            sin(m_Time) * 3.0f
         );
         
-        // Update light position in all materials
-        for (auto entity : m_SceneEntities) {
-            if (world->HasComponent<SpoonEngine::MeshRenderer>(entity)) {
-                auto& meshRenderer = world->GetComponent<SpoonEngine::MeshRenderer>(entity);
-                if (meshRenderer.Material) {
-                    meshRenderer.Material->SetFloat3("u_LightPosition", glm::vec3(m_LightPosition.x, m_LightPosition.y, m_LightPosition.z));
-                }
-            }
-        }
-        
         // Handle camera movement
         auto& cameraComp = world->GetComponent<SpoonEngine::CameraComponent>(m_CameraEntity);
         auto flyCamera = std::dynamic_pointer_cast<SpoonEngine::FlyCamera>(cameraComp.Camera);
@@ -465,32 +371,28 @@ public:
     }
     
     void OnRender() override {
-        // Two-pass rendering: shadow map generation + main scene
-        RenderShadowMap();
-        RenderMainPass();
+        // Renders the shadow cascades and light tiles, then the scene
+        m_RenderSystem->Render(GetRenderer());
     }
     
     void OnShutdown() override {
         std::cout << "Shadow Mapping Example shutdown" << std::endl;
     }
-    
+
 private:
-    static const uint32_t SHADOW_MAP_SIZE = 2048;
-    
     std::shared_ptr<SpoonEngine::RenderSystem> m_RenderSystem;
+    std::shared_ptr<SpoonEngine::ShadowSystem> m_ShadowSystem;
+    std::shared_ptr<SpoonEngine::LightSystem> m_LightSystem;
     std::vector<SpoonEngine::Entity> m_SceneEntities;
     SpoonEngine::Entity m_CameraEntity;
+    SpoonEngine::Entity m_MovingCube;
     std::shared_ptr<SpoonEngine::Texture2D> m_CheckerboardTexture;
     
-    // Shadow mapping resources
-    std::shared_ptr<SpoonEngine::Framebuffer> m_ShadowMapFramebuffer;
-    std::shared_ptr<SpoonEngine::Shader> m_ShadowMapShader;
     std::shared_ptr<SpoonEngine::Shader> m_MainShader;
     
-    // Lighting
-    SpoonEngine::Vector3 m_LightPosition = SpoonEngine::Vector3(5.0f, 6.0f, 2.0f);
-    float m_LightAngle = 0.0f;
-    glm::mat4 m_LightSpaceMatrix;
+    // Lighting; a fixed direction keeps the cached static shadow depth valid
+    glm::vec3 m_LightDirection = glm::normalize(glm::vec3(-0.5f, -1.0f, -0.2f));
+    float m_Time = 0.0f;
 };
 
 SPOON_MAIN(ShadowMappingExampleApp)
\ No newline at end of file